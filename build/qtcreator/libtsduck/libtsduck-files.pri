@@ -176,9 +176,11 @@ HEADERS += \
     ../../../src/libtsduck/tshlsMediaPlayList.h \
     ../../../src/libtsduck/tshlsMediaSegment.h \
     ../../../src/libtsduck/tshlsPlayList.h \
+    ../../../src/libtsduck/tshlsPrefetchBuffer.h \
     ../../../src/libtsduck/tshlsTagAttributes.h \
     ../../../src/libtsduck/tsIBPDescriptor.h \
     ../../../src/libtsduck/tsIDSA.h \
+    ../../../src/libtsduck/tsIndexedSectionFile.h \
     ../../../src/libtsduck/tsInputRedirector.h \
     ../../../src/libtsduck/tsINT.h \
     ../../../src/libtsduck/tsIntegerUtils.h \
@@ -251,6 +253,8 @@ HEADERS += \
     ../../../src/libtsduck/tsPESDemux.h \
     ../../../src/libtsduck/tsPESHandlerInterface.h \
     ../../../src/libtsduck/tsPESPacket.h \
+    ../../../src/libtsduck/tsPIDMap.h \
+    ../../../src/libtsduck/tsPIDMapTemplate.h \
     ../../../src/libtsduck/tsPIDOperator.h \
     ../../../src/libtsduck/tsPlatform.h \
     ../../../src/libtsduck/tsPlugin.h \
@@ -311,6 +315,7 @@ HEADERS += \
     ../../../src/libtsduck/tsSHA256.h \
     ../../../src/libtsduck/tsSHA512.h \
     ../../../src/libtsduck/tsSharedLibrary.h \
+    ../../../src/libtsduck/tsSharedPacketRing.h \
     ../../../src/libtsduck/tsShortEventDescriptor.h \
     ../../../src/libtsduck/tsSimpleApplicationBoundaryDescriptor.h \
     ../../../src/libtsduck/tsSimpleApplicationLocationDescriptor.h \
@@ -410,10 +415,13 @@ HEADERS += \
     ../../../src/libtsduck/tsTSAnalyzer.h \
     ../../../src/libtsduck/tsTSAnalyzerOptions.h \
     ../../../src/libtsduck/tsTSAnalyzerReport.h \
+    ../../../src/libtsduck/tsTSAnalyzerSnapshot.h \
     ../../../src/libtsduck/tsTSDT.h \
+    ../../../src/libtsduck/tsTSFileIndex.h \
     ../../../src/libtsduck/tsTSFileInput.h \
     ../../../src/libtsduck/tsTSFileInputBuffered.h \
     ../../../src/libtsduck/tsTSFileOutput.h \
+    ../../../src/libtsduck/tsTSFileOutputArgs.h \
     ../../../src/libtsduck/tsTSFileOutputResync.h \
     ../../../src/libtsduck/tsTSPacket.h \
     ../../../src/libtsduck/tsTSPacketQueue.h \
@@ -458,6 +466,7 @@ HEADERS += \
     ../../../src/libtsduck/tsxmlElement.h \
     ../../../src/libtsduck/tsxmlElementTemplate.h \
     ../../../src/libtsduck/tsxmlNode.h \
+    ../../../src/libtsduck/tsxmlPullParser.h \
     ../../../src/libtsduck/tsxmlText.h \
     ../../../src/libtsduck/tsxmlTweaks.h \
     ../../../src/libtsduck/tsxmlTweaksArgs.h \
@@ -608,9 +617,11 @@ SOURCES += \
     ../../../src/libtsduck/tshlsMediaPlayList.cpp \
     ../../../src/libtsduck/tshlsMediaSegment.cpp \
     ../../../src/libtsduck/tshlsPlayList.cpp \
+    ../../../src/libtsduck/tshlsPrefetchBuffer.cpp \
     ../../../src/libtsduck/tshlsTagAttributes.cpp \
     ../../../src/libtsduck/tsIBPDescriptor.cpp \
     ../../../src/libtsduck/tsIDSA.cpp \
+    ../../../src/libtsduck/tsIndexedSectionFile.cpp \
     ../../../src/libtsduck/tsInputRedirector.cpp \
     ../../../src/libtsduck/tsINT.cpp \
     ../../../src/libtsduck/tsIntegerUtils.cpp \
@@ -715,6 +726,7 @@ SOURCES += \
     ../../../src/libtsduck/tsSHA256.cpp \
     ../../../src/libtsduck/tsSHA512.cpp \
     ../../../src/libtsduck/tsSharedLibrary.cpp \
+    ../../../src/libtsduck/tsSharedPacketRing.cpp \
     ../../../src/libtsduck/tsShortEventDescriptor.cpp \
     ../../../src/libtsduck/tsSimpleApplicationBoundaryDescriptor.cpp \
     ../../../src/libtsduck/tsSimpleApplicationLocationDescriptor.cpp \
@@ -798,10 +810,13 @@ SOURCES += \
     ../../../src/libtsduck/tsTSAnalyzer.cpp \
     ../../../src/libtsduck/tsTSAnalyzerOptions.cpp \
     ../../../src/libtsduck/tsTSAnalyzerReport.cpp \
+    ../../../src/libtsduck/tsTSAnalyzerSnapshot.cpp \
     ../../../src/libtsduck/tsTSDT.cpp \
+    ../../../src/libtsduck/tsTSFileIndex.cpp \
     ../../../src/libtsduck/tsTSFileInput.cpp \
     ../../../src/libtsduck/tsTSFileInputBuffered.cpp \
     ../../../src/libtsduck/tsTSFileOutput.cpp \
+    ../../../src/libtsduck/tsTSFileOutputArgs.cpp \
     ../../../src/libtsduck/tsTSFileOutputResync.cpp \
     ../../../src/libtsduck/tsTSPacket.cpp \
     ../../../src/libtsduck/tsTSPacketQueue.cpp \
@@ -837,6 +852,7 @@ SOURCES += \
     ../../../src/libtsduck/tsxmlDocument.cpp \
     ../../../src/libtsduck/tsxmlElement.cpp \
     ../../../src/libtsduck/tsxmlNode.cpp \
+    ../../../src/libtsduck/tsxmlPullParser.cpp \
     ../../../src/libtsduck/tsxmlText.cpp \
     ../../../src/libtsduck/tsxmlTweaks.cpp \
     ../../../src/libtsduck/tsxmlTweaksArgs.cpp \
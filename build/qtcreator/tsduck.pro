@@ -87,6 +87,7 @@ SUBDIRS += \
     tsplugin_scrambler \
     tsplugin_sdt \
     tsplugin_sections \
+    tsplugin_shm \
     tsplugin_sifilter \
     tsplugin_skip \
     tsplugin_slice \
@@ -115,6 +116,7 @@ SUBDIRS += \
     tsftrunc \
     tsgenecm \
     tshides \
+    tsindex \
     tslsdvb \
     tsp \
     tspacketize \
@@ -21,6 +21,7 @@ SOURCES += \
     ../../../src/utest/utestConfig.cpp \
     ../../../src/utest/utestCppUnitMain.cpp \
     ../../../src/utest/utestCppUnitTest.cpp \
+    ../../../src/utest/utestCRC32.cpp \
     ../../../src/utest/utestCrypto.cpp \
     ../../../src/utest/utestDemux.cpp \
     ../../../src/utest/utestDirectShow.cpp \
@@ -40,8 +41,10 @@ SOURCES += \
     ../../../src/utest/utestNames.cpp \
     ../../../src/utest/utestNetworking.cpp \
     ../../../src/utest/utestPacketizer.cpp \
+    ../../../src/utest/utestPIDMap.cpp \
     ../../../src/utest/utestPlatform.cpp \
     ../../../src/utest/utestPlugin.cpp \
+    ../../../src/utest/utestProcessorPlugin.cpp \
     ../../../src/utest/utestReport.cpp \
     ../../../src/utest/utestResidentBuffer.cpp \
     ../../../src/utest/utestRing.cpp \
@@ -49,6 +52,7 @@ SOURCES += \
     ../../../src/utest/utestScrambling.cpp \
     ../../../src/utest/utestSection.cpp \
     ../../../src/utest/utestSectionFile.cpp \
+    ../../../src/utest/utestSharedPacketRing.cpp \
     ../../../src/utest/utestSingleton.cpp \
     ../../../src/utest/utestStaticInstance.cpp \
     ../../../src/utest/utestSystemRandomGenerator.cpp \
@@ -59,6 +63,11 @@ SOURCES += \
     ../../../src/utest/utestThread.cpp \
     ../../../src/utest/utestThreadAttributes.cpp \
     ../../../src/utest/utestTime.cpp \
+    ../../../src/utest/utestTSAnalyzerSnapshot.cpp \
+    ../../../src/utest/utestTSFileIndex.cpp \
+    ../../../src/utest/utestTSFileInput.cpp \
+    ../../../src/utest/utestTSFileOutput.cpp \
+    ../../../src/utest/utestTSFileOutputArgs.cpp \
     ../../../src/utest/utestTSPacket.cpp \
     ../../../src/utest/utestUString.cpp \
     ../../../src/utest/utestVariable.cpp \
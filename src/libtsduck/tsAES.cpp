@@ -1012,6 +1012,126 @@ namespace {
 }
 
 
+//----------------------------------------------------------------------------
+// AES-NI implementation (x86-64 AES instructions).
+// The round keys are the same as the portable implementation, in memory
+// order. The decryption keys are the "equivalent inverse cipher" keys,
+// already transformed by InvMixColumns, as expected by AESDEC.
+//----------------------------------------------------------------------------
+
+#if defined(TS_X86_64) && (defined(TS_GCC) || defined(TS_MSC))
+
+#define TS_AES_NI 1
+
+#if defined(TS_MSC)
+#include <intrin.h>
+#define AESNI_TARGET
+#else
+#include <cpuid.h>
+#include <immintrin.h>
+#define AESNI_TARGET __attribute__((target("aes,sse2")))
+#endif
+
+namespace {
+
+    // Check once if the CPU supports AES-NI.
+    bool CheckAESNI()
+    {
+#if defined(TS_MSC)
+        int regs[4];
+        ::__cpuid(regs, 1);
+        return (regs[2] & (1 << 25)) != 0;
+#else
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (::__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+            return false;
+        }
+        return (ecx & bit_AES) != 0;
+#endif
+    }
+
+    bool SupportAESNI()
+    {
+        static const bool supported = CheckAESNI();
+        return supported;
+    }
+
+    // Encrypt or decrypt blocks with AES-NI.
+    AESNI_TARGET void EncryptNI(const uint8_t* keys, int Nr, const uint8_t* in, uint8_t* out, size_t count)
+    {
+        __m128i rk[15];
+        for (int r = 0; r <= Nr; ++r) {
+            rk[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + 16 * r));
+        }
+        // Interleave four independent blocks to hide the latency of AESENC.
+        while (count >= 4) {
+            __m128i b0 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), rk[0]);
+            __m128i b1 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16)), rk[0]);
+            __m128i b2 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 32)), rk[0]);
+            __m128i b3 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 48)), rk[0]);
+            for (int r = 1; r < Nr; ++r) {
+                b0 = _mm_aesenc_si128(b0, rk[r]);
+                b1 = _mm_aesenc_si128(b1, rk[r]);
+                b2 = _mm_aesenc_si128(b2, rk[r]);
+                b3 = _mm_aesenc_si128(b3, rk[r]);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_aesenclast_si128(b0, rk[Nr]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_aesenclast_si128(b1, rk[Nr]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 32), _mm_aesenclast_si128(b2, rk[Nr]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 48), _mm_aesenclast_si128(b3, rk[Nr]));
+            in += 64;
+            out += 64;
+            count -= 4;
+        }
+        // Remaining blocks, one by one.
+        for (; count > 0; --count, in += 16, out += 16) {
+            __m128i b = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), rk[0]);
+            for (int r = 1; r < Nr; ++r) {
+                b = _mm_aesenc_si128(b, rk[r]);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_aesenclast_si128(b, rk[Nr]));
+        }
+    }
+
+    AESNI_TARGET void DecryptNI(const uint8_t* keys, int Nr, const uint8_t* in, uint8_t* out, size_t count)
+    {
+        __m128i rk[15];
+        for (int r = 0; r <= Nr; ++r) {
+            rk[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + 16 * r));
+        }
+        // Interleave four independent blocks to hide the latency of AESDEC.
+        while (count >= 4) {
+            __m128i b0 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), rk[0]);
+            __m128i b1 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16)), rk[0]);
+            __m128i b2 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 32)), rk[0]);
+            __m128i b3 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 48)), rk[0]);
+            for (int r = 1; r < Nr; ++r) {
+                b0 = _mm_aesdec_si128(b0, rk[r]);
+                b1 = _mm_aesdec_si128(b1, rk[r]);
+                b2 = _mm_aesdec_si128(b2, rk[r]);
+                b3 = _mm_aesdec_si128(b3, rk[r]);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_aesdeclast_si128(b0, rk[Nr]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_aesdeclast_si128(b1, rk[Nr]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 32), _mm_aesdeclast_si128(b2, rk[Nr]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 48), _mm_aesdeclast_si128(b3, rk[Nr]));
+            in += 64;
+            out += 64;
+            count -= 4;
+        }
+        // Remaining blocks, one by one.
+        for (; count > 0; --count, in += 16, out += 16) {
+            __m128i b = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), rk[0]);
+            for (int r = 1; r < Nr; ++r) {
+                b = _mm_aesdec_si128(b, rk[r]);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_aesdeclast_si128(b, rk[Nr]));
+        }
+    }
+}
+
+#endif
+
 //----------------------------------------------------------------------------
 // Schedule a new key. If rounds is zero, the default is used.
 // Return true on success, false on error.
@@ -1165,26 +1285,22 @@ bool ts::AES::setKey(const void* key_, size_t key_length, size_t rounds)
     *rk++ = *rrk++;
     *rk   = *rrk;
 
+    // Round keys in memory order for hardware acceleration.
+    for (i = 0; i < 4 * (_Nr + 1); i++) {
+        PutUInt32(_hwEK + 4 * i, _eK[i]);
+        PutUInt32(_hwDK + 4 * i, _dK[i]);
+    }
+
     return true;
 }
 
 
 //----------------------------------------------------------------------------
-// Encryption in ECB mode.
-// Return true on success, false on error.
+// Encryption of one block using the portable implementation.
 //----------------------------------------------------------------------------
 
-bool ts::AES::encrypt(const void* plain, size_t plain_length,
-                      void* cipher, size_t cipher_maxsize,
-                      size_t* cipher_length)
+void ts::AES::encryptBlock(const uint8_t* pt, uint8_t* ct)
 {
-    if (plain_length != BLOCK_SIZE || cipher_maxsize < BLOCK_SIZE) {
-        return false;
-    }
-
-    const uint8_t* pt = reinterpret_cast<const uint8_t*> (plain);
-    uint8_t* ct = reinterpret_cast<uint8_t*> (cipher);
-
     uint32_t s0, s1, s2, s3, t0, t1, t2, t3, *rk;
     int Nr, r;
 
@@ -1288,31 +1404,15 @@ bool ts::AES::encrypt(const void* plain, size_t plain_length,
         (Te4_0[BYTE (t2, 0)]) ^
         rk[3];
     PutUInt32 (ct+12, s3);
-
-    if (cipher_length != nullptr) {
-        *cipher_length = BLOCK_SIZE;
-    }
-
-    return true;
 }
 
 
 //----------------------------------------------------------------------------
-// Decryption in ECB mode.
-// Return true on success, false on error.
+// Decryption of one block using the portable implementation.
 //----------------------------------------------------------------------------
 
-bool ts::AES::decrypt(const void* cipher, size_t cipher_length,
-                      void* plain, size_t plain_maxsize,
-                      size_t* plain_length)
+void ts::AES::decryptBlock(const uint8_t* ct, uint8_t* pt)
 {
-    if (cipher_length != BLOCK_SIZE || plain_maxsize < BLOCK_SIZE) {
-        return false;
-    }
-
-    const uint8_t* ct = reinterpret_cast<const uint8_t*> (cipher);
-    uint8_t* pt = reinterpret_cast<uint8_t*> (plain);
-
     uint32_t s0, s1, s2, s3, t0, t1, t2, t3, *rk;
     int Nr, r;
 
@@ -1417,20 +1517,117 @@ bool ts::AES::decrypt(const void* cipher, size_t cipher_length,
         (Td4[BYTE (t0, 0)] & 0x000000ff) ^
         rk[3];
     PutUInt32 (pt+12, s3);
+}
+
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+ts::AES::AES() :
+    _Nr(0),
+    _accel(IsAccelerated()),
+    _eK(),
+    _dK(),
+    _hwEK(),
+    _hwDK()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Hardware acceleration control.
+//----------------------------------------------------------------------------
+
+bool ts::AES::IsAccelerated()
+{
+#if defined(TS_AES_NI)
+    return SupportAESNI();
+#else
+    return false;
+#endif
+}
+
+void ts::AES::setAcceleration(bool on)
+{
+    _accel = on && IsAccelerated();
+}
+
 
+//----------------------------------------------------------------------------
+// Encryption in ECB mode.
+// Return true on success, false on error.
+//----------------------------------------------------------------------------
+
+bool ts::AES::encrypt(const void* plain, size_t plain_length,
+                      void* cipher, size_t cipher_maxsize,
+                      size_t* cipher_length)
+{
+    if (plain_length != BLOCK_SIZE || cipher_maxsize < BLOCK_SIZE || !encryptBlocks(plain, cipher, 1)) {
+        return false;
+    }
+    if (cipher_length != nullptr) {
+        *cipher_length = BLOCK_SIZE;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Decryption in ECB mode.
+// Return true on success, false on error.
+//----------------------------------------------------------------------------
+
+bool ts::AES::decrypt(const void* cipher, size_t cipher_length,
+                      void* plain, size_t plain_maxsize,
+                      size_t* plain_length)
+{
+    if (cipher_length != BLOCK_SIZE || plain_maxsize < BLOCK_SIZE || !decryptBlocks(cipher, plain, 1)) {
+        return false;
+    }
     if (plain_length != nullptr) {
         *plain_length = BLOCK_SIZE;
     }
-
     return true;
 }
 
 
 //----------------------------------------------------------------------------
-// Constructor
+// Encryption / decryption of several blocks in ECB mode.
 //----------------------------------------------------------------------------
 
-ts::AES::AES() :
-    _Nr(0)
+bool ts::AES::encryptBlocks(const void* plain, void* cipher, size_t count)
+{
+    const uint8_t* pt = reinterpret_cast<const uint8_t*>(plain);
+    uint8_t* ct = reinterpret_cast<uint8_t*>(cipher);
+
+#if defined(TS_AES_NI)
+    if (_accel) {
+        EncryptNI(_hwEK, _Nr, pt, ct, count);
+        return true;
+    }
+#endif
+
+    for (; count > 0; --count, pt += BLOCK_SIZE, ct += BLOCK_SIZE) {
+        encryptBlock(pt, ct);
+    }
+    return true;
+}
+
+bool ts::AES::decryptBlocks(const void* cipher, void* plain, size_t count)
 {
+    const uint8_t* ct = reinterpret_cast<const uint8_t*>(cipher);
+    uint8_t* pt = reinterpret_cast<uint8_t*>(plain);
+
+#if defined(TS_AES_NI)
+    if (_accel) {
+        DecryptNI(_hwDK, _Nr, ct, pt, count);
+        return true;
+    }
+#endif
+
+    for (; count > 0; --count, ct += BLOCK_SIZE, pt += BLOCK_SIZE) {
+        decryptBlock(ct, pt);
+    }
+    return true;
 }
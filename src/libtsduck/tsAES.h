@@ -68,10 +68,36 @@ namespace ts {
         virtual bool decrypt(const void* cipher, size_t cipher_length,
                              void* plain, size_t plain_maxsize,
                              size_t* plain_length = nullptr) override;
+        virtual bool encryptBlocks(const void* plain, void* cipher, size_t count) override;
+        virtual bool decryptBlocks(const void* cipher, void* plain, size_t count) override;
+
+        //!
+        //! Check if AES hardware acceleration is supported on this system.
+        //! Currently, this is the AES-NI instruction set on x86-64 processors.
+        //! @return True if AES hardware acceleration is supported.
+        //!
+        static bool IsAccelerated();
+
+        //!
+        //! Enable or disable the hardware acceleration for this instance.
+        //! By default, hardware acceleration is used when supported. Disabling it
+        //! is typically used in tests and benchmarks, to compare with the portable
+        //! implementation. The results are identical in all cases.
+        //! @param [in] on When true, use hardware acceleration if supported.
+        //! When false, always use the portable implementation.
+        //!
+        void setAcceleration(bool on);
 
     private:
-        int      _Nr;     //!< Number of rounds
-        uint32_t _eK[60]; //!< Scheduled encryption keys
-        uint32_t _dK[60]; //!< Scheduled decryption keys
+        int      _Nr;        //!< Number of rounds
+        bool     _accel;     //!< Use hardware acceleration
+        uint32_t _eK[60];    //!< Scheduled encryption keys
+        uint32_t _dK[60];    //!< Scheduled decryption keys
+        uint8_t  _hwEK[240]; //!< Encryption round keys in memory order, for hardware acceleration
+        uint8_t  _hwDK[240]; //!< Decryption round keys in memory order, for hardware acceleration
+
+        // Encrypt / decrypt one block using the portable implementation.
+        void encryptBlock(const uint8_t* pt, uint8_t* ct);
+        void decryptBlock(const uint8_t* ct, uint8_t* pt);
     };
 }
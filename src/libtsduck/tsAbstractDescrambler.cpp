@@ -560,3 +560,34 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
     // Descramble the packet payload.
     return pecm->scrambling.decrypt(pkt) ? TSP_OK : TSP_END;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+size_t ts::AbstractDescrambler::processPacketBatch(TSPacket* pkt, size_t count, Status* status, bool& flush, bool& bitrate_changed)
+{
+    // The packets of the batch are descrambled together, after all other processing.
+    _scrambling.startBatch();
+    for (ECMStreamMap::iterator it = _ecm_streams.begin(); it != _ecm_streams.end(); ++it) {
+        it->second->scrambling.startBatch();
+    }
+
+    const size_t done = ProcessorPlugin::processPacketBatch(pkt, count, status, flush, bitrate_changed);
+
+    // Do not pass any packet from the first one which was not properly descrambled.
+    bool ok = _scrambling.endBatch();
+    size_t first = _scrambling.batchErrorIndex(pkt, done);
+    for (ECMStreamMap::iterator it = _ecm_streams.begin(); it != _ecm_streams.end(); ++it) {
+        ok = it->second->scrambling.endBatch() && ok;
+        first = std::min(first, it->second->scrambling.batchErrorIndex(pkt, done));
+    }
+    if (first < done) {
+        status[first] = TSP_END;
+    }
+    else if (!ok && done > 0) {
+        status[done - 1] = TSP_END;
+    }
+    return done;
+}
@@ -61,6 +61,7 @@ namespace ts {
         virtual bool stop() override;
         virtual BitRate getBitrate() override {return 0;}
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, size_t, Status*, bool&, bool&) override;
 
     protected:
         //!
@@ -97,7 +97,8 @@ bool ts::ArgsWithPlugins::analyze(const ts::UString& app_name, const ts::UString
     // Locate the first processor option. All preceeding options are command-specific options and must be analyzed.
     PluginType plugin_type = PROCESSOR_PLUGIN;
     PluginOptionsVector* options = nullptr;
-    size_t plugin_index = nextProcOpt(args, 0, plugin_type, options);
+    bool grouped = false;
+    size_t plugin_index = nextProcOpt(args, 0, plugin_type, options, grouped);
 
     // Analyze the command-specifc options, not including the plugin options, not processing redirections.
     if (!Args::analyze(app_name, UStringVector(args.begin(), args.begin() + plugin_index), false)) {
@@ -123,10 +124,11 @@ bool ts::ArgsWithPlugins::analyze(const ts::UString& app_name, const ts::UString
         opt.type = plugin_type;
         opt.name = args[plugin_index + 1];
         opt.args.clear();
+        opt.grouped = grouped;
 
         // Search for next plugin.
         const size_t start = plugin_index;
-        plugin_index = nextProcOpt(args, plugin_index + 2, plugin_type, options);
+        plugin_index = nextProcOpt(args, plugin_index + 2, plugin_type, options, grouped);
 
         // Now set options of previous plugin.
         opt.args.insert(opt.args.begin(), args.begin() + start + 2, args.begin() + plugin_index);
@@ -167,12 +169,32 @@ bool ts::ArgsWithPlugins::analyze(const ts::UString& app_name, const ts::UString
 }
 
 
+//----------------------------------------------------------------------------
+// Get the CPU affinity of a plugin thread from a command line option.
+//----------------------------------------------------------------------------
+
+void ts::ArgsWithPlugins::getCPUAffinity(ThreadAttributes::CPUSet& cpus, const UChar* name, size_t index, const ThreadAttributes::CPUSet& def_cpus)
+{
+    const size_t occurrences = count(name);
+    if (occurrences == 0) {
+        cpus = def_cpus;
+    }
+    else {
+        const UString list(value(name, u"", std::min(index, occurrences - 1)));
+        if (!ThreadAttributes::DecodeCPUList(list, cpus)) {
+            error(u"invalid list of CPU's for --%s: %s", {name, list});
+        }
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Search the next plugin option.
 //----------------------------------------------------------------------------
 
-size_t ts::ArgsWithPlugins::nextProcOpt(const UStringVector& args, size_t index, PluginType& type, PluginOptionsVector*& opts)
+size_t ts::ArgsWithPlugins::nextProcOpt(const UStringVector& args, size_t index, PluginType& type, PluginOptionsVector*& opts, bool& grouped)
 {
+    grouped = false;
     while (index < args.size()) {
         const UString& arg(args[index]);
         if (arg == u"-I" || arg == u"--input") {
@@ -190,6 +212,12 @@ size_t ts::ArgsWithPlugins::nextProcOpt(const UStringVector& args, size_t index,
             opts = &plugins;
             return index;
         }
+        if (arg == u"-G" || arg == u"--group") {
+            type = PROCESSOR_PLUGIN;
+            opts = &plugins;
+            grouped = true;
+            return index;
+        }
         index++;
     }
     opts = nullptr;
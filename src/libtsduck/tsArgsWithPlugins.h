@@ -35,6 +35,7 @@
 #pragma once
 #include "tsArgs.h"
 #include "tsPluginOptions.h"
+#include "tsThreadAttributes.h"
 
 namespace ts {
     //!
@@ -77,6 +78,20 @@ namespace ts {
         PluginOptionsVector plugins;   //!< Ordered list of packet processor plugins.
         PluginOptionsVector outputs;   //!< Ordered list of output plugins.
 
+    protected:
+        //!
+        //! Get the CPU affinity of a plugin thread from a command line option.
+        //! The option value is a list of CPU's as decoded by ThreadAttributes::DecodeCPUList().
+        //! When the option is specified several times, the @a index-th occurrence is used
+        //! or the last one when there are less occurrences. An error is reported when
+        //! the value is invalid.
+        //! @param [out] cpus Returned set of CPU's.
+        //! @param [in] name Option name.
+        //! @param [in] index Index of the occurrence to use, typically the plugin index.
+        //! @param [in] def_cpus Default set of CPU's when the option is not present.
+        //!
+        void getCPUAffinity(ThreadAttributes::CPUSet& cpus, const UChar* name, size_t index, const ThreadAttributes::CPUSet& def_cpus);
+
     private:
         const size_t _min_inputs;
         const size_t _max_inputs;
@@ -86,7 +101,7 @@ namespace ts {
         const size_t _max_outputs;
 
         // Search next plugin option.
-        size_t nextProcOpt(const UStringVector& args, size_t index, PluginType& type, PluginOptionsVector*& opts);
+        size_t nextProcOpt(const UStringVector& args, size_t index, PluginType& type, PluginOptionsVector*& opts, bool& grouped);
 
         // Load default list of plugins by type.
         void loadDefaultPlugins(PluginType type, const UString& entry, PluginOptionsVector& options);
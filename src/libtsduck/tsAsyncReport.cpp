@@ -28,12 +28,21 @@
 //----------------------------------------------------------------------------
 
 #include "tsAsyncReport.h"
+#include "tsGuardCondition.h"
+#include "tsSysUtils.h"
+#include "tsTime.h"
 TSDUCK_SOURCE;
 
 #if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
 const size_t ts::AsyncReport::MAX_LOG_MESSAGES;
+const size_t ts::AsyncReport::MAX_RECORD_ARGS;
+const size_t ts::AsyncReport::RECORD_DATA_SIZE;
+const uint16_t ts::AsyncReport::NO_OFFSET;
 #endif
 
+// Maximum wait time of the idle logging thread (safety net, normally signaled).
+#define IDLE_TIMEOUT 1000 // milliseconds
+
 
 //----------------------------------------------------------------------------
 // Default constructor
@@ -42,13 +51,30 @@ const size_t ts::AsyncReport::MAX_LOG_MESSAGES;
 ts::AsyncReport::AsyncReport(int max_severity, bool time_stamp, size_t max_messages, bool synchronous) :
     Report(max_severity),
     Thread(ThreadAttributes().setPriority(ThreadAttributes::GetMinimumPriority())),
-    _log_queue(max_messages),
+    _ring_size(std::max<size_t>(max_messages, 2)),
+    _ring(new Record[_ring_size]),
+    _tail(0),
+    _head(0),
+    _dropped(0),
+    _total_dropped(0),
+    _idle(false),
+    _terminate(false),
+    _mutex(),
+    _wakeup(),
+    _released(),
+    _waiting(0),
     _default_handler(*this),
     _handler(&_default_handler),
     _time_stamp(time_stamp),
     _synchronous(synchronous),
     _terminated(false)
 {
+    // Each slot in the ring is initially free for the message with the same index.
+    for (size_t i = 0; i < _ring_size; ++i) {
+        _ring[i].sequence = i;
+        _ring[i].message = nullptr;
+    }
+
     // Start the logging thread
     start ();
 }
@@ -61,6 +87,12 @@ ts::AsyncReport::AsyncReport(int max_severity, bool time_stamp, size_t max_messa
 ts::AsyncReport::~AsyncReport()
 {
     terminate();
+
+    // Free messages which were queued after the termination of the logging thread.
+    for (size_t i = 0; i < _ring_size; ++i) {
+        delete _ring[i].message;
+    }
+    delete[] _ring;
 }
 
 
@@ -71,48 +103,398 @@ ts::AsyncReport::~AsyncReport()
 void ts::AsyncReport::terminate()
 {
     if (!_terminated) {
-        // Insert an "end of report" message in the queue.
-        // This message will tell the logging thread to terminate.
-        _log_queue.forceEnqueue(new LogMessage(true, 0, UString()));
+        // Tell the logging thread to terminate after logging all queued messages.
+        _terminate = true;
+        wakeUp();
 
         // Wait for termination of the logging thread
         waitForTermination();
         _terminated = true;
+
+        // Application threads which still wait for a free slot must give up.
+        GuardCondition lock(_mutex, _released);
+        lock.signal();
     }
 }
 
 
 //----------------------------------------------------------------------------
-// Message logging method.
+// Message logging methods.
 //----------------------------------------------------------------------------
 
-void ts::AsyncReport::writeLog(int severity, const UString &msg)
+void ts::AsyncReport::writeLog(int severity, const UString& msg)
 {
-    if (!_terminated) {
-        // Enqueue the message immediately (timeout = 0), drop message on overflow.
-        // On the contrary, in synchronous mode, wait infinitely until the message is queued.
-        _log_queue.enqueue(new LogMessage(false, severity, msg), _synchronous ? Infinite : 0);
+    enqueue(severity, nullptr, nullptr, nullptr, &msg);
+}
+
+void ts::AsyncReport::log(int severity, const UChar* fmt, const std::initializer_list<ArgMixIn>& args)
+{
+    if (severity <= _max_severity) {
+        enqueue(severity, nullptr, fmt, &args, nullptr);
+    }
+}
+
+void ts::AsyncReport::log(int severity, const UString& fmt, const std::initializer_list<ArgMixIn>& args)
+{
+    if (severity <= _max_severity) {
+        enqueue(severity, nullptr, fmt.c_str(), &args, nullptr);
+    }
+}
+
+void ts::AsyncReport::logWithPrefix(int severity, const UString& prefix, const UChar* fmt, const std::initializer_list<ArgMixIn>& args)
+{
+    if (severity <= _max_severity) {
+        enqueue(severity, &prefix, fmt, &args, nullptr);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Enqueue a message, in the context of the application thread.
+//----------------------------------------------------------------------------
+
+void ts::AsyncReport::enqueue(int severity, const UString* prefix, const UChar* fmt, const std::initializer_list<ArgMixIn>* args, const UString* msg)
+{
+    if (_terminated) {
+        return;
+    }
+
+    // Reserve a free slot in the ring. This is a lock-free bounded queue where each
+    // slot has a sequence number indicating if it is free for the message at a given
+    // position, filled with that message or not yet released by the logging thread.
+    Record* rec = nullptr;
+    size_t pos = _tail.load(std::memory_order_relaxed);
+    while (rec == nullptr) {
+        Record& slot(_ring[pos % _ring_size]);
+        const ptrdiff_t diff = ptrdiff_t(slot.sequence.load(std::memory_order_acquire) - pos);
+        if (diff == 0) {
+            // The slot is free, try to grab it.
+            if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                rec = &slot;
+            }
+        }
+        else if (diff < 0) {
+            // The slot still contains the message which was one round before: the queue is full.
+            wakeUp();
+            if (!_synchronous) {
+                // Drop the message on overflow, never wait.
+                _dropped++;
+                _total_dropped++;
+                return;
+            }
+            // In synchronous mode, wait until the logging thread frees a slot.
+            if (!waitRelease(slot, pos)) {
+                _dropped++;
+                _total_dropped++;
+                return;
+            }
+            pos = _tail.load(std::memory_order_relaxed);
+        }
+        else {
+            // Another thread grabbed the slot, retry with the next one.
+            pos = _tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Fill the record. Copy the format and the arguments when possible.
+    rec->severity = severity;
+    rec->used = 0;
+    rec->prefix = NO_OFFSET;
+    rec->argc = 0;
+    rec->deferred = false;
+    bool ok = prefix == nullptr || rec->store(rec->prefix, prefix->data(), prefix->length());
+    if (ok) {
+        ok = fmt != nullptr ? rec->storeArgs(fmt, *args) : rec->store(rec->text, msg->data(), msg->length());
+    }
+
+    // If the message is too large for the record, format it now.
+    if (!ok) {
+        UString full(prefix == nullptr ? UString() : *prefix);
+        full.append(fmt != nullptr ? UString::Format(fmt, *args) : *msg);
+        rec->used = 0;
+        rec->prefix = NO_OFFSET;
+        rec->argc = 0;
+        rec->deferred = false;
+        if (!rec->store(rec->text, full.data(), full.length())) {
+            rec->message = new UString(full);
+        }
+    }
+
+    // Publish the message to the logging thread.
+    rec->sequence = pos + 1;
+    if (_idle) {
+        wakeUp();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Wake up the logging thread if it is waiting.
+//----------------------------------------------------------------------------
+
+void ts::AsyncReport::wakeUp()
+{
+    if (_idle.exchange(false)) {
+        GuardCondition lock(_mutex, _wakeup);
+        lock.signal();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// In synchronous mode, wait until the logging thread releases a slot.
+//----------------------------------------------------------------------------
+
+bool ts::AsyncReport::waitRelease(const Record& slot, size_t pos)
+{
+    GuardCondition lock(_mutex, _released);
+
+    // Declare the wait before checking the slot so that the logging thread sees it.
+    _waiting++;
+    while (!_terminate && ptrdiff_t(slot.sequence.load() - pos) < 0) {
+        lock.waitCondition(IDLE_TIMEOUT);
+    }
+    _waiting--;
+
+    // Only one thread is awakened by a signal, pass it to the other waiting threads.
+    if (_waiting > 0) {
+        lock.signal();
+    }
+    return !_terminate;
+}
+
+
+//----------------------------------------------------------------------------
+// Dequeue and release records, in the context of the logging thread.
+//----------------------------------------------------------------------------
+
+ts::AsyncReport::Record* ts::AsyncReport::dequeue()
+{
+    Record* rec = &_ring[_head % _ring_size];
+    return rec->sequence.load(std::memory_order_acquire) == _head + 1 ? rec : nullptr;
+}
+
+void ts::AsyncReport::release(Record* rec)
+{
+    // The slot becomes free for the message which is one round after.
+    rec->sequence.store(_head + _ring_size, std::memory_order_release);
+    _head++;
+
+    // Wake up an application thread which waits for a free slot in synchronous mode.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_waiting > 0) {
+        GuardCondition lock(_mutex, _released);
+        lock.signal();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Copy strings in a record.
+//----------------------------------------------------------------------------
+
+bool ts::AsyncReport::Record::store(uint16_t& offset, const UChar* str, size_t length)
+{
+    const size_t start = (size_t(used) + 1) & ~size_t(1);
+    const size_t size = (length + 1) * sizeof(UChar);
+    if (start + size > RECORD_DATA_SIZE) {
+        return false;
+    }
+    ::memcpy(data + start, str, length * sizeof(UChar));
+    reinterpret_cast<UChar*>(data + start)[length] = CHAR_NULL;
+    offset = uint16_t(start);
+    used = uint16_t(start + size);
+    return true;
+}
+
+bool ts::AsyncReport::Record::store(uint16_t& offset, const char* str, size_t length)
+{
+    if (size_t(used) + length + 1 > RECORD_DATA_SIZE) {
+        return false;
+    }
+    ::memcpy(data + used, str, length);
+    data[used + length] = 0;
+    offset = used;
+    used = uint16_t(used + length + 1);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Copy a message format and its arguments in a record.
+//----------------------------------------------------------------------------
+
+bool ts::AsyncReport::Record::storeArgs(const UChar* fmt, const std::initializer_list<ArgMixIn>& arguments)
+{
+    if (arguments.size() > MAX_RECORD_ARGS || !store(text, fmt, std::char_traits<UChar>::length(fmt))) {
+        return false;
+    }
+
+    for (std::initializer_list<ArgMixIn>::const_iterator it = arguments.begin(); it != arguments.end(); ++it) {
+        RecordArg& a(args[argc++]);
+        a.size = uint8_t(it->size());
+        a.offset = NO_OFFSET;
+        a.value.uint64 = 0;
+        if (it->isBool()) {
+            a.type = ARG_BOOL;
+            a.value.uint64 = it->toBool();
+        }
+        else if (it->isSigned()) {
+            a.type = ARG_SIGNED;
+            a.value.int64 = it->toInt64();
+        }
+        else if (it->isUnsigned()) {
+            a.type = ARG_UNSIGNED;
+            a.value.uint64 = it->toUInt64();
+        }
+        else if (it->isDouble()) {
+            a.type = ARG_DOUBLE;
+            a.value.dbl = it->toDouble();
+        }
+        else if (it->isAnyString8()) {
+            // Also get the string value of StringifyInterface objects, since their state may change.
+            const char* str = it->toCharPtr();
+            a.type = ARG_STRING8;
+            if (!store(a.offset, str, ::strlen(str))) {
+                return false;
+            }
+        }
+        else if (it->isAnyString16()) {
+            const UChar* str = it->toUCharPtr();
+            a.type = ARG_STRING16;
+            if (!store(a.offset, str, std::char_traits<UChar>::length(str))) {
+                return false;
+            }
+        }
+        else {
+            a.type = ARG_NONE;
+        }
+    }
+
+    deferred = true;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Rebuild an argument from a record, with the same type as the original one.
+//----------------------------------------------------------------------------
+
+ts::ArgMixIn ts::AsyncReport::Record::arg(size_t index) const
+{
+    const RecordArg& a(args[index]);
+    switch (a.type) {
+        case ARG_BOOL:
+            return ArgMixIn(a.value.uint64 != 0);
+        case ARG_SIGNED:
+            switch (a.size) {
+                case 1: return ArgMixIn(int8_t(a.value.int64));
+                case 2: return ArgMixIn(int16_t(a.value.int64));
+                case 4: return ArgMixIn(int32_t(a.value.int64));
+                default: return ArgMixIn(a.value.int64);
+            }
+        case ARG_UNSIGNED:
+            switch (a.size) {
+                case 1: return ArgMixIn(uint8_t(a.value.uint64));
+                case 2: return ArgMixIn(uint16_t(a.value.uint64));
+                case 4: return ArgMixIn(uint32_t(a.value.uint64));
+                default: return ArgMixIn(a.value.uint64);
+            }
+        case ARG_DOUBLE:
+            return ArgMixIn(a.value.dbl);
+        case ARG_STRING8:
+            return ArgMixIn(str(a.offset));
+        case ARG_STRING16:
+            return ArgMixIn(ustr(a.offset));
+        case ARG_NONE:
+        default:
+            return ArgMixIn();
     }
 }
 
 
+//----------------------------------------------------------------------------
+// Format the message of a record, in the context of the logging thread.
+//----------------------------------------------------------------------------
+
+ts::UString ts::AsyncReport::Record::format()
+{
+    UString msg;
+    if (message != nullptr) {
+        // Preformatted message, too large for the record.
+        msg.swap(*message);
+        delete message;
+        message = nullptr;
+    }
+    else if (!deferred) {
+        msg = ustr(text);
+    }
+    else {
+        const UChar* const fmt = ustr(text);
+        switch (argc) {
+            case 0:  msg = UString::Format(fmt, {}); break;
+            case 1:  msg = UString::Format(fmt, {arg(0)}); break;
+            case 2:  msg = UString::Format(fmt, {arg(0), arg(1)}); break;
+            case 3:  msg = UString::Format(fmt, {arg(0), arg(1), arg(2)}); break;
+            case 4:  msg = UString::Format(fmt, {arg(0), arg(1), arg(2), arg(3)}); break;
+            case 5:  msg = UString::Format(fmt, {arg(0), arg(1), arg(2), arg(3), arg(4)}); break;
+            case 6:  msg = UString::Format(fmt, {arg(0), arg(1), arg(2), arg(3), arg(4), arg(5)}); break;
+            case 7:  msg = UString::Format(fmt, {arg(0), arg(1), arg(2), arg(3), arg(4), arg(5), arg(6)}); break;
+            default: msg = UString::Format(fmt, {arg(0), arg(1), arg(2), arg(3), arg(4), arg(5), arg(6), arg(7)}); break;
+        }
+    }
+    if (prefix != NO_OFFSET) {
+        msg.insert(0, ustr(prefix));
+    }
+    return msg;
+}
+
+
 //----------------------------------------------------------------------------
 // This hook is invoked in the context of the logging thread.
 //----------------------------------------------------------------------------
 
 void ts::AsyncReport::main()
 {
-    LogMessagePtr msg;
+    for (;;) {
+        // Log all queued messages.
+        Record* rec = nullptr;
+        while ((rec = dequeue()) != nullptr) {
+            const int severity = rec->severity;
+            const UString msg(rec->format());
+            release(rec);
 
-    while (_log_queue.dequeue(msg) && !msg->terminate) {
+            // Invoke the report handler
+            _handler->handleMessage(severity, msg);
+
+            // Abort application on fatal error
+            if (severity == Severity::Fatal) {
+                ::exit(EXIT_FAILURE);
+            }
+        }
 
-        // Invoke the report handler
-        _handler->handleMessage(msg->severity, msg->message);
+        // Report dropped messages.
+        const size_t dropped = _dropped.exchange(0);
+        if (dropped > 0) {
+            _handler->handleMessage(Severity::Warning, UString::Format(u"%'d log messages dropped", {dropped}));
+        }
+
+        // Terminate only when all queued messages are logged.
+        if (_terminate) {
+            if (dequeue() == nullptr) {
+                break;
+            }
+            continue;
+        }
 
-        // Abort application on fatal error
-        if (msg->severity == Severity::Fatal) {
-            ::exit(EXIT_FAILURE);
+        // Wait for new messages. Declare the thread as idle before checking the
+        // queue again so that new messages from now on will wake us up.
+        GuardCondition lock(_mutex, _wakeup);
+        _idle = true;
+        if (dequeue() == nullptr && !_terminate) {
+            lock.waitCondition(IDLE_TIMEOUT);
         }
+        _idle = false;
     }
 
     if (_max_severity >= Severity::Debug) {
@@ -35,9 +35,10 @@
 #pragma once
 #include "tsReport.h"
 #include "tsReportHandler.h"
-#include "tsMessageQueue.h"
-#include "tsNullMutex.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
 #include "tsThread.h"
+#include <atomic>
 
 namespace ts {
     //!
@@ -53,7 +54,14 @@ namespace ts {
     //! cannot immediately enqueue a message or if the internal queue of messages is
     //! full, the message is dropped. In other words, reporting messages is guaranteed
     //! to never block, slow down or crash the application. Messages are dropped when
-    //! necessary to avoid that kind of problem.
+    //! necessary to avoid that kind of problem. The number of dropped messages is
+    //! periodically reported in the log.
+    //!
+    //! The internal queue is a lock-free ring buffer of fixed-size records. When a
+    //! message is logged with a format and a list of arguments, the format and the
+    //! values of the arguments are copied in the record and the message is formatted
+    //! later in the logging thread. Thus, the application threads never format messages,
+    //! never allocate memory (except for very long messages) and never lock a mutex.
     //!
     //! Messages are displayed on the standard error device by default.
     //!
@@ -117,12 +125,35 @@ namespace ts {
         //!
         bool getSynchronous() const { return _synchronous; }
 
+        //!
+        //! Get the total number of messages which were dropped because the queue was full.
+        //! @return The total number of dropped messages.
+        //!
+        size_t droppedMessages() const { return _total_dropped; }
+
         //!
         //! Synchronously terminate the report thread.
         //! Automatically performed in destructor.
         //!
         void terminate();
 
+        //!
+        //! Report a message with a prefix, formatted in the logging thread.
+        //! This is typically used by intermediate Report objects which forward
+        //! messages to an AsyncReport after adding a prefix.
+        //! @param [in] severity Message severity.
+        //! @param [in] prefix A prefix which is prepended to the formatted message.
+        //! @param [in] fmt Format string with embedded '\%' sequences.
+        //! @param [in] args List of arguments to substitute in the format string.
+        //! @see UString::Format()
+        //!
+        void logWithPrefix(int severity, const UString& prefix, const UChar* fmt, const std::initializer_list<ArgMixIn>& args);
+
+        // Report implementation, the messages are formatted in the logging thread.
+        using Report::log;
+        virtual void log(int severity, const UChar* fmt, const std::initializer_list<ArgMixIn>& args) override;
+        virtual void log(int severity, const UString& fmt, const std::initializer_list<ArgMixIn>& args) override;
+
     protected:
         // Report implementation.
         virtual void writeLog(int severity, const UString& msg) override;
@@ -131,19 +162,74 @@ namespace ts {
         // This hook is invoked in the context of the logging thread.
         virtual void main() override;
 
-        // The application threads send that type of message to the logging thread
-        struct LogMessage
+        // Maximum number of arguments and size of text data in a record.
+        static const size_t MAX_RECORD_ARGS = 8;
+        static const size_t RECORD_DATA_SIZE = 448;
+        static const uint16_t NO_OFFSET = 0xFFFF;
+
+        // Types of arguments in a record.
+        enum ArgType : uint8_t {ARG_NONE, ARG_BOOL, ARG_SIGNED, ARG_UNSIGNED, ARG_DOUBLE, ARG_STRING8, ARG_STRING16};
+
+        // One argument in a record, a copy of the original ArgMixIn.
+        struct RecordArg
         {
-            // Members
-            bool    terminate;  // ask the logging thread to terminate
-            int     severity;
-            UString message;
+            ArgType  type;    // Type of argument.
+            uint8_t  size;    // Original size of integer types.
+            uint16_t offset;  // Offset of string in record data.
+            union {
+                int64_t  int64;
+                uint64_t uint64;
+                double   dbl;
+            } value;
+        };
 
-            // Constructor:
-            LogMessage(bool t, int s, const UString& m) : terminate(t), severity(s), message(m) {}
+        // The application threads send that type of record to the logging thread.
+        // The message is either preformatted (in record data or, when too large, on the heap)
+        // or deferred (format and arguments in the record).
+        struct Record
+        {
+            std::atomic<size_t> sequence;  // Sequence number of the slot in the ring.
+            int       severity;            // Message severity.
+            UString*  message;             // Preformatted message, when too large for the record.
+            uint16_t  prefix;              // Offset of the message prefix in data, NO_OFFSET if none.
+            uint16_t  text;                // Offset of the preformatted message or the format in data.
+            uint16_t  used;                // Used size in data.
+            bool      deferred;            // The text is a format to apply on the arguments.
+            uint8_t   argc;                // Number of arguments.
+            RecordArg args[MAX_RECORD_ARGS];
+            uint8_t   data[RECORD_DATA_SIZE];
+
+            // Copy a nul-terminated string in data, return false if too large.
+            bool store(uint16_t& offset, const UChar* str, size_t length);
+            bool store(uint16_t& offset, const char* str, size_t length);
+
+            // Copy a message format and arguments, return false if not possible.
+            bool storeArgs(const UChar* fmt, const std::initializer_list<ArgMixIn>& args);
+
+            // Get a string from data.
+            const UChar* ustr(uint16_t offset) const { return reinterpret_cast<const UChar*>(data + offset); }
+            const char* str(uint16_t offset) const { return reinterpret_cast<const char*>(data + offset); }
+
+            // Rebuild an argument.
+            ArgMixIn arg(size_t index) const;
+
+            // Format the message (in the logging thread).
+            UString format();
         };
-        typedef SafePtr <LogMessage, NullMutex> LogMessagePtr;
-        typedef MessageQueue <LogMessage, NullMutex> LogMessageQueue;
+
+        // Enqueue a message, either a format and its arguments or a preformatted message.
+        void enqueue(int severity, const UString* prefix, const UChar* fmt, const std::initializer_list<ArgMixIn>* args, const UString* msg);
+
+        // Dequeue a record in the logging thread, return null if the queue is empty.
+        Record* dequeue();
+        void release(Record* rec);
+
+        // Wake up the logging thread if it is waiting.
+        void wakeUp();
+
+        // In synchronous mode, wait until the logging thread releases a given slot.
+        // Return false if the logging thread is terminating.
+        bool waitRelease(const Record& slot, size_t pos);
 
         // Default report handler:
         class DefaultHandler : public ReportHandler
@@ -156,7 +242,18 @@ namespace ts {
         };
 
         // Private members:
-        LogMessageQueue         _log_queue;
+        const size_t            _ring_size;      // Number of records in the ring.
+        Record*                 _ring;           // Ring buffer of records.
+        std::atomic<size_t>     _tail;           // Next slot to write (application threads).
+        size_t                  _head;           // Next slot to read (logging thread).
+        std::atomic<size_t>     _dropped;        // Dropped messages since last report.
+        std::atomic<size_t>     _total_dropped;  // Total dropped messages.
+        std::atomic<bool>       _idle;           // The logging thread is waiting for messages.
+        std::atomic<bool>       _terminate;      // The logging thread shall terminate.
+        Mutex                   _mutex;          // Protect the wake up condition.
+        Condition               _wakeup;         // Signaled to wake up the logging thread.
+        Condition               _released;       // Signaled by the logging thread when a slot is released.
+        std::atomic<size_t>     _waiting;        // Number of application threads waiting for a free slot.
         DefaultHandler          _default_handler;
         ReportHandler* volatile _handler;
         volatile bool           _time_stamp;
@@ -177,6 +177,38 @@ namespace ts {
         //!
         virtual bool decryptInPlace(void* data, size_t data_length, size_t* max_actual_length = nullptr);
 
+        //!
+        //! Encrypt several consecutive blocks of data in ECB mode.
+        //!
+        //! This is a building block for cipher chainings. Each block is encrypted
+        //! independently, as with encrypt(). The default implementation calls encrypt()
+        //! on each block. A subclass may provide an implementation which processes
+        //! several blocks in parallel.
+        //!
+        //! @param [in] plain Address of plain text, @a count blocks of blockSize() bytes.
+        //! @param [out] cipher Address of buffer for cipher text, @a count blocks of blockSize() bytes.
+        //! It can be the same as @a plain but the two areas shall not partially overlap.
+        //! @param [in] count Number of blocks to encrypt.
+        //! @return True on success, false on error.
+        //!
+        virtual bool encryptBlocks(const void* plain, void* cipher, size_t count);
+
+        //!
+        //! Decrypt several consecutive blocks of data in ECB mode.
+        //!
+        //! This is a building block for cipher chainings. Each block is decrypted
+        //! independently, as with decrypt(). The default implementation calls decrypt()
+        //! on each block. A subclass may provide an implementation which processes
+        //! several blocks in parallel.
+        //!
+        //! @param [in] cipher Address of cipher text, @a count blocks of blockSize() bytes.
+        //! @param [out] plain Address of buffer for plain text, @a count blocks of blockSize() bytes.
+        //! It can be the same as @a cipher but the two areas shall not partially overlap.
+        //! @param [in] count Number of blocks to decrypt.
+        //! @return True on success, false on error.
+        //!
+        virtual bool decryptBlocks(const void* cipher, void* plain, size_t count);
+
         //!
         //! Virtual destructor.
         //!
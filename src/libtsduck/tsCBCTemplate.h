@@ -102,26 +102,9 @@ bool ts::CBC<CIPHER>::decrypt(const void* cipher, size_t cipher_length,
         *plain_length = cipher_length;
     }
 
-    const uint8_t* previous = this->iv.data();
-    const uint8_t* ct = reinterpret_cast<const uint8_t*> (cipher);
-    uint8_t* pt = reinterpret_cast<uint8_t*> (plain);
-
-    while (cipher_length > 0) {
-        // work = decrypt (cipher-text)
-        if (!this->algo->decrypt(ct, this->block_size, this->work.data(), this->block_size)) {
-            return false;
-        }
-        // plain-text = previous-cipher XOR work
-        for (size_t i = 0; i < this->block_size; ++i) {
-            pt[i] = previous[i] ^ this->work[i];
-        }
-        // previous-cipher = cipher-text
-        previous = ct;
-        // advance one block
-        ct += this->block_size;
-        pt += this->block_size;
-        cipher_length -= this->block_size;
-    }
-
-    return true;
+    // Decrypt several blocks at a time, the IV is the previous cipher of the first block.
+    return this->decryptCBC(reinterpret_cast<const uint8_t*>(cipher),
+                            reinterpret_cast<uint8_t*>(plain),
+                            cipher_length / this->block_size,
+                            this->iv.data());
 }
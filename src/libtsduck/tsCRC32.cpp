@@ -109,13 +109,230 @@ namespace {
     };
 }
 
-// Continue the computation of a data area, following a previous CRC32
 
-void ts::CRC32::add (const void* data, size_t size)
+//----------------------------------------------------------------------------
+// Slicing-by-8 tables: the table of index k contains the CRC32 of a byte
+// followed by k zero bytes. The table of index 0 is fcstab_32.
+//----------------------------------------------------------------------------
+
+namespace {
+    class SliceTables
+    {
+    public:
+        uint32_t tab[8][256];
+        SliceTables()
+        {
+            for (size_t i = 0; i < 256; ++i) {
+                tab[0][i] = fcstab_32[i];
+            }
+            for (size_t k = 1; k < 8; ++k) {
+                for (size_t i = 0; i < 256; ++i) {
+                    tab[k][i] = (tab[k-1][i] << 8) ^ fcstab_32[tab[k-1][i] >> 24];
+                }
+            }
+        }
+    };
+
+    // Built on first use, CRC32 may be computed during static initialization.
+    const SliceTables& GetSliceTables()
+    {
+        static const SliceTables tables;
+        return tables;
+    }
+
+    // Reference implementation, one table lookup per byte.
+    uint32_t AddByteTable(uint32_t fcs, const uint8_t* cp, size_t size)
+    {
+        while (size-- > 0) {
+            fcs = (fcs << 8) ^ fcstab_32[((fcs >> 24) ^ (*cp++)) & 0xFF];
+        }
+        return fcs;
+    }
+
+    // Slicing-by-8 implementation, eight table lookups per 8 bytes.
+    uint32_t AddSlicingBy8(uint32_t fcs, const uint8_t* cp, size_t size)
+    {
+        const SliceTables& t(GetSliceTables());
+        while (size >= 8) {
+            const uint32_t hi = fcs ^ ts::GetUInt32(cp);
+            fcs = t.tab[7][hi >> 24] ^ t.tab[6][(hi >> 16) & 0xFF] ^ t.tab[5][(hi >> 8) & 0xFF] ^ t.tab[4][hi & 0xFF] ^
+                  t.tab[3][cp[4]] ^ t.tab[2][cp[5]] ^ t.tab[1][cp[6]] ^ t.tab[0][cp[7]];
+            cp += 8;
+            size -= 8;
+        }
+        return AddByteTable(fcs, cp, size);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Carry-less multiplication implementation (x86 PCLMULQDQ).
+//
+// The data are processed as one polynomial, most significant bit first.
+// Blocks of 16 bytes are "folded" onto the next ones, using multiplications
+// by constants x^n mod P. The final 128-bit remainder is reduced to 32 bits
+// using a Barrett reduction. See "Fast CRC Computation for Generic Polynomials
+// Using PCLMULQDQ Instruction", Intel, 2009.
+//----------------------------------------------------------------------------
+
+#if defined(TS_X86_64) && (defined(TS_GCC) || defined(TS_MSC))
+
+#define TS_CRC32_CLMUL 1
+
+#if defined(TS_MSC)
+#include <intrin.h>
+#define CLMUL_TARGET
+#else
+#include <cpuid.h>
+#include <immintrin.h>
+#define CLMUL_TARGET __attribute__((target("pclmul,ssse3")))
+#endif
+
+namespace {
+
+    // Check once if the CPU supports PCLMULQDQ and SSSE3.
+    bool CheckCLMUL()
+    {
+        uint32_t ecx = 0;
+#if defined(TS_MSC)
+        int regs[4];
+        ::__cpuid(regs, 1);
+        ecx = uint32_t(regs[2]);
+#else
+        unsigned int eax = 0, ebx = 0, edx = 0;
+        if (::__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+            return false;
+        }
+#endif
+        return (ecx & (1 << 1)) != 0 && (ecx & (1 << 9)) != 0;
+    }
+
+    bool SupportCLMUL()
+    {
+        static const bool supported = CheckCLMUL();
+        return supported;
+    }
+
+    // Fold a 128-bit accumulator onto the next data block: acc * (x^(n+64), x^n) + data.
+    CLMUL_TARGET inline __m128i Fold(__m128i acc, __m128i k, __m128i data)
+    {
+        return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(acc, k, 0x11), _mm_clmulepi64_si128(acc, k, 0x00)), data);
+    }
+
+    // Process the data, at least 64 bytes.
+    CLMUL_TARGET uint32_t AddCLMUL(uint32_t fcs, const uint8_t* cp, size_t size)
+    {
+        // Reverse the bytes of a 16-byte block: the first byte becomes the most significant one.
+        const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+        // Folding constants, high 64 bits: x^(n+64) mod P, low 64 bits: x^n mod P.
+        const __m128i k512 = _mm_set_epi64x(0x8833794C, 0xE6228B11);  // fold by 512 bits
+        const __m128i k128 = _mm_set_epi64x(0xC5B9CD4C, 0xE8A45605);  // fold by 128 bits
+
+        // Load the first 64 bytes in 4 accumulators, the current CRC is xor'ed to the first 32 bits.
+        __m128i a0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cp)), bswap);
+        __m128i a1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cp + 16)), bswap);
+        __m128i a2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cp + 32)), bswap);
+        __m128i a3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cp + 48)), bswap);
+        a0 = _mm_xor_si128(a0, _mm_set_epi32(int(fcs), 0, 0, 0));
+        cp += 64;
+        size -= 64;
+
+        // Fold 64 bytes at a time, 4 independent accumulators.
+        while (size >= 64) {
+            a0 = Fold(a0, k512, _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cp)), bswap));
+            a1 = Fold(a1, k512, _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cp + 16)), bswap));
+            a2 = Fold(a2, k512, _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cp + 32)), bswap));
+            a3 = Fold(a3, k512, _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cp + 48)), bswap));
+            cp += 64;
+            size -= 64;
+        }
+
+        // Fold the 4 accumulators into one.
+        a0 = Fold(Fold(Fold(a0, k128, a1), k128, a2), k128, a3);
+
+        // Fold the remaining 16-byte blocks.
+        while (size >= 16) {
+            a0 = Fold(a0, k128, _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cp)), bswap));
+            cp += 16;
+            size -= 16;
+        }
+
+        // Reduce the 128-bit accumulator A to a 64-bit value T such that T = A * x^32 mod P.
+        // First, A * x^32 = A_hi * x^96 + A_lo * x^32 = 96-bit value.
+        const __m128i k96_64 = _mm_set_epi64x(0x490D678D, 0xF200AA66);  // x^64 mod P, x^96 mod P
+        __m128i t = _mm_xor_si128(_mm_clmulepi64_si128(a0, k96_64, 0x01), _mm_slli_si128(_mm_move_epi64(a0), 4));
+        // Then, 96-bit value T = T_hi * x^64 + T_lo (T_hi is 32 bits).
+        t = _mm_xor_si128(_mm_clmulepi64_si128(t, k96_64, 0x11), _mm_move_epi64(t));
+
+        // Barrett reduction of the 64-bit value to 32 bits.
+        const __m128i mu_p = _mm_set_epi64x(0x104C11DB7, 0x104D101DF);  // P, floor(x^64 / P)
+        __m128i q = _mm_clmulepi64_si128(_mm_srli_epi64(t, 32), mu_p, 0x00);
+        q = _mm_clmulepi64_si128(_mm_srli_epi64(q, 32), mu_p, 0x10);
+        fcs = uint32_t(_mm_cvtsi128_si64(_mm_xor_si128(t, q)));
+
+        // Process the last bytes.
+        return AddSlicingBy8(fcs, cp, size);
+    }
+}
+
+#endif
+
+
+//----------------------------------------------------------------------------
+// Check if a CRC32 engine is supported on this system.
+//----------------------------------------------------------------------------
+
+bool ts::CRC32::IsSupported(Engine engine)
+{
+    switch (engine) {
+        case BYTE_TABLE:
+        case SLICING_BY_8:
+            return true;
+        case CLMUL:
+#if defined(TS_CRC32_CLMUL)
+            return SupportCLMUL();
+#else
+            return false;
+#endif
+        default:
+            return false;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Continue the computation of a data area, following a previous CRC32.
+//----------------------------------------------------------------------------
+
+// Minimum data size to use carry-less multiplication.
+#define CLMUL_MIN_SIZE 64
+
+void ts::CRC32::add(const void* data, size_t size)
 {
-    const uint8_t* cp = static_cast <const uint8_t*> (data);
+    const uint8_t* cp = static_cast<const uint8_t*>(data);
+#if defined(TS_CRC32_CLMUL)
+    if (size >= CLMUL_MIN_SIZE && SupportCLMUL()) {
+        _fcs = AddCLMUL(_fcs, cp, size);
+        return;
+    }
+#endif
+    _fcs = AddSlicingBy8(_fcs, cp, size);
+}
 
-    while (size-- > 0) {
-        _fcs = (_fcs << 8) ^ fcstab_32 [((_fcs >> 24) ^ (*cp++)) & 0xFF];
+void ts::CRC32::add(const void* data, size_t size, Engine engine)
+{
+    const uint8_t* cp = static_cast<const uint8_t*>(data);
+    if (engine == BYTE_TABLE) {
+        _fcs = AddByteTable(_fcs, cp, size);
+        return;
+    }
+#if defined(TS_CRC32_CLMUL)
+    if (engine == CLMUL && size >= CLMUL_MIN_SIZE && SupportCLMUL()) {
+        _fcs = AddCLMUL(_fcs, cp, size);
+        return;
     }
+#endif
+    // Slicing-by-8, also used when carry-less multiplication is unsupported or the data are too short.
+    _fcs = AddSlicingBy8(_fcs, cp, size);
 }
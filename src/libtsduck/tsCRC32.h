@@ -68,6 +68,33 @@ namespace ts {
         //!
         void add(const void* data, size_t size);
 
+        //!
+        //! Available implementations of the CRC32 computation.
+        //! By default, the fastest supported one is used.
+        //!
+        enum Engine {
+            BYTE_TABLE,    //!< Reference implementation, one table lookup per byte.
+            SLICING_BY_8,  //!< Portable implementation, eight table lookups per 8 bytes.
+            CLMUL          //!< Carry-less multiplication (x86 PCLMULQDQ instruction), when supported by the CPU.
+        };
+
+        //!
+        //! Continue the computation of a data area using a specific implementation.
+        //! This is typically used in tests and benchmarks.
+        //! @param [in] data Address of area to analyze.
+        //! @param [in] size Size in bytes of area to analyze.
+        //! @param [in] engine The implementation to use. When the implementation is not
+        //! supported by the CPU or is not efficient on the data size, SLICING_BY_8 is used.
+        //!
+        void add(const void* data, size_t size, Engine engine);
+
+        //!
+        //! Check if an implementation of the CRC32 computation is supported on this system.
+        //! @param [in] engine The implementation to check.
+        //! @return True if @a engine is supported.
+        //!
+        static bool IsSupported(Engine engine);
+
         //!
         //! Get the value of the CRC32 as computed so far.
         //! @return The value of the CRC32 as computed so far.
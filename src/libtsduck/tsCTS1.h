@@ -59,7 +59,7 @@ namespace ts {
         //!
         //! Constructor.
         //!
-        CTS1() : CipherChainingTemplate<CIPHER>(1, 1, 2) {}
+        CTS1() : CipherChainingTemplate<CIPHER>(1, 1, CipherChaining::PARALLEL_BLOCKS) {}
 
         // Implementation of CipherChaining interface.
         virtual size_t minMessageSize() const override {return this->block_size + 1;}
@@ -55,7 +55,7 @@ namespace ts {
         //!
         //! Constructor.
         //!
-        CTS2() : CipherChainingTemplate<CIPHER>(1, 1, 1) {}
+        CTS2() : CipherChainingTemplate<CIPHER>(1, 1, CipherChaining::PARALLEL_BLOCKS) {}
 
         // Implementation of CipherChaining interface.
         virtual size_t minMessageSize() const override {return this->block_size;}
@@ -110,3 +110,40 @@ bool ts::CipherChaining::setIV(const void* iv_data, size_t iv_length)
         return true;
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Decrypt a sequence of complete blocks in CBC mode.
+//----------------------------------------------------------------------------
+
+bool ts::CipherChaining::decryptCBC(const uint8_t* cipher, uint8_t* plain, size_t count, const uint8_t* previous)
+{
+    // Number of blocks to decrypt at a time.
+    const size_t max_blocks = block_size == 0 ? 0 : work.size() / block_size;
+    if (algo == nullptr || max_blocks == 0) {
+        return false;
+    }
+
+    while (count > 0) {
+        const size_t blocks = std::min(count, max_blocks);
+        const size_t size = blocks * block_size;
+        // work = decrypt (cipher-text)
+        if (!algo->decryptBlocks(cipher, work.data(), blocks)) {
+            return false;
+        }
+        // plain-text = previous-cipher XOR work, the previous cipher block of
+        // the first one is given, the others are in the cipher text.
+        for (size_t i = 0; i < block_size; ++i) {
+            plain[i] = previous[i] ^ work[i];
+        }
+        for (size_t i = block_size; i < size; ++i) {
+            plain[i] = cipher[i - block_size] ^ work[i];
+        }
+        // advance
+        previous = cipher + size - block_size;
+        cipher += size;
+        plain += size;
+        count -= blocks;
+    }
+    return true;
+}
@@ -100,6 +100,26 @@ namespace ts {
         ByteBlock    iv;          //!< Current initialization vector.
         ByteBlock    work;        //!< Temporary working buffer.
 
+        //!
+        //! Recommended size of the work buffer, in blocks, for chaining modes which decrypt
+        //! several blocks at a time using BlockCipher::decryptBlocks().
+        //!
+        static const size_t PARALLEL_BLOCKS = 8;
+
+        //!
+        //! Decrypt a sequence of complete blocks in CBC mode.
+        //! The work buffer is used to decrypt as many blocks as possible
+        //! at a time using BlockCipher::decryptBlocks() on the underlying cipher.
+        //! @param [in] cipher Address of cipher text, @a count blocks.
+        //! @param [out] plain Address of buffer for plain text, @a count blocks.
+        //! It shall not overlap with @a cipher.
+        //! @param [in] count Number of blocks to decrypt.
+        //! @param [in] previous Address of the cipher block which precedes @a cipher
+        //! in the chain, usually the initialization vector for the first block.
+        //! @return True on success, false on error.
+        //!
+        bool decryptCBC(const uint8_t* cipher, uint8_t* plain, size_t count, const uint8_t* previous);
+
         //!
         //! Constructor for subclasses.
         //! @param [in,out] cipher An instance of block cipher.
@@ -10,6 +10,9 @@
 //----------------------------------------------------------------------------
 
 #include "tsDVBCSA2.h"
+#if defined(TS_X86_64)
+#include <emmintrin.h>
+#endif
 TSDUCK_SOURCE;
 
 // Operations on 64-bit areas.
@@ -747,3 +750,447 @@ bool ts::DVBCSA2::decrypt(const void* cipher, size_t cipher_length, void* plain,
         return decryptInPlace(plain, cipher_length, plain_length);
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Bitsliced implementation of the stream cipher.
+//
+// The stream cipher is applied on many data blocks in parallel, all of them
+// with the same control word. In a bitsliced word, bit i belongs to the data
+// block i. Each bit of the stream cipher state is a bitsliced word. The
+// S-boxes are evaluated as multiplexer trees. The block cipher is not
+// bitsliced, its 8-bit S-box is better implemented with table lookups.
+//
+// The 8-byte blocks of input and output are represented as 64 bitsliced
+// words, the word index k being the bit k of the 64-bit big-endian value of
+// the block. The transposition between 8-byte blocks and bitsliced words is
+// made by groups of 64 data blocks.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Bitsliced word for 64 data blocks, portable version.
+    class BSWord64
+    {
+    public:
+        static const size_t GROUPS = 1;  // Number of groups of 64 bits.
+        BSWord64() : _v(0) {}
+        BSWord64(const uint64_t* p, size_t stride) : _v(*p) {}
+        static BSWord64 Fill(int bit) { return BSWord64(bit != 0 ? ~uint64_t(0) : 0); }
+        void store(uint64_t* p, size_t stride) const { *p = _v; }
+        BSWord64 operator^(const BSWord64& w) const { return BSWord64(_v ^ w._v); }
+        BSWord64 operator&(const BSWord64& w) const { return BSWord64(_v & w._v); }
+        BSWord64 operator|(const BSWord64& w) const { return BSWord64(_v | w._v); }
+        BSWord64 operator~() const { return BSWord64(~_v); }
+    private:
+        uint64_t _v;
+        explicit BSWord64(uint64_t v) : _v(v) {}
+    };
+
+#if defined(TS_X86_64)
+#define TS_DVBCSA2_SSE2 1
+
+    // Bitsliced word for 128 data blocks, using SSE2 registers (always present on x86-64).
+    class BSWord128
+    {
+    public:
+        static const size_t GROUPS = 2;  // Number of groups of 64 bits.
+        BSWord128() : _v(_mm_setzero_si128()) {}
+        BSWord128(const uint64_t* p, size_t stride) : _v(_mm_set_epi64x(int64_t(p[stride]), int64_t(p[0]))) {}
+        static BSWord128 Fill(int bit) { return BSWord128(_mm_set1_epi32(bit != 0 ? -1 : 0)); }
+        void store(uint64_t* p, size_t stride) const
+        {
+            p[0] = uint64_t(_mm_cvtsi128_si64(_v));
+            p[stride] = uint64_t(_mm_cvtsi128_si64(_mm_unpackhi_epi64(_v, _v)));
+        }
+        BSWord128 operator^(const BSWord128& w) const { return BSWord128(_mm_xor_si128(_v, w._v)); }
+        BSWord128 operator&(const BSWord128& w) const { return BSWord128(_mm_and_si128(_v, w._v)); }
+        BSWord128 operator|(const BSWord128& w) const { return BSWord128(_mm_or_si128(_v, w._v)); }
+        BSWord128 operator~() const { return BSWord128(_mm_xor_si128(_v, _mm_set1_epi32(-1))); }
+    private:
+        __m128i _v;
+        explicit BSWord128(__m128i v) : _v(v) {}
+    };
+
+    typedef BSWord128 BSWord;
+#else
+    typedef BSWord64 BSWord;
+#endif
+
+    // Transpose a 64x64 bit matrix: on output, bit j of a[i] is bit i of a[j] on input.
+    void Transpose64(uint64_t* a)
+    {
+        uint64_t m = TS_UCONST64(0x00000000FFFFFFFF);
+        for (size_t j = 32; j != 0; j >>= 1, m ^= (m << j)) {
+            for (size_t k = 0; k < 64; k = (k + j + 1) & ~j) {
+                const uint64_t t = ((a[k] >> j) ^ a[k + j]) & m;
+                a[k + j] ^= t;
+                a[k] ^= t << j;
+            }
+        }
+    }
+
+    // Select a or b according to s (s ? b : a).
+    template <class W>
+    inline W Mux(const W& a, const W& b, const W& s)
+    {
+        return a ^ ((a ^ b) & s);
+    }
+
+    // Evaluate one output bit of a 5-bit to 2-bit S-box. i4 is the most significant input bit.
+    // The S-box and the bit are template parameters to let the compiler remove the constant selections.
+    template <const int* SBOX, int BIT, class W>
+    inline W SBoxBit(const W& i4, const W& i3, const W& i2, const W& i1, const W& i0)
+    {
+        const W zero(W::Fill(0));
+        const W ones(W::Fill(1));
+        const W ni0(~i0);
+        W m[16];
+        for (size_t n = 0; n < 16; ++n) {
+            const int b0 = (SBOX[2 * n] >> BIT) & 1;
+            const int b1 = (SBOX[2 * n + 1] >> BIT) & 1;
+            m[n] = b0 != 0 ? (b1 != 0 ? ones : ni0) : (b1 != 0 ? i0 : zero);
+        }
+        for (size_t n = 0; n < 8; ++n) {
+            m[n] = Mux(m[2 * n], m[2 * n + 1], i1);
+        }
+        for (size_t n = 0; n < 4; ++n) {
+            m[n] = Mux(m[2 * n], m[2 * n + 1], i2);
+        }
+        for (size_t n = 0; n < 2; ++n) {
+            m[n] = Mux(m[2 * n], m[2 * n + 1], i3);
+        }
+        return Mux(m[0], m[1], i4);
+    }
+
+    // Bitsliced stream cipher, same structure as DVBCSA2::StreamCipher.
+    template <class W>
+    class BSStreamCipher
+    {
+    public:
+        void init(const uint8_t* key);
+        void cipher(const W* in, W* out);
+    private:
+        W A[11][4];  // A[1]..A[10], bit 0 to 3 of each nibble
+        W B[11][4];
+        W X[4];
+        W Y[4];
+        W Z[4];
+        W D[4];
+        W E[4];
+        W F[4];
+        W p;
+        W q;
+        W r;
+    };
+}
+
+template <class W>
+void BSStreamCipher<W>::init(const uint8_t* key)
+{
+    for (size_t n = 0; n < 4; ++n) {
+        for (size_t i = 1; i <= 8; ++i) {
+            A[i][n] = W::Fill((key[(i - 1) / 2] >> (i % 2 == 1 ? n + 4 : n)) & 1);
+            B[i][n] = W::Fill((key[4 + (i - 1) / 2] >> (i % 2 == 1 ? n + 4 : n)) & 1);
+        }
+        A[9][n] = A[10][n] = B[9][n] = B[10][n] = W::Fill(0);
+        X[n] = Y[n] = Z[n] = D[n] = E[n] = F[n] = W::Fill(0);
+    }
+    p = q = r = W::Fill(0);
+}
+
+// Process one 8-byte block. With input data (initialization), the output is ignored and can be null.
+template <class W>
+void BSStreamCipher<W>::cipher(const W* in, W* out)
+{
+    for (size_t i = 0; i < 8; i++) {
+
+        // Bitsliced words of the current byte.
+        const size_t k = 8 * (7 - i);
+
+        for (size_t j = 0; j < 4; j++) {
+
+            // From A[1]..A[10], 35 bits are selected as inputs to 7 s-boxes.
+            const W s1_1(SBoxBit<sbox1, 1>(A[4][0], A[1][2], A[6][1], A[7][3], A[9][0]));
+            const W s1_0(SBoxBit<sbox1, 0>(A[4][0], A[1][2], A[6][1], A[7][3], A[9][0]));
+            const W s2_1(SBoxBit<sbox2, 1>(A[2][1], A[3][2], A[6][3], A[7][0], A[9][1]));
+            const W s2_0(SBoxBit<sbox2, 0>(A[2][1], A[3][2], A[6][3], A[7][0], A[9][1]));
+            const W s3_1(SBoxBit<sbox3, 1>(A[1][3], A[2][0], A[5][1], A[5][3], A[6][2]));
+            const W s3_0(SBoxBit<sbox3, 0>(A[1][3], A[2][0], A[5][1], A[5][3], A[6][2]));
+            const W s4_1(SBoxBit<sbox4, 1>(A[3][3], A[1][1], A[2][3], A[4][2], A[8][0]));
+            const W s4_0(SBoxBit<sbox4, 0>(A[3][3], A[1][1], A[2][3], A[4][2], A[8][0]));
+            const W s5_1(SBoxBit<sbox5, 1>(A[5][2], A[4][3], A[6][0], A[8][1], A[9][2]));
+            const W s5_0(SBoxBit<sbox5, 0>(A[5][2], A[4][3], A[6][0], A[8][1], A[9][2]));
+            const W s6_1(SBoxBit<sbox6, 1>(A[3][1], A[4][1], A[5][0], A[7][2], A[9][3]));
+            const W s6_0(SBoxBit<sbox6, 0>(A[3][1], A[4][1], A[5][0], A[7][2], A[9][3]));
+            const W s7_1(SBoxBit<sbox7, 1>(A[2][2], A[3][0], A[7][1], A[8][2], A[8][3]));
+            const W s7_0(SBoxBit<sbox7, 0>(A[2][2], A[3][0], A[7][1], A[8][2], A[8][3]));
+
+            // Use 4x4 xor to produce extra nibble for T3.
+            W extra_B[4];
+            extra_B[3] = B[3][0] ^ B[6][1] ^ B[7][2] ^ B[9][3];
+            extra_B[2] = B[6][0] ^ B[8][1] ^ B[3][3] ^ B[4][2];
+            extra_B[1] = B[5][3] ^ B[8][2] ^ B[4][0] ^ B[5][1];
+            extra_B[0] = B[9][2] ^ B[6][3] ^ B[3][1] ^ B[8][0];
+
+            W next_A1[4];
+            W next_B1[4];
+            W sum[4];
+            W carry(r);
+            for (size_t n = 0; n < 4; ++n) {
+                // T1 and T2, input nibbles are used during initialisation only.
+                next_A1[n] = A[10][n] ^ X[n];
+                next_B1[n] = B[7][n] ^ B[10][n] ^ Y[n];
+                if (in != nullptr) {
+                    next_A1[n] = next_A1[n] ^ D[n] ^ in[k + n + (j % 2 == 0 ? 4 : 0)];
+                    next_B1[n] = next_B1[n] ^ in[k + n + (j % 2 == 0 ? 0 : 4)];
+                }
+                // T4 = sum, carry of Z + E + r
+                sum[n] = Z[n] ^ E[n] ^ carry;
+                carry = (Z[n] & E[n]) | (carry & (Z[n] ^ E[n]));
+            }
+
+            for (size_t n = 0; n < 4; ++n) {
+                // If p=1, rotate next_B1 left.
+                const W rotated(Mux(next_B1[n], next_B1[(n + 3) % 4], p));
+                // T3 = xor all inputs
+                D[n] = E[n] ^ Z[n] ^ extra_B[n];
+                // If q=1, F = sum, else F = E
+                const W next_E(F[n]);
+                F[n] = Mux(E[n], sum[n], q);
+                E[n] = next_E;
+                // Shift registers.
+                for (size_t m = 10; m > 1; --m) {
+                    A[m][n] = A[m-1][n];
+                    B[m][n] = B[m-1][n];
+                }
+                A[1][n] = next_A1[n];
+                B[1][n] = rotated;
+            }
+            r = Mux(r, carry, q);
+
+            X[3] = s4_0; X[2] = s3_0; X[1] = s2_1; X[0] = s1_1;
+            Y[3] = s6_0; Y[2] = s5_0; Y[1] = s4_1; Y[0] = s3_1;
+            Z[3] = s2_0; Z[2] = s1_0; Z[1] = s6_1; Z[0] = s5_1;
+            p = s7_1;
+            q = s7_0;
+
+            // 2 output bits are a function of the 4 bits of D.
+            if (out != nullptr) {
+                out[k + 7 - 2 * j] = D[2] ^ D[3];
+                out[k + 6 - 2 * j] = D[0] ^ D[1];
+            }
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Batch processing.
+//----------------------------------------------------------------------------
+
+// Number of data blocks which are processed in parallel.
+size_t ts::DVBCSA2::BatchSize()
+{
+    return 64 * BSWord::GROUPS;
+}
+
+// Minimum number of data blocks to use the bitsliced stream cipher.
+#define MIN_BATCH_SIZE 24
+
+// Check parameters of a batch.
+bool ts::DVBCSA2::checkBatch(const size_t sizes[], size_t count) const
+{
+    if (!_init) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (sizes[i] / 8 > MAX_NBLOCKS) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Encrypt a batch of data blocks, at most BatchSize().
+template <class W>
+void ts::DVBCSA2::encryptBatch(uint8_t* const data[], const size_t sizes[], size_t count)
+{
+    uint64_t rows[W::GROUPS][64];
+    W words[64];
+    BSStreamCipher<W> stream;
+
+    // Perform block cipher in reverse CBC mode, in place, on each data block.
+    // Then, get the first block of each data block to initialize the stream cipher.
+    size_t max_steps = 0;
+    for (size_t i = 0; i < 64 * W::GROUPS; i++) {
+        uint64_t& first(rows[i / 64][i % 64]);
+        first = 0;
+        if (i < count && sizes[i] >= 8) {
+            uint8_t* const dt = data[i];
+            uint8_t iblock[8];
+            uint8_t prev[8];
+            clear_8(prev);
+            for (size_t b = sizes[i] / 8; b-- > 0; ) {
+                xor_8(iblock, dt + 8*b, prev);
+                _block.encipher(iblock, dt + 8*b);
+                memcpy_8(prev, dt + 8*b);
+            }
+            first = GetUInt64(dt);
+            max_steps = std::max(max_steps, (sizes[i] + 7) / 8);
+        }
+    }
+    if (max_steps == 0) {
+        return;
+    }
+
+    // Initialize the stream cipher with the first block of each data block.
+    for (size_t g = 0; g < W::GROUPS; ++g) {
+        Transpose64(rows[g]);
+    }
+    for (size_t k = 0; k < 64; ++k) {
+        words[k] = W(&rows[0][k], 64);
+    }
+    stream.init(_key);
+    stream.cipher(words, nullptr);
+
+    // Now perform stream cipher on subsequent blocks and residues.
+    for (size_t step = 1; step < max_steps; ++step) {
+        stream.cipher(nullptr, words);
+        for (size_t k = 0; k < 64; ++k) {
+            words[k].store(&rows[0][k], 64);
+        }
+        for (size_t g = 0; g < W::GROUPS; ++g) {
+            Transpose64(rows[g]);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (sizes[i] >= 8 && 8 * step < sizes[i]) {
+                uint8_t ostream[8];
+                PutUInt64(ostream, rows[i / 64][i % 64]);
+                uint8_t* const dt = data[i] + 8 * step;
+                const size_t size = std::min<size_t>(8, sizes[i] - 8 * step);
+                for (size_t b = 0; b < size; ++b) {
+                    dt[b] ^= ostream[b];
+                }
+            }
+        }
+    }
+}
+
+// Decrypt a batch of data blocks, at most BatchSize().
+template <class W>
+void ts::DVBCSA2::decryptBatch(uint8_t* const data[], const size_t sizes[], size_t count)
+{
+    uint64_t rows[W::GROUPS][64];
+    uint8_t ib[64 * W::GROUPS][8];  // intermediate block of each data block
+    W words[64];
+    BSStreamCipher<W> stream;
+
+    // Initialize stream cipher with first 8 bytes of each scrambled data block.
+    size_t max_steps = 0;
+    for (size_t i = 0; i < 64 * W::GROUPS; i++) {
+        uint64_t& first(rows[i / 64][i % 64]);
+        first = 0;
+        if (i < count && sizes[i] >= 8) {
+            memcpy_8(ib[i], data[i]);
+            first = GetUInt64(data[i]);
+            max_steps = std::max(max_steps, (sizes[i] + 7) / 8);
+        }
+    }
+    if (max_steps == 0) {
+        return;
+    }
+    for (size_t g = 0; g < W::GROUPS; ++g) {
+        Transpose64(rows[g]);
+    }
+    for (size_t k = 0; k < 64; ++k) {
+        words[k] = W(&rows[0][k], 64);
+    }
+    stream.init(_key);
+    stream.cipher(words, nullptr);
+
+    // Decipher all blocks except last one, then residue.
+    for (size_t step = 1; step < max_steps; ++step) {
+        stream.cipher(nullptr, words);
+        for (size_t k = 0; k < 64; ++k) {
+            words[k].store(&rows[0][k], 64);
+        }
+        for (size_t g = 0; g < W::GROUPS; ++g) {
+            Transpose64(rows[g]);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (sizes[i] >= 8 && 8 * step < sizes[i]) {
+                uint8_t ostream[8];
+                PutUInt64(ostream, rows[i / 64][i % 64]);
+                uint8_t* const dt = data[i] + 8 * step;
+                if (8 * step + 8 <= sizes[i]) {
+                    // Full block.
+                    uint8_t oblock[8];
+                    _block.decipher(ib[i], oblock);
+                    xor_8(ib[i], dt, ostream);
+                    xor_8(dt - 8, ib[i], oblock);
+                }
+                else {
+                    // Residue.
+                    for (size_t b = 0; b < sizes[i] - 8 * step; ++b) {
+                        dt[b] ^= ostream[b];
+                    }
+                }
+            }
+        }
+    }
+
+    // Last block of each data block.
+    for (size_t i = 0; i < count; ++i) {
+        if (sizes[i] >= 8) {
+            _block.decipher(ib[i], data[i] + 8 * (sizes[i] / 8 - 1));
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Encrypt / decrypt several data blocks in place.
+//----------------------------------------------------------------------------
+
+bool ts::DVBCSA2::encryptBatchInPlace(uint8_t* const data[], const size_t sizes[], size_t count)
+{
+    if (!checkBatch(sizes, count)) {
+        return false;
+    }
+    const size_t batch = BatchSize();
+    for (size_t i = 0; i < count; ) {
+        if (count - i < MIN_BATCH_SIZE) {
+            // Not enough data blocks for the bitsliced implementation.
+            encryptInPlace(data[i], sizes[i]);
+            i++;
+        }
+        else {
+            const size_t n = std::min(batch, count - i);
+            encryptBatch<BSWord>(data + i, sizes + i, n);
+            i += n;
+        }
+    }
+    return true;
+}
+
+bool ts::DVBCSA2::decryptBatchInPlace(uint8_t* const data[], const size_t sizes[], size_t count)
+{
+    if (!checkBatch(sizes, count)) {
+        return false;
+    }
+    const size_t batch = BatchSize();
+    for (size_t i = 0; i < count; ) {
+        if (count - i < MIN_BATCH_SIZE) {
+            // Not enough data blocks for the bitsliced implementation.
+            decryptInPlace(data[i], sizes[i]);
+            i++;
+        }
+        else {
+            const size_t n = std::min(batch, count - i);
+            decryptBatch<BSWord>(data + i, sizes + i, n);
+            i += n;
+        }
+    }
+    return true;
+}
@@ -87,6 +87,36 @@ namespace ts {
         //!
         static bool IsReducedCW(const uint8_t *cw);
 
+        //!
+        //! Get the number of data blocks which are processed in parallel by the batch methods.
+        //! The batch methods use a bitsliced implementation of the stream cipher.
+        //! The processing time of a batch is roughly the same for 1 to BatchSize() data blocks.
+        //! @return The number of data blocks which are processed in parallel.
+        //!
+        static size_t BatchSize();
+
+        //!
+        //! Encrypt several data blocks in place, all of them with the current control word.
+        //! Each data block is processed as with encryptInPlace(), typically the payload of a TS packet.
+        //! @param [in,out] data Array of @a count addresses of data blocks.
+        //! @param [in] sizes Array of @a count sizes of data blocks.
+        //! @param [in] count Number of data blocks.
+        //! @return True on success, false on error (no control word or one data block is too large).
+        //! On error, no data block is modified.
+        //!
+        bool encryptBatchInPlace(uint8_t* const data[], const size_t sizes[], size_t count);
+
+        //!
+        //! Decrypt several data blocks in place, all of them with the current control word.
+        //! Each data block is processed as with decryptInPlace(), typically the payload of a TS packet.
+        //! @param [in,out] data Array of @a count addresses of data blocks.
+        //! @param [in] sizes Array of @a count sizes of data blocks.
+        //! @param [in] count Number of data blocks.
+        //! @return True on success, false on error (no control word or one data block is too large).
+        //! On error, no data block is modified.
+        //!
+        bool decryptBatchInPlace(uint8_t* const data[], const size_t sizes[], size_t count);
+
         // Implementation of CipherChaining interface. Cannot set IV with DVB CSA.
         virtual bool setIV(const void*, size_t) override { return false; }
         virtual size_t minIVSize() const override { return 0; }
@@ -141,6 +171,11 @@ namespace ts {
             void cipher(const uint8_t* sb, uint8_t *cb);
         };
 
+        // Batch processing with a bitsliced stream cipher, W is the type of bitsliced words.
+        bool checkBatch(const size_t sizes[], size_t count) const;
+        template <class W> void encryptBatch(uint8_t* const data[], const size_t sizes[], size_t count);
+        template <class W> void decryptBatch(uint8_t* const data[], const size_t sizes[], size_t count);
+
         // DVB-CSA scrambling data
         bool         _init;
         EntropyMode  _mode;
@@ -72,16 +72,30 @@ ts::DVBCharsetSingleByte::DVBCharsetSingleByte(const UString& name, uint32_t tab
 bool ts::DVBCharsetSingleByte::decode(UString& str, const uint8_t* dvb, size_t dvbSize) const
 {
     str.clear();
-    str.reserve(dvbSize);
+    if (dvb == nullptr || dvbSize == 0) {
+        return true;
+    }
+
+    // There is at most one character per byte, decode directly into the string.
+    str.resize(dvbSize);
+    const char* in = reinterpret_cast<const char*>(dvb);
+    const char* const inEnd = in + dvbSize;
+    UChar* out = const_cast<UChar*>(str.data());
+    UChar* const outEnd = out + dvbSize;
     bool status = true;
 
-    for (; dvb != nullptr && dvbSize > 0; --dvbSize) {
+    while (in < inEnd) {
         // Get next byte
-        const uint8_t b = *dvb++;
+        const uint8_t b = uint8_t(*in++);
         // Convert it to a code point
         uint16_t cp = 0;
         if (b >= 0x20 && b <= 0x7E) {
-            cp = b; // ASCII range = identity
+            // ASCII range = identity, convert the following ASCII characters at once.
+            *out++ = UChar(b);
+            if (in < inEnd && *in >= 0x20 && *in <= 0x7E) {
+                UString::ConvertASCIIToUTF16(in, inEnd, out, outEnd, 0x20, 0x7E);
+            }
+            continue;
         }
         else if (b >= 0xA0) {
             cp = _upperCodePoints[b - 0xA0];
@@ -91,13 +105,16 @@ bool ts::DVBCharsetSingleByte::decode(UString& str, const uint8_t* dvb, size_t d
         }
         // Add in result if no error.
         if (cp != 0) {
-            str.push_back(UChar(cp));
+            *out++ = UChar(cp);
         }
         else {
             // Untranslatable character.
             status = false;
         }
     }
+
+    // Truncate to the exact number of characters.
+    str.resize(out - str.data());
     return status;
 }
 
@@ -41,7 +41,7 @@ const ts::DVBCharsetUTF8 ts::DVBCharsetUTF8::UTF_8;
 
 bool ts::DVBCharsetUTF8::decode(UString& str, const uint8_t* dvb, size_t dvbSize) const
 {
-    str = UString::FromUTF8(reinterpret_cast<const char*>(dvb), dvbSize);
+    str.assignFromUTF8(reinterpret_cast<const char*>(dvb), dvbSize);
     return true;
 }
 
@@ -48,7 +48,7 @@
 
 template<class CIPHER>
 ts::DVS042<CIPHER>::DVS042() :
-    CipherChainingTemplate<CIPHER>(1, 1, 1),
+    CipherChainingTemplate<CIPHER>(1, 1, CipherChaining::PARALLEL_BLOCKS),
     shortIV(this->block_size)
 {
 }
@@ -176,21 +176,17 @@ bool ts::DVS042<CIPHER>::decrypt(const void* cipher, size_t cipher_length,
     const uint8_t* ct = reinterpret_cast<const uint8_t*>(cipher);
     uint8_t* pt = reinterpret_cast<uint8_t*>(plain);
 
-    while (cipher_length >= this->block_size) {
-        // work = decrypt (cipher-text)
-        if (!this->algo->decrypt(ct, this->block_size, this->work.data(), this->block_size)) {
+    const size_t count = cipher_length / this->block_size;
+    if (count > 0) {
+        // Decrypt several blocks at a time.
+        if (!this->decryptCBC(ct, pt, count, previous)) {
             return false;
         }
-        // plain-text = previous-cipher XOR work
-        for (size_t i = 0; i < this->block_size; ++i) {
-            pt[i] = previous[i] ^ this->work[i];
-        }
-        // previous-cipher = cipher-text
-        previous = ct;
-        // advance one block
-        ct += this->block_size;
-        pt += this->block_size;
-        cipher_length -= this->block_size;
+        // previous-cipher = last cipher-text block
+        ct += count * this->block_size;
+        pt += count * this->block_size;
+        cipher_length -= count * this->block_size;
+        previous = ct - this->block_size;
     }
 
     // Process final block if incomplete
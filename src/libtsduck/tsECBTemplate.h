@@ -51,19 +51,7 @@ bool ts::ECB<CIPHER>::encrypt(const void* plain, size_t plain_length,
         *cipher_length = plain_length;
     }
 
-    const uint8_t* pt = reinterpret_cast<const uint8_t*>(plain);
-    uint8_t* ct = reinterpret_cast<uint8_t*>(cipher);
-
-    while (plain_length > 0) {
-        if (!this->algo->encrypt(pt, this->block_size, ct, this->block_size)) {
-            return false;
-        }
-        ct += this->block_size;
-        pt += this->block_size;
-        plain_length -= this->block_size;
-    }
-
-    return true;
+    return this->algo->encryptBlocks(plain, cipher, plain_length / this->block_size);
 }
 
 
@@ -83,17 +71,5 @@ bool ts::ECB<CIPHER>::decrypt(const void* cipher, size_t cipher_length,
         *plain_length = cipher_length;
     }
 
-    const uint8_t* ct = reinterpret_cast<const uint8_t*>(cipher);
-    uint8_t* pt = reinterpret_cast<uint8_t*>(plain);
-
-    while (cipher_length > 0) {
-        if (!this->algo->decrypt(ct, this->block_size, pt, this->block_size)) {
-            return false;
-        }
-        ct += this->block_size;
-        pt += this->block_size;
-        cipher_length -= this->block_size;
-    }
-
-    return true;
+    return this->algo->decryptBlocks(cipher, plain, cipher_length / this->block_size);
 }
@@ -0,0 +1,464 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Binary section file with an index, for random and lazy access.
+//
+//----------------------------------------------------------------------------
+
+#include "tsIndexedSectionFile.h"
+#include "tsMemoryUtils.h"
+#include "tsSysUtils.h"
+#include "tsNullReport.h"
+TSDUCK_SOURCE;
+
+// File header.
+#define INDEXED_MAGIC     "TSSECIDX"
+#define INDEXED_VERSION   1
+#define HEADER_SIZE       32
+
+// Size of an index entry and number of significant bytes for sorting:
+// PID (2), TID (1), TIDext (2), version (1), section number (1).
+#define ENTRY_SIZE        20
+#define ENTRY_SORT_SIZE    7
+
+// Flags in an index entry.
+#define FLAG_LONG         0x01
+#define FLAG_CURRENT      0x02
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors.
+//----------------------------------------------------------------------------
+
+ts::IndexedSectionFile::Entry::Entry() :
+    pid(PID_NULL),
+    tid(TID_NULL),
+    tid_ext(0),
+    version(0),
+    section_number(0),
+    last_section_number(0),
+    is_long(false),
+    is_current(false),
+    size(0),
+    offset(0)
+{
+}
+
+ts::IndexedSectionFile::IndexedSectionFile() :
+    _file_name(),
+    _base(nullptr),
+    _size(0),
+    _count(0),
+    _index(nullptr),
+    _sorted(nullptr),
+    _mapped(false),
+    _buffer(),
+    _output(),
+    _offset(0),
+    _entries()
+{
+}
+
+ts::IndexedSectionFile::~IndexedSectionFile()
+{
+    close(NULLREP);
+}
+
+
+//----------------------------------------------------------------------------
+// Open an indexed section file for reading.
+//----------------------------------------------------------------------------
+
+bool ts::IndexedSectionFile::open(const UString& file_name, Report& report)
+{
+    if (isOpen() || isCreated()) {
+        report.error(u"%s is already open", {_file_name});
+        return false;
+    }
+    _file_name = file_name;
+
+#if defined(TS_WINDOWS)
+
+    // No memory mapping, load the complete file.
+    if (!_buffer.loadFromFile(file_name, std::numeric_limits<size_t>::max(), &report)) {
+        return false;
+    }
+    _base = _buffer.data();
+    _size = _buffer.size();
+
+#else
+
+    // Memory-map the complete file. Nothing is read until accessed.
+    const int fd = ::open(file_name.toUTF8().c_str(), O_RDONLY | O_LARGEFILE);
+    if (fd < 0) {
+        report.error(u"cannot open %s: %s", {file_name, ErrorCodeMessage()});
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) < 0) {
+        report.error(u"cannot get size of %s: %s", {file_name, ErrorCodeMessage()});
+        ::close(fd);
+        return false;
+    }
+    _size = size_t(st.st_size);
+    if (_size > 0) {
+        void* addr = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            report.error(u"error mapping file %s: %s", {file_name, ErrorCodeMessage()});
+            ::close(fd);
+            return false;
+        }
+        _base = reinterpret_cast<const uint8_t*>(addr);
+        _mapped = true;
+    }
+    ::close(fd);
+
+#endif
+
+    // Check the header and the size of the index.
+    const size_t magic_size = ::strlen(INDEXED_MAGIC);
+    bool valid = _base != nullptr && _size >= HEADER_SIZE && ::memcmp(_base, INDEXED_MAGIC, magic_size) == 0 && GetUInt32(_base + magic_size) == INDEXED_VERSION;
+    if (valid) {
+        _count = GetUInt32(_base + magic_size + 4);
+        const uint64_t index_offset = GetUInt64(_base + magic_size + 8);
+        valid = index_offset >= HEADER_SIZE && index_offset <= _size && (_size - index_offset) / (ENTRY_SIZE + 4) >= _count;
+        if (valid) {
+            _index = _base + index_offset;
+            _sorted = _index + _count * ENTRY_SIZE;
+        }
+    }
+    if (!valid) {
+        report.error(u"%s is not a valid indexed section file", {file_name});
+        release();
+        return false;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Release the file content when open for reading.
+//----------------------------------------------------------------------------
+
+void ts::IndexedSectionFile::release()
+{
+#if !defined(TS_WINDOWS)
+    if (_mapped && _base != nullptr) {
+        ::munmap(const_cast<uint8_t*>(_base), _size);
+    }
+#endif
+    _buffer.clear();
+    _base = nullptr;
+    _size = 0;
+    _count = 0;
+    _index = nullptr;
+    _sorted = nullptr;
+    _mapped = false;
+}
+
+
+//----------------------------------------------------------------------------
+// Create an indexed section file for writing.
+//----------------------------------------------------------------------------
+
+bool ts::IndexedSectionFile::create(const UString& file_name, Report& report)
+{
+    if (isOpen() || isCreated()) {
+        report.error(u"%s is already open", {_file_name});
+        return false;
+    }
+    _file_name = file_name;
+    _entries.clear();
+    _offset = HEADER_SIZE;
+
+    // The header is rewritten by close(), when the index is known.
+    _output.open(file_name.toUTF8().c_str(), std::ios::out | std::ios::binary);
+    if (!_output) {
+        report.error(u"error creating %s", {file_name});
+        return false;
+    }
+    const ByteBlock header(HEADER_SIZE, 0);
+    if (!_output.write(reinterpret_cast<const char*>(header.data()), std::streamsize(header.size()))) {
+        report.error(u"error writing %s", {file_name});
+        _output.close();
+        return false;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Write a section in a file which was created.
+//----------------------------------------------------------------------------
+
+bool ts::IndexedSectionFile::write(const Section& section, Report& report)
+{
+    if (!isCreated()) {
+        report.error(u"indexed section file not created");
+        return false;
+    }
+    if (!section.isValid() || _entries.size() / ENTRY_SIZE >= 0xFFFFFFFF) {
+        return false;
+    }
+    if (!section.write(_output, report)) {
+        return false;
+    }
+
+    // Serialize the index entry.
+    uint8_t* const e = reinterpret_cast<uint8_t*>(_entries.enlarge(ENTRY_SIZE));
+    const bool is_long = section.isLongSection();
+    PutUInt16(e, section.sourcePID());
+    e[2] = section.tableId();
+    PutUInt16(e + 3, is_long ? section.tableIdExtension() : 0);
+    e[5] = is_long ? section.version() : 0;
+    e[6] = is_long ? section.sectionNumber() : 0;
+    e[7] = is_long ? section.lastSectionNumber() : 0;
+    e[8] = (is_long ? FLAG_LONG : 0) | (is_long && section.isCurrent() ? FLAG_CURRENT : 0);
+    e[9] = 0xFF;
+    PutUInt16(e + 10, uint16_t(section.size()));
+    PutUInt64(e + 12, _offset);
+
+    _offset += section.size();
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Close the file.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Sort the section numbers by index entry, then by position in file.
+    class EntryOrder
+    {
+    public:
+        EntryOrder(const uint8_t* entries) : _entries(entries) {}
+        bool operator()(uint32_t n1, uint32_t n2) const
+        {
+            const int cmp = ::memcmp(_entries + size_t(n1) * ENTRY_SIZE, _entries + size_t(n2) * ENTRY_SIZE, ENTRY_SORT_SIZE);
+            return cmp < 0 || (cmp == 0 && n1 < n2);
+        }
+    private:
+        const uint8_t* _entries;
+    };
+}
+
+bool ts::IndexedSectionFile::close(Report& report)
+{
+    bool success = true;
+
+    if (isCreated()) {
+        // Build the sorted index.
+        const size_t count = _entries.size() / ENTRY_SIZE;
+        std::vector<uint32_t> order(count);
+        for (size_t i = 0; i < count; ++i) {
+            order[i] = uint32_t(i);
+        }
+        std::sort(order.begin(), order.end(), EntryOrder(_entries.data()));
+        ByteBlock sorted(4 * count);
+        for (size_t i = 0; i < count; ++i) {
+            PutUInt32(&sorted[4 * i], order[i]);
+        }
+
+        // Write the index and rewrite the header.
+        ByteBlock header;
+        header.append(INDEXED_MAGIC, ::strlen(INDEXED_MAGIC));
+        header.appendUInt32(INDEXED_VERSION);
+        header.appendUInt32(uint32_t(count));
+        header.appendUInt64(_offset);
+        header.appendUInt64(0);
+        assert(header.size() == HEADER_SIZE);
+
+        success = (_entries.empty() || _output.write(reinterpret_cast<const char*>(_entries.data()), std::streamsize(_entries.size()))) &&
+                  (sorted.empty() || _output.write(reinterpret_cast<const char*>(sorted.data()), std::streamsize(sorted.size()))) &&
+                  _output.seekp(0) &&
+                  _output.write(reinterpret_cast<const char*>(header.data()), std::streamsize(header.size()));
+        _output.close();
+        if (!success) {
+            report.error(u"error writing %s", {_file_name});
+        }
+        _entries.clear();
+        _offset = 0;
+    }
+
+    release();
+    return success;
+}
+
+
+//----------------------------------------------------------------------------
+// Get the number of sections in the file.
+//----------------------------------------------------------------------------
+
+size_t ts::IndexedSectionFile::count() const
+{
+    return isCreated() ? _entries.size() / ENTRY_SIZE : _count;
+}
+
+
+//----------------------------------------------------------------------------
+// Get the index entry of a section.
+//----------------------------------------------------------------------------
+
+bool ts::IndexedSectionFile::getEntry(size_t index, Entry& entry) const
+{
+    if (_base == nullptr || index >= _count) {
+        return false;
+    }
+    const uint8_t* const e = _index + index * ENTRY_SIZE;
+    entry.pid = GetUInt16(e);
+    entry.tid = e[2];
+    entry.tid_ext = GetUInt16(e + 3);
+    entry.version = e[5];
+    entry.section_number = e[6];
+    entry.last_section_number = e[7];
+    entry.is_long = (e[8] & FLAG_LONG) != 0;
+    entry.is_current = (e[8] & FLAG_CURRENT) != 0;
+    entry.size = GetUInt16(e + 10);
+    entry.offset = GetUInt64(e + 12);
+
+    // The section must be entirely in the sections area.
+    const uint64_t end = uint64_t(_index - _base);
+    return entry.offset >= HEADER_SIZE && entry.offset <= end && entry.size <= end - entry.offset;
+}
+
+
+//----------------------------------------------------------------------------
+// Get the address of the binary content of a section.
+//----------------------------------------------------------------------------
+
+const uint8_t* ts::IndexedSectionFile::sectionData(size_t index, size_t& size) const
+{
+    Entry entry;
+    if (getEntry(index, entry)) {
+        size = entry.size;
+        return _base + entry.offset;
+    }
+    else {
+        size = 0;
+        return nullptr;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Build one section.
+//----------------------------------------------------------------------------
+
+ts::SectionPtr ts::IndexedSectionFile::getSection(size_t index, CRC32::Validation crc_op) const
+{
+    Entry entry;
+    if (getEntry(index, entry)) {
+        const SectionPtr section(new Section(_base + entry.offset, entry.size, entry.pid, crc_op));
+        if (section->isValid()) {
+            return section;
+        }
+    }
+    return SectionPtr();
+}
+
+
+//----------------------------------------------------------------------------
+// Find sections using the sorted index.
+//----------------------------------------------------------------------------
+
+void ts::IndexedSectionFile::findSections(std::vector<size_t>& indexes, PID pid) const
+{
+    uint8_t key[2];
+    PutUInt16(key, pid);
+    findSections(indexes, key, sizeof(key));
+}
+
+void ts::IndexedSectionFile::findSections(std::vector<size_t>& indexes, PID pid, TID tid) const
+{
+    uint8_t key[3];
+    PutUInt16(key, pid);
+    key[2] = tid;
+    findSections(indexes, key, sizeof(key));
+}
+
+void ts::IndexedSectionFile::findSections(std::vector<size_t>& indexes, PID pid, TID tid, uint16_t tid_ext) const
+{
+    uint8_t key[5];
+    PutUInt16(key, pid);
+    key[2] = tid;
+    PutUInt16(key + 3, tid_ext);
+    findSections(indexes, key, sizeof(key));
+}
+
+void ts::IndexedSectionFile::findSections(std::vector<size_t>& indexes, const uint8_t* key, size_t key_size) const
+{
+    indexes.clear();
+
+    // Binary search of the first matching entry.
+    size_t low = 0;
+    size_t high = _base == nullptr ? 0 : _count;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const uint8_t* const e = sortedEntry(mid);
+        if (e == nullptr) {
+            return;
+        }
+        if (::memcmp(e, key, key_size) < 0) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    // Collect all matching entries.
+    for (size_t rank = low; rank < _count; ++rank) {
+        const uint8_t* const e = sortedEntry(rank);
+        if (e == nullptr || ::memcmp(e, key, key_size) != 0) {
+            break;
+        }
+        indexes.push_back(GetUInt32(_sorted + 4 * rank));
+    }
+}
+
+// Get the index entry at a given position in the sorted index, null if corrupted.
+const uint8_t* ts::IndexedSectionFile::sortedEntry(size_t rank) const
+{
+    const uint32_t number = GetUInt32(_sorted + 4 * rank);
+    return number < _count ? _index + size_t(number) * ENTRY_SIZE : nullptr;
+}
+
+
+//----------------------------------------------------------------------------
+// Check if a file is an indexed section file.
+//----------------------------------------------------------------------------
+
+bool ts::IndexedSectionFile::IsIndexedFile(const UString& file_name)
+{
+    const size_t magic_size = ::strlen(INDEXED_MAGIC);
+    char magic[16];
+    std::ifstream strm(file_name.toUTF8().c_str(), std::ios::in | std::ios::binary);
+    return strm.read(magic, std::streamsize(magic_size)) && ::memcmp(magic, INDEXED_MAGIC, magic_size) == 0;
+}
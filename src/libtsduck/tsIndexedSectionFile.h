@@ -0,0 +1,247 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Binary section file with an index, for random and lazy access.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsSection.h"
+#include "tsByteBlock.h"
+#include "tsCerrReport.h"
+
+//!
+//! Default suffix of indexed section file names.
+//!
+#define TS_DEFAULT_INDEXED_SECTION_FILE_SUFFIX u".sidx"
+
+namespace ts {
+    //!
+    //! Binary section file with an index, for random and lazy access.
+    //! @ingroup mpeg
+    //!
+    //! An indexed section file contains the binary sections, in their original order,
+    //! followed by an index. The index contains one fixed-size entry per section (PID,
+    //! table id, table id extension, version, section number, position and size) in
+    //! file order, and a list of section numbers, sorted by PID, table id, table id
+    //! extension, version and section number.
+    //!
+    //! When reading, the file is memory-mapped (on UNIX systems) and nothing is
+    //! loaded in memory. The index entries are decoded and the sections are built
+    //! only when they are accessed. Very large collections of sections, such as EIT's
+    //! for an EPG, can be opened in constant time and searched using the sorted index.
+    //!
+    //! The file format is the following. All integers are in big endian format.
+    //! - Header (32 bytes): "TSSECIDX" (8 bytes), format version (4 bytes), number
+    //!   of sections (4 bytes), offset of the index (8 bytes), reserved (8 bytes).
+    //! - Sections: all sections, one after the other, in binary form.
+    //! - Index entries: one 20-byte entry per section, in file order.
+    //! - Sorted index: one 4-byte section number per section.
+    //!
+    class TSDUCKDLL IndexedSectionFile
+    {
+    public:
+        //!
+        //! Description of one section in the index.
+        //! For short sections, the fields of long sections are zero.
+        //!
+        struct TSDUCKDLL Entry
+        {
+            PID      pid;                  //!< Source PID of the section (PID_NULL if unknown).
+            TID      tid;                  //!< Table id.
+            uint16_t tid_ext;              //!< Table id extension (long sections).
+            uint8_t  version;              //!< Version number (long sections).
+            uint8_t  section_number;       //!< Section number (long sections).
+            uint8_t  last_section_number;  //!< Last section number (long sections).
+            bool     is_long;              //!< True for a long section.
+            bool     is_current;           //!< Current/next indicator (long sections).
+            size_t   size;                 //!< Section size in bytes.
+            uint64_t offset;               //!< Offset of the section in the file.
+
+            //!
+            //! Default constructor.
+            //!
+            Entry();
+        };
+
+        //!
+        //! Default constructor.
+        //!
+        IndexedSectionFile();
+
+        //!
+        //! Destructor.
+        //!
+        ~IndexedSectionFile();
+
+        //!
+        //! Open an indexed section file for reading.
+        //! @param [in] file_name Name of the file to open.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool open(const UString& file_name, Report& report = CERR);
+
+        //!
+        //! Create an indexed section file for writing.
+        //! Sections are written one by one using write(). The index is written by close().
+        //! @param [in] file_name Name of the file to create.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool create(const UString& file_name, Report& report = CERR);
+
+        //!
+        //! Close the file.
+        //! When the file was created, the index is written and the file is complete.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool close(Report& report = CERR);
+
+        //!
+        //! Check if the file is open for reading.
+        //! @return True if the file is open for reading.
+        //!
+        bool isOpen() const { return _base != nullptr; }
+
+        //!
+        //! Check if the file is created for writing.
+        //! @return True if the file is created for writing.
+        //!
+        bool isCreated() const { return _output.is_open(); }
+
+        //!
+        //! Get the file name.
+        //! @return The file name.
+        //!
+        UString fileName() const { return _file_name; }
+
+        //!
+        //! Write a section in a file which was created.
+        //! @param [in] section The section to write. Its source PID is stored in the index.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool write(const Section& section, Report& report = CERR);
+
+        //!
+        //! Get the number of sections in the file.
+        //! @return The number of sections in the file (read or written).
+        //!
+        size_t count() const;
+
+        //!
+        //! Get the index entry of a section in a file which is open for reading.
+        //! @param [in] index Index of the section in the file, from 0 to count() - 1.
+        //! @param [out] entry Description of the section.
+        //! @return True on success, false if @a index is out of range or the entry is invalid.
+        //!
+        bool getEntry(size_t index, Entry& entry) const;
+
+        //!
+        //! Get the address of the binary content of a section in a file which is open for reading.
+        //! The returned address points inside the memory-mapped file and remains valid
+        //! until the file is closed.
+        //! @param [in] index Index of the section in the file, from 0 to count() - 1.
+        //! @param [out] size Size in bytes of the section.
+        //! @return Address of the section or zero if @a index is out of range or the entry is invalid.
+        //!
+        const uint8_t* sectionData(size_t index, size_t& size) const;
+
+        //!
+        //! Build one section from a file which is open for reading.
+        //! @param [in] index Index of the section in the file, from 0 to count() - 1.
+        //! @param [in] crc_op How to process the CRC32 of the section.
+        //! @return A safe pointer to the section, null on error.
+        //!
+        SectionPtr getSection(size_t index, CRC32::Validation crc_op = CRC32::IGNORE) const;
+
+        //!
+        //! Find all sections with a given PID in a file which is open for reading.
+        //! @param [out] indexes Indexes in the file of the matching sections,
+        //! sorted by table id, table id extension, version, section number and position.
+        //! @param [in] pid PID to search.
+        //!
+        void findSections(std::vector<size_t>& indexes, PID pid) const;
+
+        //!
+        //! Find all sections of a table id in a PID, in a file which is open for reading.
+        //! @param [out] indexes Indexes in the file of the matching sections,
+        //! sorted by table id extension, version, section number and position.
+        //! @param [in] pid PID to search.
+        //! @param [in] tid Table id to search.
+        //!
+        void findSections(std::vector<size_t>& indexes, PID pid, TID tid) const;
+
+        //!
+        //! Find all sections of a table in a PID, in a file which is open for reading.
+        //! @param [out] indexes Indexes in the file of the matching sections,
+        //! sorted by version, section number and position.
+        //! @param [in] pid PID to search.
+        //! @param [in] tid Table id to search.
+        //! @param [in] tid_ext Table id extension to search (zero for short sections).
+        //!
+        void findSections(std::vector<size_t>& indexes, PID pid, TID tid, uint16_t tid_ext) const;
+
+        //!
+        //! Check if a file is an indexed section file, based on its content.
+        //! @param [in] file_name Name of the file to check.
+        //! @return True if the file exists and starts with the header of an indexed section file.
+        //!
+        static bool IsIndexedFile(const UString& file_name);
+
+    private:
+        UString        _file_name;  // File name.
+        const uint8_t* _base;       // Base address of the file content when open for reading.
+        size_t         _size;       // Size of the file content.
+        size_t         _count;      // Number of sections when open for reading.
+        const uint8_t* _index;      // Address of index entries.
+        const uint8_t* _sorted;     // Address of sorted index.
+        bool           _mapped;     // File content is memory-mapped.
+        ByteBlock      _buffer;     // File content when not memory-mapped.
+        std::ofstream  _output;     // Output file when writing.
+        uint64_t       _offset;     // Current write offset.
+        ByteBlock      _entries;    // Serialized index entries when writing.
+
+        // Find the range of entries in the sorted index which match a key prefix.
+        void findSections(std::vector<size_t>& indexes, const uint8_t* key, size_t key_size) const;
+
+        // Get the index entry at a given position in the sorted index, null if corrupted.
+        const uint8_t* sortedEntry(size_t rank) const;
+
+        // Release the file content when open for reading.
+        void release();
+
+        // Inaccessible operations.
+        IndexedSectionFile(const IndexedSectionFile&) = delete;
+        IndexedSectionFile& operator=(const IndexedSectionFile&) = delete;
+    };
+}
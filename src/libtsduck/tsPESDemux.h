@@ -159,11 +159,11 @@ namespace ts {
 
         // Map of PID contexts, indexed by PID.
         // One context is created per demuxed PES PID.
-        typedef std::map<PID,PIDContext> PIDContextMap;
+        typedef PIDMap<PIDContext> PIDContextMap;
 
         // Map of stream types (from PMT), indexed by PID.
         // All known PID's are referenced here, not only demuxed PES PID's.
-        typedef std::map<PID,uint8_t> StreamTypeMap;
+        typedef PIDMap<uint8_t> StreamTypeMap;
 
         // Feed the demux with a TS packet (PID already filtered).
         void processPacket(const TSPacket&);
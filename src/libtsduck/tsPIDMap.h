@@ -0,0 +1,236 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Direct-indexed map of objects, indexed by PID.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsMPEG.h"
+
+namespace ts {
+    //!
+    //! Direct-indexed map of objects, indexed by PID.
+    //! @ingroup mpeg
+    //!
+    //! This class is a replacement for @c std::map<PID,T> with a subset of its interface.
+    //! The element of a PID is located in constant time using a table of PID_MAX entries.
+    //! A sorted list of active PID's is maintained for iterations. Like with @c std::map,
+    //! the iteration is done in increasing order of PID and inserting or erasing elements
+    //! does not invalidate iterators on other elements.
+    //!
+    //! @tparam T The type of the elements. Must be default-constructible.
+    //!
+    template <typename T>
+    class PIDMap
+    {
+    public:
+        typedef PID key_type;                     //!< Type of the keys.
+        typedef T mapped_type;                    //!< Type of the elements.
+        typedef std::pair<const PID, T> value_type;  //!< Type of the (key, element) pairs.
+        typedef size_t size_type;                 //!< Type of sizes.
+
+        //!
+        //! Iterators on a PIDMap, with or without const.
+        //! @tparam VT Type of the pointed value, with or without const.
+        //! @tparam MAP Type of the map, with or without const.
+        //!
+        template <typename VT, typename MAP>
+        class Iterator
+        {
+        public:
+            //!
+            //! Default constructor.
+            //!
+            Iterator() : _map(nullptr), _pid(PID_MAX) {}
+            //!
+            //! Conversion constructor from another iterator (typically non-const to const).
+            //! @param [in] other Other iterator to copy.
+            //!
+            template <typename VT2, typename MAP2>
+            Iterator(const Iterator<VT2,MAP2>& other) : _map(other._map), _pid(other._pid) {}
+            //!
+            //! Dereference operator.
+            //! @return A reference to the pointed (PID, element) pair.
+            //!
+            VT& operator*() const { return *_map->_table[_pid]; }
+            //!
+            //! Dereference operator.
+            //! @return A pointer to the pointed (PID, element) pair.
+            //!
+            VT* operator->() const { return _map->_table[_pid]; }
+            //!
+            //! Move to the next element, in increasing order of PID.
+            //! @return A reference to this object.
+            //!
+            Iterator& operator++() { _pid = _map->next(_pid); return *this; }
+            //!
+            //! Move to the next element, in increasing order of PID.
+            //! @return A copy of this object before being incremented.
+            //!
+            Iterator operator++(int) { Iterator it(*this); _pid = _map->next(_pid); return it; }
+            //!
+            //! Equality operator.
+            //! @param [in] other Other iterator to compare.
+            //! @return True if both iterators point to the same element.
+            //!
+            template <typename VT2, typename MAP2>
+            bool operator==(const Iterator<VT2,MAP2>& other) const { return _pid == other._pid; }
+            //!
+            //! Difference operator.
+            //! @param [in] other Other iterator to compare.
+            //! @return True if the iterators point to distinct elements.
+            //!
+            template <typename VT2, typename MAP2>
+            bool operator!=(const Iterator<VT2,MAP2>& other) const { return _pid != other._pid; }
+
+        private:
+            template <typename VT2, typename MAP2> friend class Iterator;
+            friend class PIDMap<T>;
+            MAP* _map;  // Parent map.
+            PID  _pid;  // Current PID, PID_MAX at end of map.
+            Iterator(MAP* map, PID pid) : _map(map), _pid(pid) {}
+        };
+
+        typedef Iterator<value_type, PIDMap<T>> iterator;                    //!< Iterator type.
+        typedef Iterator<const value_type, const PIDMap<T>> const_iterator;  //!< Constant iterator type.
+
+        //!
+        //! Default constructor.
+        //!
+        PIDMap();
+
+        //!
+        //! Copy constructor.
+        //! @param [in] other Other instance to copy.
+        //!
+        PIDMap(const PIDMap<T>& other);
+
+        //!
+        //! Destructor.
+        //!
+        ~PIDMap();
+
+        //!
+        //! Assignment operator.
+        //! @param [in] other Other instance to copy.
+        //! @return A reference to this object.
+        //!
+        PIDMap<T>& operator=(const PIDMap<T>& other);
+
+        //!
+        //! Get a reference to the element of a PID, create it if it does not exist.
+        //! @param [in] pid The PID to search.
+        //! @return A reference to the element for @a pid.
+        //!
+        T& operator[](PID pid);
+
+        //!
+        //! Find the element of a PID.
+        //! @param [in] pid The PID to search.
+        //! @return An iterator to the element of @a pid or end() if there is none.
+        //!
+        iterator find(PID pid) { return iterator(this, exists(pid) ? pid : PID_MAX); }
+
+        //!
+        //! Find the element of a PID.
+        //! @param [in] pid The PID to search.
+        //! @return A constant iterator to the element of @a pid or end() if there is none.
+        //!
+        const_iterator find(PID pid) const { return const_iterator(this, exists(pid) ? pid : PID_MAX); }
+
+        //!
+        //! Count the number of elements for a PID.
+        //! @param [in] pid The PID to search.
+        //! @return One if @a pid is present in the map, zero otherwise.
+        //!
+        size_type count(PID pid) const { return exists(pid) ? 1 : 0; }
+
+        //!
+        //! Remove the element of a PID.
+        //! @param [in] pid The PID to remove.
+        //! @return The number of removed elements (zero or one).
+        //!
+        size_type erase(PID pid);
+
+        //!
+        //! Remove all elements.
+        //!
+        void clear();
+
+        //!
+        //! Get the number of elements in the map.
+        //! @return The number of elements in the map.
+        //!
+        size_type size() const { return _active.size(); }
+
+        //!
+        //! Check if the map is empty.
+        //! @return True if the map is empty.
+        //!
+        bool empty() const { return _active.empty(); }
+
+        //!
+        //! Get an iterator to the first element, in increasing order of PID.
+        //! @return An iterator to the first element.
+        //!
+        iterator begin() { return iterator(this, _active.empty() ? PID_MAX : _active.front()); }
+
+        //!
+        //! Get a constant iterator to the first element, in increasing order of PID.
+        //! @return A constant iterator to the first element.
+        //!
+        const_iterator begin() const { return const_iterator(this, _active.empty() ? PID_MAX : _active.front()); }
+
+        //!
+        //! Get an iterator after the last element.
+        //! @return An iterator after the last element.
+        //!
+        iterator end() { return iterator(this, PID_MAX); }
+
+        //!
+        //! Get a constant iterator after the last element.
+        //! @return A constant iterator after the last element.
+        //!
+        const_iterator end() const { return const_iterator(this, PID_MAX); }
+
+    private:
+        std::vector<value_type*> _table;   // PID_MAX entries, null when unused.
+        std::vector<PID>         _active;  // Sorted list of used PID's.
+
+        // Check if a PID is present.
+        bool exists(PID pid) const { return pid < PID_MAX && _table[pid] != nullptr; }
+
+        // Get the next used PID after a PID, PID_MAX if there is none.
+        PID next(PID pid) const;
+    };
+}
+
+#include "tsPIDMapTemplate.h"
@@ -0,0 +1,134 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+
+
+//----------------------------------------------------------------------------
+// Constructors, destructor and assignment.
+//----------------------------------------------------------------------------
+
+template <typename T>
+ts::PIDMap<T>::PIDMap() :
+    _table(PID_MAX, nullptr),
+    _active()
+{
+}
+
+template <typename T>
+ts::PIDMap<T>::PIDMap(const PIDMap<T>& other) :
+    _table(PID_MAX, nullptr),
+    _active(other._active)
+{
+    for (auto it = _active.begin(); it != _active.end(); ++it) {
+        _table[*it] = new value_type(*other._table[*it]);
+    }
+}
+
+template <typename T>
+ts::PIDMap<T>::~PIDMap()
+{
+    clear();
+}
+
+template <typename T>
+ts::PIDMap<T>& ts::PIDMap<T>::operator=(const PIDMap<T>& other)
+{
+    if (&other != this) {
+        clear();
+        _active = other._active;
+        for (auto it = _active.begin(); it != _active.end(); ++it) {
+            _table[*it] = new value_type(*other._table[*it]);
+        }
+    }
+    return *this;
+}
+
+
+//----------------------------------------------------------------------------
+// Get a reference to the element of a PID, create it if it does not exist.
+//----------------------------------------------------------------------------
+
+template <typename T>
+T& ts::PIDMap<T>::operator[](PID pid)
+{
+    assert(pid < PID_MAX);
+    value_type*& entry(_table[pid]);
+    if (entry == nullptr) {
+        entry = new value_type(pid, T());
+        _active.insert(std::lower_bound(_active.begin(), _active.end(), pid), pid);
+    }
+    return entry->second;
+}
+
+
+//----------------------------------------------------------------------------
+// Remove elements.
+//----------------------------------------------------------------------------
+
+template <typename T>
+typename ts::PIDMap<T>::size_type ts::PIDMap<T>::erase(PID pid)
+{
+    if (!exists(pid)) {
+        return 0;
+    }
+    else {
+        // Remove the PID from the active list before deleting the element,
+        // in case the destructor of the element accesses the map.
+        value_type* const entry = _table[pid];
+        _table[pid] = nullptr;
+        _active.erase(std::lower_bound(_active.begin(), _active.end(), pid));
+        delete entry;
+        return 1;
+    }
+}
+
+template <typename T>
+void ts::PIDMap<T>::clear()
+{
+    std::vector<PID> active;
+    active.swap(_active);
+    for (auto it = active.begin(); it != active.end(); ++it) {
+        value_type* const entry = _table[*it];
+        _table[*it] = nullptr;
+        delete entry;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get the next used PID after a PID.
+//----------------------------------------------------------------------------
+
+template <typename T>
+ts::PID ts::PIDMap<T>::next(PID pid) const
+{
+    const auto it = std::upper_bound(_active.begin(), _active.end(), pid);
+    return it == _active.end() ? PID_MAX : *it;
+}
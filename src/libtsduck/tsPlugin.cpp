@@ -65,6 +65,29 @@ ts::ProcessorPlugin::ProcessorPlugin(TSP* tsp_, const UString& description, cons
 }
 
 
+//----------------------------------------------------------------------------
+// Default packet batch processing: one packet at a time.
+//----------------------------------------------------------------------------
+
+size_t ts::ProcessorPlugin::processPacketBatch(TSPacket* pkt, size_t count, Status* status, bool& flush, bool& bitrate_changed)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (pkt[i].b[0] == 0) {
+            // Already dropped by a previous plugin.
+            status[i] = TSP_DROP;
+        }
+        else {
+            status[i] = processPacket(pkt[i], flush, bitrate_changed);
+            // Return as soon as the application must be notified.
+            if (flush || bitrate_changed || status[i] == TSP_END) {
+                return i + 1;
+            }
+        }
+    }
+    return count;
+}
+
+
 //----------------------------------------------------------------------------
 // Report implementation.
 //----------------------------------------------------------------------------
@@ -75,6 +98,20 @@ void ts::Plugin::writeLog(int severity, const UString& message)
     tsp->log(severity, message);
 }
 
+void ts::Plugin::log(int severity, const UChar* fmt, const std::initializer_list<ArgMixIn>& args)
+{
+    if (severity <= _max_severity) {
+        tsp->log(severity, fmt, args);
+    }
+}
+
+void ts::Plugin::log(int severity, const UString& fmt, const std::initializer_list<ArgMixIn>& args)
+{
+    if (severity <= _max_severity) {
+        tsp->log(severity, fmt, args);
+    }
+}
+
 
 //----------------------------------------------------------------------------
 // Displayable names of plugin types.
@@ -103,7 +103,7 @@ namespace ts {
         //! @c int data named @c tspInterfaceVersion which contains the current
         //! interface version at the time the library is built.
         //!
-        static const int API_VERSION = 8;
+        static const int API_VERSION = 9;
 
         //!
         //! Get the current input bitrate in bits/seconds.
@@ -290,6 +290,12 @@ namespace ts {
         //!
         virtual ~Plugin() override {}
 
+        // Report implementation: forward the message and its arguments to tsp
+        // without formatting the message here.
+        using Args::log;
+        virtual void log(int severity, const UChar* fmt, const std::initializer_list<ArgMixIn>& args) override;
+        virtual void log(int severity, const UString& fmt, const std::initializer_list<ArgMixIn>& args) override;
+
     protected:
         TSP* tsp; //!< The TSP callback structure can be directly accessed by subclasses.
 
@@ -487,6 +493,43 @@ namespace ts {
         //!
         virtual Status processPacket(TSPacket& pkt, bool& flush, bool& bitrate_changed) = 0;
 
+        //!
+        //! Packet batch processing interface.
+        //!
+        //! The main application invokes processPacketBatch() to let the shared
+        //! library process a contiguous slice of TS packets in one call. This
+        //! avoids one virtual call per packet in the packet processing thread.
+        //!
+        //! Packets which were already dropped by a previous plugin in the chain
+        //! (their first byte is zero) must not be processed. Their status shall
+        //! be set to @link TSP_DROP @endlink.
+        //!
+        //! The method may process fewer packets than requested. It must process
+        //! at least one packet. The application passes the processed packets to
+        //! the next processor and invokes the method again with the remaining ones.
+        //! When a status is @link TSP_END @endlink, the method shall return
+        //! immediately, this packet being the last processed one.
+        //!
+        //! The default implementation invokes processPacket() for each packet.
+        //! It returns after the first packet for which a flush, a bitrate change
+        //! or the end of processing is requested. This way, the behaviour of a
+        //! plugin which only implements processPacket() is unchanged. Plugins
+        //! with a high packet rate and a light per-packet processing should
+        //! override this method.
+        //!
+        //! @param [in,out] pkt Address of the first TS packet to process.
+        //! @param [in] count Number of packets to process.
+        //! @param [out] status Address of an array of at least @a count elements
+        //! which receives the processing status of each packet.
+        //! @param [in,out] flush Initially set to false. If the method sets @a flush to true,
+        //! the processed packets and all previously processed and buffered packets should be
+        //! passed to the next processor as soon as possible.
+        //! @param [in,out] bitrate_changed Initially set to false. If the method sets
+        //! @a bitrate_changed to true, tsp should call the getBitrate() callback as soon as possible.
+        //! @return The number of processed packets, in the range 1 to @a count.
+        //!
+        virtual size_t processPacketBatch(TSPacket* pkt, size_t count, Status* status, bool& flush, bool& bitrate_changed);
+
         //!
         //! Constructor.
         //!
@@ -504,6 +547,38 @@ namespace ts {
         // Implementation of inherited interface.
         virtual PluginType type() const override { return PROCESSOR_PLUGIN; }
 
+    protected:
+        //!
+        //! Packet batch processing for plugins which never request a flush or a bitrate change.
+        //!
+        //! A plugin can implement processPacketBatch() using this method. The processPacket()
+        //! method of the plugin class is directly invoked for each packet, without virtual call.
+        //! Unlike the default processPacketBatch(), the processing does not stop when a flush
+        //! or a bitrate change is requested. It stops after the first packet with status
+        //! @link TSP_END @endlink.
+        //!
+        //! @tparam PLUGIN The plugin class, a subclass of ProcessorPlugin.
+        //! @param [in,out] pkt Address of the first TS packet to process.
+        //! @param [in] count Number of packets to process.
+        //! @param [out] status Address of an array of at least @a count elements.
+        //! @param [in,out] flush Passed to processPacket().
+        //! @param [in,out] bitrate_changed Passed to processPacket().
+        //! @return The number of processed packets, in the range 1 to @a count.
+        //!
+        template <class PLUGIN>
+        size_t processPacketBatchDirect(TSPacket* pkt, size_t count, Status* status, bool& flush, bool& bitrate_changed)
+        {
+            PLUGIN* const plugin = static_cast<PLUGIN*>(this);
+            for (size_t i = 0; i < count; ++i) {
+                // Skip packets which were already dropped by a previous plugin.
+                status[i] = pkt[i].b[0] == 0 ? TSP_DROP : plugin->PLUGIN::processPacket(pkt[i], flush, bitrate_changed);
+                if (status[i] == TSP_END) {
+                    return i + 1;
+                }
+            }
+            return count;
+        }
+
     private:
         // Inaccessible operations
         ProcessorPlugin() = delete;
@@ -38,7 +38,8 @@ TSDUCK_SOURCE;
 ts::PluginOptions::PluginOptions(ts::PluginType type_, const ts::UString& name_) :
     type(type_),
     name(name_),
-    args()
+    args(),
+    grouped(false)
 {
 
 }
@@ -52,6 +53,9 @@ std::ostream& ts::PluginOptions::display(std::ostream& strm, const UString& marg
 {
     strm << margin << "Name: " << name << std::endl
          << margin << "Type: " << PluginTypeNames.name(type) << std::endl;
+    if (grouped) {
+        strm << margin << "Grouped with previous plugin" << std::endl;
+    }
     for (size_t i = 0; i < args.size(); ++i) {
         strm << margin << "Arg[" << i << "]: \"" << args[i] << "\"" << std::endl;
     }
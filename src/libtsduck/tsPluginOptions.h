@@ -54,9 +54,10 @@ namespace ts {
         // Implementation of DisplayInterface
         virtual std::ostream& display(std::ostream& stream = std::cout, const UString& margin = UString()) const override;
 
-        PluginType    type;  //!< Plugin type.
-        UString       name;  //!< Plugin name.
-        UStringVector args;  //!< Plugin options.
+        PluginType    type;     //!< Plugin type.
+        UString       name;     //!< Plugin name.
+        UStringVector args;     //!< Plugin options.
+        bool          grouped;  //!< Packet processor only: execute in the same thread as the previous processor.
     };
 
     //!
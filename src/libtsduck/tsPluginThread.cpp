@@ -40,8 +40,10 @@ ts::PluginThread::PluginThread(Report* report, const UString& appName, const Plu
     Thread(),
     TSP(report->maxSeverity()),
     _report(report),
+    _async_report(dynamic_cast<AsyncReport*>(report)),
     _name(options.name),
     _logname(),
+    _logprefix(options.name + u": "),
     _shlib(nullptr)
 {
     const UChar* shellOpt = nullptr;
@@ -120,3 +122,21 @@ void ts::PluginThread::writeLog(int severity, const UString& msg)
 {
     _report->log(severity, u"%s: %s", {_logname.empty() ? _name : _logname, msg});
 }
+
+void ts::PluginThread::log(int severity, const UChar* fmt, const std::initializer_list<ArgMixIn>& args)
+{
+    if (severity <= _max_severity) {
+        if (_async_report != nullptr) {
+            // Do not format the message in the plugin thread.
+            _async_report->logWithPrefix(severity, _logprefix, fmt, args);
+        }
+        else {
+            writeLog(severity, UString::Format(fmt, args));
+        }
+    }
+}
+
+void ts::PluginThread::log(int severity, const UString& fmt, const std::initializer_list<ArgMixIn>& args)
+{
+    log(severity, fmt.c_str(), args);
+}
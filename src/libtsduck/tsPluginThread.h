@@ -36,6 +36,7 @@
 #include "tsThread.h"
 #include "tsPlugin.h"
 #include "tsPluginOptions.h"
+#include "tsAsyncReport.h"
 
 namespace ts {
     //!
@@ -69,6 +70,7 @@ namespace ts {
         void setReport(Report* rep)
         {
             _report = rep;
+            _async_report = dynamic_cast<AsyncReport*>(rep);
         }
 
         //!
@@ -106,17 +108,26 @@ namespace ts {
         void setLogName(const UString& name)
         {
             _logname = name;
+            _logprefix = (_logname.empty() ? _name : _logname) + u": ";
         }
 
+        // Inherited from Report (via TSP). When the common report is asynchronous,
+        // the messages are formatted in the logging thread.
+        using TSP::log;
+        virtual void log(int severity, const UChar* fmt, const std::initializer_list<ArgMixIn>& args) override;
+        virtual void log(int severity, const UString& fmt, const std::initializer_list<ArgMixIn>& args) override;
+
     protected:
         // Inherited from Report (via TSP)
         virtual void writeLog(int severity, const UString& msg) override;
 
     private:
-        Report* _report;  // Common report interface for all plugins
-        UString _name;    // Plugin name.
-        UString _logname; // Plugin name as displayed in log messages.
-        Plugin* _shlib;   // Shared library API.
+        Report*      _report;        // Common report interface for all plugins
+        AsyncReport* _async_report;  // Same as _report when it is asynchronous, null otherwise.
+        UString      _name;          // Plugin name.
+        UString      _logname;       // Plugin name as displayed in log messages.
+        UString      _logprefix;     // Prefix of log messages.
+        Plugin*      _shlib;         // Shared library API.
 
         // Inaccessible operations.
         PluginThread() = delete;
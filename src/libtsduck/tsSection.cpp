@@ -175,6 +175,24 @@ ts::Section::Section(TID tid,
 }
 
 
+//----------------------------------------------------------------------------
+// Reload from full binary content.
+//----------------------------------------------------------------------------
+
+void ts::Section::reload(const void* content, size_t content_size, PID source_pid, CRC32::Validation crc_op)
+{
+    if (_data.isNull() || _data.count() > 1) {
+        initialize(new ByteBlock(content, content_size), source_pid, crc_op);
+    }
+    else {
+        // The data block is not shared, reuse it.
+        const ByteBlockPtr data(_data);
+        data->copy(content, content_size);
+        initialize(data, source_pid, crc_op);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Reload short section
 //----------------------------------------------------------------------------
@@ -202,7 +202,9 @@ ts::SectionDemux::SectionDemux(TableHandlerInterface* table_handler,
     _pids(),
     _status(),
     _get_current(true),
-    _get_next(false)
+    _get_next(false),
+    _recycled(),
+    _allocs_avoided(0)
 {
 }
 
@@ -349,14 +351,19 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
         pc.sync = true;
     }
 
-    // Copy TS packet payload in PID context
+    // If there is no pending incomplete section in the PID context, the sections
+    // are analyzed directly in the packet payload. Otherwise, copy the TS packet
+    // payload in PID context, after the start of the incomplete section.
 
-    pc.ts.append (payload, payload_size);
+    const bool in_packet = pc.ts.empty();
+    if (!in_packet) {
+        pc.ts.append(payload, payload_size);
+    }
 
     // Locate TS buffer by address and size.
 
-    const uint8_t* ts_start = pc.ts.data();
-    size_t ts_size = pc.ts.size();
+    const uint8_t* ts_start = in_packet ? payload : pc.ts.data();
+    size_t ts_size = in_packet ? payload_size : pc.ts.size();
 
     // If current packet has a PUSI, locate start of this new section
     // inside the TS buffer. This is not useful to locate the section but
@@ -468,12 +475,26 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
             }
 
             // Create a new Section object if necessary (ie. if a section
-            // hendler is registered or if this is a new section).
+            // hendler is registered or if this is a new section). When the
+            // section is not stored in the table, it is only passed to the
+            // section handler and the recycled section object is used when
+            // no one else references it.
 
             SectionPtr sect_ptr;
+            const bool new_section = tc.sects[section_number].isNull();
 
-            if (section_ok && (_section_handler != nullptr || tc.sects[section_number].isNull())) {
+            if (section_ok && !new_section && _section_handler != nullptr && !_recycled.isNull() && _recycled.count() == 1) {
+                sect_ptr = _recycled;
+                sect_ptr->reload(ts_start, section_length, pid, CRC32::CHECK);
+                _allocs_avoided++;
+            }
+            else if (section_ok && (_section_handler != nullptr || new_section)) {
                 sect_ptr = new Section(ts_start, section_length, pid, CRC32::CHECK);
+                if (!new_section) {
+                    _recycled = sect_ptr;
+                }
+            }
+            if (!sect_ptr.isNull()) {
                 sect_ptr->setFirstTSPacketIndex(pusi_pkt_index);
                 sect_ptr->setLastTSPacketIndex(_packet_count);
                 if (!sect_ptr->isValid()) {
@@ -535,6 +556,10 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
         // TS buffer becomes empty
         pc.ts.clear();
     }
+    else if (in_packet) {
+        // Keep the start of the incomplete section from the packet
+        pc.ts.copy(ts_start, ts_size);
+    }
     else if (ts_start > pc.ts.data()) {
         // Remove start of TS buffer
         pc.ts.erase(0, ts_start - pc.ts.data());
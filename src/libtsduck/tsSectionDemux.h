@@ -35,6 +35,7 @@
 #pragma once
 #include "tsAbstractDemux.h"
 #include "tsETID.h"
+#include "tsPIDMap.h"
 #include "tsTableHandlerInterface.h"
 #include "tsSectionHandlerInterface.h"
 
@@ -183,6 +184,20 @@ namespace ts {
             return _status.hasErrors();
         }
 
+        //!
+        //! Get the number of section allocations which were avoided by the demux.
+        //! Sections which are not stored in a table being collected (typically
+        //! repeated sections which are only passed to a section handler) are
+        //! built in a recycled Section object and data buffer. Similarly, the
+        //! sections which are entirely contained in one TS packet are analyzed
+        //! directly in the packet, without intermediate copy.
+        //! @return The number of sections which were built in a recycled object.
+        //!
+        PacketCounter allocationsAvoided() const
+        {
+            return _allocs_avoided;
+        }
+
     protected:
         // Inherited methods
         virtual void immediateReset() override;
@@ -232,10 +247,12 @@ namespace ts {
         // Private members:
         TableHandlerInterface*   _table_handler;
         SectionHandlerInterface* _section_handler;
-        std::map<PID,PIDContext> _pids;
+        PIDMap<PIDContext>       _pids;
         Status                   _status;
         bool                     _get_current;
         bool                     _get_next;
+        SectionPtr               _recycled;        // Reusable section, not stored in any table.
+        PacketCounter            _allocs_avoided;  // Number of sections built in _recycled.
 
         // Inacessible operations
         SectionDemux(const SectionDemux&) = delete;
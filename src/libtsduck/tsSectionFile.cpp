@@ -271,6 +271,60 @@ bool ts::SectionFile::saveBinary(std::ostream& strm, Report& report) const
 }
 
 
+//----------------------------------------------------------------------------
+// Load an indexed binary section file.
+//----------------------------------------------------------------------------
+
+bool ts::SectionFile::loadIndexed(const UString& file_name, Report& report, CRC32::Validation crc_op)
+{
+    clear();
+
+    IndexedSectionFile file;
+    if (!file.open(file_name, report)) {
+        return false;
+    }
+
+    // Sections are built directly from the memory-mapped file, in file order.
+    bool success = true;
+    const size_t count = file.count();
+    _sections.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const SectionPtr sp(file.getSection(i, crc_op));
+        if (sp.isNull()) {
+            report.error(u"%s: invalid section #%d", {file_name, i});
+            success = false;
+            break;
+        }
+        add(sp);
+    }
+
+    file.close(report);
+    return success;
+}
+
+
+//----------------------------------------------------------------------------
+// Save an indexed binary section file.
+//----------------------------------------------------------------------------
+
+bool ts::SectionFile::saveIndexed(const UString& file_name, Report& report) const
+{
+    IndexedSectionFile file;
+    if (!file.create(file_name, report)) {
+        return false;
+    }
+
+    bool success = true;
+    for (size_t i = 0; success && i < _sections.size(); ++i) {
+        if (!_sections[i].isNull() && _sections[i]->isValid()) {
+            success = file.write(*_sections[i], report);
+        }
+    }
+
+    return file.close(report) && success;
+}
+
+
 //----------------------------------------------------------------------------
 // Load / parse an XML file.
 //----------------------------------------------------------------------------
@@ -278,17 +332,15 @@ bool ts::SectionFile::saveBinary(std::ostream& strm, Report& report) const
 bool ts::SectionFile::loadXML(const UString& file_name, Report& report, const DVBCharset* charset)
 {
     clear();
-    xml::Document doc(report);
-    doc.setTweaks(_xmlTweaks);
-    return doc.load(file_name, false) && parseDocument(doc, charset);
+    xml::PullParser parser(report);
+    return parser.open(file_name) && parseElements(parser, report, charset);
 }
 
 bool ts::SectionFile::loadXML(std::istream& strm, Report& report, const DVBCharset* charset)
 {
     clear();
-    xml::Document doc(report);
-    doc.setTweaks(_xmlTweaks);
-    return doc.load(strm) && parseDocument(doc, charset);
+    xml::PullParser parser(report);
+    return parser.open(strm) && parseElements(parser, report, charset);
 }
 
 bool ts::SectionFile::parseXML(const UString& xml_content, Report& report, const DVBCharset* charset)
@@ -299,15 +351,48 @@ bool ts::SectionFile::parseXML(const UString& xml_content, Report& report, const
     return doc.parse(xml_content) && parseDocument(doc, charset);
 }
 
-bool ts::SectionFile::parseDocument(const xml::Document& doc, const DVBCharset* charset)
+bool ts::SectionFile::LoadModel(xml::Document& model)
 {
     // Load the XML model for TSDuck files. Search it in TSDuck directory.
-    xml::Document model(doc.report());
     if (!model.load(u"tsduck.xml", true)) {
-        doc.report().error(u"Model for TSDuck XML files not found");
+        model.report().error(u"Model for TSDuck XML files not found");
+        return false;
+    }
+    return true;
+}
+
+bool ts::SectionFile::parseElements(xml::PullParser& parser, Report& report, const DVBCharset* charset)
+{
+    xml::Document model(report);
+    if (!LoadModel(model)) {
         return false;
     }
 
+    // Check the root name first, in case there is no table.
+    const xml::Element* modelRoot = model.rootElement();
+    if (modelRoot == nullptr || !parser.rootName().similar(modelRoot->name())) {
+        report.error(u"invalid XML document, expected <%s> as root, found <%s>", {modelRoot == nullptr ? u"(null)" : modelRoot->name(), parser.rootName()});
+        return false;
+    }
+
+    // Each document contains one single table, which is discarded after compilation.
+    xml::Document doc(report);
+    doc.setTweaks(_xmlTweaks);
+    bool success = true;
+    while (parser.readElement(doc)) {
+        success = parseDocument(doc, model, charset) && success;
+    }
+    return success && !parser.hasError();
+}
+
+bool ts::SectionFile::parseDocument(const xml::Document& doc, const DVBCharset* charset)
+{
+    xml::Document model(doc.report());
+    return LoadModel(model) && parseDocument(doc, model, charset);
+}
+
+bool ts::SectionFile::parseDocument(const xml::Document& doc, const xml::Document& model, const DVBCharset* charset)
+{
     // Validate the input document according to the model.
     if (!doc.validate(model)) {
         return false;
@@ -397,6 +482,9 @@ ts::SectionFile::FileType ts::SectionFile::GetFileType(const UString& file_name,
     else if (ext == TS_DEFAULT_BINARY_SECTION_FILE_SUFFIX) {
         return BINARY;
     }
+    else if (ext == TS_DEFAULT_INDEXED_SECTION_FILE_SUFFIX) {
+        return INDEXED;
+    }
     else {
         return UNSPECIFIED;
     }
@@ -412,6 +500,7 @@ ts::UString ts::SectionFile::BuildFileName(const UString& file_name, FileType ty
     switch (type) {
         case BINARY: return PathPrefix(file_name) + TS_DEFAULT_BINARY_SECTION_FILE_SUFFIX;
         case XML: return PathPrefix(file_name) + TS_DEFAULT_XML_SECTION_FILE_SUFFIX;
+        case INDEXED: return PathPrefix(file_name) + TS_DEFAULT_INDEXED_SECTION_FILE_SUFFIX;
         default: return file_name;
     }
 }
@@ -428,6 +517,8 @@ bool ts::SectionFile::load(const UString& file_name, Report& report, FileType ty
             return loadBinary(file_name, report, crc_op);
         case XML:
             return loadXML(file_name, report, charset);
+        case INDEXED:
+            return loadIndexed(file_name, report, crc_op);
         default:
             report.error(u"unknown file type for %s", {file_name});
             return false;
@@ -441,6 +532,9 @@ bool ts::SectionFile::load(std::istream& strm, Report& report, FileType type, CR
             return loadBinary(strm, report, crc_op);
         case XML:
             return loadXML(strm, report, charset);
+        case INDEXED:
+            report.error(u"indexed section files cannot be read from a stream");
+            return false;
         default:
             report.error(u"unknown input file type");
             return false;
@@ -34,6 +34,7 @@
 
 #pragma once
 #include "tsxmlDocument.h"
+#include "tsxmlPullParser.h"
 #include "tsxmlElement.h"
 #include "tsMPEG.h"
 #include "tsSection.h"
@@ -42,6 +43,7 @@
 #include "tsDVBCharset.h"
 #include "tsxmlTweaks.h"
 #include "tsTablesPtr.h"
+#include "tsIndexedSectionFile.h"
 #include "tsCerrReport.h"
 
 //!
@@ -125,6 +127,7 @@ namespace ts {
             UNSPECIFIED,  //!< Unspecified, depends on file name extension.
             BINARY,       //!< Binary section file.
             XML,          //!< XML section file.
+            INDEXED,      //!< Indexed binary section file (see IndexedSectionFile).
         };
 
         //!
@@ -181,6 +184,8 @@ namespace ts {
 
         //!
         //! Load an XML file.
+        //! The file is read and compiled one table at a time, the complete XML document
+        //! is never loaded in memory.
         //! @param [in] file_name XML file name.
         //! @param [in,out] report Where to report errors.
         //! @param [in] charset If not zero, default character set to encode strings.
@@ -190,6 +195,8 @@ namespace ts {
 
         //!
         //! Load an XML file.
+        //! The file is read and compiled one table at a time, the complete XML document
+        //! is never loaded in memory.
         //! @param [in,out] strm A standard text stream in input mode.
         //! @param [in,out] report Where to report errors.
         //! @param [in] charset If not zero, default character set to encode strings.
@@ -257,6 +264,25 @@ namespace ts {
         //!
         bool saveBinary(const UString& file_name, Report& report = CERR) const;
 
+        //!
+        //! Load an indexed binary section file.
+        //! The file is memory-mapped and all sections are loaded. To access
+        //! a few sections in a large file, use IndexedSectionFile directly.
+        //! @param [in] file_name Indexed binary file name.
+        //! @param [in] crc_op How to process the CRC32 of the input packet.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool loadIndexed(const UString& file_name, Report& report = CERR, CRC32::Validation crc_op = CRC32::IGNORE);
+
+        //!
+        //! Save an indexed binary section file.
+        //! @param [in] file_name Indexed binary file name.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool saveIndexed(const UString& file_name, Report& report = CERR) const;
+
         //!
         //! Fast access to the list of loaded tables.
         //! @return A constant reference to the internal list of loaded tables.
@@ -357,6 +383,31 @@ namespace ts {
         //!
         bool parseDocument(const xml::Document& doc, const DVBCharset* charset);
 
+        //!
+        //! Parse an XML document using an already loaded model.
+        //! @param [in] doc Document to load.
+        //! @param [in] model Model document for TSDuck XML files.
+        //! @param [in] charset If not zero, default character set to encode strings.
+        //! @return True on success, false on error.
+        //!
+        bool parseDocument(const xml::Document& doc, const xml::Document& model, const DVBCharset* charset);
+
+        //!
+        //! Parse an XML document, one table at a time, using a pull parser.
+        //! @param [in,out] parser An open XML pull parser.
+        //! @param [in,out] report Where to report errors.
+        //! @param [in] charset If not zero, default character set to encode strings.
+        //! @return True on success, false on error.
+        //!
+        bool parseElements(xml::PullParser& parser, Report& report, const DVBCharset* charset);
+
+        //!
+        //! Load the XML model for TSDuck files.
+        //! @param [out] model Model document for TSDuck XML files.
+        //! @return True on success, false on error.
+        //!
+        static bool LoadModel(xml::Document& model);
+
         //!
         //! Generate an XML document.
         //! @param [in,out] doc XML document.
@@ -0,0 +1,670 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Ring of TS packets in shared memory, between processes.
+//
+//----------------------------------------------------------------------------
+
+#include "tsSharedPacketRing.h"
+#include "tsNullReport.h"
+#include "tsMemoryUtils.h"
+#include "tsIntegerUtils.h"
+#include "tsTime.h"
+#include <atomic>
+#if defined(TS_LINUX)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::SharedPacketRing::DEFAULT_CAPACITY;
+const size_t ts::SharedPacketRing::DEFAULT_MAX_READERS;
+#endif
+
+#define RING_MAGIC      0x54535252  // Set in header when the ring is initialized.
+#define RING_VERSION             1  // Version of the shared memory layout.
+#define RING_ALIGN              64  // Alignment of shared structures, typical cache line size.
+#define POLL_INTERVAL            1  // Polling interval in milliseconds on systems without futex.
+#define READER_FREE              0  // State of an unused reader slot.
+#define READER_JOINING           1  // State of a reader slot being initialized.
+#define READER_ACTIVE            2  // State of an active reader slot.
+
+
+//----------------------------------------------------------------------------
+// Structures in shared memory. All processes access them using atomic
+// operations. Only lock-free atomics can be shared between processes.
+//----------------------------------------------------------------------------
+
+struct ts::SharedPacketRing::Header
+{
+    // Set by the writer before the ring becomes usable.
+    std::atomic<uint32_t> magic;          // RING_MAGIC when initialized.
+    uint32_t              version;        // RING_VERSION.
+    uint32_t              capacity;       // Number of packets in the ring.
+    uint32_t              maxReaders;     // Number of reader slots.
+    uint32_t              policy;         // What the writer does when the ring is full.
+    uint32_t              writerPid;      // Process id of the writer.
+    uint64_t              packetOffset;   // Offset of the packet area.
+
+    // Updated by the writer.
+    alignas(RING_ALIGN) std::atomic<uint64_t> reserveIndex;  // Packets before this index are written or being written.
+    std::atomic<uint64_t> writeIndex;     // Packets before this index are written.
+    std::atomic<uint32_t> writeSeq;       // Incremented after each write, readers wait on it.
+    std::atomic<uint32_t> closed;         // The writer closed the ring.
+
+    // Updated by the readers.
+    alignas(RING_ALIGN) std::atomic<uint32_t> readSeq;  // Incremented after each read, the writer waits on it.
+    std::atomic<uint32_t> readWaiters;    // Number of readers waiting for packets.
+    std::atomic<uint32_t> writerWaiting;  // The writer waits for free space.
+};
+
+struct ts::SharedPacketRing::Reader
+{
+    alignas(RING_ALIGN) std::atomic<uint32_t> state;  // One of READER_*.
+    std::atomic<uint32_t> pid;            // Process id of the reader.
+    std::atomic<uint64_t> readIndex;      // Packets before this index are read.
+};
+
+
+//----------------------------------------------------------------------------
+// System-specific synchronization and process utilities.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Wait until the value of a shared word changes, is signaled or the timeout expires.
+    void WaitChange(std::atomic<uint32_t>& word, uint32_t value, ts::MilliSecond timeout)
+    {
+#if defined(TS_LINUX)
+        ::timespec delay;
+        delay.tv_sec = ::time_t(timeout / ts::MilliSecPerSec);
+        delay.tv_nsec = long(timeout % ts::MilliSecPerSec) * 1000000;
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, value, &delay, nullptr, 0);
+#else
+        if (word.load() == value) {
+            ts::SleepThread(std::min<ts::MilliSecond>(timeout, POLL_INTERVAL));
+        }
+#endif
+    }
+
+    // Wake up all processes waiting on a shared word.
+    void WakeAll(std::atomic<uint32_t>& word)
+    {
+#if defined(TS_LINUX)
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+    }
+
+    // Check if a process is still running.
+    bool ProcessAlive(uint32_t pid)
+    {
+#if defined(TS_WINDOWS)
+        ::HANDLE proc = ::OpenProcess(SYNCHRONIZE, FALSE, ::DWORD(pid));
+        if (proc == nullptr) {
+            return ::GetLastError() == ERROR_ACCESS_DENIED;
+        }
+        const bool alive = ::WaitForSingleObject(proc, 0) == WAIT_TIMEOUT;
+        ::CloseHandle(proc);
+        return alive;
+#else
+        return ::kill(::pid_t(pid), 0) == 0 || errno == EPERM;
+#endif
+    }
+
+    // Copy packets between a buffer and the ring, with wrap-around.
+    void CopyToRing(ts::TSPacket* ring, size_t capacity, uint64_t index, const ts::TSPacket* buffer, size_t count)
+    {
+        const size_t first = size_t(index % capacity);
+        const size_t count1 = std::min(count, capacity - first);
+        ts::TSPacket::Copy(ring + first, buffer, count1);
+        ts::TSPacket::Copy(ring, buffer + count1, count - count1);
+    }
+
+    void CopyFromRing(const ts::TSPacket* ring, size_t capacity, uint64_t index, ts::TSPacket* buffer, size_t count)
+    {
+        const size_t first = size_t(index % capacity);
+        const size_t count1 = std::min(count, capacity - first);
+        ts::TSPacket::Copy(buffer, ring + first, count1);
+        ts::TSPacket::Copy(buffer + count1, ring, count - count1);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors.
+//----------------------------------------------------------------------------
+
+ts::SharedPacketRing::SharedPacketRing() :
+    _name(),
+    _writer(false),
+    _header(nullptr),
+    _reader(nullptr),
+    _packets(nullptr),
+    _size(0),
+    _capacity(0),
+    _index(0),
+    _lost(0),
+    _eof(false)
+#if defined(TS_WINDOWS)
+    , _handle(nullptr)
+#endif
+{
+}
+
+ts::SharedPacketRing::~SharedPacketRing()
+{
+    close(NULLREP);
+}
+
+
+//----------------------------------------------------------------------------
+// Build the system name of the shared memory object.
+//----------------------------------------------------------------------------
+
+ts::UString ts::SharedPacketRing::SystemName(const UString& name)
+{
+#if defined(TS_WINDOWS)
+    return u"Local\\tsduck-" + name;
+#else
+    return u"/tsduck-" + name;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Get the array of reader slots in shared memory, after the header.
+//----------------------------------------------------------------------------
+
+ts::SharedPacketRing::Reader* ts::SharedPacketRing::readers() const
+{
+    return reinterpret_cast<Reader*>(reinterpret_cast<uint8_t*>(_header) + RoundUp(sizeof(Header), size_t(RING_ALIGN)));
+}
+
+
+//----------------------------------------------------------------------------
+// Map the shared memory. When the object is not created, the size is ignored.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::map(bool create, size_t size, Report& report)
+{
+    void* addr = nullptr;
+
+#if defined(TS_WINDOWS)
+
+    if (create) {
+        _handle = ::CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, ::DWORD(uint64_t(size) >> 32), ::DWORD(size), _name.wc_str());
+        if (_handle != nullptr && ::GetLastError() == ERROR_ALREADY_EXISTS) {
+            report.error(u"shared memory %s is still in use by another ring", {_name});
+            ::CloseHandle(_handle);
+            _handle = nullptr;
+            return false;
+        }
+    }
+    else {
+        _handle = ::OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, _name.wc_str());
+    }
+    if (_handle == nullptr) {
+        report.error(u"error opening shared memory %s: %s", {_name, ErrorCodeMessage()});
+        return false;
+    }
+    addr = ::MapViewOfFile(_handle, FILE_MAP_ALL_ACCESS, 0, 0, create ? size : 0);
+    if (addr == nullptr) {
+        report.error(u"error mapping shared memory %s: %s", {_name, ErrorCodeMessage()});
+        ::CloseHandle(_handle);
+        _handle = nullptr;
+        return false;
+    }
+    if (!create) {
+        ::MEMORY_BASIC_INFORMATION info;
+        TS_ZERO(info);
+        ::VirtualQuery(addr, &info, sizeof(info));
+        size = info.RegionSize;
+    }
+
+#else
+
+    const int fd = ::shm_open(_name.toUTF8().c_str(), create ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR, 0666);
+    if (fd < 0) {
+        report.error(u"error opening shared memory %s: %s", {_name, ErrorCodeMessage()});
+        return false;
+    }
+    ErrorCode err = SYS_SUCCESS;
+    struct ::stat st;
+    if (create) {
+        if (::ftruncate(fd, ::off_t(size)) < 0) {
+            err = LastErrorCode();
+        }
+    }
+    else if (::fstat(fd, &st) < 0) {
+        err = LastErrorCode();
+    }
+    else {
+        size = size_t(st.st_size);
+    }
+    if (err == SYS_SUCCESS && size >= sizeof(Header) && (addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+        err = LastErrorCode();
+    }
+    ::close(fd);
+    if (err != SYS_SUCCESS || addr == nullptr || addr == MAP_FAILED) {
+        if (err == SYS_SUCCESS) {
+            report.error(u"shared packet ring %s is not initialized", {_name});
+        }
+        else {
+            report.error(u"error mapping shared memory %s: %s", {_name, ErrorCodeMessage(err)});
+        }
+        if (create) {
+            ::shm_unlink(_name.toUTF8().c_str());
+        }
+        return false;
+    }
+
+#endif
+
+    _header = reinterpret_cast<Header*>(addr);
+    _size = size;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Unmap the shared memory.
+//----------------------------------------------------------------------------
+
+void ts::SharedPacketRing::unmap()
+{
+    if (_header != nullptr) {
+#if defined(TS_WINDOWS)
+        ::UnmapViewOfFile(_header);
+        ::CloseHandle(_handle);
+        _handle = nullptr;
+#else
+        ::munmap(_header, _size);
+#endif
+    }
+    _header = nullptr;
+    _reader = nullptr;
+    _packets = nullptr;
+    _size = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Create a ring as the writer.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::create(const UString& name, size_t capacity, size_t max_readers, Policy policy, Report& report)
+{
+    if (isOpen()) {
+        report.error(u"shared packet ring already open");
+        return false;
+    }
+    if (name.empty() || name.find(u'/') != NPOS || name.find(u'\\') != NPOS) {
+        report.error(u"invalid shared packet ring name \"%s\"", {name});
+        return false;
+    }
+    if (capacity == 0 || capacity > 0xFFFFFFFF || max_readers == 0 || max_readers > 0xFFFF) {
+        report.error(u"invalid shared packet ring size, %d packets, %d readers", {capacity, max_readers});
+        return false;
+    }
+
+    _name = SystemName(name);
+    const size_t packetOffset = RoundUp(RoundUp(sizeof(Header), size_t(RING_ALIGN)) + max_readers * sizeof(Reader), size_t(RING_ALIGN));
+
+#if !defined(TS_WINDOWS)
+    // Replace a previous ring with the same name. Its readers keep their own mapping.
+    ::shm_unlink(_name.toUTF8().c_str());
+#endif
+
+    if (!map(true, packetOffset + capacity * PKT_SIZE, report)) {
+        return false;
+    }
+
+    // Initialize the shared structures.
+    Header* const h = new(_header) Header();
+    Reader* const r = readers();
+    for (size_t i = 0; i < max_readers; ++i) {
+        new(&r[i]) Reader();
+    }
+    if (!h->writeIndex.is_lock_free() || !h->writeSeq.is_lock_free()) {
+        report.error(u"shared packet rings are not supported on this platform");
+        _writer = true;
+        close(report);
+        return false;
+    }
+    h->version = RING_VERSION;
+    h->capacity = uint32_t(capacity);
+    h->maxReaders = uint32_t(max_readers);
+    h->policy = uint32_t(policy);
+    h->writerPid = uint32_t(CurrentProcessId());
+    h->packetOffset = packetOffset;
+
+    // The ring becomes usable by readers when the magic number is set.
+    h->magic.store(RING_MAGIC, std::memory_order_release);
+
+    _writer = true;
+    _packets = reinterpret_cast<TSPacket*>(reinterpret_cast<uint8_t*>(_header) + packetOffset);
+    _capacity = capacity;
+    _index = 0;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Open an existing ring as a reader.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::open(const UString& name, Report& report)
+{
+    if (isOpen()) {
+        report.error(u"shared packet ring already open");
+        return false;
+    }
+    if (name.empty() || name.find(u'/') != NPOS || name.find(u'\\') != NPOS) {
+        report.error(u"invalid shared packet ring name \"%s\"", {name});
+        return false;
+    }
+
+    _name = SystemName(name);
+    if (!map(false, 0, report)) {
+        return false;
+    }
+    _writer = false;
+
+    // Check that the ring is initialized and still alive.
+    Header* const h = _header;
+    if (h->magic.load(std::memory_order_acquire) != RING_MAGIC ||
+        h->version != RING_VERSION ||
+        h->capacity == 0 ||
+        RoundUp(sizeof(Header), size_t(RING_ALIGN)) + uint64_t(h->maxReaders) * sizeof(Reader) > h->packetOffset ||
+        h->packetOffset + uint64_t(h->capacity) * PKT_SIZE > _size)
+    {
+        report.error(u"shared packet ring %s is not initialized", {_name});
+        unmap();
+        return false;
+    }
+    if (h->closed.load() != 0 || !ProcessAlive(h->writerPid)) {
+        report.error(u"shared packet ring %s is closed", {_name});
+        unmap();
+        return false;
+    }
+
+    // Allocate a reader slot. The slot is not reclaimed by the writer until it becomes active.
+    Reader* const r = readers();
+    for (size_t i = 0; _reader == nullptr && i < h->maxReaders; ++i) {
+        uint32_t state = READER_FREE;
+        if (r[i].state.compare_exchange_strong(state, READER_JOINING)) {
+            _reader = &r[i];
+            _reader->pid.store(uint32_t(CurrentProcessId()));
+        }
+    }
+    if (_reader == nullptr) {
+        report.error(u"too many readers on shared packet ring %s, max: %d", {_name, h->maxReaders});
+        unmap();
+        return false;
+    }
+
+    // Start reading at the current write position.
+    _capacity = h->capacity;
+    _packets = reinterpret_cast<TSPacket*>(reinterpret_cast<uint8_t*>(_header) + h->packetOffset);
+    _index = h->writeIndex.load(std::memory_order_acquire);
+    _lost = 0;
+    _eof = false;
+    _reader->readIndex.store(_index, std::memory_order_release);
+    _reader->state.store(READER_ACTIVE, std::memory_order_release);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Close the ring.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::close(Report& report)
+{
+    if (!isOpen()) {
+        return true;
+    }
+
+    bool ok = true;
+    if (_writer) {
+        // Signal the end of stream to all readers.
+        _header->closed.store(1, std::memory_order_release);
+        _header->writeSeq.fetch_add(1);
+        WakeAll(_header->writeSeq);
+#if !defined(TS_WINDOWS)
+        // Remove the name, current readers keep their mapping.
+        if (::shm_unlink(_name.toUTF8().c_str()) < 0 && errno != ENOENT) {
+            report.error(u"error deleting shared memory %s: %s", {_name, ErrorCodeMessage()});
+            ok = false;
+        }
+#endif
+    }
+    else if (_reader != nullptr) {
+        // Release the reader slot, the writer may wait for it.
+        _reader->state.store(READER_FREE, std::memory_order_release);
+        _header->readSeq.fetch_add(1);
+        if (_header->writerWaiting.load() != 0) {
+            WakeAll(_header->readSeq);
+        }
+    }
+
+    unmap();
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Get the number of active readers.
+//----------------------------------------------------------------------------
+
+size_t ts::SharedPacketRing::readerCount() const
+{
+    size_t count = 0;
+    if (_header != nullptr) {
+        const Reader* const r = readers();
+        for (size_t i = 0; i < _header->maxReaders; ++i) {
+            if (r[i].state.load() == READER_ACTIVE) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+
+//----------------------------------------------------------------------------
+// Get the minimum read index of all active readers.
+//----------------------------------------------------------------------------
+
+uint64_t ts::SharedPacketRing::minReadIndex() const
+{
+    uint64_t index = _index;
+    const Reader* const r = readers();
+    for (size_t i = 0; i < _header->maxReaders; ++i) {
+        if (r[i].state.load(std::memory_order_acquire) == READER_ACTIVE) {
+            index = std::min(index, r[i].readIndex.load(std::memory_order_acquire));
+        }
+    }
+    return index;
+}
+
+
+//----------------------------------------------------------------------------
+// Release the reader slots of terminated processes.
+//----------------------------------------------------------------------------
+
+void ts::SharedPacketRing::cleanupReaders(Report& report)
+{
+    Reader* const r = readers();
+    for (size_t i = 0; i < _header->maxReaders; ++i) {
+        // Joining slots may still contain the pid of a previous reader, ignore them.
+        uint32_t state = READER_ACTIVE;
+        const uint32_t pid = r[i].pid.load();
+        if (r[i].state.load() == READER_ACTIVE && !ProcessAlive(pid) && r[i].state.compare_exchange_strong(state, READER_FREE)) {
+            report.verbose(u"reader process %d of shared packet ring %s terminated", {pid, _name});
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Write packets in the ring.
+//----------------------------------------------------------------------------
+
+size_t ts::SharedPacketRing::write(const TSPacket* buffer, size_t count, MilliSecond timeout, Report& report)
+{
+    if (!isOpen() || !_writer) {
+        report.error(u"shared packet ring not open for writing");
+        return 0;
+    }
+
+    Header* const h = _header;
+    const Time deadline(Time::CurrentUTC() + timeout);
+    size_t written = 0;
+
+    while (written < count) {
+
+        // Never write more than the ring size at a time.
+        size_t room = std::min(count - written, _capacity);
+
+        if (h->policy == BACK_PRESSURE) {
+            // Do not overwrite packets which are not yet read by all readers.
+            room = std::min(room, _capacity - size_t(std::min<uint64_t>(_index - minReadIndex(), _capacity)));
+            if (room == 0) {
+                // The ring is full, wait for the slowest reader.
+                const Time now(Time::CurrentUTC());
+                if (now >= deadline) {
+                    // Maybe the slowest reader is dead.
+                    cleanupReaders(report);
+                    break;
+                }
+                h->writerWaiting.store(1);
+                const uint32_t seq = h->readSeq.load();
+                if (_index - minReadIndex() >= _capacity) {
+                    WaitChange(h->readSeq, seq, deadline - now);
+                }
+                h->writerWaiting.store(0);
+                continue;
+            }
+        }
+
+        // Announce the area to overwrite before writing in it. A reader which
+        // copied packets from that area concurrently will drop them.
+        h->reserveIndex.store(_index + room, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        CopyToRing(_packets, _capacity, _index, buffer + written, room);
+        _index += room;
+        written += room;
+        h->writeIndex.store(_index, std::memory_order_release);
+
+        // Wake up readers, only when some are waiting.
+        h->writeSeq.fetch_add(1);
+        if (h->readWaiters.load() != 0) {
+            WakeAll(h->writeSeq);
+        }
+    }
+    return written;
+}
+
+
+//----------------------------------------------------------------------------
+// Read packets from the ring.
+//----------------------------------------------------------------------------
+
+size_t ts::SharedPacketRing::read(TSPacket* buffer, size_t max_count, MilliSecond timeout, Report& report)
+{
+    if (!isOpen() || _reader == nullptr) {
+        report.error(u"shared packet ring not open for reading");
+        return 0;
+    }
+
+    Header* const h = _header;
+    const Time deadline(Time::CurrentUTC() + timeout);
+
+    while (!_eof && max_count > 0) {
+
+        const uint64_t windex = h->writeIndex.load(std::memory_order_acquire);
+        if (windex == _index) {
+            // No packet available.
+            if (h->closed.load(std::memory_order_acquire) != 0) {
+                _eof = true;
+                break;
+            }
+            const Time now(Time::CurrentUTC());
+            if (now >= deadline) {
+                // Maybe the writer is dead.
+                if (!ProcessAlive(h->writerPid)) {
+                    report.verbose(u"writer process %d of shared packet ring %s terminated", {h->writerPid, _name});
+                    _eof = true;
+                }
+                break;
+            }
+            h->readWaiters.fetch_add(1);
+            const uint32_t seq = h->writeSeq.load();
+            if (h->writeIndex.load() == _index && h->closed.load() == 0) {
+                WaitChange(h->writeSeq, seq, deadline - now);
+            }
+            h->readWaiters.fetch_sub(1);
+            continue;
+        }
+
+        // Skip packets which were already overwritten.
+        if (windex - _index > _capacity) {
+            _lost += windex - _capacity - _index;
+            _index = windex - _capacity;
+        }
+
+        // Copy available packets.
+        size_t count = size_t(std::min<uint64_t>(max_count, windex - _index));
+        CopyFromRing(_packets, _capacity, _index, buffer, count);
+
+        // Drop the packets which were overwritten during the copy.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t reserve = h->reserveIndex.load(std::memory_order_relaxed);
+        if (reserve > _index + _capacity) {
+            const size_t skip = size_t(std::min<uint64_t>(reserve - _capacity - _index, count));
+            ::memmove(buffer->b, buffer[skip].b, (count - skip) * PKT_SIZE);
+            _lost += skip;
+            _index += skip;
+            count -= skip;
+        }
+        _index += count;
+
+        // Free the space in the ring, wake up the writer when it waits for it.
+        _reader->readIndex.store(_index, std::memory_order_release);
+        h->readSeq.fetch_add(1);
+        if (h->writerWaiting.load() != 0) {
+            WakeAll(h->readSeq);
+        }
+        if (count > 0) {
+            return count;
+        }
+    }
+    return 0;
+}
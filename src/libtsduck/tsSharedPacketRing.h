@@ -0,0 +1,202 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Ring of TS packets in shared memory, between processes.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSPacket.h"
+#include "tsSysUtils.h"
+#include "tsReport.h"
+
+namespace ts {
+    //!
+    //! Ring of TS packets in shared memory, between processes.
+    //! @ingroup system
+    //!
+    //! The ring is created by one writer process and is read by any number of reader
+    //! processes, up to a maximum which is set by the writer. Each reader receives all
+    //! packets which are written after it opened the ring. Packets are copied only once
+    //! on each side, directly from and to the caller's buffers. Waiting for packets or
+    //! free space does not involve any system call as long as there is something to do.
+    //! On Linux, waiting processes are woken up using futexes. On other systems, waiting
+    //! processes periodically poll the ring.
+    //!
+    //! The shared memory object is identified by a name. It is deleted when the writer
+    //! closes the ring. Readers which still use the ring can read the remaining packets.
+    //!
+    class TSDUCKDLL SharedPacketRing
+    {
+    public:
+        //!
+        //! What the writer does when the ring is full.
+        //!
+        enum Policy {
+            BACK_PRESSURE,  //!< Wait for the slowest reader to free some space.
+            DROP_OLDEST,    //!< Overwrite the oldest packets, readers which are too slow lose packets.
+        };
+
+        //!
+        //! Default number of packets in a ring.
+        //!
+        static const size_t DEFAULT_CAPACITY = 32768;
+
+        //!
+        //! Default maximum number of readers of a ring.
+        //!
+        static const size_t DEFAULT_MAX_READERS = 16;
+
+        //!
+        //! Default constructor.
+        //!
+        SharedPacketRing();
+
+        //!
+        //! Destructor.
+        //!
+        ~SharedPacketRing();
+
+        //!
+        //! Create a ring as the writer.
+        //! A previous ring with the same name is replaced. Its readers see the end of it.
+        //! @param [in] name Name of the ring.
+        //! @param [in] capacity Number of packets in the ring.
+        //! @param [in] max_readers Maximum number of readers.
+        //! @param [in] policy What to do when the ring is full.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool create(const UString& name, size_t capacity, size_t max_readers, Policy policy, Report& report);
+
+        //!
+        //! Open an existing ring as a reader.
+        //! The reader receives the packets which are written after this call.
+        //! @param [in] name Name of the ring.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error, including when the ring does not exist yet.
+        //!
+        bool open(const UString& name, Report& report);
+
+        //!
+        //! Close the ring.
+        //! When the writer closes the ring, the readers get an end of stream after the last packet.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool close(Report& report);
+
+        //!
+        //! Check if the ring is open.
+        //! @return True if the ring is open.
+        //!
+        bool isOpen() const { return _header != nullptr; }
+
+        //!
+        //! Write packets in the ring (writer only).
+        //! With the BACK_PRESSURE policy, wait for free space when the ring is full.
+        //! @param [in] buffer Address of the packets to write.
+        //! @param [in] count Number of packets to write.
+        //! @param [in] timeout Maximum time to wait for free space.
+        //! @param [in,out] report Where to report errors.
+        //! @return Number of written packets, lower than @a count when the timeout expired.
+        //!
+        size_t write(const TSPacket* buffer, size_t count, MilliSecond timeout, Report& report);
+
+        //!
+        //! Read packets from the ring (reader only).
+        //! @param [out] buffer Address of the buffer for the packets.
+        //! @param [in] max_count Maximum number of packets to read.
+        //! @param [in] timeout Maximum time to wait for packets.
+        //! @param [in,out] report Where to report errors.
+        //! @return Number of read packets. Zero when the timeout expired or at end of stream.
+        //! @see eof()
+        //!
+        size_t read(TSPacket* buffer, size_t max_count, MilliSecond timeout, Report& report);
+
+        //!
+        //! Check if the end of stream was reached (reader only).
+        //! @return True when the writer closed the ring or terminated and all packets were read.
+        //!
+        bool eof() const { return _eof; }
+
+        //!
+        //! Get the number of packets which were lost by this reader (reader only).
+        //! Packets are lost when the writer overwrites them before they are read.
+        //! @return The number of lost packets.
+        //!
+        PacketCounter lostPackets() const { return _lost; }
+
+        //!
+        //! Get the number of active readers.
+        //! @return The number of active readers.
+        //!
+        size_t readerCount() const;
+
+    private:
+        // Structures in shared memory, defined in the implementation.
+        struct Header;
+        struct Reader;
+
+        UString       _name;        // System name of the shared memory object.
+        bool          _writer;      // This is the writer of the ring.
+        Header*       _header;      // Start of shared memory.
+        Reader*       _reader;      // Reader slot of this process (reader only).
+        TSPacket*     _packets;     // Packet area in shared memory.
+        size_t        _size;        // Mapped size.
+        size_t        _capacity;    // Number of packets in the ring.
+        uint64_t      _index;       // Next packet to write or read.
+        PacketCounter _lost;        // Lost packets (reader only).
+        bool          _eof;         // End of stream (reader only).
+#if defined(TS_WINDOWS)
+        ::HANDLE      _handle;      // File mapping handle.
+#endif
+
+        // Build the system name of the shared memory object.
+        static UString SystemName(const UString& name);
+
+        // Get the array of reader slots in shared memory.
+        Reader* readers() const;
+
+        // Map / unmap the shared memory.
+        bool map(bool create, size_t size, Report& report);
+        void unmap();
+
+        // Get the minimum read index of all active readers, or the write index if there is none.
+        uint64_t minReadIndex() const;
+
+        // Release the reader slots of terminated processes.
+        void cleanupReaders(Report& report);
+
+        // Inaccessible operations.
+        SharedPacketRing(const SharedPacketRing&) = delete;
+        SharedPacketRing& operator=(const SharedPacketRing&) = delete;
+    };
+}
@@ -95,7 +95,11 @@ ts::TSAnalyzer::TSAnalyzer(BitRate bitrate_hint) :
     _default_charset(nullptr),
     _demux(this, this),
     _pes_demux(this),
-    _t2mi_demux(this)
+    _t2mi_demux(this),
+    _snapshot(nullptr),
+    _snapshot_interval(0),
+    _next_snapshot(0),
+    _snapshot_counters()
 {
     // Specify the PID filters to collect PSI tables.
     _demux.addPID(PID_PAT);
@@ -168,6 +172,7 @@ void ts::TSAnalyzer::reset()
     _ts_bitrate_cnt = 0;
     _preceding_errors = 0;
     _preceding_suspects = 0;
+    _next_snapshot = _snapshot_interval;
     _demux.reset();
     _pes_demux.reset();
 
@@ -1289,6 +1294,12 @@ void ts::TSAnalyzer::feedPacket(const TSPacket& pkt)
         _first_local = Time::CurrentLocalTime();
     }
 
+    // Periodically publish the main counters, before this packet.
+    if (_snapshot != nullptr && _snapshot_interval > 0 && _ts_pkt_cnt >= _next_snapshot) {
+        publishSnapshot();
+        _next_snapshot = _ts_pkt_cnt + _snapshot_interval;
+    }
+
     // Each new packet leads to various modifications
     _modified = true;
 
@@ -1494,6 +1505,60 @@ void ts::TSAnalyzer::setBitrateHint(BitRate bitrate)
 }
 
 
+//----------------------------------------------------------------------------
+// Attach a snapshot object to the analyzer.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::setSnapshot(TSAnalyzerSnapshot* snapshot, PacketCounter interval)
+{
+    _snapshot = snapshot;
+    _snapshot_interval = interval;
+    _next_snapshot = _ts_pkt_cnt + interval;
+}
+
+
+//----------------------------------------------------------------------------
+// Publish the current counters in the attached snapshot object.
+// Only use counters which are maintained per packet, no recomputeStatistics().
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::publishSnapshot()
+{
+    if (_snapshot == nullptr) {
+        return;
+    }
+
+    TSAnalyzerSnapshot::Counters& c(_snapshot_counters);
+    c.ts_packets = _ts_pkt_cnt;
+    c.invalid_sync = _invalid_sync;
+    c.transport_errors = _transport_errors;
+    c.suspect_ignored = _suspect_ignored;
+    c.discontinuities = 0;
+    c.scrambled = 0;
+    c.pcr_bitrate = _ts_bitrate_cnt == 0 ? 0 : BitRate(_ts_bitrate_sum / _ts_bitrate_cnt);
+    c.user_bitrate = _ts_user_bitrate;
+
+    // The PID map is iterated in increasing order of PID, active PID's only.
+    c.pids.resize(_pids.size());
+    size_t count = 0;
+    for (PIDContextMap::const_iterator it = _pids.begin(); it != _pids.end(); ++it) {
+        const PIDContext& ps(*it->second);
+        TSAnalyzerSnapshot::PIDCounters& pc(c.pids[count++]);
+        pc.pid = ps.pid;
+        pc.packets = ps.ts_pkt_cnt;
+        pc.discontinuities = ps.unexp_discont;
+        pc.duplicated = ps.duplicated;
+        pc.scrambled = ps.ts_sc_cnt;
+        pc.pcr_count = ps.pcr_cnt;
+        c.discontinuities += ps.unexp_discont;
+        c.scrambled += ps.ts_sc_cnt;
+    }
+    c.pids.resize(count);
+
+    _snapshot->publish(c);
+}
+
+
 //----------------------------------------------------------------------------
 // Update the global statistics value if internal data were modified.
 //----------------------------------------------------------------------------
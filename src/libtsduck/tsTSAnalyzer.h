@@ -34,6 +34,7 @@
 
 #pragma once
 #include "tsMPEG.h"
+#include "tsPIDMap.h"
 #include "tsTSPacket.h"
 #include "tsSectionDemux.h"
 #include "tsPESDemux.h"
@@ -45,6 +46,7 @@
 #include "tsTDT.h"
 #include "tsTOT.h"
 #include "tsTime.h"
+#include "tsTSAnalyzerSnapshot.h"
 #include "tsUString.h"
 #include "tsSafePtr.h"
 
@@ -95,6 +97,25 @@ namespace ts {
         //!
         void setBitrateHint(BitRate bitrate_hint = 0);
 
+        //!
+        //! Attach a snapshot object to the analyzer.
+        //! The main counters of the analysis are periodically published in the snapshot
+        //! object from feedPacket(). They can be read at any time by other threads,
+        //! without interfering with the thread which feeds the analyzer.
+        //! @param [in] snapshot Address of the snapshot object. If null, no longer
+        //! publish snapshots. The object must remain valid as long as it is attached.
+        //! @param [in] interval Number of TS packets between two publications.
+        //! If zero, the counters are published only when publishSnapshot() is called.
+        //!
+        void setSnapshot(TSAnalyzerSnapshot* snapshot, PacketCounter interval);
+
+        //!
+        //! Immediately publish the current counters in the attached snapshot object, if any.
+        //! The cost of a publication depends on the number of PID's, not on the
+        //! analysis history. Must be called from the thread which feeds the analyzer.
+        //!
+        void publishSnapshot();
+
         //!
         //! Set the number of consecutive packet errors threshold.
         //! @param [in] count The number of consecutive packet errors after which a packet is
@@ -387,7 +408,7 @@ namespace ts {
         //!
         //! Map of PIDContext, indexed by PID.
         //!
-        typedef std::map <PID, PIDContextPtr> PIDContextMap;
+        typedef PIDMap<PIDContextPtr> PIDContextMap;
 
     protected:
 
@@ -508,6 +529,12 @@ namespace ts {
         PESDemux          _pes_demux;                 // Audio/video analysis
         T2MIDemux         _t2mi_demux;                // T2-MI analysis
 
+        // Publication of snapshots:
+        TSAnalyzerSnapshot*          _snapshot;           // Where to publish snapshots (if not null)
+        PacketCounter                _snapshot_interval;  // Number of packets between snapshots
+        PacketCounter                _next_snapshot;      // Packet count of next snapshot
+        TSAnalyzerSnapshot::Counters _snapshot_counters;  // Counters to publish, reused to avoid reallocation
+
         // Inaccessible operations.
         TSAnalyzer(const TSAnalyzer&) = delete;
         TSAnalyzer& operator=(const TSAnalyzer&) = delete;
@@ -0,0 +1,236 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Lock-free snapshot of the main counters of a TSAnalyzer.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSAnalyzerSnapshot.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors.
+//----------------------------------------------------------------------------
+
+ts::TSAnalyzerSnapshot::PIDCounters::PIDCounters() :
+    pid(PID_NULL),
+    packets(0),
+    discontinuities(0),
+    duplicated(0),
+    scrambled(0),
+    pcr_count(0)
+{
+}
+
+ts::TSAnalyzerSnapshot::Counters::Counters() :
+    sequence(0),
+    utc(Time::Epoch),
+    ts_packets(0),
+    invalid_sync(0),
+    transport_errors(0),
+    suspect_ignored(0),
+    discontinuities(0),
+    scrambled(0),
+    pcr_bitrate(0),
+    user_bitrate(0),
+    pids()
+{
+}
+
+ts::TSAnalyzerSnapshot::TSAnalyzerSnapshot() :
+    _sequence(0),
+    _buffers(new Buffer[2])
+{
+    for (size_t i = 0; i < 2; ++i) {
+        _buffers[i].seq.store(0, std::memory_order_relaxed);
+    }
+}
+
+ts::TSAnalyzerSnapshot::~TSAnalyzerSnapshot()
+{
+    delete[] _buffers;
+}
+
+
+//----------------------------------------------------------------------------
+// Clear the content of the counters.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzerSnapshot::Counters::clear()
+{
+    sequence = 0;
+    utc = Time::Epoch;
+    ts_packets = 0;
+    invalid_sync = 0;
+    transport_errors = 0;
+    suspect_ignored = 0;
+    discontinuities = 0;
+    scrambled = 0;
+    pcr_bitrate = 0;
+    user_bitrate = 0;
+    pids.clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Publish a new set of counters (writer thread).
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzerSnapshot::publish(const Counters& counters)
+{
+    // Write into the buffer which is not the current one.
+    const uint64_t seq = _sequence.load(std::memory_order_relaxed) + 1;
+    Buffer& buf(_buffers[seq % 2]);
+
+    // Mark the buffer as being written (odd sequence).
+    buf.seq.store(2 * seq - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const size_t count = std::min<size_t>(counters.pids.size(), PID_MAX);
+    buf.global[G_TS_PACKETS].store(counters.ts_packets, std::memory_order_relaxed);
+    buf.global[G_INVALID_SYNC].store(counters.invalid_sync, std::memory_order_relaxed);
+    buf.global[G_TRANSPORT_ERRORS].store(counters.transport_errors, std::memory_order_relaxed);
+    buf.global[G_SUSPECT_IGNORED].store(counters.suspect_ignored, std::memory_order_relaxed);
+    buf.global[G_DISCONTINUITIES].store(counters.discontinuities, std::memory_order_relaxed);
+    buf.global[G_SCRAMBLED].store(counters.scrambled, std::memory_order_relaxed);
+    buf.global[G_PCR_BITRATE].store(counters.pcr_bitrate, std::memory_order_relaxed);
+    buf.global[G_USER_BITRATE].store(counters.user_bitrate, std::memory_order_relaxed);
+    buf.global[G_UTC].store(uint64_t(Time::CurrentUTC() - Time::Epoch), std::memory_order_relaxed);
+    buf.global[G_PID_COUNT].store(count, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < count; ++i) {
+        const PIDCounters& pc(counters.pids[i]);
+        std::atomic<uint64_t>* const p = buf.pids[i];
+        p[P_PID].store(pc.pid, std::memory_order_relaxed);
+        p[P_PACKETS].store(pc.packets, std::memory_order_relaxed);
+        p[P_DISCONTINUITIES].store(pc.discontinuities, std::memory_order_relaxed);
+        p[P_DUPLICATED].store(pc.duplicated, std::memory_order_relaxed);
+        p[P_SCRAMBLED].store(pc.scrambled, std::memory_order_relaxed);
+        p[P_PCR_COUNT].store(pc.pcr_count, std::memory_order_relaxed);
+    }
+
+    // Mark the buffer as complete (even sequence) and make it the current one.
+    buf.seq.store(2 * seq, std::memory_order_release);
+    _sequence.store(seq, std::memory_order_release);
+}
+
+
+//----------------------------------------------------------------------------
+// Get the last published set of counters (any thread).
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzerSnapshot::get(Counters& counters) const
+{
+    for (;;) {
+        const uint64_t seq = _sequence.load(std::memory_order_acquire);
+        if (seq == 0) {
+            counters.clear();
+            return;
+        }
+
+        // Read the current buffer. Retry if it is being rewritten.
+        const Buffer& buf(_buffers[seq % 2]);
+        const uint64_t before = buf.seq.load(std::memory_order_acquire);
+        if ((before & 1) != 0) {
+            continue;
+        }
+
+        counters.sequence = before / 2;
+        counters.ts_packets = buf.global[G_TS_PACKETS].load(std::memory_order_relaxed);
+        counters.invalid_sync = buf.global[G_INVALID_SYNC].load(std::memory_order_relaxed);
+        counters.transport_errors = buf.global[G_TRANSPORT_ERRORS].load(std::memory_order_relaxed);
+        counters.suspect_ignored = buf.global[G_SUSPECT_IGNORED].load(std::memory_order_relaxed);
+        counters.discontinuities = buf.global[G_DISCONTINUITIES].load(std::memory_order_relaxed);
+        counters.scrambled = buf.global[G_SCRAMBLED].load(std::memory_order_relaxed);
+        counters.pcr_bitrate = BitRate(buf.global[G_PCR_BITRATE].load(std::memory_order_relaxed));
+        counters.user_bitrate = BitRate(buf.global[G_USER_BITRATE].load(std::memory_order_relaxed));
+        counters.utc = Time::Epoch + MilliSecond(buf.global[G_UTC].load(std::memory_order_relaxed));
+
+        const size_t count = std::min<size_t>(buf.global[G_PID_COUNT].load(std::memory_order_relaxed), PID_MAX);
+        counters.pids.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            PIDCounters& pc(counters.pids[i]);
+            const std::atomic<uint64_t>* const p = buf.pids[i];
+            pc.pid = PID(p[P_PID].load(std::memory_order_relaxed));
+            pc.packets = p[P_PACKETS].load(std::memory_order_relaxed);
+            pc.discontinuities = p[P_DISCONTINUITIES].load(std::memory_order_relaxed);
+            pc.duplicated = p[P_DUPLICATED].load(std::memory_order_relaxed);
+            pc.scrambled = p[P_SCRAMBLED].load(std::memory_order_relaxed);
+            pc.pcr_count = p[P_PCR_COUNT].load(std::memory_order_relaxed);
+        }
+
+        // The copy is consistent if the buffer was not rewritten in the meantime.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (buf.seq.load(std::memory_order_relaxed) == before) {
+            return;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Build a JSON representation of the counters.
+//----------------------------------------------------------------------------
+
+ts::json::ValuePtr ts::TSAnalyzerSnapshot::Counters::toJSON() const
+{
+    const BitRate ts_bitrate = bitrate();
+
+    json::ValuePtr ts(new json::Object);
+    ts->add(u"packets", json::ValuePtr(new json::Number(int64_t(ts_packets))));
+    ts->add(u"invalid-sync", json::ValuePtr(new json::Number(int64_t(invalid_sync))));
+    ts->add(u"transport-errors", json::ValuePtr(new json::Number(int64_t(transport_errors))));
+    ts->add(u"suspect-ignored", json::ValuePtr(new json::Number(int64_t(suspect_ignored))));
+    ts->add(u"discontinuities", json::ValuePtr(new json::Number(int64_t(discontinuities))));
+    ts->add(u"scrambled", json::ValuePtr(new json::Number(int64_t(scrambled))));
+    ts->add(u"bitrate", json::ValuePtr(new json::Number(int64_t(ts_bitrate))));
+    ts->add(u"pcr-bitrate", json::ValuePtr(new json::Number(int64_t(pcr_bitrate))));
+
+    json::ValuePtr pid_list(new json::Array);
+    for (size_t i = 0; i < pids.size(); ++i) {
+        const PIDCounters& pc(pids[i]);
+        json::ValuePtr pid(new json::Object);
+        pid->add(u"pid", json::ValuePtr(new json::Number(int64_t(pc.pid))));
+        pid->add(u"packets", json::ValuePtr(new json::Number(int64_t(pc.packets))));
+        pid->add(u"bitrate", json::ValuePtr(new json::Number(ts_packets == 0 ? 0 : int64_t((uint64_t(ts_bitrate) * pc.packets) / ts_packets))));
+        pid->add(u"discontinuities", json::ValuePtr(new json::Number(int64_t(pc.discontinuities))));
+        pid->add(u"duplicated", json::ValuePtr(new json::Number(int64_t(pc.duplicated))));
+        pid->add(u"scrambled", json::ValuePtr(new json::Number(int64_t(pc.scrambled))));
+        pid->add(u"pcr-count", json::ValuePtr(new json::Number(int64_t(pc.pcr_count))));
+        pid_list->set(pid);
+    }
+
+    json::ValuePtr root(new json::Object);
+    root->add(u"sequence", json::ValuePtr(new json::Number(int64_t(sequence))));
+    root->add(u"utc", json::ValuePtr(new json::String(utc.format(Time::DATE | Time::TIME))));
+    root->add(u"ts", ts);
+    root->add(u"pids", pid_list);
+    return root;
+}
@@ -0,0 +1,181 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Lock-free snapshot of the main counters of a TSAnalyzer.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsMPEG.h"
+#include "tsTime.h"
+#include "tsjson.h"
+#include <atomic>
+
+namespace ts {
+    //!
+    //! Lock-free snapshot of the main counters of a TSAnalyzer.
+    //! @ingroup mpeg
+    //!
+    //! A full TSAnalyzer report is expensive: all statistics are recomputed
+    //! and a large text is formatted, in the thread which owns the analyzer.
+    //! A snapshot is a small fixed set of global and per-PID counters which
+    //! is periodically published by the analyzer (see TSAnalyzer::setSnapshot())
+    //! and which can be read at any time from any other thread, typically a
+    //! monitoring thread, without locking the packet processing thread.
+    //!
+    //! There is one writer (the thread which feeds the analyzer) and any number of readers.
+    //! The counters are published in two alternating buffers, each of them protected
+    //! by a sequence number. The writer never waits. A reader retries only when the
+    //! writer published twice while the reader was copying a buffer. The cost of a
+    //! publication and the cost of a read only depend on the number of active PID's.
+    //!
+    class TSDUCKDLL TSAnalyzerSnapshot
+    {
+    public:
+        //!
+        //! Counters of one PID.
+        //!
+        struct TSDUCKDLL PIDCounters
+        {
+            PID      pid;              //!< PID value.
+            uint64_t packets;          //!< Number of TS packets.
+            uint64_t discontinuities;  //!< Number of unexpected discontinuities.
+            uint64_t duplicated;       //!< Number of duplicated packets.
+            uint64_t scrambled;        //!< Number of scrambled packets.
+            uint64_t pcr_count;        //!< Number of PCR's.
+
+            //!
+            //! Default constructor.
+            //!
+            PIDCounters();
+        };
+
+        //!
+        //! Set of counters in a snapshot.
+        //!
+        struct TSDUCKDLL Counters
+        {
+            uint64_t                 sequence;          //!< Publication sequence number, zero if nothing was published.
+            Time                     utc;               //!< System UTC time of the publication.
+            uint64_t                 ts_packets;        //!< Number of TS packets.
+            uint64_t                 invalid_sync;      //!< Number of packets with invalid sync byte.
+            uint64_t                 transport_errors;  //!< Number of packets with transport error.
+            uint64_t                 suspect_ignored;   //!< Number of suspect packets, ignored.
+            uint64_t                 discontinuities;   //!< Number of unexpected discontinuities in all PID's.
+            uint64_t                 scrambled;         //!< Number of scrambled packets in all PID's.
+            BitRate                  pcr_bitrate;       //!< Average TS bitrate in b/s, evaluated from PCR's (zero if unknown).
+            BitRate                  user_bitrate;      //!< User-specified or hint TS bitrate (zero if unknown).
+            std::vector<PIDCounters> pids;              //!< Counters of each PID, in increasing order of PID values.
+
+            //!
+            //! Default constructor.
+            //!
+            Counters();
+
+            //!
+            //! Clear the content of the counters.
+            //!
+            void clear();
+
+            //!
+            //! Get the TS bitrate, either user-specified or evaluated from PCR's.
+            //! @return The TS bitrate in b/s or zero if unknown.
+            //!
+            BitRate bitrate() const { return user_bitrate != 0 ? user_bitrate : pcr_bitrate; }
+
+            //!
+            //! Build a JSON representation of the counters.
+            //! The per-PID bitrates are computed from the TS bitrate.
+            //! @return A JSON object.
+            //!
+            json::ValuePtr toJSON() const;
+        };
+
+        //!
+        //! Constructor.
+        //!
+        TSAnalyzerSnapshot();
+
+        //!
+        //! Destructor.
+        //!
+        ~TSAnalyzerSnapshot();
+
+        //!
+        //! Publish a new set of counters.
+        //! Must be called from one single thread, the writer.
+        //! The @a sequence and @a utc fields of @a counters are ignored and
+        //! recomputed. Only the first PID_MAX PID entries are published.
+        //! @param [in] counters The counters to publish.
+        //!
+        void publish(const Counters& counters);
+
+        //!
+        //! Get the last published set of counters.
+        //! Can be called from any thread, concurrently with publish().
+        //! @param [out] counters The last published counters. If nothing was published
+        //! yet, the counters are cleared and their sequence number is zero.
+        //!
+        void get(Counters& counters) const;
+
+        //!
+        //! Get the sequence number of the last publication.
+        //! Can be called from any thread.
+        //! @return The sequence number of the last publication, zero if nothing was published.
+        //!
+        uint64_t sequence() const { return _sequence.load(std::memory_order_acquire); }
+
+    private:
+        // Number of global and per-PID values in a buffer.
+        enum {
+            G_TS_PACKETS, G_INVALID_SYNC, G_TRANSPORT_ERRORS, G_SUSPECT_IGNORED, G_DISCONTINUITIES,
+            G_SCRAMBLED, G_PCR_BITRATE, G_USER_BITRATE, G_UTC, G_PID_COUNT, GLOBAL_COUNT
+        };
+        enum {
+            P_PID, P_PACKETS, P_DISCONTINUITIES, P_DUPLICATED, P_SCRAMBLED, P_PCR_COUNT, PID_COUNT
+        };
+
+        // One publication buffer. All values are atomic to avoid data races with readers.
+        // An odd sequence number means that the buffer is being written.
+        struct Buffer
+        {
+            std::atomic<uint64_t> seq;
+            std::atomic<uint64_t> global[GLOBAL_COUNT];
+            std::atomic<uint64_t> pids[PID_MAX][PID_COUNT];
+        };
+
+        std::atomic<uint64_t> _sequence;  // Last publication sequence number, also selects current buffer.
+        Buffer*               _buffers;   // Two alternating buffers.
+
+        // Inaccessible operations.
+        TSAnalyzerSnapshot(const TSAnalyzerSnapshot&) = delete;
+        TSAnalyzerSnapshot& operator=(const TSAnalyzerSnapshot&) = delete;
+    };
+}
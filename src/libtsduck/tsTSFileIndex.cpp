@@ -0,0 +1,483 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSFileIndex.h"
+#include "tsTSFileInput.h"
+#include "tsBinaryTable.h"
+#include "tsByteBlock.h"
+#include "tsSysUtils.h"
+#include "tsPAT.h"
+#include "tsTDT.h"
+#include "tsTOT.h"
+TSDUCK_SOURCE;
+
+// Suffix of index file names.
+#define INDEX_SUFFIX u".tsidx"
+
+// Header of index files: magic string and format version.
+#define INDEX_MAGIC   "TSIDX"
+#define INDEX_VERSION 1
+
+// Number of packets per read operation while building the index.
+#define READ_PACKETS 1024
+
+// In the list of PUSI packets, distances between packets which do not fit
+// in 32 bits are coded as this escape value, followed by 64 bits.
+#define PUSI_ESCAPE 0xFFFFFFFF
+
+
+//----------------------------------------------------------------------------
+// Constructor.
+//----------------------------------------------------------------------------
+
+ts::TSFileIndex::TSFileIndex() :
+    TableHandlerInterface(),
+    SectionHandlerInterface(),
+    _packet_count(0),
+    _file_size(0),
+    _file_time(),
+    _pcrs(),
+    _times(),
+    _versions(),
+    _pusi(),
+    _demux(this, this),
+    _last_version()
+{
+    clear();
+}
+
+ts::UString ts::TSFileIndex::IndexFileName(const UString& ts_file)
+{
+    return ts_file + INDEX_SUFFIX;
+}
+
+
+//----------------------------------------------------------------------------
+// Clear the content of the index.
+//----------------------------------------------------------------------------
+
+void ts::TSFileIndex::clear()
+{
+    _packet_count = 0;
+    _file_size = 0;
+    _file_time = Time::Epoch;
+    _pcrs.clear();
+    _times.clear();
+    _versions.clear();
+    _pusi.clear();
+    _last_version.clear();
+    _demux.reset();
+
+    // All DVB-reserved PID's for PSI/SI, PMT PID's are added from the PAT.
+    for (PID pid = PID_PAT; pid <= PID_DVB_LAST; ++pid) {
+        _demux.addPID(pid);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Add the next packet of the transport stream in the index.
+//----------------------------------------------------------------------------
+
+void ts::TSFileIndex::feedPacket(const TSPacket& pkt)
+{
+    const PID pid = pkt.getPID();
+    if (pkt.getPUSI()) {
+        _pusi[pid].push_back(_packet_count);
+    }
+    if (pkt.hasPCR()) {
+        const PCRPoint point = {_packet_count, pid, pkt.getPCR()};
+        _pcrs.push_back(point);
+    }
+    _demux.feedPacket(pkt);
+    _packet_count++;
+}
+
+
+//----------------------------------------------------------------------------
+// Handlers for tables and sections while building the index.
+//----------------------------------------------------------------------------
+
+void ts::TSFileIndex::handleTable(SectionDemux& demux, const BinaryTable& table)
+{
+    // The packet which completes the table was not yet counted.
+    switch (table.tableId()) {
+        case TID_PAT: {
+            const PAT pat(table);
+            if (pat.isValid()) {
+                for (PAT::ServiceMap::const_iterator it = pat.pmts.begin(); it != pat.pmts.end(); ++it) {
+                    _demux.addPID(it->second);
+                }
+            }
+            break;
+        }
+        case TID_TDT: {
+            const TDT tdt(table);
+            if (tdt.isValid()) {
+                const TimePoint point = {_packet_count, tdt.utc_time};
+                _times.push_back(point);
+            }
+            break;
+        }
+        case TID_TOT: {
+            const TOT tot(table);
+            if (tot.isValid()) {
+                const TimePoint point = {_packet_count, tot.utc_time};
+                _times.push_back(point);
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+void ts::TSFileIndex::handleSection(SectionDemux& demux, const Section& section)
+{
+    if (section.isLongSection()) {
+        const uint64_t key = (uint64_t(section.sourcePID()) << 24) | (uint64_t(section.tableId()) << 16) | section.tableIdExtension();
+        const std::map<uint64_t,uint8_t>::iterator it = _last_version.find(key);
+        if (it == _last_version.end() || it->second != section.version()) {
+            _last_version[key] = section.version();
+            const TableVersion tv = {_packet_count, section.sourcePID(), section.tableId(), section.tableIdExtension(), section.version()};
+            _versions.push_back(tv);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Build the index of a transport stream file in one pass.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileIndex::build(const UString& ts_file, Report& report, bool memory_map)
+{
+    clear();
+
+    TSFileInput file;
+    file.setMemoryMapping(memory_map);
+    if (!file.open(ts_file, 1, 0, report)) {
+        return false;
+    }
+
+    const TSPacket* pkt = nullptr;
+    size_t count = 0;
+    bool sync = true;
+    while (sync && (count = file.readInPlace(pkt, READ_PACKETS, report)) > 0) {
+        for (size_t i = 0; sync && i < count; ++i) {
+            if ((sync = pkt[i].hasValidSync())) {
+                feedPacket(pkt[i]);
+            }
+            else {
+                report.error(u"synchronization lost after %'d TS packets, got 0x%X instead of 0x%X at start of TS packet", {_packet_count, pkt[i].b[0], SYNC_BYTE});
+            }
+        }
+    }
+    file.close(report);
+
+    // Characteristics of the indexed file, to detect outdated indexes.
+    const int64_t size = GetFileSize(ts_file);
+    _file_size = size < 0 ? 0 : uint64_t(size);
+    _file_time = GetFileModificationTimeUTC(ts_file);
+
+    return sync;
+}
+
+
+//----------------------------------------------------------------------------
+// Check if the index matches a transport stream file.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileIndex::matchFile(const UString& ts_file) const
+{
+    const int64_t size = GetFileSize(ts_file);
+    return size >= 0 && uint64_t(size) == _file_size && GetFileModificationTimeUTC(ts_file) == _file_time;
+}
+
+
+//----------------------------------------------------------------------------
+// Save the index in a binary file.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileIndex::save(const UString& index_file, Report& report) const
+{
+    ByteBlock data;
+    data.append(INDEX_MAGIC, ::strlen(INDEX_MAGIC));
+    data.appendUInt8(INDEX_VERSION);
+    data.appendUInt64(_file_size);
+    data.appendUInt64(uint64_t(_file_time - Time::Epoch));
+    data.appendUInt64(_packet_count);
+
+    data.appendUInt32(uint32_t(_pcrs.size()));
+    for (std::vector<PCRPoint>::const_iterator it = _pcrs.begin(); it != _pcrs.end(); ++it) {
+        data.appendUInt64(it->packet);
+        data.appendUInt16(it->pid);
+        data.appendUInt64(it->pcr);
+    }
+
+    data.appendUInt32(uint32_t(_times.size()));
+    for (std::vector<TimePoint>::const_iterator it = _times.begin(); it != _times.end(); ++it) {
+        data.appendUInt64(it->packet);
+        data.appendUInt64(uint64_t(it->utc - Time::Epoch));
+    }
+
+    data.appendUInt32(uint32_t(_versions.size()));
+    for (std::vector<TableVersion>::const_iterator it = _versions.begin(); it != _versions.end(); ++it) {
+        data.appendUInt64(it->packet);
+        data.appendUInt16(it->pid);
+        data.appendUInt8(it->tid);
+        data.appendUInt16(it->tid_ext);
+        data.appendUInt8(it->version);
+    }
+
+    // PUSI packets are stored as distances from the previous one in the same PID.
+    data.appendUInt16(uint16_t(_pusi.size()));
+    for (PIDMap<PacketIndexVector>::const_iterator it = _pusi.begin(); it != _pusi.end(); ++it) {
+        data.appendUInt16(it->first);
+        data.appendUInt32(uint32_t(it->second.size()));
+        PacketCounter previous = 0;
+        for (PacketIndexVector::const_iterator pi = it->second.begin(); pi != it->second.end(); ++pi) {
+            const PacketCounter distance = *pi - previous;
+            if (distance < PUSI_ESCAPE) {
+                data.appendUInt32(uint32_t(distance));
+            }
+            else {
+                data.appendUInt32(PUSI_ESCAPE);
+                data.appendUInt64(distance);
+            }
+            previous = *pi;
+        }
+    }
+
+    return data.saveToFile(index_file, &report);
+}
+
+
+//----------------------------------------------------------------------------
+// Load the index from a binary file.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileIndex::load(const UString& index_file, Report& report)
+{
+    clear();
+
+    ByteBlock data;
+    if (!data.loadFromFile(index_file, std::numeric_limits<size_t>::max(), &report)) {
+        return false;
+    }
+
+    const uint8_t* p = data.data();
+    const uint8_t* const end = p + data.size();
+    const size_t magic_size = ::strlen(INDEX_MAGIC);
+    bool valid = data.size() >= magic_size + 25 && ::memcmp(p, INDEX_MAGIC, magic_size) == 0 && p[magic_size] == INDEX_VERSION;
+
+    if (valid) {
+        p += magic_size + 1;
+        _file_size = GetUInt64(p);
+        _file_time = Time::Epoch + MilliSecond(GetUInt64(p + 8));
+        _packet_count = GetUInt64(p + 16);
+        p += 24;
+    }
+
+    size_t count = 0;
+    if (valid && (valid = end - p >= 4)) {
+        count = GetUInt32(p);
+        p += 4;
+        valid = size_t(end - p) >= count * 18;
+    }
+    for (size_t i = 0; valid && i < count; ++i, p += 18) {
+        const PCRPoint point = {GetUInt64(p), PID(GetUInt16(p + 8)), GetUInt64(p + 10)};
+        _pcrs.push_back(point);
+    }
+
+    if (valid && (valid = end - p >= 4)) {
+        count = GetUInt32(p);
+        p += 4;
+        valid = size_t(end - p) >= count * 16;
+    }
+    for (size_t i = 0; valid && i < count; ++i, p += 16) {
+        const TimePoint point = {GetUInt64(p), Time::Epoch + MilliSecond(GetUInt64(p + 8))};
+        _times.push_back(point);
+    }
+
+    if (valid && (valid = end - p >= 4)) {
+        count = GetUInt32(p);
+        p += 4;
+        valid = size_t(end - p) >= count * 14;
+    }
+    for (size_t i = 0; valid && i < count; ++i, p += 14) {
+        const TableVersion tv = {GetUInt64(p), PID(GetUInt16(p + 8)), p[10], GetUInt16(p + 11), p[13]};
+        _versions.push_back(tv);
+    }
+
+    size_t pid_count = 0;
+    if (valid && (valid = end - p >= 2)) {
+        pid_count = GetUInt16(p);
+        p += 2;
+    }
+    for (size_t ipid = 0; valid && ipid < pid_count; ++ipid) {
+        PID pid = PID_NULL;
+        if ((valid = end - p >= 6)) {
+            pid = GetUInt16(p);
+            count = GetUInt32(p + 2);
+            p += 6;
+            valid = pid < PID_MAX;
+        }
+        if (!valid) {
+            break;
+        }
+        // Each distance uses at least 4 bytes, do not trust the count before reserving.
+        PacketIndexVector& packets(_pusi[pid]);
+        if (count <= size_t(end - p) / 4) {
+            packets.reserve(count);
+        }
+        PacketCounter previous = 0;
+        for (size_t i = 0; valid && i < count; ++i) {
+            if ((valid = end - p >= 4)) {
+                PacketCounter distance = GetUInt32(p);
+                p += 4;
+                if (distance == PUSI_ESCAPE && (valid = end - p >= 8)) {
+                    distance = GetUInt64(p);
+                    p += 8;
+                }
+                previous += distance;
+                packets.push_back(previous);
+            }
+        }
+    }
+
+    if (!valid) {
+        report.error(u"invalid index file %s", {index_file});
+        clear();
+    }
+    return valid;
+}
+
+
+//----------------------------------------------------------------------------
+// Get the indexes of the packets with a payload unit start indicator in a PID.
+//----------------------------------------------------------------------------
+
+const ts::TSFileIndex::PacketIndexVector& ts::TSFileIndex::pusiPackets(PID pid) const
+{
+    static const PacketIndexVector empty;
+    const PIDMap<PacketIndexVector>::const_iterator it = _pusi.find(pid);
+    return it == _pusi.end() ? empty : it->second;
+}
+
+void ts::TSFileIndex::getPUSIPIDs(std::vector<PID>& pids) const
+{
+    pids.clear();
+    for (PIDMap<PacketIndexVector>::const_iterator it = _pusi.begin(); it != _pusi.end(); ++it) {
+        pids.push_back(it->first);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Find the first packet with a PUSI in a PID at or after a given position.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileIndex::findPUSI(PID pid, PacketCounter from, PacketCounter& packet) const
+{
+    const PacketIndexVector& packets(pusiPackets(pid));
+    const PacketIndexVector::const_iterator it = std::lower_bound(packets.begin(), packets.end(), from);
+    if (it == packets.end()) {
+        return false;
+    }
+    packet = *it;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Find the first packet with a PCR greater than or equal to a given value.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileIndex::findPCR(uint64_t pcr, PacketCounter& packet) const
+{
+    // PCR values are not monotonic in case of discontinuity, use a linear search.
+    for (std::vector<PCRPoint>::const_iterator it = _pcrs.begin(); it != _pcrs.end(); ++it) {
+        if (it->pid == _pcrs.front().pid && it->pcr >= pcr) {
+            packet = it->packet;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Find the packet at a given UTC time in the stream.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileIndex::findTime(const Time& utc, PacketCounter& packet) const
+{
+    // Locate the last TDT or TOT before the requested time.
+    std::vector<TimePoint>::const_iterator tp = _times.end();
+    for (std::vector<TimePoint>::const_iterator it = _times.begin(); it != _times.end(); ++it) {
+        if (it->utc <= utc) {
+            tp = it;
+        }
+    }
+    if (tp == _times.end()) {
+        return false;
+    }
+    packet = tp->packet;
+
+    // Refine the position using the PCR timeline from the PCR PID, after the table.
+    if (_pcrs.empty()) {
+        return true;
+    }
+    const PID pcr_pid = _pcrs.front().pid;
+    std::vector<PCRPoint>::const_iterator it = _pcrs.begin();
+    while (it != _pcrs.end() && (it->pid != pcr_pid || it->packet < tp->packet)) {
+        ++it;
+    }
+    if (it == _pcrs.end()) {
+        return true;
+    }
+    const uint64_t target = it->pcr + uint64_t(utc - tp->utc) * (SYSTEM_CLOCK_FREQ / MilliSecPerSec);
+    uint64_t previous = it->pcr;
+    for (; it != _pcrs.end(); ++it) {
+        if (it->pid == pcr_pid) {
+            // Stop on PCR discontinuity, use the last known position.
+            if (it->pcr < previous) {
+                break;
+            }
+            packet = it->packet;
+            if (it->pcr >= target) {
+                break;
+            }
+            previous = it->pcr;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,236 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Sparse index of a transport stream file for random access.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSPacket.h"
+#include "tsSectionDemux.h"
+#include "tsPIDMap.h"
+#include "tsTime.h"
+
+namespace ts {
+    //!
+    //! Sparse index of a transport stream file for random access.
+    //! @ingroup mpeg
+    //!
+    //! The index is built in one pass over the file. It contains the position of all
+    //! packets with a payload unit start indicator, per PID, the PCR timeline, the
+    //! UTC times from TDT and TOT, and all version changes of PSI/SI tables.
+    //! All positions are packet indexes in the file.
+    //!
+    //! The index can be saved in a compact binary "sidecar" file, next to the
+    //! transport stream file. The sidecar file records the size and modification
+    //! time of the indexed file to detect outdated indexes.
+    //!
+    class TSDUCKDLL TSFileIndex : private TableHandlerInterface, private SectionHandlerInterface
+    {
+    public:
+        //!
+        //! Default constructor.
+        //!
+        TSFileIndex();
+
+        //!
+        //! Get the default name of the index file of a transport stream file.
+        //! @param [in] ts_file Name of the transport stream file.
+        //! @return Default name of the index file.
+        //!
+        static UString IndexFileName(const UString& ts_file);
+
+        //!
+        //! A PCR value in the transport stream.
+        //!
+        struct TSDUCKDLL PCRPoint
+        {
+            PacketCounter packet;  //!< Packet index in the file.
+            PID           pid;     //!< PID of the packet.
+            uint64_t      pcr;     //!< PCR value in the packet.
+        };
+
+        //!
+        //! A UTC time from a TDT or TOT in the transport stream.
+        //!
+        struct TSDUCKDLL TimePoint
+        {
+            PacketCounter packet;  //!< Index of the last packet of the table.
+            Time          utc;     //!< UTC time in the table.
+        };
+
+        //!
+        //! A new version of a PSI/SI table section in the transport stream.
+        //! The first occurrence of a table is also a version change.
+        //!
+        struct TSDUCKDLL TableVersion
+        {
+            PacketCounter packet;   //!< Index of the last packet of the section.
+            PID           pid;      //!< PID of the section.
+            TID           tid;      //!< Table id.
+            uint16_t      tid_ext;  //!< Table id extension.
+            uint8_t       version;  //!< New version.
+        };
+
+        //!
+        //! Vector of packet indexes.
+        //!
+        typedef std::vector<PacketCounter> PacketIndexVector;
+
+        //!
+        //! Clear the content of the index.
+        //!
+        void clear();
+
+        //!
+        //! Add the next packet of the transport stream in the index.
+        //! @param [in] pkt The next packet in the transport stream.
+        //!
+        void feedPacket(const TSPacket& pkt);
+
+        //!
+        //! Build the index of a transport stream file in one pass.
+        //! @param [in] ts_file Name of the transport stream file.
+        //! @param [in,out] report Where to report errors.
+        //! @param [in] memory_map If true, read the file using memory-mapped I/O.
+        //! The file must then not be truncated while the index is built.
+        //! @return True on success, false on error.
+        //!
+        bool build(const UString& ts_file, Report& report, bool memory_map = false);
+
+        //!
+        //! Save the index in a binary file.
+        //! @param [in] index_file Name of the index file.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool save(const UString& index_file, Report& report) const;
+
+        //!
+        //! Load the index from a binary file.
+        //! @param [in] index_file Name of the index file.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool load(const UString& index_file, Report& report);
+
+        //!
+        //! Check if the index matches a transport stream file.
+        //! The index must have been built from a file with the same size and modification time.
+        //! @param [in] ts_file Name of the transport stream file.
+        //! @return True if the index matches @a ts_file.
+        //!
+        bool matchFile(const UString& ts_file) const;
+
+        //!
+        //! Get the number of indexed packets.
+        //! @return The number of indexed packets.
+        //!
+        PacketCounter packetCount() const { return _packet_count; }
+
+        //!
+        //! Get the PCR timeline.
+        //! @return A constant reference to all PCR's in the file.
+        //!
+        const std::vector<PCRPoint>& pcrPoints() const { return _pcrs; }
+
+        //!
+        //! Get the UTC timeline from TDT and TOT.
+        //! @return A constant reference to all TDT and TOT times in the file.
+        //!
+        const std::vector<TimePoint>& timePoints() const { return _times; }
+
+        //!
+        //! Get the table version changes.
+        //! @return A constant reference to all table version changes in the file.
+        //!
+        const std::vector<TableVersion>& tableVersions() const { return _versions; }
+
+        //!
+        //! Get the indexes of the packets with a payload unit start indicator in a PID.
+        //! @param [in] pid The PID to search.
+        //! @return A constant reference to the packet indexes in @a pid, in increasing order.
+        //!
+        const PacketIndexVector& pusiPackets(PID pid) const;
+
+        //!
+        //! Get the list of PID's with at least one payload unit start indicator.
+        //! @param [out] pids Returned list of PID's.
+        //!
+        void getPUSIPIDs(std::vector<PID>& pids) const;
+
+        //!
+        //! Find the first packet with a PCR greater than or equal to a given value.
+        //! Only the PCR's from the first PID carrying PCR's in the file are used.
+        //! @param [in] pcr The PCR value to search.
+        //! @param [out] packet Index of the found packet.
+        //! @return True if found, false otherwise.
+        //!
+        bool findPCR(uint64_t pcr, PacketCounter& packet) const;
+
+        //!
+        //! Find the packet at a given UTC time in the stream.
+        //! The last TDT or TOT before that time is located and the position is
+        //! refined using the PCR's after that table.
+        //! @param [in] utc The UTC time to search.
+        //! @param [out] packet Index of the found packet.
+        //! @return True if found, false otherwise.
+        //!
+        bool findTime(const Time& utc, PacketCounter& packet) const;
+
+        //!
+        //! Find the first packet with a payload unit start indicator in a PID at or after a given position.
+        //! @param [in] pid The PID to search.
+        //! @param [in] from Index of the first packet to consider.
+        //! @param [out] packet Index of the found packet.
+        //! @return True if found, false otherwise.
+        //!
+        bool findPUSI(PID pid, PacketCounter from, PacketCounter& packet) const;
+
+    private:
+        PacketCounter              _packet_count;  // Number of indexed packets.
+        uint64_t                   _file_size;     // Size of indexed file.
+        Time                       _file_time;     // Modification time of indexed file.
+        std::vector<PCRPoint>      _pcrs;          // PCR timeline.
+        std::vector<TimePoint>     _times;         // TDT/TOT timeline.
+        std::vector<TableVersion>  _versions;      // Table version changes.
+        PIDMap<PacketIndexVector>  _pusi;          // PUSI packets per PID.
+        SectionDemux               _demux;         // Demux for PSI/SI while building.
+        std::map<uint64_t,uint8_t> _last_version;  // Last version per PID/TID/TIDext while building.
+
+        // Implementation of table and section handlers.
+        virtual void handleTable(SectionDemux& demux, const BinaryTable& table) override;
+        virtual void handleSection(SectionDemux& demux, const Section& section) override;
+
+        // Inaccessible operations.
+        TSFileIndex(const TSFileIndex&) = delete;
+        TSFileIndex& operator=(const TSFileIndex&) = delete;
+    };
+}
@@ -36,6 +36,10 @@
 #include "tsSysUtils.h"
 TSDUCK_SOURCE;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::TSFileInput::DEFAULT_MMAP_WINDOW;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Default constructor.
@@ -51,6 +55,15 @@ ts::TSFileInput::TSFileInput() :
     _severity(Severity::Error),
     _at_eof(false),
     _rewindable(false),
+    _mmap_request(false),
+    _mmapped(false),
+    _file_size(0),
+    _file_pos(0),
+    _map_base(nullptr),
+    _map_offset(0),
+    _map_size(0),
+    _map_window(DEFAULT_MMAP_WINDOW),
+    _inbuf(),
 #if defined(TS_WINDOWS)
     _handle(INVALID_HANDLE_VALUE)
 #else
@@ -211,6 +224,18 @@ bool ts::TSFileInput::openInternal (Report& report)
         return false;
     }
 
+    // Use memory-mapped I/O on regular files only.
+
+    _mmapped = false;
+    if (_mmap_request && !_filename.empty()) {
+        struct stat st;
+        if (::fstat(_fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            _mmapped = true;
+            _file_size = uint64_t(st.st_size);
+            _file_pos = _start_offset;
+        }
+    }
+
 #endif
 
     _is_open = true;
@@ -225,6 +250,13 @@ bool ts::TSFileInput::openInternal (Report& report)
 
 bool ts::TSFileInput::seekInternal(uint64_t index, Report& report)
 {
+    if (_mmapped) {
+        // No system seek, the next read operation maps the right area.
+        _file_pos = _start_offset + index;
+        _at_eof = false;
+        return true;
+    }
+
 #if defined (TS_WINDOWS)
     // In Win32, LARGE_INTEGER is a 64-bit structure, not an integer type
     uint64_t where = _start_offset + index;
@@ -276,6 +308,9 @@ bool ts::TSFileInput::close(Report& report)
         return false;
     }
 
+    unmap();
+    _mmapped = false;
+
     if (!_filename.empty()) {
 #if defined (TS_WINDOWS)
         ::CloseHandle(_handle);
@@ -308,6 +343,18 @@ size_t ts::TSFileInput::read(TSPacket* buffer, size_t max_packets, Report& repor
         return 0;
     }
 
+    // With memory-mapped I/O, copy packets from the file mapping.
+    if (_mmapped) {
+        size_t count = 0;
+        size_t got = 0;
+        const TSPacket* packets = nullptr;
+        while (count < max_packets && (got = readMapped(packets, max_packets - count, report)) > 0) {
+            TSPacket::Copy(buffer + count, packets, got);
+            count += got;
+        }
+        return count;
+    }
+
     char* data = reinterpret_cast <char*> (buffer);
     const size_t req_size = max_packets * PKT_SIZE;
     size_t got_size = 0;
@@ -372,6 +419,120 @@ size_t ts::TSFileInput::read(TSPacket* buffer, size_t max_packets, Report& repor
     return count;
 }
 
+//----------------------------------------------------------------------------
+// Read TS packets without copying them into a user buffer.
+//----------------------------------------------------------------------------
+
+size_t ts::TSFileInput::readInPlace(const TSPacket*& packets, size_t max_packets, Report& report)
+{
+    if (!_is_open) {
+        report.log(_severity, u"not open");
+        return 0;
+    }
+    else if (_at_eof) {
+        return 0;
+    }
+    else if (_mmapped) {
+        return readMapped(packets, max_packets, report);
+    }
+    else {
+        // Standard I/O, read packets in the internal buffer.
+        if (_inbuf.size() < max_packets) {
+            _inbuf.resize(max_packets);
+        }
+        packets = _inbuf.data();
+        return read(_inbuf.data(), max_packets, report);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get the next packets in the file mapping, loop back at end of file when
+// the file shall be repeated. Return the number of packets.
+//----------------------------------------------------------------------------
+
+size_t ts::TSFileInput::readMapped(const TSPacket*& packets, size_t max_packets, Report& report)
+{
+    size_t count = 0;
+
+    while (count == 0 && !_at_eof) {
+        if (!mapPackets(packets, count, max_packets, report)) {
+            return 0; // mapping error
+        }
+        else if (count > 0) {
+            _file_pos += count * PKT_SIZE;
+        }
+        else if ((_repeat == 0 || ++_counter < _repeat) && _start_offset + PKT_SIZE <= _file_size) {
+            // End of file, the file must be repeated again.
+            _file_pos = _start_offset;
+        }
+        else {
+            // End of file, last repetition (a truncated packet is ignored).
+            _at_eof = true;
+        }
+    }
+
+    _total_packets += count;
+    return count;
+}
+
+
+//----------------------------------------------------------------------------
+// Map the packets at the current read position. The returned count is
+// limited to the packets in the current mapping window, zero at end of file.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileInput::mapPackets(const TSPacket*& packets, size_t& count, size_t max_packets, Report& report)
+{
+    count = 0;
+
+#if !defined(TS_WINDOWS)
+
+    if (_file_pos + PKT_SIZE > _file_size || max_packets == 0) {
+        return true; // end of file
+    }
+
+    // Map a new window when the next packet is not entirely in the current one.
+    if (_map_base == nullptr || _file_pos < _map_offset || _file_pos + PKT_SIZE > _map_offset + _map_size) {
+        unmap();
+        const uint64_t page_size = uint64_t(::sysconf(_SC_PAGESIZE));
+        _map_offset = _file_pos - _file_pos % page_size;
+        _map_size = size_t(std::min<uint64_t>(std::max<uint64_t>(_map_window, 2 * page_size), _file_size - _map_offset));
+        void* addr = ::mmap(nullptr, _map_size, PROT_READ, MAP_SHARED, _fd, off_t(_map_offset));
+        if (addr == MAP_FAILED) {
+            const ErrorCode error_code = LastErrorCode();
+            report.log(_severity, u"error mapping file %s: %s", {_filename, ErrorCodeMessage(error_code)});
+            return false;
+        }
+        _map_base = reinterpret_cast<uint8_t*>(addr);
+        ::madvise(addr, _map_size, MADV_SEQUENTIAL);
+    }
+
+    packets = reinterpret_cast<const TSPacket*>(_map_base + (_file_pos - _map_offset));
+    count = std::min(max_packets, size_t(_map_offset + _map_size - _file_pos) / PKT_SIZE);
+
+#endif
+
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Unmap the current mapping window, if any.
+//----------------------------------------------------------------------------
+
+void ts::TSFileInput::unmap()
+{
+#if !defined(TS_WINDOWS)
+    if (_map_base != nullptr) {
+        ::munmap(_map_base, _map_size);
+        _map_base = nullptr;
+        _map_size = 0;
+    }
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Abort any currenly read operation in progress.
 //----------------------------------------------------------------------------
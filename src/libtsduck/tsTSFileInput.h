@@ -44,6 +44,11 @@ namespace ts {
     class TSDUCKDLL TSFileInput
     {
     public:
+        //!
+        //! Default size in bytes of a memory mapping window.
+        //!
+        static const size_t DEFAULT_MMAP_WINDOW = 64 * 1024 * 1024;
+
         //!
         //! Default constructor.
         //!
@@ -109,6 +114,31 @@ namespace ts {
             _severity = level;
         }
 
+        //!
+        //! Set memory-mapped I/O mode for the next open().
+        //! Memory-mapped I/O is used on regular files on UNIX systems only. Other files
+        //! are read using standard I/O. Large files are mapped by successive windows of
+        //! limited size. The file shall not be truncated while it is read and the
+        //! packets which are appended after open() are not read.
+        //! @param [in] on True to use memory-mapped I/O, false to use standard I/O.
+        //! @param [in] window_size Size in bytes of the mapping windows. Small values
+        //! are rounded up to two memory pages.
+        //!
+        void setMemoryMapping(bool on, size_t window_size = DEFAULT_MMAP_WINDOW)
+        {
+            _mmap_request = on;
+            _map_window = window_size;
+        }
+
+        //!
+        //! Check if the file is read using memory-mapped I/O.
+        //! @return True if the file is open and memory-mapped.
+        //!
+        bool isMemoryMapped() const
+        {
+            return _is_open && _mmapped;
+        }
+
         //!
         //! Get the file name.
         //! @return The file name.
@@ -137,6 +167,22 @@ namespace ts {
         //!
         size_t read(TSPacket* buffer, size_t max_packets, Report& report);
 
+        //!
+        //! Read TS packets without copying them into a user buffer.
+        //! With memory-mapped I/O, the returned packets are directly located in the
+        //! file mapping. Otherwise, the packets are read in an internal buffer.
+        //! If the file file was opened with a @a repeat_count different from 1,
+        //! reading packets transparently loops back at end if file.
+        //! @param [out] packets Address of the first returned packet. The packets
+        //! are read-only and remain valid until the next read operation or until
+        //! the file is closed.
+        //! @param [in] max_packets Maximum number of packets to return.
+        //! @param [in,out] report Where to report errors.
+        //! @return The actual number of returned packets. Returning zero means
+        //! error or end of file repetition.
+        //!
+        size_t readInPlace(const TSPacket*& packets, size_t max_packets, Report& report);
+
         //!
         //! Abort any currenly read operation in progress.
         //! The file is left in a broken state and can be only closed.
@@ -187,6 +233,15 @@ namespace ts {
         int           _severity;      //!< Severity level for error reporting
         volatile bool _at_eof;        //!< End of file has been reached
         bool          _rewindable;    //!< Opened in rewindable mode
+        bool          _mmap_request;  //!< Use memory-mapped I/O when possible
+        bool          _mmapped;       //!< The file is actually memory-mapped
+        uint64_t      _file_size;     //!< File size when memory-mapped
+        uint64_t      _file_pos;      //!< Next read position when memory-mapped
+        uint8_t*      _map_base;      //!< Address of current mapping window (if not null)
+        uint64_t      _map_offset;    //!< File offset of current mapping window
+        size_t        _map_size;      //!< Size of current mapping window
+        size_t        _map_window;    //!< Maximum size of a mapping window
+        TSPacketVector _inbuf;        //!< Internal buffer for readInPlace() without memory mapping
 #if defined(TS_WINDOWS)
         ::HANDLE      _handle;        //!< File handle
 #else
@@ -200,5 +255,8 @@ namespace ts {
         // Internal methods
         bool openInternal(Report& report);
         bool seekInternal(uint64_t, Report& report);
+        size_t readMapped(const TSPacket*& packets, size_t max_packets, Report& report);
+        bool mapPackets(const TSPacket*& packets, size_t& count, size_t max_packets, Report& report);
+        void unmap();
     };
 }
@@ -34,11 +34,22 @@
 #include "tsTSFileOutput.h"
 #include "tsNullReport.h"
 #include "tsSysUtils.h"
+#include "tsGuard.h"
+#include "tsGuardCondition.h"
+#include "tsMonotonic.h"
+#include "tsIntegerUtils.h"
 TSDUCK_SOURCE;
 
 // File string for standard output.
 const ts::UString ts::TSFileOutput::stdoutName(u"standard output");
 
+// Alignment of memory, file offsets and sizes with direct I/O.
+#define DIRECT_IO_ALIGNMENT 4096
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::TSFileOutput::DEFAULT_ASYNC_BUFFER_SIZE;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Default constructor.
@@ -50,11 +61,59 @@ ts::TSFileOutput::TSFileOutput() :
     _severity(Severity::Error),
     _total_packets(0),
 #if defined(TS_WINDOWS)
-    _handle(INVALID_HANDLE_VALUE)
+    _handle(INVALID_HANDLE_VALUE),
 #else
-    _fd(-1)
+    _fd(-1),
 #endif
+    _async_depth(0),
+    _async_buffer_size(DEFAULT_ASYNC_BUFFER_SIZE),
+    _direct_request(false),
+    _direct(false),
+    _buffers(),
+    _buffer_sizes(),
+    _fill_index(0),
+    _write_index(0),
+    _pending(0),
+    _terminate(false),
+    _async_error(false),
+    _async_error_code(SYS_SUCCESS),
+    _writer(nullptr),
+    _mutex(),
+    _to_write(),
+    _written(),
+    _stats()
+{
+}
+
+ts::TSFileOutput::WriteStatistics::WriteStatistics() :
+    writes(0),
+    bytes(0),
+    total_time(0),
+    max_time(0),
+    max_pending(0)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Set the asynchronous output mode for the next open().
+//----------------------------------------------------------------------------
+
+void ts::TSFileOutput::setAsynchronous(size_t depth, size_t buffer_size)
+{
+    _async_depth = depth;
+    _async_buffer_size = std::max<size_t>(DIRECT_IO_ALIGNMENT, RoundUp(buffer_size, size_t(DIRECT_IO_ALIGNMENT)));
+}
+
+
+//----------------------------------------------------------------------------
+// Get the statistics on the write operations.
+//----------------------------------------------------------------------------
+
+void ts::TSFileOutput::getWriteStatistics(WriteStatistics& stats) const
 {
+    Guard lock(_mutex);
+    stats = _stats;
 }
 
 
@@ -124,7 +183,23 @@ bool ts::TSFileOutput::open(const UString& filename, bool append, bool keep, Rep
         _fd = STDOUT_FILENO;
     }
     else {
-        _fd = ::open(_filename.toUTF8().c_str(), flags, mode);
+        _fd = -1;
+#if defined(TS_LINUX)
+        // Try direct I/O first, not supported by all file systems.
+        if (_direct_request && _async_depth > 0) {
+            _fd = ::open(_filename.toUTF8().c_str(), flags | O_DIRECT, mode);
+            _direct = _fd >= 0;
+            // With --append, the end of file must be aligned.
+            struct stat st;
+            if (_direct && (::fstat(_fd, &st) < 0 || st.st_size % DIRECT_IO_ALIGNMENT != 0)) {
+                _direct = ::fcntl(_fd, F_SETFL, ::fcntl(_fd, F_GETFL) & ~O_DIRECT) < 0;
+            }
+            report.debug(u"direct I/O on %s: %s", {filename, UString::YesNo(_direct)});
+        }
+#endif
+        if (_fd < 0) {
+            _fd = ::open(_filename.toUTF8().c_str(), flags, mode);
+        }
         got_error = _fd < 0;
         error_code = LastErrorCode();
         report.debug(u"creating file %s, fd=%d, error_code=%d", {filename, _fd, error_code});
@@ -134,10 +209,40 @@ bool ts::TSFileOutput::open(const UString& filename, bool append, bool keep, Rep
 
     if (got_error) {
         report.log(_severity, u"cannot create %s: %s", {getDisplayFileName(), ErrorCodeMessage(error_code)});
+        _direct = false;
+        return _is_open = false;
     }
 
     _total_packets = 0;
-    return _is_open = !got_error;
+    _stats = WriteStatistics();
+
+    // In asynchronous mode, allocate the buffers and start the writer thread.
+    if (_async_depth > 0) {
+        _buffers.resize(_async_depth + 1);
+        _buffer_sizes.assign(_async_depth + 1, 0);
+        for (size_t i = 0; i < _buffers.size(); ++i) {
+            _buffers[i].resize(_async_buffer_size + DIRECT_IO_ALIGNMENT);
+        }
+        _fill_index = _write_index = _pending = 0;
+        _terminate = _async_error = false;
+        _async_error_code = SYS_SUCCESS;
+        _writer = new Writer(this);
+        if (!_writer->start()) {
+            report.log(_severity, u"cannot start writer thread for %s", {getDisplayFileName()});
+            delete _writer;
+            _writer = nullptr;
+            _buffers.clear();
+#if defined(TS_LINUX)
+            // Synchronous writes use the caller's buffers, which are not aligned for direct I/O.
+            if (_direct) {
+                ::fcntl(_fd, F_SETFL, ::fcntl(_fd, F_GETFL) & ~O_DIRECT);
+                _direct = false;
+            }
+#endif
+        }
+    }
+
+    return _is_open = true;
 }
 
 
@@ -152,6 +257,25 @@ bool ts::TSFileOutput::close(Report& report)
         return false;
     }
 
+    // In asynchronous mode, write the last buffer and wait for the writer thread.
+    bool success = true;
+    if (_writer != nullptr) {
+        if (_buffer_sizes[_fill_index] > 0) {
+            submitBuffer();
+        }
+        {
+            GuardCondition lock(_mutex, _to_write);
+            _terminate = true;
+            lock.signal();
+        }
+        _writer->waitForTermination();
+        delete _writer;
+        _writer = nullptr;
+        _buffers.clear();
+        success = !reportAsyncError(report);
+    }
+    _direct = false;
+
     if (!_filename.empty()) {
 #if defined (TS_WINDOWS)
         ::CloseHandle(_handle);
@@ -161,7 +285,7 @@ bool ts::TSFileOutput::close(Report& report)
     }
 
     _is_open = false;
-    return true;
+    return success;
 }
 
 
@@ -188,18 +312,74 @@ bool ts::TSFileOutput::write(const TSPacket* buffer, size_t packet_count, Report
         return false;
     }
 
-    // Loop on write until everything is gone
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer);
+    size_t remain = packet_count * PKT_SIZE;
+
+    if (_writer == nullptr) {
+        // Synchronous mode, write directly from the caller's buffer.
+        size_t written = 0;
+        ErrorCode error_code = SYS_SUCCESS;
+        const bool success = writeData(data, remain, written, error_code, report);
+        if (!success && error_code != SYS_SUCCESS) {
+            report.log(_severity, u"error writing %s: %s (%d)", {getDisplayFileName(), ErrorCodeMessage(error_code), error_code});
+        }
+        _total_packets += written / PKT_SIZE;
+        return success;
+    }
+
+    // Asynchronous mode, report previous errors from the writer thread.
+    if (reportAsyncError(report)) {
+        return false;
+    }
 
+    // Copy the packets in the buffers, submit the full ones.
+    while (remain > 0) {
+        size_t& size(_buffer_sizes[_fill_index]);
+        const size_t chunk = std::min(remain, _async_buffer_size - size);
+        ::memcpy(bufferAddress(_fill_index) + size, data, chunk);  // Flawfinder: ignore: memcpy()
+        size += chunk;
+        data += chunk;
+        remain -= chunk;
+        if (size == _async_buffer_size && !submitBuffer()) {
+            return false;
+        }
+    }
+    _total_packets += packet_count;
+
+    // Without direct I/O, do not wait for a full buffer when the writer thread is idle.
+    // This avoids latency on low bitrates and naturally groups packets on high bitrates.
+    if (!_direct && _buffer_sizes[_fill_index] > 0) {
+        bool idle = false;
+        {
+            Guard lock(_mutex);
+            idle = _pending == 0;
+        }
+        if (idle && !submitBuffer()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Write data in the file, loop until everything is written.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileOutput::writeData(const uint8_t* data, size_t size, size_t& written, ErrorCode& error_code, Report& report)
+{
     bool got_error = false;
-    ErrorCode error_code = SYS_SUCCESS;
-    const char* const data_buffer = reinterpret_cast <const char*> (buffer);
-    const char* data = data_buffer;
+    const uint8_t* const data_start = data;
+    error_code = SYS_SUCCESS;
+
+    Monotonic start;
+    start.getSystemTime();
 
 #if defined (TS_WINDOWS)
 
     // Windows implementation
 
-    ::DWORD remain = ::DWORD (packet_count) * PKT_SIZE;
+    ::DWORD remain = ::DWORD(size);
     ::DWORD outsize;
 
     while (remain > 0 && !got_error) {
@@ -227,7 +407,7 @@ bool ts::TSFileOutput::write(const TSPacket* buffer, size_t packet_count, Report
 
     // UNIX implementation
 
-    size_t remain = packet_count * PKT_SIZE;
+    size_t remain = size;
     ssize_t outsize;
 
     while (remain > 0 && !got_error) {
@@ -251,10 +431,134 @@ bool ts::TSFileOutput::write(const TSPacket* buffer, size_t packet_count, Report
 
 #endif
 
-    if (got_error && error_code != SYS_SUCCESS) {
-        report.log(_severity, u"error writing %s: %s (%d)", {getDisplayFileName(), ErrorCodeMessage(error_code), error_code});
-    }
+    Monotonic end;
+    end.getSystemTime();
+    const NanoSecond duration = end - start;
+    written = data - data_start;
+
+    // Update statistics.
+    Guard lock(_mutex);
+    _stats.writes++;
+    _stats.bytes += written;
+    _stats.total_time += duration;
+    _stats.max_time = std::max(_stats.max_time, duration);
 
-    _total_packets += (data - data_buffer) / PKT_SIZE;
     return !got_error;
 }
+
+
+//----------------------------------------------------------------------------
+// Get the aligned address of a buffer (asynchronous mode).
+//----------------------------------------------------------------------------
+
+uint8_t* ts::TSFileOutput::bufferAddress(size_t index)
+{
+    uint8_t* const base = _buffers[index].data();
+    return base + (DIRECT_IO_ALIGNMENT - reinterpret_cast<uintptr_t>(base) % DIRECT_IO_ALIGNMENT) % DIRECT_IO_ALIGNMENT;
+}
+
+
+//----------------------------------------------------------------------------
+// Submit the buffer being filled to the writer thread (asynchronous mode).
+//----------------------------------------------------------------------------
+
+bool ts::TSFileOutput::submitBuffer()
+{
+    // Wait until the next buffer to fill is available.
+    {
+        GuardCondition lock(_mutex, _written);
+        while (_pending >= _async_depth && !_async_error) {
+            lock.waitCondition();
+        }
+        if (_async_error) {
+            return false;
+        }
+    }
+
+    // Pass the buffer to the writer thread.
+    {
+        GuardCondition lock(_mutex, _to_write);
+        _pending++;
+        _stats.max_pending = std::max(_stats.max_pending, _pending);
+        lock.signal();
+    }
+
+    // Move to next buffer, free since _pending <= _async_depth.
+    _fill_index = (_fill_index + 1) % _buffers.size();
+    _buffer_sizes[_fill_index] = 0;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Report an asynchronous write error, if any.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileOutput::reportAsyncError(Report& report)
+{
+    Guard lock(_mutex);
+    if (_async_error && _async_error_code != SYS_SUCCESS) {
+        report.log(_severity, u"error writing %s: %s (%d)", {getDisplayFileName(), ErrorCodeMessage(_async_error_code), _async_error_code});
+        // Report the error only once.
+        _async_error_code = SYS_SUCCESS;
+    }
+    return _async_error;
+}
+
+
+//----------------------------------------------------------------------------
+// Writer thread (asynchronous mode).
+//----------------------------------------------------------------------------
+
+ts::TSFileOutput::Writer::Writer(TSFileOutput* parent) :
+    Thread(),
+    _parent(parent)
+{
+}
+
+void ts::TSFileOutput::Writer::main()
+{
+    for (;;) {
+        // Wait for a buffer to write or termination.
+        size_t index = 0;
+        bool skip = false;
+        {
+            GuardCondition lock(_parent->_mutex, _parent->_to_write);
+            while (_parent->_pending == 0 && !_parent->_terminate) {
+                lock.waitCondition();
+            }
+            if (_parent->_pending == 0) {
+                break; // terminate when all buffers are written.
+            }
+            index = _parent->_write_index;
+            skip = _parent->_async_error;
+        }
+
+        // Write the buffer without holding the mutex. The buffer is not modified
+        // by the parent while it is pending. After an error, drop the buffers.
+        const size_t size = _parent->_buffer_sizes[index];
+        size_t written = 0;
+        ErrorCode error_code = SYS_SUCCESS;
+        bool success = true;
+        if (!skip) {
+#if defined(TS_LINUX)
+            // With direct I/O, the last buffer is usually not aligned.
+            if (_parent->_direct && size % DIRECT_IO_ALIGNMENT != 0) {
+                ::fcntl(_parent->_fd, F_SETFL, ::fcntl(_parent->_fd, F_GETFL) & ~O_DIRECT);
+                _parent->_direct = false;
+            }
+#endif
+            success = _parent->writeData(_parent->bufferAddress(index), size, written, error_code, NULLREP);
+        }
+
+        // Release the buffer.
+        GuardCondition lock(_parent->_mutex, _parent->_written);
+        if (!success) {
+            _parent->_async_error = true;
+            _parent->_async_error_code = error_code;
+        }
+        _parent->_write_index = (index + 1) % _parent->_buffers.size();
+        _parent->_pending--;
+        lock.signal();
+    }
+}
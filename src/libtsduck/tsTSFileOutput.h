@@ -35,6 +35,11 @@
 #pragma once
 #include "tsTSPacket.h"
 #include "tsReport.h"
+#include "tsByteBlock.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+#include "tsThread.h"
+#include <atomic>
 
 namespace ts {
     //!
@@ -132,6 +137,61 @@ namespace ts {
             return _total_packets;
         }
 
+        //!
+        //! Default size in bytes of each buffer in asynchronous mode.
+        //!
+        static const size_t DEFAULT_ASYNC_BUFFER_SIZE = 1024 * 1024;
+
+        //!
+        //! Set the asynchronous output mode for the next open().
+        //!
+        //! In asynchronous mode, write() copies the packets into memory buffers and
+        //! the buffers are written to the file by a separate thread. The caller is
+        //! blocked only when all buffers are waiting to be written. This isolates
+        //! the caller from transient slow-downs of the disk or network file system.
+        //! Write errors are reported by the next call to write() or close().
+        //!
+        //! @param [in] depth Maximum number of buffers waiting to be written. Zero
+        //! means synchronous output, the default.
+        //! @param [in] buffer_size Size in bytes of each buffer. Rounded up to a
+        //! multiple of the direct I/O alignment.
+        //!
+        void setAsynchronous(size_t depth, size_t buffer_size = DEFAULT_ASYNC_BUFFER_SIZE);
+
+        //!
+        //! Use direct I/O (bypass the system cache) for the next open().
+        //! Direct I/O is used in asynchronous mode only, on Linux only, and only on file
+        //! systems supporting it. Otherwise, this option is silently ignored.
+        //! @param [in] on True to use direct I/O.
+        //!
+        void setDirectIO(bool on)
+        {
+            _direct_request = on;
+        }
+
+        //!
+        //! Statistics on the write operations.
+        //!
+        struct TSDUCKDLL WriteStatistics
+        {
+            uint64_t   writes;       //!< Number of write operations.
+            uint64_t   bytes;        //!< Total number of written bytes.
+            NanoSecond total_time;   //!< Total duration of write operations.
+            NanoSecond max_time;     //!< Duration of the longest write operation.
+            size_t     max_pending;  //!< Maximum number of buffers waiting to be written (asynchronous mode).
+            //!
+            //! Default constructor.
+            //!
+            WriteStatistics();
+        };
+
+        //!
+        //! Get the statistics on the write operations since the file was open.
+        //! The statistics remain available after close().
+        //! @param [out] stats Returned statistics.
+        //!
+        void getWriteStatistics(WriteStatistics& stats) const;
+
     private:
         UString       _filename;          // Output file name
         bool          _is_open;           // Check if file is actually open
@@ -144,6 +204,53 @@ namespace ts {
 #endif
         static const UString stdoutName;  // File string for standard output.
 
+        // Thread which writes the buffers in asynchronous mode.
+        class Writer : public Thread
+        {
+        public:
+            Writer(TSFileOutput* parent);
+        private:
+            TSFileOutput* _parent;
+            virtual void main() override;
+            Writer() = delete;
+            Writer(const Writer&) = delete;
+            Writer& operator=(const Writer&) = delete;
+        };
+
+        // Asynchronous mode. The buffers are used as a ring. The buffer at
+        // _fill_index is filled by write(). The _pending buffers starting at
+        // _write_index are written by the writer thread.
+        size_t            _async_depth;        // Max buffers waiting to be written, zero if synchronous.
+        size_t            _async_buffer_size;  // Size of each buffer.
+        bool              _direct_request;     // Use direct I/O in next open().
+        std::atomic<bool> _direct;             // Direct I/O is currently in use (cleared by the writer thread).
+        std::vector<ByteBlock> _buffers;       // Buffers (with margin for alignment).
+        std::vector<size_t> _buffer_sizes;     // Data size in each buffer.
+        size_t            _fill_index;         // Index of buffer to fill.
+        size_t            _write_index;        // Index of next buffer to write.
+        size_t            _pending;            // Number of buffers waiting to be written.
+        bool              _terminate;          // Writer thread shall terminate when all buffers are written.
+        bool              _async_error;        // A write error occurred in the writer thread.
+        ErrorCode         _async_error_code;   // Error code of the write error.
+        Writer*           _writer;             // Writer thread, null if synchronous.
+        mutable Mutex     _mutex;              // Exclusive access to asynchronous state and statistics.
+        Condition         _to_write;           // Signaled when a buffer is submitted or on termination.
+        Condition         _written;            // Signaled when a buffer is written.
+        WriteStatistics   _stats;              // Statistics on write operations.
+
+        // Get the aligned address of a buffer.
+        uint8_t* bufferAddress(size_t index);
+
+        // Submit the buffer at _fill_index to the writer thread. Return false on write error.
+        bool submitBuffer();
+
+        // Write data in the file, loop until everything is written. Return true on success.
+        // Update the statistics. On error, error_code is SYS_SUCCESS on broken pipe.
+        bool writeData(const uint8_t* data, size_t size, size_t& written, ErrorCode& error_code, Report& report);
+
+        // Report an asynchronous write error, if any. Return true if there was an error.
+        bool reportAsyncError(Report& report);
+
         // Inaccessible operations
         TSFileOutput(const TSFileOutput&) = delete;
         TSFileOutput& operator=(const TSFileOutput&) = delete;
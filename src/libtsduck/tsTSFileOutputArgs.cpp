@@ -0,0 +1,550 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSFileOutputArgs.h"
+#include "tsNullReport.h"
+#include "tsSysUtils.h"
+#include "tsGuard.h"
+#include "tsGuardCondition.h"
+TSDUCK_SOURCE;
+
+// Default number of asynchronous write operations with --direct.
+#define DEFAULT_DIRECT_DEPTH 4
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructor.
+//----------------------------------------------------------------------------
+
+ts::TSFileOutputArgs::TSFileOutputArgs() :
+    _name(),
+    _append(false),
+    _keep(false),
+    _async_depth(0),
+    _direct(false),
+    _max_size(0),
+    _max_duration(0),
+    _wall_clock(false),
+    _max_files(0),
+    _file(nullptr),
+    _trim(false),
+    _segment_size(0),
+    _segment_end(),
+    _last_time(),
+    _segments(),
+    _mutex(),
+    _work(),
+    _helper(nullptr),
+    _report(nullptr),
+    _terminate(false),
+    _next_name(),
+    _next_ready(false),
+    _next_failed(false),
+    _largest(0),
+    _completed(),
+    _obsolete(),
+    _stats()
+{
+}
+
+ts::TSFileOutputArgs::~TSFileOutputArgs()
+{
+    if (_file != nullptr) {
+        close(NULLREP);
+    }
+}
+
+ts::TSFileOutputArgs::Helper::Helper(TSFileOutputArgs* parent) :
+    Thread(),
+    _parent(parent)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Define command line options in an Args.
+//----------------------------------------------------------------------------
+
+void ts::TSFileOutputArgs::defineOptions(Args& args) const
+{
+    args.option(u"append", 'a');
+    args.help(u"append",
+              u"If the file already exists, append to the end of the file. By default, existing files are overwritten. "
+              u"This option cannot be used with --max-duration or --max-size.");
+
+    args.option(u"async-depth", 0, Args::UNSIGNED);
+    args.help(u"async-depth",
+              u"Write the file asynchronously in a separate thread, with the specified maximum "
+              u"number of pending write operations of one megabyte each. The packets are passed "
+              u"to the next plugin as soon as they are copied in a write buffer. This is useful "
+              u"on storage with irregular latencies. By default, the file is written synchronously.");
+
+    args.option(u"direct", 0);
+    args.help(u"direct",
+              u"Bypass the system page cache when writing the file (direct I/O). "
+              u"This implies asynchronous writes, with a default depth of " TS_USTRINGIFY(DEFAULT_DIRECT_DEPTH) u". "
+              u"This option is supported on Linux only and ignored when the file system "
+              u"does not support direct I/O or when writing to the standard output.");
+
+    args.option(u"keep", 'k');
+    args.help(u"keep",
+              u"Keep existing file (abort if the specified file already exists). By default, existing files are overwritten. "
+              u"This option cannot be used with --max-duration or --max-size, segment files are always new files.");
+
+    args.option(u"max-duration", 0, Args::POSITIVE);
+    args.help(u"max-duration", u"seconds",
+              u"Split the output in successive segment files of the specified maximum duration. "
+              u"The output file name is used as a template: each segment file is named with "
+              u"the local date and time of its creation, e.g. name-YYYYMMDD-hhmmss-mmm.ts.");
+
+    args.option(u"max-files", 0, Args::POSITIVE);
+    args.help(u"max-files",
+              u"With --max-duration or --max-size, specify the maximum number of segment files "
+              u"to retain. When a new segment is created, the oldest segments from the same "
+              u"execution are deleted. By default, all segment files are kept.");
+
+    args.option(u"max-size", 0, Args::POSITIVE);
+    args.help(u"max-size",
+              u"Split the output in successive segment files of the specified maximum size in bytes. "
+              u"The size of segments is rounded down to a multiple of the TS packet size. "
+              u"The naming of segment files is the same as with --max-duration. "
+              u"Both options can be combined.");
+
+    args.option(u"wall-clock", 0);
+    args.help(u"wall-clock",
+              u"With --max-duration, switch to a new segment at each multiple of the duration "
+              u"since local midnight. For instance, with --max-duration 3600 --wall-clock, "
+              u"the segments start at the beginning of each hour.");
+}
+
+
+//----------------------------------------------------------------------------
+// Load arguments from command line.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileOutputArgs::loadArgs(Args& args)
+{
+    _name = args.value(u"");
+    _append = args.present(u"append");
+    _keep = args.present(u"keep");
+    _direct = args.present(u"direct");
+    _async_depth = args.intValue<size_t>(u"async-depth", _direct ? DEFAULT_DIRECT_DEPTH : 0);
+    _max_size = args.intValue<uint64_t>(u"max-size", 0);
+    _max_duration = args.intValue<Second>(u"max-duration", 0);
+    _wall_clock = args.present(u"wall-clock");
+    _max_files = args.intValue<size_t>(u"max-files", 0);
+
+    // At least one packet per segment.
+    if (_max_size > 0) {
+        _max_size = std::max<uint64_t>(PKT_SIZE, _max_size - _max_size % PKT_SIZE);
+    }
+
+    if (isSegmented() && _name.empty()) {
+        args.error(u"--max-duration and --max-size cannot be used on standard output");
+        return false;
+    }
+    if (isSegmented() && (_append || _keep)) {
+        // Segment files are always new files with unique names.
+        args.error(u"--append and --keep cannot be used with --max-duration or --max-size");
+        return false;
+    }
+    if (_max_files > 0 && !isSegmented()) {
+        args.error(u"--max-files requires --max-duration or --max-size");
+        return false;
+    }
+    if (_wall_clock && _max_duration == 0) {
+        args.error(u"--wall-clock requires --max-duration");
+        return false;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Open the output file or the first segment.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileOutputArgs::open(Report& report)
+{
+    if (_file != nullptr) {
+        report.error(u"already open");
+        return false;
+    }
+
+    _stats = TSFileOutput::WriteStatistics();
+    _segments.clear();
+    _segment_size = 0;
+    _last_time = Time::Epoch;
+
+    if (!isSegmented()) {
+        // Single output file.
+        _file = new TSFileOutput;
+        _file->setAsynchronous(_async_depth);
+        _file->setDirectIO(_direct);
+        if (!_file->open(_name, _append, _keep, report)) {
+            delete _file;
+            _file = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    // Segmented output, open the first segment and start the helper thread.
+    _report = &report;
+    _terminate = false;
+    _next_name = _name + u".next";
+    _next_ready = false;
+    _next_failed = false;
+    _largest = _max_size;
+    _completed.clear();
+    _obsolete.clear();
+
+    if (!openSegment(report)) {
+        return false;
+    }
+    _helper = new Helper(this);
+    if (!_helper->start()) {
+        // Not fatal, segments are then neither preallocated nor closed in the background.
+        report.warning(u"cannot start segment helper thread");
+        delete _helper;
+        _helper = nullptr;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Close the output file and wait for the background operations.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileOutputArgs::close(Report& report)
+{
+    if (_file == nullptr) {
+        report.error(u"not open");
+        return false;
+    }
+
+    // Close the current file in this thread to report its status.
+    const bool success = _file->close(report);
+    TSFileOutput::WriteStatistics stats;
+    _file->getWriteStatistics(stats);
+    delete _file;
+    _file = nullptr;
+
+    if (_helper != nullptr) {
+        // Let the helper thread complete the pending operations.
+        {
+            GuardCondition lock(_mutex, _work);
+            _terminate = true;
+            lock.signal();
+        }
+        _helper->waitForTermination();
+        delete _helper;
+        _helper = nullptr;
+    }
+
+    Guard lock(_mutex);
+    AddStatistics(_stats, stats);
+    if (_trim) {
+        TruncateFile(_segments.back(), stats.bytes);
+    }
+    if (_next_ready || (isSegmented() && FileExists(_next_name))) {
+        DeleteFile(_next_name);
+        _next_ready = false;
+    }
+    _report = nullptr;
+    return success;
+}
+
+
+//----------------------------------------------------------------------------
+// Write TS packets to the file, switch to a new segment when necessary.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileOutputArgs::write(const TSPacket* buffer, size_t packet_count, Report& report)
+{
+    if (_file == nullptr) {
+        report.error(u"not open");
+        return false;
+    }
+    if (!isSegmented()) {
+        return _file->write(buffer, packet_count, report);
+    }
+
+    // Segment end by duration is checked once per call.
+    if (_max_duration > 0 && _segment_size > 0 && Time::CurrentUTC() >= _segment_end && !openSegment(report)) {
+        return false;
+    }
+
+    while (packet_count > 0) {
+        // Segment end by size is checked inside the buffer.
+        size_t count = packet_count;
+        if (_max_size > 0) {
+            if (_segment_size >= _max_size && !openSegment(report)) {
+                return false;
+            }
+            count = size_t(std::min<uint64_t>(count, (_max_size - _segment_size) / PKT_SIZE));
+        }
+        if (!_file->write(buffer, count, report)) {
+            return false;
+        }
+        buffer += count;
+        packet_count -= count;
+        _segment_size += count * PKT_SIZE;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Open a new segment and move the current one to the helper thread.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileOutputArgs::openSegment(Report& report)
+{
+    const Time now(Time::CurrentUTC());
+    const UString name(segmentName(now));
+
+    // Use the prepared file if the helper thread is ready. A prepared file is empty
+    // and must be open in append mode to preserve the preallocated space.
+    bool prepared = false;
+    {
+        Guard lock(_mutex);
+        if (_next_ready) {
+            _next_ready = false;
+            prepared = RenameFile(_next_name, name) == SYS_SUCCESS;
+        }
+    }
+
+    TSFileOutput* file = new TSFileOutput;
+    file->setAsynchronous(_async_depth);
+    file->setDirectIO(_direct);
+    if (!file->open(name, prepared, false, report)) {
+        delete file;
+        return false;
+    }
+    report.verbose(u"created segment %s", {name});
+
+    // Pass the previous segment to the helper thread for closing.
+    // Without helper thread, close it here.
+    if (_file != nullptr) {
+        GuardCondition lock(_mutex, _work);
+        if (_helper != nullptr) {
+            _completed.push_back(Completed {_file, _trim});
+        }
+        else {
+            _file->close(report);
+            TSFileOutput::WriteStatistics stats;
+            _file->getWriteStatistics(stats);
+            AddStatistics(_stats, stats);
+            delete _file;
+        }
+        lock.signal();
+    }
+    _file = file;
+    _trim = prepared;
+    _segment_size = 0;
+
+    // Compute the end time of the segment.
+    if (_max_duration > 0) {
+        const MilliSecond duration = _max_duration * MilliSecPerSec;
+        if (_wall_clock) {
+            const Time local(now.UTCToLocal());
+            const Time midnight(local.thisDay());
+            _segment_end = (midnight + ((local - midnight) / duration + 1) * duration).localToUTC();
+        }
+        else {
+            _segment_end = now + duration;
+        }
+    }
+
+    // Drop the oldest segments.
+    _segments.push_back(name);
+    while (_max_files > 0 && _segments.size() > _max_files) {
+        if (_helper != nullptr) {
+            GuardCondition lock(_mutex, _work);
+            _obsolete.push_back(_segments.front());
+            lock.signal();
+        }
+        else {
+            DeleteFile(_segments.front());
+        }
+        _segments.pop_front();
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Build a unique segment file name for a given UTC time.
+//----------------------------------------------------------------------------
+
+ts::UString ts::TSFileOutputArgs::segmentName(const Time& utc)
+{
+    // Segment times are strictly increasing to keep the alphabetical order of file names,
+    // even when several segments are created in the same millisecond or the system time
+    // moves backward. Never reuse the name of an existing file.
+    UString name;
+    Time time(std::max(utc, _last_time + 1));
+    do {
+        const Time::Fields f(time.UTCToLocal());
+        name = PathPrefix(_name) +
+               UString::Format(u"-%04d%02d%02d-%02d%02d%02d-%03d", {f.year, f.month, f.day, f.hour, f.minute, f.second, f.millisecond}) +
+               PathSuffix(_name);
+        _last_time = time;
+        time += 1;
+    } while (FileExists(name));
+    return name;
+}
+
+
+//----------------------------------------------------------------------------
+// Create an empty file and preallocate disk space when supported.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileOutputArgs::PrepareFile(const UString& name, uint64_t size, Report& report)
+{
+#if defined(TS_WINDOWS)
+    const ::HANDLE handle = ::CreateFileW(name.wc_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        report.error(u"cannot create %s: %s", {name, ErrorCodeMessage()});
+        return false;
+    }
+    ::CloseHandle(handle);
+#else
+    const int fd = ::open(name.toUTF8().c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0666);
+    if (fd < 0) {
+        report.error(u"cannot create %s: %s", {name, ErrorCodeMessage()});
+        return false;
+    }
+#if defined(TS_LINUX)
+    // Reserve the space without changing the file size. Not supported by all file systems.
+    if (size > 0 && ::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, off_t(size)) < 0) {
+        report.debug(u"cannot preallocate %'d bytes in %s: %s", {size, name, ErrorCodeMessage()});
+    }
+#endif
+    ::close(fd);
+#endif
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Statistics.
+//----------------------------------------------------------------------------
+
+void ts::TSFileOutputArgs::AddStatistics(TSFileOutput::WriteStatistics& total, const TSFileOutput::WriteStatistics& stats)
+{
+    total.writes += stats.writes;
+    total.bytes += stats.bytes;
+    total.total_time += stats.total_time;
+    total.max_time = std::max(total.max_time, stats.max_time);
+    total.max_pending = std::max(total.max_pending, stats.max_pending);
+}
+
+void ts::TSFileOutputArgs::getWriteStatistics(TSFileOutput::WriteStatistics& stats) const
+{
+    TSFileOutput::WriteStatistics current;
+    if (_file != nullptr) {
+        _file->getWriteStatistics(current);
+    }
+    Guard lock(_mutex);
+    stats = _stats;
+    AddStatistics(stats, current);
+}
+
+
+//----------------------------------------------------------------------------
+// Helper thread: prepare, close and delete segments in the background.
+//----------------------------------------------------------------------------
+
+void ts::TSFileOutputArgs::Helper::main()
+{
+    for (;;) {
+        // Wait for some work. Closing and deletion take precedence over preparation.
+        TSFileOutput* file = nullptr;
+        bool trim = false;
+        UString obsolete;
+        bool prepare = false;
+        uint64_t size = 0;
+        {
+            GuardCondition lock(_parent->_mutex, _parent->_work);
+            while (_parent->_completed.empty() && _parent->_obsolete.empty() && (_parent->_next_ready || _parent->_next_failed || _parent->_terminate)) {
+                if (_parent->_terminate) {
+                    return; // nothing more to do
+                }
+                lock.waitCondition();
+            }
+            if (!_parent->_completed.empty()) {
+                file = _parent->_completed.front().file;
+                trim = _parent->_completed.front().trim;
+                _parent->_completed.pop_front();
+            }
+            else if (!_parent->_obsolete.empty()) {
+                obsolete = _parent->_obsolete.front();
+                _parent->_obsolete.pop_front();
+            }
+            else {
+                prepare = true;
+                size = _parent->_largest;
+            }
+        }
+
+        // Perform the work without holding the mutex.
+        Report& report(*_parent->_report);
+        if (file != nullptr) {
+            const UString name(file->getFileName());
+            file->close(report);
+            TSFileOutput::WriteStatistics stats;
+            file->getWriteStatistics(stats);
+            delete file;
+            // Release the unused preallocated space.
+            if (trim) {
+                TruncateFile(name, stats.bytes);
+            }
+            Guard lock(_parent->_mutex);
+            AddStatistics(_parent->_stats, stats);
+            _parent->_largest = std::max(_parent->_largest, stats.bytes);
+        }
+        else if (!obsolete.empty()) {
+            report.verbose(u"deleting segment %s", {obsolete});
+            const ErrorCode err = DeleteFile(obsolete);
+            if (err != SYS_SUCCESS) {
+                report.error(u"error deleting %s: %s", {obsolete, ErrorCodeMessage(err)});
+            }
+        }
+        else if (prepare) {
+            const bool ok = PrepareFile(_parent->_next_name, size, report);
+            Guard lock(_parent->_mutex);
+            // Do not retry on error, segments are then created on the fly.
+            _parent->_next_ready = ok;
+            _parent->_next_failed = !ok;
+        }
+    }
+}
@@ -0,0 +1,193 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Transport stream file output with command line arguments and segmentation.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSFileOutput.h"
+#include "tsArgs.h"
+#include "tsTime.h"
+
+namespace ts {
+    //!
+    //! Transport stream file output with command line arguments and segmentation.
+    //! @ingroup mpeg
+    //!
+    //! The output file can be split in successive segments, based on size, duration
+    //! or wall-clock boundaries. Each segment file is named from the output file name
+    //! template with the local date and time of its creation ("name-YYYYMMDD-hhmmss-mmm.ts").
+    //!
+    //! A background thread prepares the file of the next segment (with disk space
+    //! preallocation on Linux), closes the completed segments and deletes the oldest
+    //! ones when the number of retained segments is limited. The switch from one
+    //! segment to the next one only renames and opens a file in the writing thread.
+    //!
+    class TSDUCKDLL TSFileOutputArgs
+    {
+    public:
+        //!
+        //! Default constructor.
+        //!
+        TSFileOutputArgs();
+
+        //!
+        //! Destructor.
+        //!
+        ~TSFileOutputArgs();
+
+        //!
+        //! Define command line options in an Args.
+        //! The file name parameter is not defined, it must be defined by the application.
+        //! @param [in,out] args Command line arguments to update.
+        //!
+        void defineOptions(Args& args) const;
+
+        //!
+        //! Load arguments from command line.
+        //! @param [in,out] args Command line arguments.
+        //! @return True on success, false on error.
+        //! Args error indicator is also set in case of incorrect arguments.
+        //!
+        bool loadArgs(Args& args);
+
+        //!
+        //! Open the output file or the first segment.
+        //! @param [in,out] report Where to report errors. Must remain valid until close()
+        //! since it is also used by the background thread in segmented mode.
+        //! @return True on success, false on error.
+        //!
+        bool open(Report& report);
+
+        //!
+        //! Close the output file and wait for the completion of all background operations.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool close(Report& report);
+
+        //!
+        //! Write TS packets to the file, switch to a new segment when necessary.
+        //! @param [in] buffer Address of first packet to write.
+        //! @param [in] packet_count Number of packets to write.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool write(const TSPacket* buffer, size_t packet_count, Report& report);
+
+        //!
+        //! Check if the output is split in segments.
+        //! @return True if the output is split in segments.
+        //!
+        bool isSegmented() const
+        {
+            return _max_size > 0 || _max_duration > 0;
+        }
+
+        //!
+        //! Get the statistics on the write operations in all segments since open().
+        //! @param [out] stats Returned statistics.
+        //!
+        void getWriteStatistics(TSFileOutput::WriteStatistics& stats) const;
+
+    private:
+        // Background thread for segment preparation, completion and deletion.
+        class Helper : public Thread
+        {
+        public:
+            Helper(TSFileOutputArgs* parent);
+        private:
+            TSFileOutputArgs* _parent;
+            virtual void main() override;
+
+            // Inaccessible operations.
+            Helper() = delete;
+            Helper(const Helper&) = delete;
+            Helper& operator=(const Helper&) = delete;
+        };
+
+        // A completed segment to close in the background.
+        struct Completed
+        {
+            TSFileOutput* file;  // Segment file to close and delete.
+            bool          trim;  // Release the preallocated space after close.
+        };
+
+        // Command line options.
+        UString  _name;           // Output file name or segment name template.
+        bool     _append;         // Append to existing file (not segmented).
+        bool     _keep;           // Keep existing file (not segmented).
+        size_t   _async_depth;    // Depth of asynchronous writes, zero for synchronous.
+        bool     _direct;         // Use direct I/O.
+        uint64_t _max_size;       // Maximum segment size in bytes, zero if unlimited.
+        Second   _max_duration;   // Maximum segment duration in seconds, zero if unlimited.
+        bool     _wall_clock;     // Align segments on wall-clock multiples of _max_duration.
+        size_t   _max_files;      // Maximum number of retained segments, zero if unlimited.
+
+        // Writer state, accessed by the writing thread only.
+        TSFileOutput*       _file;          // Current file or segment.
+        bool                _trim;          // Current segment was preallocated.
+        uint64_t            _segment_size;  // Bytes in current segment.
+        Time                _segment_end;   // UTC time of next segment switch (with _max_duration).
+        Time                _last_time;     // UTC time in last segment name.
+        std::list<UString>  _segments;      // Retained segments, oldest first.
+
+        // Shared state with the helper thread, protected by _mutex.
+        mutable Mutex          _mutex;
+        Condition              _work;          // Signaled when there is work for the helper thread.
+        Helper*                _helper;        // Helper thread, segmented mode only.
+        Report*                _report;        // Where the helper thread reports errors.
+        bool                   _terminate;     // Helper thread shall terminate.
+        UString                _next_name;     // Temporary name of next prepared segment.
+        bool                   _next_ready;    // Next segment is prepared.
+        bool                   _next_failed;   // Preparation of next segment failed, do not retry.
+        uint64_t               _largest;       // Largest completed segment, used for preallocation.
+        std::list<Completed>   _completed;     // Segments to close.
+        std::list<UString>     _obsolete;      // Segments to delete.
+        TSFileOutput::WriteStatistics _stats;  // Cumulated statistics of closed files.
+
+        // Open a new segment and move the current one to the helper thread.
+        bool openSegment(Report& report);
+
+        // Build a unique segment file name for a given UTC time.
+        UString segmentName(const Time& utc);
+
+        // Create an empty file and preallocate disk space when supported.
+        static bool PrepareFile(const UString& name, uint64_t size, Report& report);
+
+        // Add statistics of a closed file.
+        static void AddStatistics(TSFileOutput::WriteStatistics& total, const TSFileOutput::WriteStatistics& stats);
+
+        // Inaccessible operations.
+        TSFileOutputArgs(const TSFileOutputArgs&) = delete;
+        TSFileOutputArgs& operator=(const TSFileOutputArgs&) = delete;
+    };
+}
@@ -28,8 +28,13 @@
 //----------------------------------------------------------------------------
 
 #include "tsTSScrambling.h"
+#include "tsGuardCondition.h"
 TSDUCK_SOURCE;
 
+// Minimum number of packets per thread when splitting a batch between threads.
+// Below this, the thread synchronization costs more than the scrambling.
+#define MIN_PACKETS_PER_THREAD 64
+
 
 //----------------------------------------------------------------------------
 // Constructors.
@@ -45,7 +50,17 @@ ts::TSScrambling::TSScrambling(Report& report, uint8_t scrambling) :
     _decrypt_scv(SC_CLEAR),
     _dvbcsa(),
     _idsa(),
-    _scrambler{nullptr, nullptr}
+    _scrambler{nullptr, nullptr},
+    _batch(false),
+    _batch_error(nullptr),
+    _encrypt_batch(),
+    _decrypt_batch(),
+    _batch_data(),
+    _batch_sizes(),
+    _cw(),
+    _workers(),
+    _mutex(),
+    _job_done()
 {
     setScramblingType(scrambling);
 }
@@ -60,11 +75,26 @@ ts::TSScrambling::TSScrambling(const TSScrambling& other) :
     _decrypt_scv(SC_CLEAR),
     _dvbcsa(),
     _idsa(),
-    _scrambler{nullptr, nullptr}
+    _scrambler{nullptr, nullptr},
+    _batch(false),
+    _batch_error(nullptr),
+    _encrypt_batch(),
+    _decrypt_batch(),
+    _batch_data(),
+    _batch_sizes(),
+    _cw(),
+    _workers(),
+    _mutex(),
+    _job_done()
 {
     setScramblingType(_scrambling_type);
 }
 
+ts::TSScrambling::~TSScrambling()
+{
+    stopWorkers();
+}
+
 
 //----------------------------------------------------------------------------
 // Force the usage of a specific algorithm.
@@ -73,6 +103,10 @@ ts::TSScrambling::TSScrambling(const TSScrambling& other) :
 bool ts::TSScrambling::setScramblingType(uint8_t scrambling, bool overrideExplicit)
 {
     if (overrideExplicit || !_explicit_type) {
+        // Deferred packets must be processed with the previous algorithm.
+        if (!flushBatch()) {
+            return false;
+        }
         switch (scrambling) {
             case SCRAMBLING_DVB_CSA1:
             case SCRAMBLING_DVB_CSA2:
@@ -102,6 +136,10 @@ void ts::TSScrambling::setEntropyMode(DVBCSA2::EntropyMode mode)
 {
     _dvbcsa[0].setEntropyMode(mode);
     _dvbcsa[1].setEntropyMode(mode);
+    for (size_t i = 0; i < _workers.size(); ++i) {
+        _workers[i]->dvbcsa[0].setEntropyMode(mode);
+        _workers[i]->dvbcsa[1].setEntropyMode(mode);
+    }
 }
 
 
@@ -249,8 +287,25 @@ bool ts::TSScrambling::setCW(const ByteBlock& cw, int parity)
     CipherChaining* algo = _scrambler[parity & 1];
     assert(algo != nullptr);
 
+    // Deferred packets must be processed with the previous keys.
+    // After this, the worker threads are idle and their keys can be updated.
+    if (!flushBatch()) {
+        return false;
+    }
+
     if (algo->setKey(cw.data(), cw.size())) {
         _report.debug(u"using scrambling key: " + UString::Dump(cw, UString::SINGLE_LINE));
+        _cw[parity & 1] = cw;
+        const bool csa = algo == &_dvbcsa[parity & 1];
+        for (size_t i = 0; i < _workers.size(); ++i) {
+            Worker* const w = _workers[i];
+            if (csa) {
+                w->dvbcsa[parity & 1].setKey(cw.data(), cw.size());
+            }
+            else {
+                w->idsa[parity & 1].setKey(cw.data(), cw.size());
+            }
+        }
         return true;
     }
     else {
@@ -303,6 +358,12 @@ bool ts::TSScrambling::encrypt(TSPacket& pkt)
     assert(algo != nullptr);
     assert(_encrypt_scv == SC_EVEN_KEY || _encrypt_scv == SC_ODD_KEY);
 
+    // Register the packet in deferred mode.
+    if (_batch) {
+        _encrypt_batch[_encrypt_scv & 1].push_back(&pkt);
+        return true;
+    }
+
     const bool ok = algo->encryptInPlace(pkt.getPayload(), pkt.getPayloadSize());
     if (ok) {
         pkt.setScrambling(_encrypt_scv);
@@ -332,6 +393,12 @@ bool ts::TSScrambling::decrypt(TSPacket& pkt)
         return false;
     }
 
+    // Register the packet in deferred mode.
+    if (_batch) {
+        _decrypt_batch[_decrypt_scv & 1].push_back(&pkt);
+        return true;
+    }
+
     // Decrypt the packet.
     CipherChaining* algo = _scrambler[_decrypt_scv & 1];
     assert(algo != nullptr);
@@ -342,3 +409,257 @@ bool ts::TSScrambling::decrypt(TSPacket& pkt)
     }
     return ok;
 }
+
+
+//----------------------------------------------------------------------------
+// Deferred processing of packets.
+//----------------------------------------------------------------------------
+
+void ts::TSScrambling::startBatch()
+{
+    _batch = true;
+    _batch_error = nullptr;
+}
+
+bool ts::TSScrambling::endBatch()
+{
+    const bool ok = flushBatch();
+    _batch = false;
+    return ok;
+}
+
+size_t ts::TSScrambling::batchErrorIndex(const TSPacket* pkt, size_t count) const
+{
+    const std::less<const TSPacket*> less;
+    if (_batch_error == nullptr || !less(_batch_error, pkt + count)) {
+        return count;
+    }
+    else if (less(_batch_error, pkt)) {
+        return 0;
+    }
+    else {
+        return size_t(_batch_error - pkt);
+    }
+}
+
+bool ts::TSScrambling::flushBatch()
+{
+    bool ok = true;
+
+    for (int parity = 0; parity < 2; ++parity) {
+        for (int decrypt = 0; decrypt < 2; ++decrypt) {
+
+            std::vector<TSPacket*>& pkts(decrypt ? _decrypt_batch[parity] : _encrypt_batch[parity]);
+            if (pkts.empty()) {
+                continue;
+            }
+
+            CipherChaining* algo = _scrambler[parity];
+            assert(algo != nullptr);
+            const bool csa = algo == &_dvbcsa[parity];
+
+            // Number of threads to use, including this one, and packets per thread.
+            const size_t nthreads = std::min(_workers.size() + 1, std::max<size_t>(1, pkts.size() / MIN_PACKETS_PER_THREAD));
+            const size_t slice = (pkts.size() + nthreads - 1) / nthreads;
+
+            // Submit the last slices to the workers.
+            size_t first = slice;
+            for (size_t i = 0; i + 1 < nthreads; ++i) {
+                Worker* const w = _workers[i];
+                GuardCondition lock(_mutex, w->to_do);
+                w->pkts = pkts.data() + first;
+                w->count = std::min(slice, pkts.size() - first);
+                w->decrypt = decrypt != 0;
+                w->parity = parity;
+                w->busy = true;
+                lock.signal();
+                first += w->count;
+            }
+
+            // Process the first slice in this thread.
+            bool success = ProcessBatch(algo, csa ? &_dvbcsa[parity] : nullptr, pkts.data(), std::min(slice, pkts.size()), decrypt != 0, parity, _batch_data, _batch_sizes);
+
+            // Wait for the completion of the workers.
+            if (nthreads > 1) {
+                GuardCondition lock(_mutex, _job_done);
+                for (size_t i = 0; i + 1 < nthreads; ++i) {
+                    while (_workers[i]->busy) {
+                        lock.waitCondition();
+                    }
+                    success = _workers[i]->success && success;
+                }
+            }
+
+            // We do not know which packets failed, consider the whole group as failed.
+            if (!success) {
+                ok = false;
+                const std::less<const TSPacket*> less;
+                for (std::vector<TSPacket*>::const_iterator it = pkts.begin(); it != pkts.end(); ++it) {
+                    if (_batch_error == nullptr || less(*it, _batch_error)) {
+                        _batch_error = *it;
+                    }
+                }
+            }
+            pkts.clear();
+        }
+    }
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Process deferred packets with a given cipher.
+//----------------------------------------------------------------------------
+
+bool ts::TSScrambling::ProcessBatch(CipherChaining* algo, DVBCSA2* dvbcsa, TSPacket* const* pkts, size_t count, bool decrypt, int parity,
+                                    std::vector<uint8_t*>& data, std::vector<size_t>& sizes)
+{
+    bool ok = true;
+
+    // Scrambling control value of the processed packets.
+    const uint8_t new_scv = decrypt ? uint8_t(SC_CLEAR) : uint8_t(SC_EVEN_KEY | parity);
+
+    if (dvbcsa != nullptr) {
+        // DVB-CSA2 processes the payloads of all packets in parallel.
+        data.resize(count);
+        sizes.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            data[i] = pkts[i]->getPayload();
+            sizes[i] = pkts[i]->getPayloadSize();
+        }
+        if (decrypt ?
+            dvbcsa->decryptBatchInPlace(data.data(), sizes.data(), count) :
+            dvbcsa->encryptBatchInPlace(data.data(), sizes.data(), count))
+        {
+            for (size_t i = 0; i < count; ++i) {
+                pkts[i]->setScrambling(new_scv);
+            }
+        }
+        else {
+            ok = false;
+        }
+    }
+    else {
+        // Other algorithms process packets one by one.
+        for (size_t i = 0; i < count; ++i) {
+            if (decrypt ?
+                algo->decryptInPlace(pkts[i]->getPayload(), pkts[i]->getPayloadSize()) :
+                algo->encryptInPlace(pkts[i]->getPayload(), pkts[i]->getPayloadSize()))
+            {
+                pkts[i]->setScrambling(new_scv);
+            }
+            else {
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Set the number of threads which process the deferred packets.
+//----------------------------------------------------------------------------
+
+bool ts::TSScrambling::setThreads(size_t count)
+{
+    // Process pending packets with the current threads.
+    bool ok = flushBatch();
+
+    stopWorkers();
+    for (size_t i = 1; ok && i < count; ++i) {
+        Worker* const w = new Worker(this);
+        for (int parity = 0; parity < 2; ++parity) {
+            w->dvbcsa[parity].setEntropyMode(_dvbcsa[parity].entropyMode());
+            if (!_cw[parity].empty()) {
+                if (_scrambler[parity] == &_dvbcsa[parity]) {
+                    w->dvbcsa[parity].setKey(_cw[parity].data(), _cw[parity].size());
+                }
+                else {
+                    w->idsa[parity].setKey(_cw[parity].data(), _cw[parity].size());
+                }
+            }
+        }
+        if (w->start()) {
+            _workers.push_back(w);
+        }
+        else {
+            _report.error(u"error starting scrambling thread");
+            delete w;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Stop and deallocate all worker threads.
+//----------------------------------------------------------------------------
+
+void ts::TSScrambling::stopWorkers()
+{
+    for (size_t i = 0; i < _workers.size(); ++i) {
+        Worker* const w = _workers[i];
+        {
+            GuardCondition lock(_mutex, w->to_do);
+            w->terminate = true;
+            lock.signal();
+        }
+        w->waitForTermination();
+        delete w;
+    }
+    _workers.clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Worker thread.
+//----------------------------------------------------------------------------
+
+ts::TSScrambling::Worker::Worker(TSScrambling* parent) :
+    Thread(),
+    dvbcsa(),
+    idsa(),
+    to_do(),
+    terminate(false),
+    busy(false),
+    success(true),
+    pkts(nullptr),
+    count(0),
+    decrypt(false),
+    parity(0),
+    data(),
+    sizes(),
+    _parent(parent)
+{
+}
+
+void ts::TSScrambling::Worker::main()
+{
+    for (;;) {
+        // Wait for a job or termination.
+        {
+            GuardCondition lock(_parent->_mutex, to_do);
+            while (!terminate && !busy) {
+                lock.waitCondition();
+            }
+            if (terminate) {
+                break;
+            }
+        }
+
+        // Process the packets without holding the mutex. The job parameters
+        // are not modified by the parent while the worker is busy.
+        const bool csa = _parent->_scrambler[parity] == &_parent->_dvbcsa[parity];
+        const bool ok = ProcessBatch(csa ? static_cast<CipherChaining*>(&dvbcsa[parity]) : &idsa[parity],
+                                     csa ? &dvbcsa[parity] : nullptr,
+                                     pkts, count, decrypt, parity, data, sizes);
+
+        // Report completion.
+        GuardCondition lock(_parent->_mutex, _parent->_job_done);
+        success = ok;
+        busy = false;
+        lock.signal();
+    }
+}
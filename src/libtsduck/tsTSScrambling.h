@@ -39,6 +39,9 @@
 #include "tsDVBCSA2.h"
 #include "tsIDSA.h"
 #include "tsMPEG.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+#include "tsThread.h"
 
 namespace ts {
     //!
@@ -73,6 +76,11 @@ namespace ts {
         //!
         TSScrambling(const TSScrambling& other);
 
+        //!
+        //! Destructor.
+        //!
+        ~TSScrambling();
+
         //!
         //! Define command line options in an Args.
         //! @param [in,out] args Command line arguments to update.
@@ -122,7 +130,8 @@ namespace ts {
         //! @param [in] scrambling Scrambling type.
         //! @param [in] overrideExplicit If true, always set the scrambling type.
         //! If false, ignore it if an explicit type was set on the command line.
-        //! @return True on success, false on unsupported type.
+        //! In batch mode, the deferred packets are first processed with the previous algorithm.
+        //! @return True on success, false on unsupported type or error in deferred packets.
         //!
         bool setScramblingType(uint8_t scrambling, bool overrideExplicit = true);
 
@@ -174,20 +183,111 @@ namespace ts {
         //!
         bool decrypt(TSPacket& pkt);
 
+        //!
+        //! Start the deferred processing of packets.
+        //! Until endBatch() is called, encrypt() and decrypt() only check and register the
+        //! packets. The registered packets are processed together, in parallel when the
+        //! algorithm allows it (DVB-CSA2). They are processed before any change of control
+        //! word and, at the latest, in endBatch(). The registered packets must remain in
+        //! memory and must not be modified until then.
+        //!
+        void startBatch();
+
+        //!
+        //! Process all registered packets and stop the deferred processing of packets.
+        //! @return True on success, false on error.
+        //!
+        bool endBatch();
+
+        //!
+        //! Locate the first registered packet which could not be processed since startBatch().
+        //! When the processing of a group of registered packets fails, it is not possible to
+        //! know which packets were correctly processed and the whole group is considered as failed.
+        //! @param [in] pkt Address of the array of packets which were registered.
+        //! @param [in] count Number of packets in the array.
+        //! @return Index in @a pkt of the first failed packet or @a count if there was no error.
+        //!
+        size_t batchErrorIndex(const TSPacket* pkt, size_t count) const;
+
+        //!
+        //! Set the number of threads which process the registered packets in deferred mode.
+        //! The registered packets of each batch are split between the calling thread and
+        //! worker threads. The packets are processed in place, their order is unchanged
+        //! and all of them are processed before any change of control word.
+        //! @param [in] count Total number of threads, including the calling thread.
+        //! The default is 1, meaning that all packets are processed in the calling thread.
+        //! @return True on success, false on error (threads cannot be created).
+        //!
+        bool setThreads(size_t count);
+
+        //!
+        //! Get the number of threads which process the registered packets in deferred mode.
+        //! @return The total number of threads, including the calling thread.
+        //!
+        size_t threads() const { return _workers.size() + 1; }
+
     private:
+        // A worker thread which processes a slice of the deferred packets.
+        // Each worker has its own instances of the ciphers, with the same keys.
+        class Worker : public Thread
+        {
+        public:
+            Worker(TSScrambling* parent);
+            DVBCSA2               dvbcsa[2];  // Index 0 = even key, 1 = odd key.
+            IDSA                  idsa[2];
+            Condition             to_do;      // Signaled by the parent when a job or termination is requested.
+            bool                  terminate;  // Terminate the thread.
+            bool                  busy;       // A job is assigned and not yet completed.
+            bool                  success;    // Completion status of the last job.
+            TSPacket* const*      pkts;       // Job: packets to process.
+            size_t                count;      // Job: number of packets to process.
+            bool                  decrypt;    // Job: decrypt (true) or encrypt (false).
+            int                   parity;     // Job: parity of the key to use.
+            std::vector<uint8_t*> data;       // Payload addresses for DVB-CSA2 batches.
+            std::vector<size_t>   sizes;      // Payload sizes for DVB-CSA2 batches.
+        private:
+            TSScrambling* _parent;
+            virtual void main() override;
+            Worker() = delete;
+            Worker(const Worker&) = delete;
+            Worker& operator=(const Worker&) = delete;
+        };
+
+
         // List of control words
         typedef std::list<ByteBlock> CWList;
 
-        Report&          _report;
-        uint8_t          _scrambling_type;
-        bool             _explicit_type;
-        CWList           _cw_list;
-        CWList::iterator _next_cw;
-        uint8_t          _encrypt_scv;  // Encryption: key to use (SC_EVEN_KEY or SC_ODD_KEY).
-        uint8_t          _decrypt_scv;  // Decryption: previous scrambling_control value.
-        DVBCSA2          _dvbcsa[2];    // Index 0 = even key, 1 = odd key.
-        IDSA             _idsa[2];
-        CipherChaining*  _scrambler[2];
+        Report&                _report;
+        uint8_t                _scrambling_type;
+        bool                   _explicit_type;
+        CWList                 _cw_list;
+        CWList::iterator       _next_cw;
+        uint8_t                _encrypt_scv;       // Encryption: key to use (SC_EVEN_KEY or SC_ODD_KEY).
+        uint8_t                _decrypt_scv;       // Decryption: previous scrambling_control value.
+        DVBCSA2                _dvbcsa[2];         // Index 0 = even key, 1 = odd key.
+        IDSA                   _idsa[2];
+        CipherChaining*        _scrambler[2];
+        bool                   _batch;             // Deferred processing of packets.
+        const TSPacket*        _batch_error;       // First failed deferred packet in memory since startBatch().
+        std::vector<TSPacket*> _encrypt_batch[2];  // Deferred packets to encrypt, per parity.
+        std::vector<TSPacket*> _decrypt_batch[2];  // Deferred packets to decrypt, per parity.
+        std::vector<uint8_t*>  _batch_data;        // Payload addresses of deferred packets.
+        std::vector<size_t>    _batch_sizes;       // Payload sizes of deferred packets.
+        ByteBlock              _cw[2];             // Current control words, per parity.
+        std::vector<Worker*>   _workers;           // Worker threads, in addition to the calling thread.
+        Mutex                  _mutex;             // Exclusive access to the jobs of the workers.
+        Condition              _job_done;          // Signaled by the workers when a job is completed.
+
+        // Process deferred packets with a given cipher. When dvbcsa is not null, it is the same
+        // as algo and the DVB-CSA2 batch processing is used. Can be called from any thread.
+        static bool ProcessBatch(CipherChaining* algo, DVBCSA2* dvbcsa, TSPacket* const* pkts, size_t count, bool decrypt, int parity,
+                                 std::vector<uint8_t*>& data, std::vector<size_t>& sizes);
+
+        // Stop and deallocate all worker threads.
+        void stopWorkers();
+
+        // Process all deferred packets.
+        bool flushBatch();
 
         // Set the next fixed control word as scrambling key.
         bool setNextFixedCW(int parity);
@@ -62,6 +62,7 @@ ts::TablesLogger::TablesLogger(const TablesLoggerArgs& opt, TablesDisplay& displ
     _xmlDoc(report),
     _xmlOpen(false),
     _binfile(),
+    _idxfile(),
     _sock(false, report),
     _shortSections(),
     _allSections(),
@@ -98,6 +99,15 @@ ts::TablesLogger::TablesLogger(const TablesLoggerArgs& opt, TablesDisplay& displ
         return;
     }
 
+    // Create the indexed section output.
+    if (_opt.use_indexed) {
+        _report.verbose(u"creating %s", {_opt.idx_destination});
+        if (!_idxfile.create(_opt.idx_destination, _report)) {
+            _abort = true;
+            return;
+        }
+    }
+
     // Initialize UDP output.
     if (_opt.use_udp) {
         // Create UDP socket.
@@ -141,6 +151,9 @@ void ts::TablesLogger::close()
         if (_binfile.is_open()) {
             _binfile.close();
         }
+        if (_idxfile.isCreated()) {
+            _idxfile.close(_report);
+        }
         if (_sock.isOpen()) {
             _sock.close(_report);
         }
@@ -248,6 +261,12 @@ void ts::TablesLogger::handleTable(SectionDemux&, const BinaryTable& table)
         }
     }
 
+    if (_opt.use_indexed) {
+        for (size_t i = 0; i < table.sectionCount(); ++i) {
+            saveIndexedSection(*table.sectionAt(i));
+        }
+    }
+
     if (_opt.use_udp) {
         sendUDP(table);
     }
@@ -348,6 +367,10 @@ void ts::TablesLogger::handleSection(SectionDemux& demux, const Section& sect)
         }
     }
 
+    if (_opt.use_indexed) {
+        saveIndexedSection(sect);
+    }
+
     if (_opt.use_udp) {
         sendUDP(sect);
     }
@@ -560,6 +583,18 @@ void ts::TablesLogger::saveBinarySection(const Section& sect)
 }
 
 
+//----------------------------------------------------------------------------
+//  Save a section in the indexed section file
+//----------------------------------------------------------------------------
+
+void ts::TablesLogger::saveIndexedSection(const Section& sect)
+{
+    if (!_idxfile.write(sect, _report)) {
+        _abort = true;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Open/write/close XML file.
 //----------------------------------------------------------------------------
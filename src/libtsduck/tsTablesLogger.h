@@ -42,6 +42,7 @@
 #include "tsUDPSocket.h"
 #include "tsCASMapper.h"
 #include "tsxmlDocument.h"
+#include "tsIndexedSectionFile.h"
 
 namespace ts {
     //!
@@ -149,6 +150,7 @@ namespace ts {
         xml::Document            _xmlDoc;          // XML root document.
         bool                     _xmlOpen;         // The XML root element is open.
         std::ofstream            _binfile;         // Binary output file.
+        IndexedSectionFile       _idxfile;         // Indexed section output file.
         UDPSocket                _sock;            // Output socket.
         std::map<PID,SectionPtr> _shortSections;   // Tracking duplicate short sections by PID.
         std::map<PID,SectionPtr> _allSections;     // Tracking duplicate sections by PID (with --all-sections).
@@ -160,6 +162,9 @@ namespace ts {
         // Save a section in a binary file
         void saveBinarySection(const Section&);
 
+        // Save a section in the indexed section file
+        void saveIndexedSection(const Section&);
+
         // Open/write/close XML tables.
         bool createXML(const UString& name);
         void saveXML(const BinaryTable& table);
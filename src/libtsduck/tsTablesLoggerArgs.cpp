@@ -32,6 +32,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsTablesLoggerArgs.h"
+#include "tsIndexedSectionFile.h"
 #include "tsException.h"
 TSDUCK_SOURCE;
 
@@ -48,10 +49,12 @@ ts::TablesLoggerArgs::TablesLoggerArgs() :
     use_text(false),
     use_xml(false),
     use_binary(false),
+    use_indexed(false),
     use_udp(false),
     text_destination(),
     xml_destination(),
     bin_destination(),
+    idx_destination(),
     udp_destination(),
     multi_files(false),
     flush(false),
@@ -116,6 +119,15 @@ void ts::TablesLoggerArgs::defineOptions(Args& args) const
               u"for instance) are ignored. Typically, such sections are stuffing and "
               u"can be ignored that way.");
 
+    args.option(u"indexed-output", 0, Args::STRING);
+    args.help(u"indexed-output", u"filename",
+              u"Save sections in the specified indexed section file. This is a binary "
+              u"file which also contains an index of all sections by PID, table id, "
+              u"table id extension, version and section number. Such a file can be "
+              u"memory-mapped and searched without loading all sections. It can be "
+              u"used as input by the plugin inject and the command tspacketize. "
+              u"The usual suffix for indexed section files is " TS_DEFAULT_INDEXED_SECTION_FILE_SUFFIX u".");
+
     args.option(u"flush", 'f');
     args.help(u"flush", u"Flush output after each display.");
 
@@ -288,8 +300,9 @@ bool ts::TablesLoggerArgs::load(Args& args)
     // Type of output, text is the default.
     use_xml = args.present(u"xml-output");
     use_binary = args.present(u"binary-output");
+    use_indexed = args.present(u"indexed-output");
     use_udp = args.present(u"ip-udp");
-    use_text = args.present(u"output-file") || args.present(u"text-output") || ( !use_xml && !use_binary && !use_udp);
+    use_text = args.present(u"output-file") || args.present(u"text-output") || ( !use_xml && !use_binary && !use_indexed && !use_udp);
 
     // --output-file and --text-output are synonyms.
     if (args.present(u"output-file") && args.present(u"text-output")) {
@@ -299,6 +312,7 @@ bool ts::TablesLoggerArgs::load(Args& args)
     // Output destinations.
     xml_destination = args.value(u"xml-output");
     bin_destination = args.value(u"binary-output");
+    idx_destination = args.value(u"indexed-output");
     udp_destination = args.value(u"ip-udp");
     text_destination = args.value(u"output-file", args.value(u"text-output").c_str());
 
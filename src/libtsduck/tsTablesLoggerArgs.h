@@ -59,10 +59,12 @@ namespace ts {
         bool     use_text;          //!< Produce formatted human-readable tables.
         bool     use_xml;           //!< Produce XML tables.
         bool     use_binary;        //!< Save binary sections.
+        bool     use_indexed;       //!< Save binary sections in an indexed section file.
         bool     use_udp;           //!< Send sections using UDP/IP.
         UString  text_destination;  //!< Text output file name.
         UString  xml_destination;   //!< XML output file name.
         UString  bin_destination;   //!< Binary output file name.
+        UString  idx_destination;   //!< Indexed section file name.
         UString  udp_destination;   //!< UDP/IP destination address:port.
         bool     multi_files;       //!< Multiple binary output files (one per section).
         bool     flush;             //!< Flush output file.
@@ -187,6 +187,12 @@ bool ts::Thread::start()
         return false;
     }
 
+    // Set the CPU affinity, on the first 64 CPU's only.
+    if (!_attributes._affinity.empty() && ::SetThreadAffinityMask(_handle, ThreadAttributes::Win32AffinityMask(_attributes._affinity)) == 0) {
+        ::CloseHandle(_handle);
+        return false;
+    }
+
     // Release the thread
     if (::ResumeThread(_handle) == ::DWORD(-1)) {
         ::CloseHandle(_handle);
@@ -233,6 +239,20 @@ bool ts::Thread::start()
         ::pthread_attr_destroy(&attr);
         return false;
     }
+#if defined(TS_LINUX)
+    // Set the CPU affinity. Not supported on other UNIX systems.
+    if (!_attributes._affinity.empty()) {
+        ::cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (auto it = _attributes._affinity.begin(); it != _attributes._affinity.end() && *it < CPU_SETSIZE; ++it) {
+            CPU_SET(*it, &cpus);
+        }
+        if (::pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus) != 0) {
+            ::pthread_attr_destroy(&attr);
+            return false;
+        }
+    }
+#endif
     // Create the thread
     if (::pthread_create(&_pthread, &attr, Thread::ThreadProc, this) != 0) {
         ::pthread_attr_destroy(&attr);
@@ -28,8 +28,12 @@
 //----------------------------------------------------------------------------
 
 #include "tsThreadAttributes.h"
+#include "tsUString.h"
 TSDUCK_SOURCE;
 
+// Upper bound of CPU indexes in a CPU list, for sanity checks.
+#define MAX_CPU_INDEX 65536
+
 
 //----------------------------------------------------------------------------
 // Default operating system priorities
@@ -152,7 +156,8 @@ int ts::ThreadAttributes::Win32Priority(int priority)
 ts::ThreadAttributes::ThreadAttributes() :
     _stackSize(0),
     _deleteWhenTerminated(false),
-    _priority(0)
+    _priority(0),
+    _affinity()
 {
     if (!_priorityInitialized) {
         InitializePriorities();
@@ -172,3 +177,134 @@ ts::ThreadAttributes& ts::ThreadAttributes::setPriority(int priority)
     _priority = std::max(_minimumPriority, std::min(_maximumPriority, priority));
     return *this;
 }
+
+
+//----------------------------------------------------------------------------
+// Decode a list of CPU indexes, Linux kernel format: "0-3,8,10-11".
+//----------------------------------------------------------------------------
+
+bool ts::ThreadAttributes::DecodeCPUList(const UString& list, CPUSet& cpus)
+{
+    cpus.clear();
+
+    UStringVector fields;
+    list.split(fields, u',', true, true);
+
+    for (auto it = fields.begin(); it != fields.end(); ++it) {
+        size_t first = 0;
+        size_t last = 0;
+        const size_t dash = it->find(u'-');
+        if (dash == NPOS) {
+            if (!it->toInteger(first)) {
+                return false;
+            }
+            last = first;
+        }
+        else if (!it->substr(0, dash).toInteger(first) || !it->substr(dash + 1).toInteger(last) || last < first) {
+            return false;
+        }
+        if (last >= MAX_CPU_INDEX) {
+            return false;
+        }
+        for (size_t cpu = first; cpu <= last; ++cpu) {
+            cpus.insert(cpu);
+        }
+    }
+    return !cpus.empty();
+}
+
+
+//----------------------------------------------------------------------------
+// Get the set of CPU's which are attached to a NUMA node.
+//----------------------------------------------------------------------------
+
+bool ts::ThreadAttributes::GetNUMANodeCPUs(size_t node, CPUSet& cpus)
+{
+    cpus.clear();
+
+#if defined(TS_LINUX)
+    // The list of CPU's in a node is available in a text file, in the kernel format.
+    const std::string path(UString::Format(u"/sys/devices/system/node/node%d/cpulist", {node}).toUTF8());
+    std::ifstream file(path.c_str());
+    std::string line;
+    return file && std::getline(file, line) && DecodeCPUList(UString::FromUTF8(line), cpus);
+#else
+    return false;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Get and set the CPU affinity of the calling thread.
+//----------------------------------------------------------------------------
+
+bool ts::ThreadAttributes::GetCurrentThreadAffinity(CPUSet& cpus)
+{
+    cpus.clear();
+
+#if defined(TS_LINUX)
+    ::cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::pthread_getaffinity_np(::pthread_self(), sizeof(set), &set) != 0) {
+        return false;
+    }
+    for (size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) {
+            cpus.insert(cpu);
+        }
+    }
+    return true;
+#elif defined(TS_WINDOWS)
+    // There is no GetThreadAffinityMask, use the process mask.
+    ::DWORD_PTR proc_mask = 0;
+    ::DWORD_PTR sys_mask = 0;
+    if (::GetProcessAffinityMask(::GetCurrentProcess(), &proc_mask, &sys_mask) == 0) {
+        return false;
+    }
+    for (size_t cpu = 0; cpu < 8 * sizeof(proc_mask); ++cpu) {
+        if ((proc_mask & (::DWORD_PTR(1) << cpu)) != 0) {
+            cpus.insert(cpu);
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool ts::ThreadAttributes::SetCurrentThreadAffinity(const CPUSet& cpus)
+{
+    if (cpus.empty()) {
+        return true;
+    }
+
+#if defined(TS_LINUX)
+    ::cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto it = cpus.begin(); it != cpus.end() && *it < CPU_SETSIZE; ++it) {
+        CPU_SET(*it, &set);
+    }
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+#elif defined(TS_WINDOWS)
+    return ::SetThreadAffinityMask(::GetCurrentThread(), Win32AffinityMask(cpus)) != 0;
+#else
+    return false;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// This static method is used by the implementation of ts::Thread on Windows
+// to obtain the Win32 affinity mask of a set of CPU's.
+//----------------------------------------------------------------------------
+
+#if defined(TS_WINDOWS)
+::DWORD_PTR ts::ThreadAttributes::Win32AffinityMask(const CPUSet& cpus)
+{
+    ::DWORD_PTR mask = 0;
+    for (auto it = cpus.begin(); it != cpus.end() && *it < 8 * sizeof(mask); ++it) {
+        mask |= ::DWORD_PTR(1) << *it;
+    }
+    return mask;
+}
+#endif
@@ -33,13 +33,25 @@
 
 #include "tsUDPSocket.h"
 #include "tsNullReport.h"
+#if defined(TS_LINUX)
+#include <netinet/udp.h>
+#endif
 TSDUCK_SOURCE;
 
+// Limits of UDP generic segmentation offload (GSO) on Linux.
+#define GSO_MAX_SEGMENTS    64  // Max number of segments in one GSO buffer.
+#define GSO_MAX_SIZE     65000  // Max size of one GSO buffer (max UDP payload, with some margin).
+
+// Max number of messages in one sendmmsg() call (kernel UIO_MAXIOV).
+#define MAX_SEND_BATCH    1024
+
 // Furiously idiotic Windows feature, see comment in receiveOne()
 #if defined(TS_WINDOWS)
 volatile ::LPFN_WSARECVMSG ts::UDPSocket::_wsaRevcMsg = 0;
 #endif
 
+const size_t ts::UDPSocket::MAX_RECEIVE_BATCH;
+
 
 //----------------------------------------------------------------------------
 // Constructor
@@ -50,7 +62,21 @@ ts::UDPSocket::UDPSocket(bool auto_open, Report& report) :
     _local_address(),
     _default_destination(),
     _mcast(),
-    _ssmcast()
+    _ssmcast(),
+    _recv_calls(0),
+    _recv_messages(0),
+    _send_calls(0),
+    _send_messages(0),
+    _use_gso(true)
+#if defined(TS_LINUX)
+    , _mmsg_headers(),
+    _mmsg_vectors(),
+    _mmsg_senders(),
+    _mmsg_control(),
+    _smsg_headers(),
+    _smsg_vectors(),
+    _smsg_control()
+#endif
 {
     if (auto_open) {
         // Returned value ignored on purpose, the socket is marked as closed in the object on error.
@@ -81,6 +107,7 @@ bool ts::UDPSocket::open(Report& report)
     if (!createSocket(PF_INET, SOCK_DGRAM, IPPROTO_UDP, report)) {
         return false;
     }
+    _recv_calls = _recv_messages = _send_calls = _send_messages = 0;
 
     // Set the IP_PKTINFO option. This option is used to get the destination address of all
     // UDP packets arriving on this socket. Actual socket option is an int.
@@ -394,10 +421,118 @@ bool ts::UDPSocket::send(const void* data, size_t size, const SocketAddress& des
         report.error(u"error sending UDP message: " + SocketErrorCodeMessage());
         return false;
     }
+    _send_calls++;
+    _send_messages++;
     return true;
 }
 
 
+//----------------------------------------------------------------------------
+// Send a sequence of messages to a destination address and port.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::sendBatch(const void* data, size_t size, size_t msg_size, const SocketAddress& dest, Report& report)
+{
+    if (msg_size == 0) {
+        report.error(u"invalid UDP message size 0");
+        return false;
+    }
+
+    const uint8_t* const base = reinterpret_cast<const uint8_t*>(data);
+
+#if defined(TS_LINUX)
+
+    ::sockaddr addr;
+    dest.copy(addr);
+
+    // Size of ancillary data per message, only used for GSO.
+    const size_t control_size = CMSG_SPACE(sizeof(uint16_t));
+
+    // Number of messages which are sent as one GSO buffer.
+#if defined(UDP_SEGMENT)
+    size_t gso_count = _use_gso ? std::min<size_t>(GSO_MAX_SEGMENTS, GSO_MAX_SIZE / msg_size) : 1;
+#else
+    size_t gso_count = 1;
+#endif
+
+    // Allocate work areas the first time.
+    if (_smsg_headers.empty()) {
+        _smsg_headers.resize(MAX_SEND_BATCH);
+        _smsg_vectors.resize(MAX_SEND_BATCH);
+        _smsg_control.resize(MAX_SEND_BATCH * control_size);
+    }
+
+    size_t sent = 0;
+    while (sent < size) {
+
+        // Build the message headers for the rest of the data.
+        size_t count = 0;
+        for (size_t offset = sent; offset < size && count < MAX_SEND_BATCH; ++count) {
+            const size_t len = std::min(size - offset, gso_count * msg_size);
+            TS_ZERO(_smsg_headers[count]);
+            _smsg_vectors[count].iov_base = const_cast<uint8_t*>(base + offset);
+            _smsg_vectors[count].iov_len = len;
+            ::msghdr& hdr(_smsg_headers[count].msg_hdr);
+            hdr.msg_name = &addr;
+            hdr.msg_namelen = sizeof(addr);
+            hdr.msg_iov = &_smsg_vectors[count];
+            hdr.msg_iovlen = 1;
+#if defined(UDP_SEGMENT)
+            if (len > msg_size) {
+                // Several messages in this buffer, let the kernel segment it.
+                hdr.msg_control = &_smsg_control[count * control_size];
+                hdr.msg_controllen = control_size;
+                ::cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+                cmsg->cmsg_level = SOL_UDP;
+                cmsg->cmsg_type = UDP_SEGMENT;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                const uint16_t segment = uint16_t(msg_size);
+                ::memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+            }
+#endif
+            offset += len;
+        }
+
+        // Send all messages at once. Some of them only may be sent.
+        const int res = ::sendmmsg(getSocket(), _smsg_headers.data(), static_cast<unsigned int>(count), 0);
+        if (res < 0) {
+            const SocketErrorCode err = LastSocketErrorCode();
+            if (err == EINTR) {
+                // Got a signal, retry.
+                continue;
+            }
+            else if (gso_count > 1 && (err == EINVAL || err == EIO || err == ENOPROTOOPT || err == EOPNOTSUPP)) {
+                // GSO is not supported by the kernel or the network interface, retry without it.
+                report.debug(u"UDP GSO not supported (%s), now disabled", {SocketErrorCodeMessage(err)});
+                _use_gso = false;
+                gso_count = 1;
+                continue;
+            }
+            report.error(u"error sending UDP message: " + SocketErrorCodeMessage(err));
+            return false;
+        }
+        _send_calls++;
+        for (size_t i = 0; i < size_t(res); ++i) {
+            sent += _smsg_vectors[i].iov_len;
+            _send_messages += (_smsg_vectors[i].iov_len + msg_size - 1) / msg_size;
+        }
+    }
+    return true;
+
+#else
+
+    // No batch transmission on this operating system, send messages one by one.
+    for (size_t offset = 0; offset < size; offset += msg_size) {
+        if (!send(base + offset, std::min(msg_size, size - offset), dest, report)) {
+            return false;
+        }
+    }
+    return true;
+
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Receive a message.
 // If abort interface is non-zero, invoke it when I/O is interrupted
@@ -570,6 +705,139 @@ ts::SocketErrorCode ts::UDPSocket::receiveOne(void* data, size_t max_size, size_
     // Successfully received a message
     ret_size = size_t(insize);
     sender = SocketAddress(sender_sock);
+    _recv_calls++;
+    _recv_messages++;
 
     return SYS_SUCCESS;
 }
+
+
+//----------------------------------------------------------------------------
+// Receive a batch of messages.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::receiveBatch(ReceivedMessage* msgs, size_t max_count, size_t& ret_count, const AbortInterface* abort, Report& report)
+{
+    ret_count = 0;
+    if (msgs == nullptr || max_count == 0) {
+        report.error(u"no buffer to receive UDP messages");
+        return false;
+    }
+
+    // Loop on unsollicited interrupts
+    for (;;) {
+
+        // Wait for at least one message.
+        const SocketErrorCode err = receiveMany(msgs, std::min(max_count, MAX_RECEIVE_BATCH), ret_count, report);
+
+        if (abort != nullptr && abort->aborting()) {
+            // Aborting, no error message.
+            ret_count = 0;
+            return false;
+        }
+        else if (err == SYS_SUCCESS) {
+            // Sometimes, we get "successful" empty message coming from nowhere. Ignore them.
+            size_t count = 0;
+            for (size_t i = 0; i < ret_count; ++i) {
+                if (msgs[i].size > 0 || msgs[i].sender.hasAddress()) {
+                    if (count < i) {
+                        std::swap(msgs[count], msgs[i]);
+                    }
+                    count++;
+                }
+            }
+            ret_count = count;
+            if (ret_count > 0) {
+                return true;
+            }
+        }
+        else if (abort != nullptr && abort->aborting()) {
+            // User-interrupt, end of processing but no error message
+            return false;
+        }
+#if !defined(TS_WINDOWS)
+        else if (err == EINTR) {
+            // Got a signal, not a user interrupt, will ignore it
+            report.debug(u"signal, not user interrupt");
+        }
+#endif
+        else {
+            // Abort on non-interrupt errors.
+            report.error(u"error receiving from UDP socket: %s", {SocketErrorCodeMessage(err)});
+            return false;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Perform one batch receive operation (at least one message).
+//----------------------------------------------------------------------------
+
+ts::SocketErrorCode ts::UDPSocket::receiveMany(ReceivedMessage* msgs, size_t max_count, size_t& ret_count, Report& report)
+{
+    ret_count = 0;
+
+#if defined(TS_LINUX)
+
+    // Size of ancillary data per message. We only need IP_PKTINFO.
+    const size_t control_size = CMSG_SPACE(sizeof(::in_pktinfo)) + 64;
+
+    // Allocate work areas the first time or when the batch becomes larger.
+    if (_mmsg_headers.size() < max_count) {
+        _mmsg_headers.resize(max_count);
+        _mmsg_vectors.resize(max_count);
+        _mmsg_senders.resize(max_count);
+        _mmsg_control.resize(max_count * control_size);
+    }
+
+    // Build the message headers.
+    for (size_t i = 0; i < max_count; ++i) {
+        TS_ZERO(_mmsg_headers[i]);
+        TS_ZERO(_mmsg_senders[i]);
+        _mmsg_vectors[i].iov_base = msgs[i].data;
+        _mmsg_vectors[i].iov_len = msgs[i].max_size;
+        ::msghdr& hdr(_mmsg_headers[i].msg_hdr);
+        hdr.msg_name = &_mmsg_senders[i];
+        hdr.msg_namelen = sizeof(::sockaddr);
+        hdr.msg_iov = &_mmsg_vectors[i];
+        hdr.msg_iovlen = 1;
+        hdr.msg_control = &_mmsg_control[i * control_size];
+        hdr.msg_controllen = control_size;
+    }
+
+    // Wait for the first message and get all other available ones without waiting.
+    const int count = ::recvmmsg(getSocket(), _mmsg_headers.data(), static_cast<unsigned int>(max_count), MSG_WAITFORONE, nullptr);
+    if (count < 0) {
+        return LastSocketErrorCode();
+    }
+    _recv_calls++;
+    _recv_messages += count;
+
+    // Analyze received messages.
+    for (size_t i = 0; i < size_t(count); ++i) {
+        ::msghdr& hdr(_mmsg_headers[i].msg_hdr);
+        msgs[i].size = _mmsg_headers[i].msg_len;
+        msgs[i].sender = SocketAddress(_mmsg_senders[i]);
+        msgs[i].destination.clear();
+        for (::cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+            if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_PKTINFO && cmsg->cmsg_len >= sizeof(::in_pktinfo)) {
+                const ::in_pktinfo* info = reinterpret_cast<const ::in_pktinfo*>(CMSG_DATA(cmsg));
+                msgs[i].destination = SocketAddress(info->ipi_addr, _local_address.port());
+            }
+        }
+    }
+    ret_count = size_t(count);
+    return SYS_SUCCESS;
+
+#else
+
+    // No batch reception on this operating system, receive one message.
+    const SocketErrorCode err = receiveOne(msgs[0].data, msgs[0].max_size, msgs[0].size, msgs[0].sender, msgs[0].destination, report);
+    if (err == SYS_SUCCESS) {
+        ret_count = 1;
+    }
+    return err;
+
+#endif
+}
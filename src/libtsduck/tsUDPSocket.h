@@ -291,6 +291,64 @@ namespace ts {
             return send(data, size, _default_destination, report);
         }
 
+        //!
+        //! Send a sequence of messages to a destination address and port in one operation.
+        //!
+        //! The data area is split into consecutive messages of @a msg_size bytes (the last
+        //! message may be shorter). On Linux, all messages are sent using as few system calls
+        //! as possible (@c sendmmsg), using UDP Generic Segmentation Offload (GSO) when the
+        //! kernel supports it and GSO is not disabled. On other operating systems, the messages
+        //! are sent one by one.
+        //!
+        //! @param [in] data Address of the messages to send.
+        //! @param [in] size Total size in bytes of the messages to send.
+        //! @param [in] msg_size Size in bytes of each message.
+        //! @param [in] destination Socket address of the destination.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        virtual bool sendBatch(const void* data, size_t size, size_t msg_size, const SocketAddress& destination, Report& report = CERR);
+
+        //!
+        //! Send a sequence of messages to the default destination address and port in one operation.
+        //!
+        //! @param [in] data Address of the messages to send.
+        //! @param [in] size Total size in bytes of the messages to send.
+        //! @param [in] msg_size Size in bytes of each message.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //! @see sendBatch(const void*, size_t, size_t, const SocketAddress&, Report&)
+        //!
+        bool sendBatch(const void* data, size_t size, size_t msg_size, Report& report = CERR)
+        {
+            return sendBatch(data, size, msg_size, _default_destination, report);
+        }
+
+        //!
+        //! Enable or disable UDP Generic Segmentation Offload (GSO) in sendBatch().
+        //!
+        //! With GSO, several messages are passed to the kernel as one single large buffer
+        //! and the segmentation is performed as late as possible, possibly by the network
+        //! adapter. GSO is enabled by default and is automatically disabled when the kernel
+        //! does not support it. GSO is currently supported on Linux only.
+        //!
+        //! @param [in] on If true, use GSO when possible.
+        //!
+        void setGSO(bool on) { _use_gso = on; }
+
+        //!
+        //! Get the number of send system calls since the socket was opened.
+        //! Used with sentMessageCount() to evaluate the number of messages per system call.
+        //! @return The number of send system calls.
+        //!
+        uint64_t sendCallCount() const { return _send_calls; }
+
+        //!
+        //! Get the number of sent messages since the socket was opened.
+        //! @return The number of sent messages.
+        //!
+        uint64_t sentMessageCount() const { return _send_messages; }
+
         //!
         //! Receive a message.
         //!
@@ -314,6 +372,76 @@ namespace ts {
                              const AbortInterface* abort = nullptr,
                              Report& report = CERR);
 
+        //!
+        //! Description of one message in a batch of received messages.
+        //! @see receiveBatch()
+        //!
+        struct TSDUCKDLL ReceivedMessage
+        {
+            void*         data;         //!< [in] Address of the buffer for the received message.
+            size_t        max_size;     //!< [in] Size in bytes of the reception buffer.
+            size_t        size;         //!< [out] Size in bytes of the received message, never larger than @a max_size.
+            SocketAddress sender;       //!< [out] Socket address of the sender.
+            SocketAddress destination;  //!< [out] Socket address of the packet destination.
+
+            //!
+            //! Constructor.
+            //! @param [in] data_ Address of the buffer for the received message.
+            //! @param [in] max_size_ Size in bytes of the reception buffer.
+            //!
+            ReceivedMessage(void* data_ = nullptr, size_t max_size_ = 0) :
+                data(data_),
+                max_size(max_size_),
+                size(0),
+                sender(),
+                destination()
+            {
+            }
+        };
+
+        //!
+        //! Receive a batch of messages.
+        //!
+        //! The method waits for at least one message and then returns all messages
+        //! which are immediately available, up to @a max_count, without waiting
+        //! for more. On Linux, all messages are received in one system call
+        //! (@c recvmmsg). On other operating systems, one message is received.
+        //!
+        //! @param [in,out] msgs Array of @a max_count message descriptions. On input,
+        //! the buffer of each message must be specified. On output, the first @a ret_count
+        //! elements describe the received messages. A subclass which filters messages
+        //! may reorder the elements of the array (including their buffers).
+        //! @param [in] max_count Number of elements in @a msgs.
+        //! @param [out] ret_count Number of received messages.
+        //! @param [in] abort If non-zero, invoked when I/O is interrupted
+        //! (in case of user-interrupt, return, otherwise retry).
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        virtual bool receiveBatch(ReceivedMessage* msgs,
+                                  size_t max_count,
+                                  size_t& ret_count,
+                                  const AbortInterface* abort = nullptr,
+                                  Report& report = CERR);
+
+        //!
+        //! Get the number of receive system calls since the socket was opened.
+        //! Used with receivedMessageCount() to evaluate the number of messages per system call.
+        //! @return The number of receive system calls.
+        //!
+        uint64_t receiveCallCount() const { return _recv_calls; }
+
+        //!
+        //! Get the number of received messages since the socket was opened.
+        //! @return The number of received messages.
+        //!
+        uint64_t receivedMessageCount() const { return _recv_messages; }
+
+        //!
+        //! Maximum number of messages in one call to receiveBatch().
+        //!
+        static const size_t MAX_RECEIVE_BATCH = 1024;
+
         // Implementation of Socket interface.
         virtual bool open(Report& report = CERR) override;
         virtual bool close(Report& report = CERR) override;
@@ -373,10 +501,29 @@ namespace ts {
         SocketAddress _default_destination;
         MReqSet       _mcast;    // Current set of multicast memberships
         SSMReqSet     _ssmcast;  // Current set of source-specific multicast memberships
+        uint64_t      _recv_calls;     // Number of receive system calls.
+        uint64_t      _recv_messages;  // Number of received messages.
+        uint64_t      _send_calls;     // Number of send system calls.
+        uint64_t      _send_messages;  // Number of sent messages.
+        bool          _use_gso;        // Use UDP generic segmentation offload in sendBatch().
+
+#if defined(TS_LINUX)
+        // Work areas for recvmmsg(), kept from one call to another.
+        std::vector<::mmsghdr>  _mmsg_headers;
+        std::vector<::iovec>    _mmsg_vectors;
+        std::vector<::sockaddr> _mmsg_senders;
+        std::vector<uint8_t>    _mmsg_control;
+        std::vector<::mmsghdr>  _smsg_headers;
+        std::vector<::iovec>    _smsg_vectors;
+        std::vector<uint8_t>    _smsg_control;
+#endif
 
         // Perform one receive operation. Hide the system mud.
         SocketErrorCode receiveOne(void* data, size_t max_size, size_t& ret_size, SocketAddress& sender, SocketAddress& destination, Report& report);
 
+        // Perform one batch receive operation (at least one message).
+        SocketErrorCode receiveMany(ReceivedMessage* msgs, size_t max_count, size_t& ret_count, Report& report);
+
         // Furiously idiotic Windows feature, see comment in receiveOne()
 #if defined(TS_WINDOWS)
         static volatile ::LPFN_WSARECVMSG _wsaRevcMsg;
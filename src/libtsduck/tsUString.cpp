@@ -54,6 +54,84 @@ const ts::UString ts::UString::DEFAULT_THOUSANDS_SEPARATOR(1, u',');
 const ts::UString ts::UString::EMPTY;
 
 
+//----------------------------------------------------------------------------
+// Fast paths for runs of ASCII characters.
+//
+// On x86_64, SSE2 is always available. Blocks of 16 characters are checked
+// and converted at once. The last partial block is converted one character
+// at a time, up to the first non-ASCII character.
+//----------------------------------------------------------------------------
+
+#if defined(TS_X86_64) && (defined(TS_GCC) || defined(TS_MSC))
+#define TS_UTF_SSE2 1
+#if defined(TS_MSC)
+#include <intrin.h>
+#else
+#include <emmintrin.h>
+#endif
+#endif
+
+namespace {
+    // Convert a run of ASCII characters from 8-bit to UTF-16, return the number of converted characters.
+    size_t WidenASCII(const char* in, size_t inSize, ts::UChar* out, size_t outSize, char minChar, char maxChar)
+    {
+        const size_t size = std::min(inSize, outSize);
+        size_t count = 0;
+#if defined(TS_UTF_SSE2)
+        // Signed comparisons: bytes 0x80-0xFF are negative and always out of range.
+        const __m128i low = _mm_set1_epi8(char(minChar - 1));
+        const __m128i high = _mm_set1_epi8(maxChar);
+        const __m128i zero = _mm_setzero_si128();
+        for (; count + 16 <= size; count += 16) {
+            const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + count));
+            const __m128i valid = _mm_andnot_si128(_mm_cmpgt_epi8(data, high), _mm_cmpgt_epi8(data, low));
+            if (_mm_movemask_epi8(valid) != 0xFFFF) {
+                break;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + count), _mm_unpacklo_epi8(data, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + count + 8), _mm_unpackhi_epi8(data, zero));
+        }
+#endif
+        for (; count < size && in[count] >= minChar && in[count] <= maxChar; ++count) {
+            out[count] = ts::UChar(in[count]);
+        }
+        return count;
+    }
+
+    // Convert a run of ASCII characters from UTF-16 to 8-bit, return the number of converted characters.
+    size_t NarrowASCII(const ts::UChar* in, size_t inSize, char* out, size_t outSize)
+    {
+        const size_t size = std::min(inSize, outSize);
+        size_t count = 0;
+#if defined(TS_UTF_SSE2)
+        const __m128i nonASCII = _mm_set1_epi16(short(0xFF80));
+        const __m128i zero = _mm_setzero_si128();
+        for (; count + 16 <= size; count += 16) {
+            const __m128i data1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + count));
+            const __m128i data2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + count + 8));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(data1, data2), nonASCII), zero)) != 0xFFFF) {
+                break;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + count), _mm_packus_epi16(data1, data2));
+        }
+#endif
+        for (; count < size && in[count] < 0x80; ++count) {
+            out[count] = char(in[count]);
+        }
+        return count;
+    }
+}
+
+void ts::UString::ConvertASCIIToUTF16(const char*& inStart, const char* inEnd, UChar*& outStart, UChar* outEnd, char minChar, char maxChar)
+{
+    if (inStart < inEnd && outStart < outEnd) {
+        const size_t count = WidenASCII(inStart, inEnd - inStart, outStart, outEnd - outStart, minChar, maxChar);
+        inStart += count;
+        outStart += count;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // General routine to convert from UTF-16 to UTF-8.
 //----------------------------------------------------------------------------
@@ -113,6 +191,12 @@ void ts::UString::ConvertUTF16ToUTF8(const UChar*& inStart, const UChar* inEnd,
             if (code < 0x0080) {
                 // ASCII compatible value, one byte encoding.
                 *outStart++ = char(code);
+                // Convert the following ASCII characters at once.
+                if (inStart < inEnd && *inStart < 0x80 && outStart < outEnd) {
+                    const size_t count = NarrowASCII(inStart, inEnd - inStart, outStart, outEnd - outStart);
+                    inStart += count;
+                    outStart += count;
+                }
             }
             else if (code < 0x800 && outStart + 1 < outEnd) {
                 // 2 bytes encoding.
@@ -186,6 +270,12 @@ void ts::UString::ConvertUTF8ToUTF16(const char*& inStart, const char* inEnd, UC
         if (code < 0x80) {
             // 0xxx xxxx, ASCII compatible value, one byte encoding.
             *outStart++ = uint16_t(code);
+            // Convert the following ASCII characters at once.
+            if (inStart < inEnd && (*inStart & 0x80) == 0 && outStart < outEnd) {
+                const size_t count = WidenASCII(inStart, inEnd - inStart, outStart, outEnd - outStart, 0x00, 0x7F);
+                inStart += count;
+                outStart += count;
+            }
         }
         else if ((code & 0xE0) == 0xC0) {
             // 110x xxx, 2 byte encoding.
@@ -326,8 +416,9 @@ ts::UString& ts::UString::assignFromUTF8(const char* utf8, size_type count)
 
 void ts::UString::toUTF8(std::string& utf8) const
 {
-    // The maximum number of UTF-8 bytes is 1.5 times the number of UTF-16 codes.
-    utf8.resize(2 * size());
+    // The maximum number of UTF-8 bytes is 3 times the number of UTF-16 codes
+    // (3 bytes for one code, 4 bytes for a surrogate pair of 2 codes).
+    utf8.resize(3 * size());
 
     const UChar* inStart = data();
     char* outStart = const_cast<char*>(utf8.data());
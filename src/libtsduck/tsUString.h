@@ -470,6 +470,22 @@ namespace ts {
         //!
         static void ConvertUTF8ToUTF16(const char*& inStart, const char* inEnd, UChar*& outStart, UChar* outEnd);
 
+        //!
+        //! Convert a run of ASCII characters into UTF-16.
+        //! This is a fast path for UTF-8 and DVB character sets where ASCII characters are encoded as is.
+        //! Stop on the first byte outside the range @a minChar to @a maxChar, when the input buffer
+        //! is empty or when the output buffer is full, whichever comes first.
+        //! @param [in,out] inStart Address of the input 8-bit buffer to convert.
+        //! Updated upon return to point after the last converted character.
+        //! @param [in] inEnd Address after the end of the input 8-bit buffer.
+        //! @param [in,out] outStart Address of the output UTF-16 buffer to fill.
+        //! Updated upon return to point after the last converted character.
+        //! @param [in] outEnd Address after the end of the output UTF-16 buffer to fill.
+        //! @param [in] minChar Lowest character to convert. Must be in the range 0x00 to 0x7F.
+        //! @param [in] maxChar Highest character to convert. Must be in the range 0x00 to 0x7F.
+        //!
+        static void ConvertASCIIToUTF16(const char*& inStart, const char* inEnd, UChar*& outStart, UChar* outEnd, char minChar = 0x00, char maxChar = 0x7F);
+
         //!
         //! Convert a DVB string into UTF-16.
         //! @param [in] dvb A string in DVB representation.
@@ -67,6 +67,7 @@ ts::WebRequest::WebRequest(Report& report) :
     _dlData(nullptr),
     _dlFile(),
     _dlHandler(nullptr),
+    _abort(nullptr),
     _interrupted(false),
     _guts(nullptr)
 {
@@ -281,6 +282,10 @@ void ts::WebRequest::processReponseHeaders(const UString& text)
 
 bool ts::WebRequest::copyData(const void* addr, size_t size)
 {
+    if (checkAbort()) {
+        return false;
+    }
+
     // Copy data in memory buffer if there is one.
     if (_dlData != nullptr) {
         // Check maximum buffer size.
@@ -320,6 +325,22 @@ bool ts::WebRequest::copyData(const void* addr, size_t size)
 }
 
 
+//----------------------------------------------------------------------------
+// Check if the transfer shall be interrupted by the abort interface.
+//----------------------------------------------------------------------------
+
+bool ts::WebRequest::checkAbort()
+{
+    if (_abort != nullptr && _abort->aborting()) {
+        if (!_interrupted) {
+            _report.debug(u"Web transfer is interrupted by application");
+        }
+        _interrupted = true;
+    }
+    return _interrupted;
+}
+
+
 //----------------------------------------------------------------------------
 // Provide possible total download size.
 //----------------------------------------------------------------------------
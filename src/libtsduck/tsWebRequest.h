@@ -35,6 +35,7 @@
 #pragma once
 #include "tsWebRequestHandlerInterface.h"
 #include "tsWebRequestArgs.h"
+#include "tsAbortInterface.h"
 #include "tsReport.h"
 #include "tsByteBlock.h"
 #include "tsUString.h"
@@ -148,6 +149,18 @@ namespace ts {
             _userAgent = name;
         }
 
+        //!
+        //! Set an abort interface which is checked during the transfers.
+        //! When the abort interface reports that the application is aborting,
+        //! the current transfer is interrupted, even when no data are received.
+        //! @param [in] abort An object which is polled during transfers. Must remain
+        //! valid during the transfers. Use a null pointer to remove it.
+        //!
+        void setAbortInterface(const AbortInterface* abort)
+        {
+            _abort = abort;
+        }
+
         //!
         //! Enable or disable the automatic redirection of HTTP requests.
         //! This option is active by default.
@@ -284,7 +297,8 @@ namespace ts {
         ByteBlock*    _dlData;                   // download data buffer
         std::ofstream _dlFile;                   // download file
         WebRequestHandlerInterface* _dlHandler;  // application-defined handler
-        volatile bool _interrupted;              // interrupted by application-defined handler
+        const AbortInterface* _abort;            // application-defined abort interface
+        volatile bool _interrupted;              // interrupted by application
         SystemGuts*   _guts;                     // system-specific data
 
         static UString  _defaultProxyHost;
@@ -299,6 +313,9 @@ namespace ts {
         // Perform initialization before any download.
         bool downloadInitialize();
 
+        // Check if the transfer shall be interrupted by the abort interface.
+        bool checkAbort();
+
         // Close or abort initialized download.
         void downloadClose();
 
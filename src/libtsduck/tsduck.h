@@ -189,9 +189,11 @@
 #include "tshlsMediaPlayList.h"
 #include "tshlsMediaSegment.h"
 #include "tshlsPlayList.h"
+#include "tshlsPrefetchBuffer.h"
 #include "tshlsTagAttributes.h"
 #include "tsIBPDescriptor.h"
 #include "tsIDSA.h"
+#include "tsIndexedSectionFile.h"
 #include "tsInputRedirector.h"
 #include "tsINT.h"
 #include "tsIntegerUtils.h"
@@ -261,6 +263,7 @@
 #include "tsPESDemux.h"
 #include "tsPESHandlerInterface.h"
 #include "tsPESPacket.h"
+#include "tsPIDMap.h"
 #include "tsPIDOperator.h"
 #include "tsPlatform.h"
 #include "tsPlugin.h"
@@ -315,6 +318,7 @@
 #include "tsSHA256.h"
 #include "tsSHA512.h"
 #include "tsSharedLibrary.h"
+#include "tsSharedPacketRing.h"
 #include "tsShortEventDescriptor.h"
 #include "tsSimpleApplicationBoundaryDescriptor.h"
 #include "tsSimpleApplicationLocationDescriptor.h"
@@ -411,10 +415,13 @@
 #include "tsTSAnalyzer.h"
 #include "tsTSAnalyzerOptions.h"
 #include "tsTSAnalyzerReport.h"
+#include "tsTSAnalyzerSnapshot.h"
 #include "tsTSDT.h"
+#include "tsTSFileIndex.h"
 #include "tsTSFileInput.h"
 #include "tsTSFileInputBuffered.h"
 #include "tsTSFileOutput.h"
+#include "tsTSFileOutputArgs.h"
 #include "tsTSFileOutputResync.h"
 #include "tsTSPacket.h"
 #include "tsTSPacketQueue.h"
@@ -457,6 +464,7 @@
 #include "tsxmlDocument.h"
 #include "tsxmlElement.h"
 #include "tsxmlNode.h"
+#include "tsxmlPullParser.h"
 #include "tsxmlText.h"
 #include "tsxmlTweaks.h"
 #include "tsxmlTweaksArgs.h"
@@ -56,6 +56,12 @@ const ts::Enumeration ts::hls::TagNames({
     {u"EXT-X-INDEPENDENT-SEGMENTS",   ts::hls::INDEPENDENT_SEGMENTS},
     {u"EXT-X-START",                  ts::hls::START},
     {u"EXT-X-DEFINE",                 ts::hls::DEFINE},
+    {u"EXT-X-SERVER-CONTROL",         ts::hls::SERVER_CONTROL},
+    {u"EXT-X-PART-INF",               ts::hls::PART_INF},
+    {u"EXT-X-PART",                   ts::hls::PART},
+    {u"EXT-X-PRELOAD-HINT",           ts::hls::PRELOAD_HINT},
+    {u"EXT-X-RENDITION-REPORT",       ts::hls::RENDITION_REPORT},
+    {u"EXT-X-SKIP",                   ts::hls::SKIP},
 });
 
 
@@ -90,6 +96,12 @@ namespace {
         {ts::hls::INDEPENDENT_SEGMENTS,   ts::hls::TAG_MASTER | ts::hls::TAG_MEDIA},
         {ts::hls::START,                  ts::hls::TAG_MASTER | ts::hls::TAG_MEDIA},
         {ts::hls::DEFINE,                 ts::hls::TAG_MASTER | ts::hls::TAG_MEDIA},
+        {ts::hls::SERVER_CONTROL,         ts::hls::TAG_MEDIA},
+        {ts::hls::PART_INF,               ts::hls::TAG_MEDIA},
+        {ts::hls::PART,                   ts::hls::TAG_MEDIA},
+        {ts::hls::PRELOAD_HINT,           ts::hls::TAG_MEDIA},
+        {ts::hls::RENDITION_REPORT,       ts::hls::TAG_MEDIA},
+        {ts::hls::SKIP,                   ts::hls::TAG_MEDIA},
     });
 }
 
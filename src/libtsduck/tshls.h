@@ -96,6 +96,15 @@ namespace ts {
             INDEPENDENT_SEGMENTS,    //!< \#EXT-X-INDEPENDENT-SEGMENTS
             START,                   //!< \#EXT-X-START:attribute-list
             DEFINE,                  //!< \#EXT-X-DEFINE:attribute-list
+            //
+            // Low-latency HLS extensions, media playlists only.
+            //
+            SERVER_CONTROL,          //!< \#EXT-X-SERVER-CONTROL:attribute-list
+            PART_INF,                //!< \#EXT-X-PART-INF:attribute-list
+            PART,                    //!< \#EXT-X-PART:attribute-list - partial segment.
+            PRELOAD_HINT,            //!< \#EXT-X-PRELOAD-HINT:attribute-list
+            RENDITION_REPORT,        //!< \#EXT-X-RENDITION-REPORT:attribute-list
+            SKIP,                    //!< \#EXT-X-SKIP:attribute-list
         };
 
         //!
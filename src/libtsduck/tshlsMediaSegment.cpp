@@ -40,6 +40,9 @@ ts::hls::MediaSegment::MediaSegment() :
     title(),
     duration(0),
     bitrate(0),
-    gap(false)
+    gap(false),
+    byteOffset(0),
+    byteSize(0),
+    independent(false)
 {
 }
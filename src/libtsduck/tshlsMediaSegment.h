@@ -51,11 +51,14 @@ namespace ts {
             MediaSegment();
 
             // Public fields.
-            UString     uri;       //!< Relative URI of segment.
-            UString     title;     //!< Optional segment title.
-            MilliSecond duration;  //!< Segment duration in milliseconds.
-            BitRate     bitrate;   //!< Indicative bitrate.
-            bool        gap;       //!< Media is a "gap", should not be loaded by clients.
+            UString     uri;          //!< Relative URI of segment.
+            UString     title;        //!< Optional segment title.
+            MilliSecond duration;     //!< Segment duration in milliseconds.
+            BitRate     bitrate;      //!< Indicative bitrate.
+            bool        gap;          //!< Media is a "gap", should not be loaded by clients.
+            uint64_t    byteOffset;   //!< Offset of the media in the resource at @a uri, meaningful when @a byteSize is not zero.
+            uint64_t    byteSize;     //!< Size of the media in the resource at @a uri, zero means the complete resource.
+            bool        independent;  //!< Partial segment only: the media starts with an independent frame.
         };
     }
 }
@@ -50,6 +50,8 @@ ts::hls::PlayList::PlayList() :
     _endList(false),
     _playlistType(),
     _segments(),
+    _parts(),
+    _partDuration(0),
     _playlists()
 {
 }
@@ -132,6 +134,157 @@ const ts::hls::MediaPlayList& ts::hls::PlayList::playList(size_t index) const
 }
 
 
+//----------------------------------------------------------------------------
+// Reset the playlist to build a new one.
+//----------------------------------------------------------------------------
+
+void ts::hls::PlayList::reset(PlayListType type, const UString& filename, int version)
+{
+    clear();
+    _valid = true;
+    _version = version;
+    _type = type;
+    _url = filename;
+    _urlBase = DirectoryName(filename) + PathSeparator;
+    _isURL = false;
+}
+
+
+//----------------------------------------------------------------------------
+// Add a media segment or a partial segment.
+//----------------------------------------------------------------------------
+
+bool ts::hls::PlayList::addSegment(const MediaSegment& seg, Report& report)
+{
+    if (!setType(MEDIA_PLAYLIST, report)) {
+        return false;
+    }
+    _segments.push_back(seg);
+    _parts.clear();
+    return true;
+}
+
+bool ts::hls::PlayList::addPart(const MediaSegment& part, Report& report)
+{
+    if (!setType(MEDIA_PLAYLIST, report)) {
+        return false;
+    }
+    _parts.push_back(part);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Build the text content of the playlist.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Format a duration in milliseconds as a decimal number of seconds.
+    ts::UString MilliToString(ts::MilliSecond ms)
+    {
+        return ts::UString::Format(u"%d.%03d", {ms / 1000, ms % 1000});
+    }
+}
+
+ts::UString ts::hls::PlayList::textContent(Report& report) const
+{
+    if (_type != MEDIA_PLAYLIST) {
+        report.error(u"only media playlists can be generated");
+        return UString();
+    }
+
+    // Global tags.
+    UString text(u"#EXTM3U\n");
+    text += UString::Format(u"#EXT-X-VERSION:%d\n", {_version});
+    text += UString::Format(u"#EXT-X-TARGETDURATION:%d\n", {_targetDuration});
+    text += UString::Format(u"#EXT-X-MEDIA-SEQUENCE:%d\n", {_mediaSequence});
+    if (!_playlistType.empty()) {
+        text += UString::Format(u"#EXT-X-PLAYLIST-TYPE:%s\n", {_playlistType});
+    }
+    if (_partDuration > 0) {
+        // Low-latency HLS: recommended hold back is three times the part target duration.
+        text += UString::Format(u"#EXT-X-SERVER-CONTROL:PART-HOLD-BACK=%s\n", {MilliToString(3 * _partDuration)});
+        text += UString::Format(u"#EXT-X-PART-INF:PART-TARGET=%s\n", {MilliToString(_partDuration)});
+    }
+
+    // Complete media segments.
+    for (auto it = _segments.begin(); it != _segments.end(); ++it) {
+        if (it->gap) {
+            text += u"#EXT-X-GAP\n";
+        }
+        if (it->bitrate > 0) {
+            text += UString::Format(u"#EXT-X-BITRATE:%d\n", {it->bitrate / 1024});
+        }
+        text += UString::Format(u"#EXTINF:%s,%s\n", {MilliToString(it->duration), it->title});
+        if (it->byteSize > 0) {
+            text += UString::Format(u"#EXT-X-BYTERANGE:%d@%d\n", {it->byteSize, it->byteOffset});
+        }
+        text += it->uri;
+        text += u"\n";
+    }
+
+    // Partial segments of the segment in progress.
+    for (auto it = _parts.begin(); it != _parts.end(); ++it) {
+        text += UString::Format(u"#EXT-X-PART:DURATION=%s,URI=\"%s\"", {MilliToString(it->duration), it->uri});
+        if (it->byteSize > 0) {
+            text += UString::Format(u",BYTERANGE=\"%d@%d\"", {it->byteSize, it->byteOffset});
+        }
+        if (it->independent) {
+            text += u",INDEPENDENT=YES";
+        }
+        text += u"\n";
+    }
+
+    if (_endList) {
+        text += u"#EXT-X-ENDLIST\n";
+    }
+    return text;
+}
+
+
+//----------------------------------------------------------------------------
+// Save the playlist in a text file.
+//----------------------------------------------------------------------------
+
+bool ts::hls::PlayList::saveFile(const UString& filename, Report& report) const
+{
+    // The default file name must not be a URL.
+    const UString name(filename.empty() && !_isURL ? _url : filename);
+    if (name.empty()) {
+        report.error(u"no file name specified to save the HLS playlist");
+        return false;
+    }
+
+    const UString text(textContent(report));
+    if (text.empty()) {
+        return false;
+    }
+
+    // Write a temporary file first.
+    const UString tmpName(name + u".tmp");
+    std::ofstream file(tmpName.toUTF8().c_str(), std::ios::out | std::ios::binary);
+    file << text;
+    file.close();
+    if (!file) {
+        report.error(u"error writing %s", {tmpName});
+        DeleteFile(tmpName);
+        return false;
+    }
+
+    // Then replace the playlist file. On Windows, an existing file cannot be replaced by a rename.
+    ErrorCode err = RenameFile(tmpName, name);
+    if (err != SYS_SUCCESS && FileExists(name) && DeleteFile(name) == SYS_SUCCESS) {
+        err = RenameFile(tmpName, name);
+    }
+    if (err != SYS_SUCCESS) {
+        report.error(u"error renaming %s to %s: %s", {tmpName, name, ErrorCodeMessage(err)});
+        DeleteFile(tmpName);
+        return false;
+    }
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Select a media playlist with specific constraints.
 //----------------------------------------------------------------------------
@@ -485,6 +638,17 @@ bool ts::hls::PlayList::parse(const UStringList& lines, bool strict, Report& rep
                     segNext.gap = true;
                     break;
                 }
+                case BYTERANGE: {
+                    // #EXT-X-BYTERANGE:<n>[@<o>]
+                    // Without offset, the sub-range starts after the previous one.
+                    const size_t at = tagParams.find(u"@");  // can be NPOS
+                    segNext.byteOffset = _segments.empty() ? 0 : _segments.back().byteOffset + _segments.back().byteSize;
+                    if (!tagParams.substr(0, at).toInteger(segNext.byteSize) || (at != NPOS && !tagParams.substr(at + 1).toInteger(segNext.byteOffset))) {
+                        report.error(u"invalid byte range in %s", {line});
+                        _valid = false;
+                    }
+                    break;
+                }
                 case TARGETDURATION: {
                     // #EXT-X-TARGETDURATION:s
                     if (!tagParams.toInteger(_targetDuration) && strict) {
@@ -525,7 +689,6 @@ bool ts::hls::PlayList::parse(const UStringList& lines, bool strict, Report& rep
                     break;
                 }
                 case MEDIA:
-                case BYTERANGE:
                 case DISCONTINUITY:
                 case KEY:
                 case MAP:
@@ -539,6 +702,12 @@ bool ts::hls::PlayList::parse(const UStringList& lines, bool strict, Report& rep
                 case INDEPENDENT_SEGMENTS:
                 case START:
                 case DEFINE:
+                case SERVER_CONTROL:
+                case PART_INF:
+                case PART:
+                case PRELOAD_HINT:
+                case RENDITION_REPORT:
+                case SKIP:
                     // Currently ignored tags.
                     break;
                 default:
@@ -190,6 +190,92 @@ namespace ts {
             //!
             bool popFirstSegment(MediaSegment& seg);
 
+            //!
+            //! Reset the playlist to build a new one.
+            //! This is typically used to generate a playlist using addSegment() and saveFile().
+            //! @param [in] type Playlist type. Only media playlists can currently be generated.
+            //! @param [in] filename File name of the playlist.
+            //! @param [in] version Playlist format version (EXT-X-VERSION).
+            //!
+            void reset(PlayListType type, const UString& filename, int version = 3);
+
+            //!
+            //! Set the segment target duration (in media playlist).
+            //! @param [in] duration The segment target duration in seconds.
+            //!
+            void setTargetDuration(Second duration) { _targetDuration = duration; }
+
+            //!
+            //! Set the sequence number of first segment (in media playlist).
+            //! @param [in] seq The sequence number of first segment.
+            //!
+            void setMediaSequence(size_t seq) { _mediaSequence = seq; }
+
+            //!
+            //! Set the end of list indicator (in media playlist).
+            //! @param [in] end The end of list indicator.
+            //!
+            void setEndList(bool end) { _endList = end; }
+
+            //!
+            //! Set the media playlist type ("EVENT" or "VOD", in media playlist).
+            //! @param [in] type The media playlist type. Empty for a live playlist.
+            //!
+            void setPlaylistType(const UString& type) { _playlistType = type; }
+
+            //!
+            //! Get the target duration of partial segments (low-latency HLS, in media playlist).
+            //! @return The target duration of partial segments in milliseconds, zero if there is none.
+            //!
+            MilliSecond partTargetDuration() const { return _partDuration; }
+
+            //!
+            //! Set the target duration of partial segments (low-latency HLS, in media playlist).
+            //! @param [in] duration The target duration of partial segments in milliseconds, zero if there is none.
+            //!
+            void setPartTargetDuration(MilliSecond duration) { _partDuration = duration; }
+
+            //!
+            //! Add a media segment at the end of a media playlist.
+            //! All partial segments are removed, they are supposed to be part of the new segment.
+            //! @param [in] seg Characteristics of the new segment.
+            //! @param [in,out] report Where to report errors.
+            //! @return True on success, false on error.
+            //!
+            bool addSegment(const MediaSegment& seg, Report& report = CERR);
+
+            //!
+            //! Add a partial segment of the media segment in progress (low-latency HLS, in media playlist).
+            //! Partial segments are listed after the last complete segment.
+            //! @param [in] part Characteristics of the new partial segment.
+            //! @param [in,out] report Where to report errors.
+            //! @return True on success, false on error.
+            //!
+            bool addPart(const MediaSegment& part, Report& report = CERR);
+
+            //!
+            //! Get the number of partial segments of the media segment in progress.
+            //! @return The number of partial segments.
+            //!
+            size_t partCount() const { return _parts.size(); }
+
+            //!
+            //! Build the text content of the playlist.
+            //! @param [in,out] report Where to report errors.
+            //! @return The text content of the playlist (multi-lines), empty on error.
+            //!
+            UString textContent(Report& report = CERR) const;
+
+            //!
+            //! Save the playlist in a text file.
+            //! The file is first written under a temporary name and then renamed.
+            //! This way, a client which concurrently reloads the playlist never gets a partial content.
+            //! @param [in] filename File name. If empty, use the file name of the playlist.
+            //! @param [in,out] report Where to report errors.
+            //! @return True on success, false on error.
+            //!
+            bool saveFile(const UString& filename = UString(), Report& report = CERR) const;
+
             //!
             //! Get a constant reference to a media playlist description (in master playlist).
             //! @param [in] index Index of the playlist, from 0 to playListCount().
@@ -258,6 +344,8 @@ namespace ts {
             bool               _endList;         // End of list indicator (media playlist).
             UString            _playlistType;    // Media playlist type ("EVENT" or "VOD", media playlist).
             MediaSegmentQueue  _segments;        // List of media segments (media playlist).
+            MediaSegmentQueue  _parts;           // Partial segments of the segment in progress (media playlist).
+            MilliSecond        _partDuration;    // Target duration of partial segments (media playlist).
             MediaPlayListQueue _playlists;       // List of media playlists (master playlist).
 
             // Empty data to return.
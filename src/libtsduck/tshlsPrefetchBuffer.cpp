@@ -0,0 +1,221 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tshlsPrefetchBuffer.h"
+#include "tsGuard.h"
+#include "tsGuardCondition.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Constructors.
+//----------------------------------------------------------------------------
+
+ts::hls::PrefetchBuffer::Segment::Segment(size_t i, const UString& u) :
+    index(i),
+    url(u),
+    status(SEG_PENDING),
+    data(),
+    mime(),
+    duration(0)
+{
+}
+
+ts::hls::PrefetchBuffer::PrefetchBuffer(size_t capacity) :
+    AbortInterface(),
+    _mutex(),
+    _work_cond(),
+    _ready_cond(),
+    _room_cond(),
+    _segments(),
+    _capacity(std::max<size_t>(1, capacity)),
+    _next_index(0),
+    _terminate(false),
+    _end(false)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Clear the buffer and restart a new session.
+//----------------------------------------------------------------------------
+
+void ts::hls::PrefetchBuffer::reset(size_t capacity)
+{
+    Guard lock(_mutex);
+    _segments.clear();
+    _capacity = std::max<size_t>(1, capacity);
+    _next_index = 0;
+    _terminate = false;
+    _end = false;
+}
+
+
+//----------------------------------------------------------------------------
+// Buffer state.
+//----------------------------------------------------------------------------
+
+size_t ts::hls::PrefetchBuffer::size() const
+{
+    Guard lock(_mutex);
+    return _segments.size();
+}
+
+size_t ts::hls::PrefetchBuffer::loadedCount() const
+{
+    Guard lock(_mutex);
+    size_t count = 0;
+    for (SegmentQueue::const_iterator it = _segments.begin(); it != _segments.end(); ++it) {
+        if ((*it)->status == SEG_LOADED) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool ts::hls::PrefetchBuffer::terminated() const
+{
+    Guard lock(_mutex);
+    return _terminate;
+}
+
+bool ts::hls::PrefetchBuffer::aborting() const
+{
+    return terminated();
+}
+
+
+//----------------------------------------------------------------------------
+// Producer side.
+//----------------------------------------------------------------------------
+
+size_t ts::hls::PrefetchBuffer::waitRoom()
+{
+    GuardCondition lock(_mutex, _room_cond);
+    while (!_terminate && _segments.size() >= _capacity) {
+        lock.waitCondition();
+    }
+    return _terminate ? 0 : _capacity - _segments.size();
+}
+
+void ts::hls::PrefetchBuffer::push(const UString& url)
+{
+    GuardCondition lock(_mutex, _work_cond);
+    _segments.push_back(new Segment(_next_index++, url));
+    lock.signal();
+}
+
+void ts::hls::PrefetchBuffer::setEnd()
+{
+    GuardCondition lock(_mutex, _ready_cond);
+    _end = true;
+    lock.signal();
+}
+
+
+//----------------------------------------------------------------------------
+// Download threads.
+//----------------------------------------------------------------------------
+
+ts::hls::PrefetchBuffer::SegmentPtr ts::hls::PrefetchBuffer::nextPending()
+{
+    GuardCondition lock(_mutex, _work_cond);
+    for (;;) {
+        if (_terminate) {
+            // Wake up the next download thread so that it terminates as well.
+            lock.signal();
+            return SegmentPtr();
+        }
+        for (SegmentQueue::const_iterator it = _segments.begin(); it != _segments.end(); ++it) {
+            if ((*it)->status == SEG_PENDING) {
+                (*it)->status = SEG_LOADING;
+                return *it;
+            }
+        }
+        lock.waitCondition();
+    }
+}
+
+void ts::hls::PrefetchBuffer::completed(const SegmentPtr& seg, bool success)
+{
+    GuardCondition lock(_mutex, _ready_cond);
+    seg->status = success ? SEG_LOADED : SEG_FAILED;
+    lock.signal();
+}
+
+
+//----------------------------------------------------------------------------
+// Consumer side.
+//----------------------------------------------------------------------------
+
+ts::hls::PrefetchBuffer::SegmentPtr ts::hls::PrefetchBuffer::pop(MilliSecond timeout, bool& end)
+{
+    GuardCondition lock(_mutex, _ready_cond);
+
+    // Segments are used in playlist order, wait for the first one only.
+    bool ready = !_segments.empty() && (_segments.front()->status == SEG_LOADED || _segments.front()->status == SEG_FAILED);
+    end = _terminate || (_segments.empty() && _end);
+    if (!ready && !end && timeout > 0) {
+        lock.waitCondition(timeout);
+        ready = !_segments.empty() && (_segments.front()->status == SEG_LOADED || _segments.front()->status == SEG_FAILED);
+        end = _terminate || (_segments.empty() && _end);
+    }
+    if (!ready || _terminate) {
+        return SegmentPtr();
+    }
+
+    // Free a slot for the producer.
+    SegmentPtr seg(_segments.front());
+    _segments.pop_front();
+    _room_cond.signal();
+    return seg;
+}
+
+
+//----------------------------------------------------------------------------
+// Termination.
+//----------------------------------------------------------------------------
+
+void ts::hls::PrefetchBuffer::terminate()
+{
+    Guard lock(_mutex);
+    _terminate = true;
+    _work_cond.signal();
+    _ready_cond.signal();
+    _room_cond.signal();
+}
+
+bool ts::hls::PrefetchBuffer::waitTerminate(MilliSecond timeout)
+{
+    GuardCondition lock(_mutex, _room_cond);
+    if (!_terminate) {
+        lock.waitCondition(timeout);
+    }
+    return _terminate;
+}
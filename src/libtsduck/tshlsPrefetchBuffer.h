@@ -0,0 +1,214 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Prefetch buffer of HLS media segments.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tshls.h"
+#include "tsByteBlock.h"
+#include "tsSafePtr.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+#include "tsAbortInterface.h"
+
+namespace ts {
+    namespace hls {
+        //!
+        //! Bounded buffer of media segments which are downloaded in parallel and used in playlist order.
+        //! @ingroup hls
+        //!
+        //! The buffer is shared by three kinds of threads:
+        //! - One producer thread adds the URL of the next segments in playlist order.
+        //! - Any number of download threads get the pending segments and download them.
+        //! - One consumer thread removes the segments in playlist order, when they are
+        //!   completed, successfully or not.
+        //!
+        //! The producer is blocked while the buffer is full. All methods are thread-safe,
+        //! except reset(). As an abort interface, the buffer reports aborting after terminate(),
+        //! which can be used to interrupt the downloads in progress.
+        //!
+        class TSDUCKDLL PrefetchBuffer: public AbortInterface
+        {
+        public:
+            //!
+            //! Download status of a media segment.
+            //!
+            enum SegmentStatus {
+                SEG_PENDING,  //!< Waiting for a download thread.
+                SEG_LOADING,  //!< Being downloaded.
+                SEG_LOADED,   //!< Successfully downloaded.
+                SEG_FAILED,   //!< Download error.
+            };
+
+            //!
+            //! A media segment in the prefetch buffer.
+            //! While the segment is being downloaded, only the download thread may access it.
+            //!
+            class TSDUCKDLL Segment
+            {
+            public:
+                size_t        index;     //!< Segment index in the buffer session.
+                UString       url;       //!< Full URL of the segment.
+                SegmentStatus status;    //!< Download status.
+                ByteBlock     data;      //!< Segment content, when loaded.
+                UString       mime;      //!< MIME type of the content.
+                MilliSecond   duration;  //!< Download duration.
+
+                //!
+                //! Constructor.
+                //! @param [in] i Segment index.
+                //! @param [in] u Full URL of the segment.
+                //!
+                Segment(size_t i, const UString& u);
+            };
+
+            //!
+            //! Safe pointer to a media segment (thread-safe).
+            //!
+            typedef SafePtr<Segment, Mutex> SegmentPtr;
+
+            //!
+            //! Constructor.
+            //! @param [in] capacity Maximum number of segments in the buffer.
+            //!
+            PrefetchBuffer(size_t capacity = 1);
+
+            //!
+            //! Clear the buffer and restart a new session.
+            //! Must not be called while other threads use the buffer.
+            //! @param [in] capacity Maximum number of segments in the buffer.
+            //!
+            void reset(size_t capacity);
+
+            //!
+            //! Get the maximum number of segments in the buffer.
+            //! @return The maximum number of segments in the buffer.
+            //!
+            size_t capacity() const { return _capacity; }
+
+            //!
+            //! Get the number of segments in the buffer.
+            //! @return The number of segments in the buffer, in any state.
+            //!
+            size_t size() const;
+
+            //!
+            //! Get the number of successfully downloaded segments in the buffer.
+            //! @return The number of successfully downloaded segments in the buffer.
+            //!
+            size_t loadedCount() const;
+
+            //!
+            //! Producer: wait until there is room in the buffer.
+            //! @return The number of free slots in the buffer, zero on termination.
+            //!
+            size_t waitRoom();
+
+            //!
+            //! Producer: add a new pending segment at the end of the buffer.
+            //! The segment is added even if the buffer is full.
+            //! @param [in] url Full URL of the segment.
+            //!
+            void push(const UString& url);
+
+            //!
+            //! Producer: declare that no more segment will be added.
+            //!
+            void setEnd();
+
+            //!
+            //! Download thread: wait for a pending segment to download.
+            //! @return The first pending segment, now in state SEG_LOADING, or a null pointer on termination.
+            //!
+            SegmentPtr nextPending();
+
+            //!
+            //! Download thread: declare that a segment download is completed.
+            //! @param [in,out] seg The segment which was returned by nextPending().
+            //! @param [in] success True if the content was successfully downloaded.
+            //!
+            void completed(const SegmentPtr& seg, bool success);
+
+            //!
+            //! Consumer: remove the first segment when it is completed.
+            //! @param [in] timeout Maximum number of milliseconds to wait. Zero means do not wait.
+            //! @param [out] end Set to true when there is no more segment to expect.
+            //! @return The first segment, which is either SEG_LOADED or SEG_FAILED. Return
+            //! a null pointer when the first segment is not yet completed after @a timeout
+            //! or when @a end is true.
+            //!
+            SegmentPtr pop(MilliSecond timeout, bool& end);
+
+            //!
+            //! Terminate the session. All waiting threads are released.
+            //!
+            void terminate();
+
+            //!
+            //! Check if the session is terminated.
+            //! @return True if terminate() was called since reset().
+            //!
+            bool terminated() const;
+
+            //!
+            //! Check if the session is terminated.
+            //! Implementation of AbortInterface.
+            //! @return True if terminate() was called since reset().
+            //!
+            virtual bool aborting() const override;
+
+            //!
+            //! Wait until termination or a given timeout.
+            //! @param [in] timeout Maximum number of milliseconds to wait.
+            //! @return True if the session is terminated.
+            //!
+            bool waitTerminate(MilliSecond timeout);
+
+        private:
+            typedef std::deque<SegmentPtr> SegmentQueue;
+
+            mutable Mutex _mutex;       // Protect all fields.
+            Condition     _work_cond;   // Signaled when a segment is waiting to be downloaded.
+            Condition     _ready_cond;  // Signaled when a segment download is completed.
+            Condition     _room_cond;   // Signaled when there is room in the buffer.
+            SegmentQueue  _segments;    // Prefetch buffer, in playlist order.
+            size_t        _capacity;    // Maximum number of segments in the buffer.
+            size_t        _next_index;  // Index of next segment to add.
+            bool          _terminate;   // Terminate all threads.
+            bool          _end;         // No more segment will be added.
+
+            // Inaccessible operations.
+            PrefetchBuffer(const PrefetchBuffer&) = delete;
+            PrefetchBuffer& operator=(const PrefetchBuffer&) = delete;
+        };
+    }
+}
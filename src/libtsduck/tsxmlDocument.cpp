@@ -52,9 +52,10 @@ ts::xml::Document::Document(Report& report) :
 // Parse an XML document.
 //----------------------------------------------------------------------------
 
-bool ts::xml::Document::parse(const UStringList& lines)
+bool ts::xml::Document::parse(const UStringList& lines, size_t firstLineNumber)
 {
-    TextParser parser(lines, _report);
+    TextParser parser(_report);
+    parser.loadDocument(lines, firstLineNumber);
     return parseNode(parser, nullptr);
 }
 
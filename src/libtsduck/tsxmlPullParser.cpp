@@ -0,0 +1,398 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Pull parser for large XML documents.
+//
+//----------------------------------------------------------------------------
+
+#include "tsxmlPullParser.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors.
+//----------------------------------------------------------------------------
+
+ts::xml::PullParser::PullParser(Report& report) :
+    _report(report),
+    _file(),
+    _input(nullptr),
+    _error(false),
+    _inRoot(false),
+    _rootName(),
+    _rootTag(),
+    _line(),
+    _index(0),
+    _lineNumber(0)
+{
+}
+
+ts::xml::PullParser::~PullParser()
+{
+    close();
+}
+
+
+//----------------------------------------------------------------------------
+// Open and close the document.
+//----------------------------------------------------------------------------
+
+bool ts::xml::PullParser::open(const UString& fileName)
+{
+    close();
+    _file.open(fileName.toUTF8().c_str(), std::ios::in);
+    if (!_file) {
+        _report.error(u"cannot open %s", {fileName});
+        _error = true;
+        return false;
+    }
+    return open(_file);
+}
+
+bool ts::xml::PullParser::open(std::istream& strm)
+{
+    if (&strm != &_file) {
+        close();
+    }
+    _input = &strm;
+    _error = false;
+    _inRoot = false;
+    _rootName.clear();
+    _rootTag.clear();
+    _line.clear();
+    _index = 0;
+    _lineNumber = 0;
+    return readProlog();
+}
+
+void ts::xml::PullParser::close()
+{
+    if (_file.is_open()) {
+        _file.close();
+    }
+    _input = nullptr;
+    _inRoot = false;
+    _line.clear();
+    _index = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Report an error and close the document.
+//----------------------------------------------------------------------------
+
+bool ts::xml::PullParser::fail(const UString& message)
+{
+    _report.error(message);
+    _error = true;
+    close();
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Read the prolog of the document, up to the root start tag.
+//----------------------------------------------------------------------------
+
+bool ts::xml::PullParser::readProlog()
+{
+    // Skip all leading declarations, comments and DTD.
+    for (;;) {
+        if (!skipSpaces(nullptr)) {
+            return fail(u"invalid XML document, no root element found");
+        }
+        else if (match(u"<?")) {
+            if (!skipTo(u"?>", nullptr)) {
+                return fail(UString::Format(u"line %d: unterminated XML declaration", {_lineNumber}));
+            }
+        }
+        else if (match(u"<!--")) {
+            if (!skipTo(u"-->", nullptr)) {
+                return fail(UString::Format(u"line %d: unterminated XML comment", {_lineNumber}));
+            }
+        }
+        else if (match(u"<!")) {
+            if (!skipTo(u">", nullptr)) {
+                return fail(UString::Format(u"line %d: unterminated XML DTD", {_lineNumber}));
+            }
+        }
+        else if (_line[_index] == u'<') {
+            break;
+        }
+        else {
+            return fail(UString::Format(u"line %d: invalid XML document, no root element found", {_lineNumber}));
+        }
+    }
+
+    // Read the complete start tag of the root element, possibly on several lines.
+    const size_t start = _index++;
+    UStringList tag;
+    tag.push_back(_line.substr(start));
+    bool empty = false;
+    if (!skipTag(&tag, empty)) {
+        return fail(u"unexpected end of document in root element tag");
+    }
+    tag.back().resize(tag.back().length() - (_line.length() - _index));
+    _rootTag = UString::Join(tag, u" ");
+
+    // Extract the name of the root element.
+    size_t end = 1;
+    while (end < _rootTag.length() && !IsSpace(_rootTag[end]) && _rootTag[end] != u'/' && _rootTag[end] != u'>') {
+        end++;
+    }
+    _rootName = _rootTag.substr(1, end - 1);
+    if (_rootName.empty()) {
+        return fail(UString::Format(u"line %d: parsing error, tag name expected", {_lineNumber}));
+    }
+
+    // With an empty root element, there is no child to read.
+    _inRoot = !empty;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Read the next child element of the root.
+//----------------------------------------------------------------------------
+
+bool ts::xml::PullParser::readElement(Document& doc)
+{
+    doc.clear();
+    if (_input == nullptr || !_inRoot) {
+        return false;
+    }
+
+    // Locate the start of the next element, skip everything else.
+    for (;;) {
+        if (!skipSpaces(nullptr)) {
+            return fail(UString::Format(u"line %d: unexpected end of document, expected </%s>", {_lineNumber, _rootName}));
+        }
+        else if (match(u"</")) {
+            // End of root element.
+            const size_t end = _line.find(u'>', _index);
+            UString name(_line.substr(_index, end == NPOS ? NPOS : end - _index));
+            name.trim();
+            if (end == NPOS || !name.similar(_rootName)) {
+                return fail(UString::Format(u"line %d: parsing error, expected </%s>", {_lineNumber, _rootName}));
+            }
+            _index = end + 1;
+            _inRoot = false;
+            // Only comments are allowed after the root element.
+            while (skipSpaces(nullptr)) {
+                if (!match(u"<!--") || !skipTo(u"-->", nullptr)) {
+                    return fail(UString::Format(u"line %d: trailing character sequence, invalid XML document", {_lineNumber}));
+                }
+            }
+            close();
+            return false;
+        }
+        else if (_line[_index] != u'<') {
+            // Ignore text directly inside the root.
+            skipText(nullptr);
+        }
+        else if (_index + 1 < _line.length() && (_line[_index + 1] == u'!' || _line[_index + 1] == u'?')) {
+            // Ignore comments, declarations, etc.
+            const size_t line = _lineNumber;
+            size_t depth = 0;
+            if (!skipMarkup(nullptr, depth)) {
+                return fail(UString::Format(u"line %d: unexpected end of document", {line}));
+            }
+        }
+        else {
+            // Found the start tag of the next element.
+            break;
+        }
+    }
+
+    // Accumulate the lines of the complete element, inside a copy of the root start tag.
+    const size_t firstLine = _lineNumber;
+    UStringList chunk;
+    chunk.push_back(_rootTag + _line.substr(_index));
+
+    size_t depth = 0;
+    bool ok = true;
+    do {
+        ok = skipMarkup(&chunk, depth) && (depth == 0 || skipText(&chunk));
+    } while (ok && depth > 0);
+
+    if (!ok) {
+        return fail(UString::Format(u"line %d: unexpected end of document, element starting at line %d is not terminated", {_lineNumber, firstLine}));
+    }
+
+    // Truncate the last line after the end of the element and close the root.
+    chunk.back().resize(chunk.back().length() - (_line.length() - _index));
+    chunk.back().append(u"</");
+    chunk.back().append(_rootName);
+    chunk.back().append(u">");
+
+    // Parse the element using the standard parser.
+    if (!doc.parse(chunk, firstLine)) {
+        _error = true;
+        close();
+        return false;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Low-level scanning of the document.
+//----------------------------------------------------------------------------
+
+bool ts::xml::PullParser::nextLine(UStringList* chunk)
+{
+    _index = 0;
+    if (_input == nullptr || !_line.getLine(*_input)) {
+        return false;
+    }
+    _lineNumber++;
+    if (chunk != nullptr) {
+        chunk->push_back(_line);
+    }
+    return true;
+}
+
+bool ts::xml::PullParser::match(const UChar* str)
+{
+    const size_t len = std::char_traits<UChar>::length(str);
+    if (_line.compare(_index, len, str) == 0) {
+        _index += len;
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+bool ts::xml::PullParser::skipSpaces(UStringList* chunk)
+{
+    for (;;) {
+        while (_index < _line.length() && IsSpace(_line[_index])) {
+            _index++;
+        }
+        if (_index < _line.length()) {
+            return true;
+        }
+        if (!nextLine(chunk)) {
+            return false;
+        }
+    }
+}
+
+bool ts::xml::PullParser::skipText(UStringList* chunk)
+{
+    for (;;) {
+        const size_t pos = _line.find(u'<', _index);
+        if (pos != NPOS) {
+            _index = pos;
+            return true;
+        }
+        if (!nextLine(chunk)) {
+            return false;
+        }
+    }
+}
+
+bool ts::xml::PullParser::skipTo(const UChar* str, UStringList* chunk)
+{
+    const size_t len = std::char_traits<UChar>::length(str);
+    for (;;) {
+        const size_t pos = _line.find(str, _index, len);
+        if (pos != NPOS) {
+            _index = pos + len;
+            return true;
+        }
+        if (!nextLine(chunk)) {
+            return false;
+        }
+    }
+}
+
+bool ts::xml::PullParser::skipTag(UStringList* chunk, bool& empty)
+{
+    UChar quote = CHAR_NULL;
+    UChar previous = CHAR_NULL;
+    for (;;) {
+        while (_index < _line.length()) {
+            const UChar c = _line[_index++];
+            if (quote != CHAR_NULL) {
+                if (c == quote) {
+                    quote = CHAR_NULL;
+                }
+            }
+            else if (c == u'"' || c == u'\'') {
+                quote = c;
+            }
+            else if (c == u'>') {
+                empty = previous == u'/';
+                return true;
+            }
+            if (!IsSpace(c)) {
+                previous = c;
+            }
+        }
+        if (!nextLine(chunk)) {
+            return false;
+        }
+    }
+}
+
+bool ts::xml::PullParser::skipMarkup(UStringList* chunk, size_t& depth)
+{
+    if (match(u"<!--")) {
+        return skipTo(u"-->", chunk);
+    }
+    else if (match(u"<![CDATA[")) {
+        return skipTo(u"]]>", chunk);
+    }
+    else if (match(u"<?")) {
+        return skipTo(u"?>", chunk);
+    }
+    else if (match(u"<!")) {
+        return skipTo(u">", chunk);
+    }
+    else if (match(u"</")) {
+        if (depth > 0) {
+            depth--;
+        }
+        return skipTo(u">", chunk);
+    }
+    else {
+        // Start tag of an element.
+        _index++;
+        bool empty = false;
+        if (!skipTag(chunk, empty)) {
+            return false;
+        }
+        if (!empty) {
+            depth++;
+        }
+        return true;
+    }
+}
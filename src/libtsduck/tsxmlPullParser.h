@@ -0,0 +1,162 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Pull parser for large XML documents.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsxmlDocument.h"
+#include "tsNullReport.h"
+
+namespace ts {
+    namespace xml {
+        //!
+        //! Pull parser for large XML documents.
+        //! @ingroup xml
+        //!
+        //! The complete XML document is never loaded in memory. The file is read line
+        //! by line and each child element of the root is returned as a small standalone
+        //! document, one at a time. The application processes the element and drops it
+        //! before reading the next one. The required memory is bounded by the size of the
+        //! largest child element of the root.
+        //!
+        //! Each returned document is the root element (with its attributes) containing the
+        //! one child element which was read. Thus, it can be validated against the same model
+        //! as the complete document. Line numbers in the returned document are the line
+        //! numbers in the input file.
+        //!
+        //! Declarations, comments and text directly inside the root element are skipped.
+        //!
+        class TSDUCKDLL PullParser
+        {
+        public:
+            //!
+            //! Constructor.
+            //! @param [in,out] report Where to report errors.
+            //!
+            explicit PullParser(Report& report = NULLREP);
+
+            //!
+            //! Destructor.
+            //!
+            ~PullParser();
+
+            //!
+            //! Open an XML file and read the document up to the start tag of the root element.
+            //! @param [in] fileName Name of the XML file to read.
+            //! @return True on success, false on error.
+            //!
+            bool open(const UString& fileName);
+
+            //!
+            //! Open an XML document from a text stream and read it up to the start tag of the root element.
+            //! @param [in,out] strm A standard text stream in input mode. The stream must remain
+            //! valid until the parser is closed or destroyed.
+            //! @return True on success, false on error.
+            //!
+            bool open(std::istream& strm);
+
+            //!
+            //! Close the XML document.
+            //!
+            void close();
+
+            //!
+            //! Check if a document is open and not completely read.
+            //! @return True if a document is open and not completely read.
+            //!
+            bool isOpen() const { return _input != nullptr; }
+
+            //!
+            //! Get the name of the root element of the document.
+            //! @return The name of the root element.
+            //!
+            UString rootName() const { return _rootName; }
+
+            //!
+            //! Read the next child element of the root.
+            //! @param [in,out] doc The document to receive the root element and the next child element.
+            //! It is cleared first. The tweaks of the document are used to parse the element.
+            //! @return True when an element was read, false at end of document or on error.
+            //!
+            bool readElement(Document& doc);
+
+            //!
+            //! Check if an error was found in the document.
+            //! @return True if an error was found.
+            //!
+            bool hasError() const { return _error; }
+
+        private:
+            Report&       _report;      // Where to report errors.
+            std::ifstream _file;        // Input file, when open by file name.
+            std::istream* _input;       // Current input stream, null when closed.
+            bool          _error;       // An error was found.
+            bool          _inRoot;      // Currently reading children of the root element.
+            UString       _rootName;    // Name of the root element.
+            UString       _rootTag;     // Complete start tag of the root element.
+            UString       _line;        // Current line.
+            size_t        _index;       // Index of next character in current line.
+            size_t        _lineNumber;  // Current line number in the document.
+
+            // Read the prolog of the document, up to the root start tag.
+            bool readProlog();
+
+            // Read the next line from the input stream. Add it in the chunk when not null.
+            bool nextLine(UStringList* chunk);
+
+            // Check if the current position matches a string. Skip it when it does.
+            bool match(const UChar* str);
+
+            // Skip white spaces, return false at end of document.
+            bool skipSpaces(UStringList* chunk);
+
+            // Skip text up to the next '<', return false at end of document.
+            bool skipText(UStringList* chunk);
+
+            // Skip all characters up to and including a string, return false at end of document.
+            bool skipTo(const UChar* str, UStringList* chunk);
+
+            // Skip the rest of a tag, after the tag name, up to '>' outside quoted attribute values.
+            bool skipTag(UStringList* chunk, bool& empty);
+
+            // Skip a markup sequence starting at a '<'. Update the depth of elements.
+            bool skipMarkup(UStringList* chunk, size_t& depth);
+
+            // Report an error and close the document.
+            bool fail(const UString& message);
+
+            // Inaccessible operations.
+            PullParser(const PullParser&) = delete;
+            PullParser& operator=(const PullParser&) = delete;
+        };
+    }
+}
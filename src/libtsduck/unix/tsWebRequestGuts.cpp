@@ -432,8 +432,9 @@ int ts::WebRequest::SystemGuts::progressCallback(void *clientp, TS_CALLBACK_PARA
     // The clientp points to the guts object.
     SystemGuts* guts = reinterpret_cast<SystemGuts*>(clientp);
 
+    // This callback is periodically invoked, even when no data are received: check abort.
     // We only use dltotal to reserve the buffer size. Return 0 on success.
-    return guts != nullptr && guts->_request.setPossibleContentSize(size_t(dltotal)) ? 0 : 1;
+    return guts != nullptr && !guts->_request.checkAbort() && guts->_request.setPossibleContentSize(size_t(dltotal)) ? 0 : 1;
 }
 
 
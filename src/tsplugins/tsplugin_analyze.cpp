@@ -35,10 +35,18 @@
 #include "tsPlugin.h"
 #include "tsPluginRepository.h"
 #include "tsTSAnalyzerReport.h"
+#include "tsTSAnalyzerSnapshot.h"
 #include "tsTSSpeedMetrics.h"
 #include "tsSysUtils.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+#include "tsGuardCondition.h"
 TSDUCK_SOURCE;
 
+// Number of TS packets between two publications of the snapshot counters.
+#define SNAPSHOT_PACKETS 1000
+
 
 //----------------------------------------------------------------------------
 // Plugin definition
@@ -65,9 +73,34 @@ namespace ts {
         TSAnalyzerReport  _analyzer;
         TSAnalyzerOptions _analyzer_options;
 
+        // Thread which periodically writes the snapshot counters in a JSON file.
+        class SnapshotThread : public Thread
+        {
+        public:
+            SnapshotThread(AnalyzePlugin* parent) : Thread(), _parent(parent) {}
+            virtual ~SnapshotThread() override { waitForTermination(); }
+        private:
+            AnalyzePlugin* _parent;
+            virtual void main() override;
+
+            // Inaccessible operations
+            SnapshotThread() = delete;
+            SnapshotThread(const SnapshotThread&) = delete;
+            SnapshotThread& operator=(const SnapshotThread&) = delete;
+        };
+
+        UString            _snapshot_name;      // JSON snapshot file name (empty if none).
+        MilliSecond        _snapshot_interval;  // Interval between two JSON snapshot files.
+        TSAnalyzerSnapshot _snapshot;           // Counters, published by the packet thread.
+        Mutex              _snapshot_mutex;     // Protect _snapshot_stop.
+        Condition          _snapshot_cond;      // Signaled when _snapshot_stop is set.
+        bool               _snapshot_stop;      // Request to terminate the snapshot thread.
+        SnapshotThread*    _snapshot_thread;    // Snapshot thread (if any).
+
         bool openOutput();
         void closeOutput();
         bool produceReport();
+        bool writeSnapshot();
 
         // Inaccessible operations
         AnalyzePlugin() = delete;
@@ -94,7 +127,14 @@ ts::AnalyzePlugin::AnalyzePlugin(TSP* tsp_) :
     _metrics(),
     _next_report(0),
     _analyzer(),
-    _analyzer_options()
+    _analyzer_options(),
+    _snapshot_name(),
+    _snapshot_interval(0),
+    _snapshot(),
+    _snapshot_mutex(),
+    _snapshot_cond(),
+    _snapshot_stop(false),
+    _snapshot_thread(nullptr)
 {
     // Define all standard analysis options.
     _analyzer_options.defineOptions(*this);
@@ -117,6 +157,19 @@ ts::AnalyzePlugin::AnalyzePlugin(TSP* tsp_) :
     help(u"output-file", u"filename",
          u"Specify the output text file for the analysis result. "
          u"By default, use the standard output.");
+
+    option(u"snapshot-file", 0, STRING);
+    help(u"snapshot-file", u"filename",
+         u"Periodically write the main counters of the analysis (global and per PID) "
+         u"in the specified file, in JSON format. The file is written by a separate "
+         u"thread, without interrupting the packet processing, and is atomically "
+         u"replaced each time. Unlike the full analysis report, the cost of a snapshot "
+         u"does not depend on the duration of the analysis.");
+
+    option(u"snapshot-interval", 0, POSITIVE);
+    help(u"snapshot-interval", u"milliseconds",
+         u"With --snapshot-file, specify the interval between two updates of the "
+         u"file in milliseconds. The default is 1000 milliseconds.");
 }
 
 
@@ -133,6 +186,9 @@ bool ts::AnalyzePlugin::start()
     _analyzer_options.load(*this);
     _analyzer.setAnalysisOptions(_analyzer_options);
 
+    _snapshot_name = value(u"snapshot-file");
+    _snapshot_interval = intValue<MilliSecond>(u"snapshot-interval", 1000);
+
     // For production of multiple reports at regular intervals.
     _metrics.start();
     _next_report = _output_interval;
@@ -144,6 +200,19 @@ bool ts::AnalyzePlugin::start()
         return false;
     }
 
+    // Start the snapshot thread. The snapshot counters are published by the packet thread.
+    if (!_snapshot_name.empty()) {
+        _analyzer.setSnapshot(&_snapshot, SNAPSHOT_PACKETS);
+        _snapshot_stop = false;
+        _snapshot_thread = new SnapshotThread(this);
+        if (!_snapshot_thread->start()) {
+            tsp->error(u"cannot start snapshot thread");
+            delete _snapshot_thread;
+            _snapshot_thread = nullptr;
+            return false;
+        }
+    }
+
     return true;
 }
 
@@ -220,11 +289,80 @@ bool ts::AnalyzePlugin::produceReport()
 
 bool ts::AnalyzePlugin::stop()
 {
+    // Terminate the snapshot thread and write the final counters.
+    if (_snapshot_thread != nullptr) {
+        {
+            GuardCondition lock(_snapshot_mutex, _snapshot_cond);
+            _snapshot_stop = true;
+            lock.signal();
+        }
+        delete _snapshot_thread;
+        _snapshot_thread = nullptr;
+        _analyzer.publishSnapshot();
+        writeSnapshot();
+        _analyzer.setSnapshot(nullptr, 0);
+    }
+
     produceReport();
     return true;
 }
 
 
+//----------------------------------------------------------------------------
+// Write the last published snapshot counters in the JSON file.
+// Executed in the snapshot thread, except the final one in stop().
+//----------------------------------------------------------------------------
+
+bool ts::AnalyzePlugin::writeSnapshot()
+{
+    TSAnalyzerSnapshot::Counters counters;
+    _snapshot.get(counters);
+
+    // Write a temporary file and rename it so that readers never see a partial file.
+    const UString tmp_name(_snapshot_name + u".tmp");
+    std::ofstream file(tmp_name.toUTF8().c_str());
+    if (!file) {
+        tsp->error(u"cannot create file %s", {tmp_name});
+        return false;
+    }
+    file << counters.toJSON()->printed(2, *tsp) << std::endl;
+    file.close();
+
+    // On Windows, an existing file cannot be replaced by a rename.
+    ErrorCode code = RenameFile(tmp_name, _snapshot_name);
+    if (code != SYS_SUCCESS && FileExists(_snapshot_name) && DeleteFile(_snapshot_name) == SYS_SUCCESS) {
+        code = RenameFile(tmp_name, _snapshot_name);
+    }
+    if (code != SYS_SUCCESS) {
+        tsp->error(u"cannot rename %s to %s: %s", {tmp_name, _snapshot_name, ErrorCodeMessage(code)});
+        DeleteFile(tmp_name);
+        return false;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Snapshot thread: write the JSON file at regular intervals.
+//----------------------------------------------------------------------------
+
+void ts::AnalyzePlugin::SnapshotThread::main()
+{
+    for (;;) {
+        {
+            GuardCondition lock(_parent->_snapshot_mutex, _parent->_snapshot_cond);
+            if (!_parent->_snapshot_stop) {
+                lock.waitCondition(_parent->_snapshot_interval);
+            }
+            if (_parent->_snapshot_stop) {
+                break;
+            }
+        }
+        _parent->writeSnapshot();
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Packet processing method
 //----------------------------------------------------------------------------
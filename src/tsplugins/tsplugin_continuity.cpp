@@ -49,6 +49,7 @@ namespace ts {
         ContinuityPlugin(TSP*);
         virtual bool start() override;
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, size_t, Status*, bool&, bool&) override;
 
     private:
         UString       _tag;             // Message tag
@@ -160,3 +161,14 @@ ts::ProcessorPlugin::Status ts::ContinuityPlugin::processPacket(TSPacket& pkt, b
     _packet_count++;
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+size_t ts::ContinuityPlugin::processPacketBatch(TSPacket* pkt, size_t count, Status* status, bool& flush, bool& bitrate_changed)
+{
+    // Never flush, never change bitrate: process all packets.
+    return processPacketBatchDirect<ContinuityPlugin>(pkt, count, status, flush, bitrate_changed);
+}
@@ -52,6 +52,7 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, size_t, Status*, bool&, bool&) override;
 
     private:
         // This structure is used at each --interval.
@@ -309,3 +310,32 @@ ts::ProcessorPlugin::Status ts::CountPlugin::processPacket(TSPacket& pkt, bool&
     _current_pkt++;
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+size_t ts::CountPlugin::processPacketBatch(TSPacket* pkt, size_t count, Status* status, bool& flush, bool& bitrate_changed)
+{
+    if (_report_interval > 0 || _report_all) {
+        // Need to check reports on each packet.
+        return processPacketBatchDirect<CountPlugin>(pkt, count, status, flush, bitrate_changed);
+    }
+
+    // Simple count loop.
+    for (size_t i = 0; i < count; ++i) {
+        if (pkt[i].b[0] == 0) {
+            status[i] = TSP_DROP;
+        }
+        else {
+            const PID pid = pkt[i].getPID();
+            if (_pids[pid] != _negate) {
+                _counters[pid]++;
+            }
+            _current_pkt++;
+            status[i] = TSP_OK;
+        }
+    }
+    return count;
+}
@@ -34,8 +34,10 @@
 
 #include "tsPlugin.h"
 #include "tsPluginRepository.h"
-#include "tsTSFileOutput.h"
+#include "tsTSFileOutputArgs.h"
 #include "tsTSFileInput.h"
+#include "tsTSFileIndex.h"
+#include "tsSysUtils.h"
 TSDUCK_SOURCE;
 
 
@@ -61,9 +63,16 @@ namespace ts {
         size_t        _current_file;
         size_t        _repeat_count;
         uint64_t      _start_offset;
+        bool          _start_pcr_set;
+        uint64_t      _start_pcr;
+        Time          _start_time;
+        UString       _index_file;
         TSFileInput   _file;
         volatile bool _aborted;
 
+        // Open an input file, locate the start position using the index if necessary.
+        bool openFile(const UString& name);
+
         // Inaccessible operations
         FileInput() = delete;
         FileInput(const FileInput&) = delete;
@@ -76,11 +85,12 @@ namespace ts {
     public:
         // Implementation of plugin API
         FileOutput(TSP*);
+        virtual bool getOptions() override;
         virtual bool start() override;
         virtual bool stop() override;
         virtual bool send(const TSPacket*, size_t) override;
     private:
-        TSFileOutput _file;
+        TSFileOutputArgs _file;
 
         // Inaccessible operations
         FileOutput() = delete;
@@ -94,11 +104,12 @@ namespace ts {
     public:
         // Implementation of plugin API
         FileProcessor(TSP*);
+        virtual bool getOptions() override;
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
     private:
-        TSFileOutput _file;
+        TSFileOutputArgs _file;
 
         // Inaccessible operations
         FileProcessor() = delete;
@@ -113,6 +124,26 @@ TSPLUGIN_DECLARE_OUTPUT(file, ts::FileOutput)
 TSPLUGIN_DECLARE_PROCESSOR(file, ts::FileProcessor)
 
 
+//----------------------------------------------------------------------------
+// Report write statistics, common to output and packet processor.
+//----------------------------------------------------------------------------
+
+namespace {
+    void ReportStatistics(ts::Report& report, const ts::TSFileOutputArgs& file)
+    {
+        ts::TSFileOutput::WriteStatistics stats;
+        file.getWriteStatistics(stats);
+        if (stats.writes > 0) {
+            report.verbose(u"%'d write operations, %'d bytes, average latency: %'d us, max latency: %'d us, max pending writes: %d",
+                           {stats.writes, stats.bytes,
+                            stats.total_time / ts::NanoSecPerMicroSec / ts::NanoSecond(stats.writes),
+                            stats.max_time / ts::NanoSecPerMicroSec,
+                            stats.max_pending});
+        }
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Input constructor
 //----------------------------------------------------------------------------
@@ -123,6 +154,10 @@ ts::FileInput::FileInput(TSP* tsp_) :
     _current_file(0),
     _repeat_count(1),
     _start_offset(0),
+    _start_pcr_set(false),
+    _start_pcr(0),
+    _start_time(),
+    _index_file(),
     _file(),
     _aborted(true)
 {
@@ -134,16 +169,43 @@ ts::FileInput::FileInput(TSP* tsp_) :
          u"Start reading each file at the specified byte offset (default: 0). "
          u"This option is allowed only if the input file is a regular file.");
 
+    option(u"index", 0, STRING);
+    help(u"index", u"filename",
+         u"Name of the index file to use with --start-pcr and --start-time, as built by "
+         u"tsindex --output. By default, the index file of each input file has the same "
+         u"name with the additional suffix \".tsidx\". This option is allowed with one "
+         u"input file only.");
+
     option(u"infinite", 'i');
     help(u"infinite",
          u"Repeat the playout of the file infinitely (default: only once). "
          u"This option is allowed only if the input file is a regular file.");
 
+    option(u"memory-map", 'm');
+    help(u"memory-map",
+         u"Read regular files using memory-mapped I/O instead of read operations. "
+         u"Large files are mapped by successive windows. On systems without support "
+         u"for memory-mapped files or when the input is not a regular file, this option "
+         u"is ignored. The input files must not be truncated while they are read.");
+
     option(u"packet-offset", 'p', UNSIGNED);
     help(u"packet-offset",
          u"Start reading each file at the specified TS packet (default: 0). "
          u"This option is allowed only if the input file is a regular file.");
 
+    option(u"start-pcr", 0, UNSIGNED);
+    help(u"start-pcr",
+         u"Start reading each file at the first packet with a PCR greater than or equal "
+         u"to the specified value, in the first PID carrying PCR's. The position is located "
+         u"using the index file which was previously built by the command tsindex.");
+
+    option(u"start-time", 0, STRING);
+    help(u"start-time",
+         u"Start reading each file at the specified UTC time in the stream, as found in the "
+         u"TDT and TOT. The time must be specified as \"year/month/day:hour:minute:second\". "
+         u"The position is located using the index file which was previously built by the "
+         u"command tsindex.");
+
     option(u"repeat", 'r', POSITIVE);
     help(u"repeat",
          u"Repeat the playout of each file the specified number of times "
@@ -163,11 +225,7 @@ ts::FileOutput::FileOutput(TSP* tsp_) :
     option(u"", 0, STRING, 0, 1);
     help(u"", u"Name of the created output file. Use standard output by default.");
 
-    option(u"append", 'a');
-    help(u"append", u"If the file already exists, append to the end of the file. By default, existing files are overwritten.");
-
-    option(u"keep", 'k');
-    help(u"keep", u"Keep existing file (abort if the specified file already exists). By default, existing files are overwritten.");
+    _file.defineOptions(*this);
 }
 
 
@@ -182,11 +240,7 @@ ts::FileProcessor::FileProcessor(TSP* tsp_) :
     option(u"", 0, STRING, 1, 1);
     help(u"", u"Name of the created output file.");
 
-    option(u"append", 'a');
-    help(u"append", u"If the file already exists, append to the end of the file. By default, existing files are overwritten.");
-
-    option(u"keep", 'k');
-    help(u"keep", u"Keep existing file (abort if the specified file already exists). By default, existing files are overwritten.");
+    _file.defineOptions(*this);
 }
 
 
@@ -199,6 +253,29 @@ bool ts::FileInput::getOptions()
     getValues(_filenames);
     _repeat_count = present(u"infinite") ? 0 : intValue<size_t>(u"repeat", 1);
     _start_offset = intValue<uint64_t>(u"byte-offset", intValue<uint64_t>(u"packet-offset", 0) * PKT_SIZE);
+    _start_pcr_set = present(u"start-pcr");
+    _start_pcr = intValue<uint64_t>(u"start-pcr", 0);
+    _start_time = Time::Epoch;
+    getValue(_index_file, u"index");
+    _file.setMemoryMapping(present(u"memory-map"));
+
+    if (present(u"start-time") && !_start_time.decode(value(u"start-time"))) {
+        tsp->error(u"invalid --start-time value \"%s\" (use \"year/month/day:hour:minute:second\")", {value(u"start-time")});
+        return false;
+    }
+    if (_start_pcr_set && present(u"start-time")) {
+        tsp->error(u"--start-pcr and --start-time are mutually exclusive");
+        return false;
+    }
+    if ((_start_pcr_set || present(u"start-time")) && (present(u"byte-offset") || present(u"packet-offset"))) {
+        tsp->error(u"--start-pcr and --start-time cannot be used with --byte-offset or --packet-offset");
+        return false;
+    }
+
+    if (!_index_file.empty() && _filenames.size() > 1) {
+        tsp->error(u"--index cannot be used with more than one input file");
+        return false;
+    }
 
     if (_filenames.size() > 1 && _repeat_count == 0) {
         tsp->error(u"specifying --infinite is meaningless with more than one file");
@@ -220,7 +297,35 @@ bool ts::FileInput::start()
     // Open first input file.
     _aborted = false;
     _current_file = 0;
-    return _file.open(first, _repeat_count, _start_offset, *tsp);
+    return openFile(first);
+}
+
+bool ts::FileInput::openFile(const UString& name)
+{
+    uint64_t offset = _start_offset;
+
+    // Locate the start position using the index of the file.
+    if (_start_pcr_set || _start_time != Time::Epoch) {
+        const UString index_file(_index_file.empty() ? TSFileIndex::IndexFileName(name) : _index_file);
+        TSFileIndex index;
+        PacketCounter packet = 0;
+        if (name.empty()) {
+            tsp->error(u"--start-pcr and --start-time cannot be used on standard input");
+            return false;
+        }
+        if (!FileExists(index_file) || !index.load(index_file, *tsp) || !index.matchFile(name)) {
+            tsp->error(u"no up-to-date index for %s, use tsindex to build it", {name});
+            return false;
+        }
+        if (_start_pcr_set ? !index.findPCR(_start_pcr, packet) : !index.findTime(_start_time, packet)) {
+            tsp->error(u"start position not found in %s", {name});
+            return false;
+        }
+        tsp->verbose(u"starting %s at packet %'d", {name, packet});
+        offset = packet * PKT_SIZE;
+    }
+
+    return _file.open(name, _repeat_count, offset, *tsp);
 }
 
 bool ts::FileInput::stop()
@@ -256,7 +361,7 @@ size_t ts::FileInput::receive(TSPacket* buffer, size_t max_packets)
         // Open the next file.
         _file.close(*tsp);
         tsp->verbose(u"reading file %s", {_filenames[_current_file]});
-        if (!_file.open(_filenames[_current_file], _repeat_count, _start_offset, *tsp)) {
+        if (!openFile(_filenames[_current_file])) {
             return 0;
         }
     }
@@ -267,14 +372,21 @@ size_t ts::FileInput::receive(TSPacket* buffer, size_t max_packets)
 // Output plugin methods
 //----------------------------------------------------------------------------
 
+bool ts::FileOutput::getOptions()
+{
+    return _file.loadArgs(*this);
+}
+
 bool ts::FileOutput::start()
 {
-    return _file.open(value(u""), present(u"append"), present(u"keep"), *tsp);
+    return _file.open(*tsp);
 }
 
 bool ts::FileOutput::stop()
 {
-    return _file.close(*tsp);
+    const bool success = _file.close(*tsp);
+    ReportStatistics(*tsp, _file);
+    return success;
 }
 
 bool ts::FileOutput::send(const TSPacket* buffer, size_t packet_count)
@@ -287,14 +399,21 @@ bool ts::FileOutput::send(const TSPacket* buffer, size_t packet_count)
 // Packet processor plugin methods
 //----------------------------------------------------------------------------
 
+bool ts::FileProcessor::getOptions()
+{
+    return _file.loadArgs(*this);
+}
+
 bool ts::FileProcessor::start()
 {
-    return _file.open(value(u""), present(u"append"), present(u"keep"), *tsp);
+    return _file.open(*tsp);
 }
 
 bool ts::FileProcessor::stop()
 {
-    return _file.close(*tsp);
+    const bool success = _file.close(*tsp);
+    ReportStatistics(*tsp, _file);
+    return success;
 }
 
 ts::ProcessorPlugin::Status ts::FileProcessor::processPacket(TSPacket& pkt, bool& flush, bool& bitrate_changed)
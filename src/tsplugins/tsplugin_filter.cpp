@@ -49,6 +49,7 @@ namespace ts {
         FilterPlugin (TSP*);
         virtual bool start() override;
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, size_t, Status*, bool&, bool&) override;
 
     private:
         int           scrambling_ctrl;  // Scrambling control value (<0: no filter)
@@ -254,3 +255,14 @@ ts::ProcessorPlugin::Status ts::FilterPlugin::processPacket(TSPacket& pkt, bool&
         return TSP_DROP;
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+size_t ts::FilterPlugin::processPacketBatch(TSPacket* pkt, size_t count, Status* status, bool& flush, bool& bitrate_changed)
+{
+    // Never flush, never change bitrate: process all packets.
+    return processPacketBatchDirect<FilterPlugin>(pkt, count, status, flush, bitrate_changed);
+}
@@ -28,19 +28,36 @@
 //----------------------------------------------------------------------------
 //
 //  Transport stream processor shared library:
-//  HLS stream input
+//  HLS stream input and output
 //
 //----------------------------------------------------------------------------
 
 #include "tsAbstractHTTPInputPlugin.h"
 #include "tsPluginRepository.h"
 #include "tshlsPlayList.h"
+#include "tshlsPrefetchBuffer.h"
 #include "tsWebRequest.h"
 #include "tsWebRequestArgs.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+#include "tsGuardCondition.h"
+#include "tsSafePtr.h"
+#include "tsByteBlock.h"
+#include "tsTime.h"
 #include "tsSysUtils.h"
+#include "tsSectionDemux.h"
+#include "tsTSFileOutput.h"
+#include "tsPAT.h"
+#include "tsPMT.h"
 TSDUCK_SOURCE;
 
 #define DEFAULT_MAX_QUEUED_PACKETS  1000    // Default size in packet of the inter-thread queue.
+#define DEFAULT_PREFETCH               3    // Default number of prefetched media segments.
+#define MIN_RELOAD_INTERVAL         1000    // Minimum interval in milliseconds between two reloads without new segment.
+#define ABORT_POLL_INTERVAL          500    // Interval in milliseconds to check for abort while waiting for a segment.
+#define DEFAULT_SEGMENT_DURATION      10    // Default target duration in seconds of output media segments.
+#define SEGMENT_NUMBER_WIDTH           6    // Number of digits of the sequence number in output segment file names.
 
 
 //----------------------------------------------------------------------------
@@ -58,6 +75,34 @@ namespace ts {
         virtual void processInput() override;
 
     private:
+        // Thread which downloads media segments from the prefetch buffer.
+        class DownloadThread: public Thread
+        {
+        public:
+            DownloadThread(HlsInput* plugin) : Thread(), _plugin(plugin) {}
+            virtual ~DownloadThread() override { waitForTermination(); }
+        private:
+            HlsInput* const _plugin;
+            virtual void main() override { _plugin->downloadSegments(); }
+            DownloadThread() = delete;
+            DownloadThread(const DownloadThread&) = delete;
+            DownloadThread& operator=(const DownloadThread&) = delete;
+        };
+
+        // Thread which fills the prefetch buffer from the playlist and reloads live playlists.
+        class PlayListThread: public Thread
+        {
+        public:
+            PlayListThread(HlsInput* plugin) : Thread(), _plugin(plugin) {}
+            virtual ~PlayListThread() override { waitForTermination(); }
+        private:
+            HlsInput* const _plugin;
+            virtual void main() override { _plugin->feedSegments(); }
+            PlayListThread() = delete;
+            PlayListThread(const PlayListThread&) = delete;
+            PlayListThread& operator=(const PlayListThread&) = delete;
+        };
+
         UString        _url;
         BitRate        _minRate;
         BitRate        _maxRate;
@@ -71,8 +116,14 @@ namespace ts {
         bool           _lowestRes;
         bool           _highestRes;
         size_t         _maxSegmentCount;
+        size_t         _prefetch;        // Maximum number of prefetched segments.
         WebRequestArgs _web_args;
-        hls::PlayList  _playlist;
+        hls::PlayList  _playlist;        // Media playlist, only used by the playlist thread after start().
+        hls::PrefetchBuffer _buffer;     // Prefetch buffer, in playlist order.
+
+        // Thread entry points.
+        void downloadSegments();
+        void feedSegments();
 
         // Inaccessible operations
         HlsInput() = delete;
@@ -81,8 +132,96 @@ namespace ts {
     };
 }
 
+namespace ts {
+    class HlsOutput: public OutputPlugin, private TableHandlerInterface
+    {
+    public:
+        // Implementation of plugin API
+        HlsOutput(TSP*);
+        virtual bool getOptions() override;
+        virtual bool start() override;
+        virtual bool stop() override;
+        virtual bool send(const TSPacket*, size_t) override;
+
+    private:
+        // Collect the packets of the last complete sections on a PSI PID, to repeat them
+        // at the start of each media segment. The collected packets start with the last
+        // packet with PUSI and contain all complete sections from the pointer field.
+        class SectionRepeater
+        {
+        public:
+            SectionRepeater();
+            void reset();
+            void feedPacket(const TSPacket& pkt);
+            // Get the packets to repeat, empty if no complete section was found yet.
+            void getPackets(TSPacketVector& pkts) const;
+        private:
+            TSPacketVector _current;  // Packets since last PUSI, with sections in progress.
+            ByteBlock      _section;  // Data of the section in progress.
+            TSPacketVector _last;     // Packets of the last complete sections.
+            uint8_t        _cc;       // Continuity counter of the last packet in the PID.
+            void addData(const uint8_t* data, size_t size);
+        };
+
+        // Command line options.
+        UString       _playlistFile;    // Playlist file name.
+        UString       _segmentPrefix;   // Segment file names, before sequence number.
+        UString       _segmentSuffix;   // Segment file names, after sequence number.
+        MilliSecond   _targetDuration;  // Target duration of media segments.
+        MilliSecond   _partDuration;    // Target duration of partial segments, zero if none.
+        size_t        _liveDepth;       // Number of segments in a live playlist, zero if not live.
+        PID           _optPID;          // Reference PID from command line, PID_NULL if none.
+
+        // Working data.
+        SectionDemux  _demux;           // Demux to locate the video PID.
+        hls::PlayList _playlist;        // Generated media playlist.
+        TSFileOutput  _segFile;         // Media segment in progress.
+        PID           _refPID;          // Reference PID for cuts and durations, PID_NULL if unknown.
+        PID           _pmtPID;          // PMT PID of the service containing the reference PID.
+        uint64_t      _lastTS;          // Last time stamp on the reference PID.
+        size_t        _segNumber;       // Sequence number of the segment in progress.
+        uint64_t      _segSize;         // Size in bytes of the segment in progress.
+        uint64_t      _segStartTS;      // First time stamp of the segment in progress.
+        PacketCounter _segPackets;      // Number of packets in the segment in progress.
+        uint64_t      _partOffset;      // Offset in segment of the partial segment in progress.
+        uint64_t      _partStartTS;     // First time stamp of the partial segment in progress.
+        PacketCounter _partPackets;     // Number of packets in the partial segment in progress.
+        bool          _partIndependent; // The partial segment in progress starts on a random access point.
+        SectionRepeater _patRepeater;   // Last PAT, to repeat at start of next segment.
+        std::map<PID, SectionRepeater> _pmtRepeaters;  // Last PMT's, only the one of the reference service once found.
+        UStringList   _segmentFiles;    // Segment files in the playlist, in the same order.
+        UStringList   _obsoleteFiles;   // Segment files which were removed from the live playlist.
+
+        // Implementation of TableHandlerInterface.
+        virtual void handleTable(SectionDemux&, const BinaryTable&) override;
+
+        // Get the time stamp of a packet on the reference PID, INVALID_PTS if there is none.
+        static uint64_t TimeStamp(const TSPacket&);
+
+        // Compute a duration from time stamps or, when unknown, from a number of packets.
+        MilliSecond duration(uint64_t startTS, uint64_t endTS, PacketCounter packets) const;
+
+        // Segment and partial segment management.
+        bool openSegment();
+        bool closeSegment(uint64_t endTS);
+        bool closePart(uint64_t endTS);
+        bool writePackets(const TSPacket*, size_t);
+        UString segmentURI(const UString& fileName) const;
+
+        // Split a directory path in normalized components.
+        static UStringVector DirectoryComponents(const UString& dir);
+        static bool IsAbsolute(const UStringVector& dir);
+
+        // Inaccessible operations
+        HlsOutput() = delete;
+        HlsOutput(const HlsOutput&) = delete;
+        HlsOutput& operator=(const HlsOutput&) = delete;
+    };
+}
+
 TSPLUGIN_DECLARE_VERSION
 TSPLUGIN_DECLARE_INPUT(hls, ts::HlsInput)
+TSPLUGIN_DECLARE_OUTPUT(hls, ts::HlsOutput)
 
 
 //----------------------------------------------------------------------------
@@ -104,8 +243,10 @@ ts::HlsInput::HlsInput(TSP* tsp_) :
     _lowestRes(false),
     _highestRes(false),
     _maxSegmentCount(0),
+    _prefetch(0),
     _web_args(),
-    _playlist()
+    _playlist(),
+    _buffer()
 {
     _web_args.defineOptions(*this);
 
@@ -156,6 +297,12 @@ ts::HlsInput::HlsInput(TSP* tsp_) :
         u"Specify the maximum number of queued TS packets before their insertion into the stream. "
         u"The default is " + UString::Decimal(DEFAULT_MAX_QUEUED_PACKETS) + u".");
 
+    option(u"prefetch", 0, POSITIVE);
+    help(u"prefetch",
+        u"Specify the number of media segments which are downloaded in advance, in parallel, "
+        u"while the current segment is inserted into the stream. Live playlists are reloaded "
+        u"in the background. The default is " + UString::Decimal(DEFAULT_PREFETCH) + u".");
+
     option(u"segment-count", 's', POSITIVE);
     help(u"segment-count",
         u"Stop receiving the HLS stream after receiving the specified number of media segments. "
@@ -173,6 +320,7 @@ bool ts::HlsInput::getOptions()
     _web_args.loadArgs(*this);
     getValue(_url, u"");
     getIntValue(_maxSegmentCount, u"segment-count");
+    _prefetch = intValue<size_t>(u"prefetch", DEFAULT_PREFETCH);
     getIntValue(_minRate, u"min-bitrate");
     getIntValue(_maxRate, u"max-bitrate");
     getIntValue(_minWidth, u"min-width");
@@ -281,28 +429,759 @@ bool ts::HlsInput::start()
 
 void ts::HlsInput::processInput()
 {
-    // Loop on all segments in the media playlists.
-    for (size_t count = 0; _playlist.segmentCount() > 0 && (_maxSegmentCount == 0 || count < _maxSegmentCount) && !tsp->aborting(); ++count) {
+    // Reset the prefetch state.
+    _buffer.reset(_prefetch);
+
+    // Start the playlist thread and the download threads.
+    PlayListThread playlistThread(this);
+    std::vector<SafePtr<DownloadThread>> downloadThreads(_prefetch);
+    playlistThread.start();
+    for (size_t i = 0; i < downloadThreads.size(); ++i) {
+        downloadThreads[i] = new DownloadThread(this);
+        downloadThreads[i]->start();
+    }
+
+    // Statistics.
+    size_t      segCount = 0;        // Number of inserted segments.
+    size_t      failCount = 0;       // Number of segments which could not be downloaded.
+    uint64_t    totalBytes = 0;      // Total downloaded bytes.
+    MilliSecond totalDuration = 0;   // Total download time of all segments.
+    MilliSecond maxDuration = 0;     // Maximum download time of a segment.
+    size_t      starveCount = 0;     // Number of times the next segment was not yet available.
+    MilliSecond starveDuration = 0;  // Total time waiting for segments.
 
-        // Remove first segment from the playlist.
-        hls::MediaSegment seg;
-        _playlist.popFirstSegment(seg);
+    // Insert the segments in playlist order, as they are downloaded.
+    bool ok = true;
+    while (ok) {
 
-        // Create a Web request to download the content.
+        // Wait for the first segment in the prefetch buffer to be completed.
+        hls::PrefetchBuffer::SegmentPtr seg;
+        bool end = false;
+        bool starved = false;
+        const Time start(Time::CurrentUTC());
+        for (;;) {
+            ok = !tsp->aborting() && !isInterrupted();
+            if (!ok || !(seg = _buffer.pop(starved ? ABORT_POLL_INTERVAL : 0, end)).isNull() || end) {
+                break;
+            }
+            starved = true;
+        }
+        const size_t depth = _buffer.loadedCount();
+        const MilliSecond waited = starved ? Time::CurrentUTC() - start : 0;
+
+        // End of playlist or abort.
+        if (seg.isNull()) {
+            break;
+        }
+        if (starved) {
+            starveCount++;
+            starveDuration += waited;
+        }
+        if (seg->status != hls::PrefetchBuffer::SEG_LOADED) {
+            failCount++;
+            continue;
+        }
+
+        // Segment statistics.
+        segCount++;
+        totalBytes += seg->data.size();
+        totalDuration += seg->duration;
+        maxDuration = std::max(maxDuration, seg->duration);
+        tsp->debug(u"segment #%d: %'d bytes, downloaded in %'d ms, waited %'d ms, prefetched: %d/%d",
+                   {seg->index, seg->data.size(), seg->duration, waited, depth, _prefetch});
+
+        if (!seg->mime.empty() && !seg->mime.similar(u"video/mp2t")) {
+            tsp->warning(u"MIME type is %s, maybe not a valid transport stream", {seg->mime});
+        }
+
+        // Insert complete packets, ignore a trailing truncated packet.
+        const size_t count = seg->data.size() / PKT_SIZE;
+        if (count * PKT_SIZE < seg->data.size()) {
+            tsp->debug(u"segment #%d: ignoring %d trailing bytes", {seg->index, seg->data.size() - count * PKT_SIZE});
+        }
+        ok = count == 0 || pushPackets(reinterpret_cast<const TSPacket*>(seg->data.data()), count);
+    }
+
+    // Terminate all threads.
+    _buffer.terminate();
+    playlistThread.waitForTermination();
+    for (size_t i = 0; i < downloadThreads.size(); ++i) {
+        downloadThreads[i]->waitForTermination();
+    }
+    _buffer.reset(_prefetch);
+
+    tsp->verbose(u"HLS playlist completed, %'d segments, %'d bytes, %d failed segments", {segCount, totalBytes, failCount});
+    tsp->verbose(u"segment download time: average %'d ms, maximum %'d ms, input waited %d times for segments, %'d ms",
+                 {segCount == 0 ? 0 : totalDuration / segCount, maxDuration, starveCount, starveDuration});
+}
+
+
+//----------------------------------------------------------------------------
+// Download threads: download media segments from the prefetch buffer.
+//----------------------------------------------------------------------------
+
+void ts::HlsInput::downloadSegments()
+{
+    for (;;) {
+        // Wait for a segment to download, until termination.
+        const hls::PrefetchBuffer::SegmentPtr seg(_buffer.nextPending());
+        if (seg.isNull()) {
+            break;
+        }
+
+        // Download the segment content. The segment is not accessed by other threads while loading.
+        // The download is interrupted when the buffer is terminated, on abort or end of input.
         WebRequest request(*tsp);
-        request.setURL(_playlist.buildURL(seg.uri));
+        request.setURL(seg->url);
         request.setAutoRedirect(true);
         request.setArgs(_web_args);
+        request.setAbortInterface(&_buffer);
 
-        // Perform the download of the current segment.
-        // Ignore errors, continue to play next segments.
-        request.downloadToApplication(this);
+        const Time start(Time::CurrentUTC());
+        const bool success = request.downloadBinaryContent(seg->data);
+        const MilliSecond duration = Time::CurrentUTC() - start;
 
-        // If there is only one or zero remaining segment, try to reload the playlist.
-        if (_playlist.segmentCount() < 2 && _playlist.updatable() && !tsp->aborting()) {
+        if (success) {
+            tsp->verbose(u"downloaded %s", {request.finalURL()});
+        }
+        else {
             // Ignore errors, continue to play next segments.
-            _playlist.reload(false, _web_args, *tsp);
+            tsp->debug(u"failed to download segment #%d", {seg->index});
+        }
+
+        // Mark the segment as completed.
+        seg->mime = request.mimeType();
+        seg->duration = duration;
+        _buffer.completed(seg, success);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Playlist thread: fill the prefetch buffer and reload live playlists.
+//----------------------------------------------------------------------------
+
+void ts::HlsInput::feedSegments()
+{
+    size_t count = 0;
+    Time nextReload(Time::Epoch);
+
+    for (;;) {
+        // Wait for room in the prefetch buffer and move segments from the playlist.
+        size_t room = _buffer.waitRoom();
+        if (room == 0) {
+            break;
+        }
+        for (; room > 0 && _playlist.segmentCount() > 0 && (_maxSegmentCount == 0 || count < _maxSegmentCount); --room) {
+            hls::MediaSegment seg;
+            _playlist.popFirstSegment(seg);
+            _buffer.push(_playlist.buildURL(seg.uri));
+            count++;
+        }
+
+        // Stop after the last segment.
+        if (_maxSegmentCount > 0 && count >= _maxSegmentCount) {
+            break;
+        }
+
+        // If there is only one or zero remaining segment, try to reload the playlist, without holding the mutex.
+        if (_playlist.segmentCount() < 2 && _playlist.updatable()) {
+            const Time now(Time::CurrentUTC());
+            if (now < nextReload) {
+                // Recent reload without new segment, wait a bit before reloading again.
+                if (_playlist.segmentCount() == 0) {
+                    _buffer.waitTerminate(nextReload - now);
+                }
+                continue;
+            }
+            const size_t previous = _playlist.mediaSequence() + _playlist.segmentCount();
+            const bool reloaded = _playlist.reload(false, _web_args, *tsp);
+            if (!reloaded && _playlist.segmentCount() == 0) {
+                // Reload error, end of live stream.
+                break;
+            }
+            if (_playlist.mediaSequence() + _playlist.segmentCount() == previous) {
+                // No new segment, do not reload before half a target duration.
+                nextReload = now + std::max<MilliSecond>(MIN_RELOAD_INTERVAL, _playlist.targetDuration() * MilliSecPerSec / 2);
+            }
+        }
+        else if (_playlist.segmentCount() == 0) {
+            // End of playlist.
+            break;
+        }
+    }
+
+    // Notify the input thread that no more segment will come.
+    _buffer.setEnd();
+}
+
+
+//----------------------------------------------------------------------------
+// Output plugin constructor
+//----------------------------------------------------------------------------
+
+ts::HlsOutput::HlsOutput(TSP* tsp_) :
+    OutputPlugin(tsp_, u"Generate HTTP Live Streaming (HLS) media", u"[options] playlist"),
+    _playlistFile(),
+    _segmentPrefix(),
+    _segmentSuffix(),
+    _targetDuration(0),
+    _partDuration(0),
+    _liveDepth(0),
+    _optPID(PID_NULL),
+    _demux(this),
+    _playlist(),
+    _segFile(),
+    _refPID(PID_NULL),
+    _pmtPID(PID_NULL),
+    _lastTS(INVALID_PTS),
+    _segNumber(0),
+    _segSize(0),
+    _segStartTS(INVALID_PTS),
+    _segPackets(0),
+    _partOffset(0),
+    _partStartTS(INVALID_PTS),
+    _partPackets(0),
+    _partIndependent(false),
+    _patRepeater(),
+    _pmtRepeaters(),
+    _segmentFiles(),
+    _obsoleteFiles()
+{
+    option(u"", 0, STRING, 1, 1);
+    help(u"",
+         u"Specify the name of the media playlist file to generate. "
+         u"This is typically a file name ending in .m3u8. "
+         u"The playlist and the media segments are written directly by this plugin, "
+         u"without external segmenter.");
+
+    option(u"duration", 'd', POSITIVE);
+    help(u"duration",
+         u"Specify the target duration in seconds of media segments. "
+         u"Segments are cut on the first random access point of the reference PID "
+         u"after the target duration. When random access points are too sparse, segments "
+         u"are cut without random access point, before exceeding the target duration. The default is " + UString::Decimal(DEFAULT_SEGMENT_DURATION) + u" seconds.");
+
+    option(u"live", 'l', POSITIVE);
+    help(u"live",
+         u"Generate a live playlist with a sliding window of the specified number of media segments. "
+         u"The segment files which are no longer referenced are later deleted. "
+         u"By default, all segments are kept in the playlist.");
+
+    option(u"partial-duration", 0, POSITIVE);
+    help(u"partial-duration",
+         u"Generate partial segments for low-latency HLS with the specified target duration in milliseconds. "
+         u"The partial segments are described as byte ranges in the media segment in progress. "
+         u"By default, no partial segment is generated.");
+
+    option(u"pid", 'p', PIDVAL);
+    help(u"pid",
+         u"Specify the reference PID for segment cuts and durations. "
+         u"By default, use the first video PID which is found in a PMT. "
+         u"Without reference PID, the segments are cut according to the TS bitrate.");
+
+    option(u"segment-template", 's', STRING);
+    help(u"segment-template",
+         u"Specify the template of the media segment file names. "
+         u"A sequence number is inserted before the file extension. "
+         u"By default, use the playlist file name with extension .ts. "
+         u"Example: with the template 'dir/seg.ts', the media segments are 'dir/seg-000000.ts', "
+         u"'dir/seg-000001.ts', etc.");
+}
+
+
+//----------------------------------------------------------------------------
+// Output command line options method
+//----------------------------------------------------------------------------
+
+bool ts::HlsOutput::getOptions()
+{
+    getValue(_playlistFile, u"");
+    const UString segTemplate(value(u"segment-template", (PathPrefix(_playlistFile) + u".ts").c_str()));
+    _segmentPrefix = PathPrefix(segTemplate) + u"-";
+    _segmentSuffix = PathSuffix(segTemplate);
+    _targetDuration = MilliSecPerSec * intValue<MilliSecond>(u"duration", DEFAULT_SEGMENT_DURATION);
+    _partDuration = intValue<MilliSecond>(u"partial-duration", 0);
+    _liveDepth = intValue<size_t>(u"live", 0);
+    _optPID = intValue<PID>(u"pid", PID_NULL);
+
+    if (_partDuration >= _targetDuration) {
+        tsp->error(u"the partial segment duration must be lower than the segment duration");
+        return false;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Output start method
+//----------------------------------------------------------------------------
+
+bool ts::HlsOutput::start()
+{
+    // Use protocol version 6 for partial segments (low-latency HLS), 3 for decimal segment durations.
+    _playlist.reset(hls::MEDIA_PLAYLIST, _playlistFile, _partDuration > 0 ? 6 : 3);
+    _playlist.setTargetDuration(Second(_targetDuration / MilliSecPerSec));
+    _playlist.setPartTargetDuration(_partDuration);
+    if (_liveDepth == 0) {
+        // Segments are only added, the playlist is complete at end of stream.
+        _playlist.setPlaylistType(u"EVENT");
+    }
+
+    // Locate the service of the reference PID. Without reference PID on the
+    // command line, use the first video PID in the PMT's.
+    _demux.reset();
+    _demux.addPID(PID_PAT);
+
+    _refPID = _optPID;
+    _pmtPID = PID_NULL;
+    _lastTS = INVALID_PTS;
+    _segNumber = 0;
+    _partIndependent = false;
+    _patRepeater.reset();
+    _pmtRepeaters.clear();
+    _segmentFiles.clear();
+    _obsoleteFiles.clear();
+
+    return openSegment();
+}
+
+
+//----------------------------------------------------------------------------
+// Output stop method
+//----------------------------------------------------------------------------
+
+bool ts::HlsOutput::stop()
+{
+    bool ok = true;
+    if (_segFile.isOpen()) {
+        if (_segPackets > 0) {
+            // Last segment, up to the last time stamp.
+            ok = closeSegment(_lastTS);
+        }
+        else {
+            // Empty segment, drop it.
+            _segFile.close(*tsp);
+            DeleteFile(_segFile.getFileName());
+        }
+    }
+
+    // The stream is complete, no more segment will come.
+    _playlist.setEndList(true);
+    return _playlist.saveFile(UString(), *tsp) && ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Implementation of TableHandlerInterface: locate the reference PID.
+//----------------------------------------------------------------------------
+
+void ts::HlsOutput::handleTable(SectionDemux& demux, const BinaryTable& table)
+{
+    if (table.tableId() == TID_PAT && _pmtPID == PID_NULL) {
+        const PAT pat(table);
+        if (pat.isValid()) {
+            for (PAT::ServiceMap::const_iterator it = pat.pmts.begin(); it != pat.pmts.end(); ++it) {
+                demux.addPID(it->second);
+                _pmtRepeaters[it->second];
+            }
+        }
+    }
+    else if (table.tableId() == TID_PMT && _pmtPID == PID_NULL) {
+        const PMT pmt(table);
+        if (pmt.isValid()) {
+            for (PMT::StreamMap::const_iterator it = pmt.streams.begin(); it != pmt.streams.end(); ++it) {
+                if ((_refPID == PID_NULL && it->second.isVideo()) || it->first == _refPID) {
+                    // Found the service of the reference PID, stop demuxing.
+                    _refPID = it->first;
+                    _pmtPID = table.sourcePID();
+                    demux.reset();
+                    // Keep the PMT packets of this service only.
+                    const SectionRepeater pmtRepeater(_pmtRepeaters[_pmtPID]);
+                    _pmtRepeaters.clear();
+                    _pmtRepeaters[_pmtPID] = pmtRepeater;
+                    tsp->verbose(u"using PID 0x%X (%d) of service 0x%X (%d) as reference", {_refPID, _refPID, pmt.service_id, pmt.service_id});
+                    break;
+                }
+            }
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get the time stamp of a packet on the reference PID.
+//----------------------------------------------------------------------------
+
+uint64_t ts::HlsOutput::TimeStamp(const TSPacket& pkt)
+{
+    // Use the DTS when present: unlike the PTS, it is monotonic.
+    return pkt.hasDTS() ? pkt.getDTS() : (pkt.hasPTS() ? pkt.getPTS() : INVALID_PTS);
+}
+
+
+//----------------------------------------------------------------------------
+// Compute a duration from time stamps or from a number of packets.
+//----------------------------------------------------------------------------
+
+ts::MilliSecond ts::HlsOutput::duration(uint64_t startTS, uint64_t endTS, PacketCounter packets) const
+{
+    if (startTS != INVALID_PTS && endTS != INVALID_PTS) {
+        return MilliSecond(((endTS - startTS) & PTS_DTS_MASK) * MilliSecPerSec / SYSTEM_CLOCK_SUBFREQ);
+    }
+    const BitRate bitrate = tsp->bitrate();
+    return bitrate == 0 ? 0 : MilliSecond(packets * PKT_SIZE * 8 * MilliSecPerSec / bitrate);
+}
+
+
+//----------------------------------------------------------------------------
+// Build the URI of a segment file, relative to the playlist.
+//----------------------------------------------------------------------------
+
+ts::UString ts::HlsOutput::segmentURI(const UString& fileName) const
+{
+    const UStringVector playlistDir(DirectoryComponents(DirectoryName(VernacularFilePath(_playlistFile))));
+    const UStringVector segmentDir(DirectoryComponents(DirectoryName(VernacularFilePath(fileName))));
+
+    // Skip the common part of the two directories.
+    size_t common = 0;
+    while (common < playlistDir.size() && common < segmentDir.size() && playlistDir[common] == segmentDir[common]) {
+        common++;
+    }
+
+    // Without common root, an absolute path cannot be made relative to the playlist and conversely.
+    // Going up from the parent of a relative playlist directory is not possible either.
+    if ((common == 0 && (IsAbsolute(playlistDir) || IsAbsolute(segmentDir))) || (common < playlistDir.size() && playlistDir[common] == u"..")) {
+        return fileName;
+    }
+
+    // Go up to the common part of the two directories, then down to the segment directory.
+    // A URI always uses forward slashes.
+    UString uri;
+    for (size_t i = common; i < playlistDir.size(); ++i) {
+        uri.append(u"../");
+    }
+    for (size_t i = common; i < segmentDir.size(); ++i) {
+        uri.append(segmentDir[i]);
+        uri.append(u'/');
+    }
+    uri.append(BaseName(VernacularFilePath(fileName)));
+    return uri;
+}
+
+
+//----------------------------------------------------------------------------
+// Split a directory path in normalized components.
+// An absolute path starts with an empty component or a Windows drive.
+//----------------------------------------------------------------------------
+
+ts::UStringVector ts::HlsOutput::DirectoryComponents(const UString& dir)
+{
+    UStringVector in;
+    UStringVector out;
+    dir.split(in, PathSeparator, false, false);
+
+    for (size_t i = 0; i < in.size(); ++i) {
+        if ((i > 0 && in[i].empty()) || in[i] == u".") {
+            // Redundant separator or current directory.
+        }
+        else if (in[i] != u".." || out.empty() || out.back() == u"..") {
+            out.push_back(in[i]);
+        }
+        else if (out.size() > 1 || !IsAbsolute(out)) {
+            // Parent of a known directory. The parent of the root is the root.
+            out.pop_back();
         }
     }
-    tsp->verbose(u"HLS playlist completed");
+    return out;
+}
+
+bool ts::HlsOutput::IsAbsolute(const UStringVector& dir)
+{
+    return !dir.empty() && (dir.front().empty() || dir.front().endWith(u":"));
+}
+
+
+//----------------------------------------------------------------------------
+// Write packets in the segment in progress.
+//----------------------------------------------------------------------------
+
+bool ts::HlsOutput::writePackets(const TSPacket* pkt, size_t count)
+{
+    _segSize += count * PKT_SIZE;
+    return count == 0 || _segFile.write(pkt, count, *tsp);
+}
+
+
+//----------------------------------------------------------------------------
+// Repetition of the last sections of a PSI PID in each segment.
+//----------------------------------------------------------------------------
+
+ts::HlsOutput::SectionRepeater::SectionRepeater() :
+    _current(),
+    _section(),
+    _last(),
+    _cc(0)
+{
+}
+
+void ts::HlsOutput::SectionRepeater::reset()
+{
+    _current.clear();
+    _section.clear();
+    _last.clear();
+    _cc = 0;
+}
+
+void ts::HlsOutput::SectionRepeater::feedPacket(const TSPacket& pkt)
+{
+    // The continuity counter is incremented only in packets with payload.
+    if (!pkt.hasPayload() || pkt.getPayloadSize() == 0) {
+        return;
+    }
+    _cc = pkt.getCC();
+
+    const uint8_t* const data = pkt.getPayload();
+    const size_t size = pkt.getPayloadSize();
+
+    if (pkt.getPUSI()) {
+        // The pointer field gives the size of the end of the section in progress, if any.
+        const size_t pointer = std::min<size_t>(data[0], size - 1);
+        if (!_current.empty() && pointer > 0) {
+            _current.push_back(pkt);
+            addData(data + 1, pointer);
+        }
+        // Restart from this packet.
+        _current.clear();
+        _section.clear();
+        _current.push_back(pkt);
+        addData(data + 1 + pointer, size - 1 - pointer);
+    }
+    else if (!_current.empty()) {
+        _current.push_back(pkt);
+        addData(data, size);
+    }
+}
+
+void ts::HlsOutput::SectionRepeater::addData(const uint8_t* data, size_t size)
+{
+    _section.append(data, size);
+
+    // Several sections can follow in the same packet, until stuffing.
+    while (_section.size() >= 3 && _section[0] != 0xFF) {
+        const size_t length = 3 + (GetUInt16(_section.data() + 1) & 0x0FFF);
+        if (_section.size() < length) {
+            return; // section in progress
+        }
+        _last = _current;
+        _section.erase(0, length);
+    }
+
+    // No section in progress after stuffing or at end of packet, wait for next PUSI.
+    if (_section.empty() || _section[0] == 0xFF) {
+        _current.clear();
+        _section.clear();
+    }
+}
+
+void ts::HlsOutput::SectionRepeater::getPackets(TSPacketVector& pkts) const
+{
+    // The last sections are repeated in each segment, even when the PSI repetition period
+    // is longer than the segments. The repeated packets follow the last packet in the PID.
+    // Their continuity counters are renumbered so that the last one is identical to the last
+    // packet in the PID. A single packet which is repeated once is a legal duplicate packet
+    // which is ignored by receivers which already got the original one. Otherwise, these
+    // receivers see a discontinuity and resynchronize on the repeated sections.
+    pkts = _last;
+    for (size_t i = 0; i < pkts.size(); ++i) {
+        pkts[i].setCC(uint8_t(_cc - (pkts.size() - 1 - i)) & CC_MASK);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Open a new media segment.
+//----------------------------------------------------------------------------
+
+bool ts::HlsOutput::openSegment()
+{
+    const UString fileName(UString::Format(u"%s%0*d%s", {_segmentPrefix, SEGMENT_NUMBER_WIDTH, _segNumber, _segmentSuffix}));
+    if (!_segFile.open(fileName, false, false, *tsp)) {
+        return false;
+    }
+    tsp->debug(u"creating media segment %s", {fileName});
+
+    _segSize = 0;
+    _segStartTS = _lastTS;
+    _segPackets = 0;
+    _partOffset = 0;
+    _partStartTS = _lastTS;
+    _partPackets = 0;
+
+    // Repeat the last PAT and PMT so that the segment can be decoded alone.
+    // Before the reference service is found, repeat all PMT's.
+    TSPacketVector pkts;
+    _patRepeater.getPackets(pkts);
+    bool ok = writePackets(pkts.data(), pkts.size());
+    for (std::map<PID, SectionRepeater>::const_iterator it = _pmtRepeaters.begin(); ok && it != _pmtRepeaters.end(); ++it) {
+        it->second.getPackets(pkts);
+        ok = writePackets(pkts.data(), pkts.size());
+    }
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Close the media segment in progress and update the playlist.
+//----------------------------------------------------------------------------
+
+bool ts::HlsOutput::closeSegment(uint64_t endTS)
+{
+    hls::MediaSegment seg;
+    seg.uri = segmentURI(_segFile.getFileName());
+    seg.duration = duration(_segStartTS, endTS, _segPackets);
+    if (seg.duration > 0) {
+        seg.bitrate = BitRate(_segSize * 8 * MilliSecPerSec / seg.duration);
+    }
+    if (!_segFile.close(*tsp)) {
+        return false;
+    }
+    tsp->debug(u"media segment %s, %d ms, %'d bytes", {seg.uri, seg.duration, _segSize});
+
+    // The target duration must not be lower than any rounded segment duration. Segments are
+    // cut before exceeding it, unless the time stamps are discontinuous or too sparse. The
+    // target duration cannot be increased since the playlist was already published with it.
+    const Second secs = Second((seg.duration + MilliSecPerSec / 2) / MilliSecPerSec);
+    if (secs > _playlist.targetDuration()) {
+        tsp->warning(u"media segment %s duration is %d ms, longer than target duration (%d seconds)", {seg.uri, seg.duration, _playlist.targetDuration()});
+    }
+
+    _playlist.addSegment(seg, *tsp);
+    _segmentFiles.push_back(_segFile.getFileName());
+    _segNumber++;
+
+    // Live playlist: remove the oldest segments from the sliding window. The segment files
+    // are deleted later: they must remain available during the duration of the playlist
+    // plus one segment, for clients which loaded a previous version of the playlist.
+    while (_liveDepth > 0 && _playlist.segmentCount() > _liveDepth) {
+        hls::MediaSegment old;
+        _playlist.popFirstSegment(old);
+        _obsoleteFiles.push_back(_segmentFiles.front());
+        _segmentFiles.pop_front();
+    }
+    while (_obsoleteFiles.size() > _liveDepth + 1) {
+        tsp->debug(u"deleting obsolete media segment %s", {_obsoleteFiles.front()});
+        DeleteFile(_obsoleteFiles.front());
+        _obsoleteFiles.pop_front();
+    }
+
+    return _playlist.saveFile(UString(), *tsp);
+}
+
+
+//----------------------------------------------------------------------------
+// Close the partial segment in progress and update the playlist.
+//----------------------------------------------------------------------------
+
+bool ts::HlsOutput::closePart(uint64_t endTS)
+{
+    hls::MediaSegment part;
+    part.uri = segmentURI(_segFile.getFileName());
+    part.duration = duration(_partStartTS, endTS, _partPackets);
+    part.byteOffset = _partOffset;
+    part.byteSize = _segSize - _partOffset;
+    part.independent = _partIndependent;
+    _playlist.addPart(part, *tsp);
+
+    _partOffset = _segSize;
+    _partStartTS = endTS;
+    _partPackets = 0;
+    _partIndependent = false;
+
+    return _playlist.saveFile(UString(), *tsp);
+}
+
+
+//----------------------------------------------------------------------------
+// Output method
+//----------------------------------------------------------------------------
+
+bool ts::HlsOutput::send(const TSPacket* buffer, size_t packet_count)
+{
+    // Packets are written directly from the buffer, by contiguous sequences between cuts.
+    size_t first = 0;
+
+    for (size_t i = 0; i < packet_count; ++i) {
+        const TSPacket& pkt(buffer[i]);
+        const PID pid = pkt.getPID();
+        bool cutSegment = false;
+        bool cutPart = false;
+        uint64_t ts = INVALID_PTS;
+
+        if (_refPID == PID_NULL) {
+            // No reference PID (yet), cut anywhere, based on the bitrate.
+            cutSegment = _segPackets > 0 && duration(INVALID_PTS, INVALID_PTS, _segPackets) >= _targetDuration;
+            cutPart = !cutSegment && _partDuration > 0 && _partPackets > 0 && duration(INVALID_PTS, INVALID_PTS, _partPackets) >= _partDuration;
+        }
+        else if (pid == _refPID && pkt.getPUSI()) {
+            // Start of a PES packet on the reference PID, a possible cut point.
+            ts = TimeStamp(pkt);
+            if (_segStartTS == INVALID_PTS) {
+                // First time stamp in the segment.
+                _segStartTS = _partStartTS = ts;
+            }
+            // Cut segments on random access points after the target duration. The rounded segment
+            // duration must not exceed the target duration, which cannot change in a playlist which
+            // is being updated. When random access points do not come in time, cut before the PES
+            // packet which would exceed it.
+            const MilliSecond segDuration = duration(_segStartTS, ts, _segPackets);
+            const MilliSecond pesDuration = _lastTS == INVALID_PTS || ts == INVALID_PTS ? 0 : duration(_lastTS, ts, 0);
+            cutSegment = _segPackets > 0 &&
+                ((pkt.getRandomAccessIndicator() && segDuration >= _targetDuration) ||
+                 segDuration + pesDuration >= _targetDuration + MilliSecPerSec / 2);
+            // Partial segments must not exceed their target duration: cut before the PES packet which would exceed it.
+            cutPart = !cutSegment && _partDuration > 0 && _partPackets > 0 && duration(_partStartTS, ts, _partPackets) + pesDuration > _partDuration;
+        }
+
+        if (ts != INVALID_PTS) {
+            _lastTS = ts;
+        }
+
+        if (cutSegment || cutPart) {
+            // Write pending packets before the cut.
+            if (!writePackets(buffer + first, i - first)) {
+                return false;
+            }
+            first = i;
+            if (cutSegment) {
+                // The complete segment replaces its partial segments in the playlist.
+                if (!closeSegment(ts) || !openSegment()) {
+                    return false;
+                }
+            }
+            else if (!closePart(ts)) {
+                return false;
+            }
+            _partIndependent = pid == _refPID && pkt.getRandomAccessIndicator();
+        }
+
+        _segPackets++;
+        _partPackets++;
+
+        // Keep track of PSI to repeat PAT and PMT in each segment and to locate the reference PID.
+        // The PMT packets are collected before the demux identifies the reference service.
+        if (pid == PID_PAT) {
+            _patRepeater.feedPacket(pkt);
+        }
+        else {
+            const std::map<PID, SectionRepeater>::iterator it(_pmtRepeaters.find(pid));
+            if (it != _pmtRepeaters.end()) {
+                it->second.feedPacket(pkt);
+            }
+        }
+        _demux.feedPacket(pkt);
+    }
+
+    // Write remaining packets.
+    return writePackets(buffer + first, packet_count - first);
 }
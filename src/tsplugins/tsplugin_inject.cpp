@@ -138,7 +138,8 @@ ts::InjectPlugin::InjectPlugin (TSP* tsp_) :
     option(u"", 0, STRING, 1, UNLIMITED_COUNT);
     help(u"",
          u"Binary or XML files containing one or more sections or tables. By default, "
-         u"files ending in .xml are XML and files ending in .bin are binary. For other "
+         u"files ending in .xml are XML, files ending in .bin are binary and files ending "
+         u"in .sidx are indexed section files (see tstables --indexed-output). For other "
          u"file names, explicitly specify --binary or --xml.\n\n"
          u"If different repetition rates are required for different files, "
          u"a parameter can be \"filename=value\" where value is the "
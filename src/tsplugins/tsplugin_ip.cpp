@@ -47,6 +47,7 @@ TSDUCK_SOURCE;
 #define DEF_PACKET_BURST     7  // 1316 B, fits (with headers) in Ethernet MTU
 #define MAX_PACKET_BURST   128  // ~ 48 kB
 #define MAX_IP_SIZE      65536
+#define DEF_RECEIVE_BATCH   32  // UDP messages per receive operation
 
 
 //----------------------------------------------------------------------------
@@ -72,6 +73,7 @@ namespace ts {
 
     private:
         UDPReceiver   _sock;               // Incoming socket with associated command line options
+        size_t        _batch_size;         // Maximum number of UDP messages per receive operation
         MilliSecond   _eval_time;          // Bitrate evaluation interval in milli-seconds
         MilliSecond   _display_time;       // Bitrate display interval in milli-seconds
         Time          _next_display;       // Next bitrate display time
@@ -81,9 +83,15 @@ namespace ts {
         PacketCounter _packets_0;          // Number of received packets since _start_0
         Time          _start_1;            // Start of previous bitrate evaluation period
         PacketCounter _packets_1;          // Number of received packets since _start_1
-        size_t        _inbuf_count;        // Remaining TS packets in inbuf
-        size_t        _inbuf_next;         // Index in inbuf of next TS packet to return
-        uint8_t       _inbuf[MAX_IP_SIZE]; // Input buffer
+        ByteBlock     _inbuf;              // Input buffer, one slot of MAX_IP_SIZE bytes per message
+        std::vector<UDPSocket::ReceivedMessage> _msgs;  // Received messages, in _inbuf
+        size_t        _msg_count;          // Number of received messages in _msgs
+        size_t        _msg_next;           // Index in _msgs of next message to process
+        size_t        _inbuf_count;        // Remaining TS packets in current message
+        const uint8_t* _inbuf_next;        // Address of next TS packet to return in current message
+
+        // Locate the TS packets inside a UDP message, set _inbuf_next and _inbuf_count.
+        bool locatePackets(const uint8_t* data, size_t size);
 
         // Inaccessible operations
         IPInput() = delete;
@@ -126,6 +134,7 @@ TSPLUGIN_DECLARE_OUTPUT(ip, ts::IPOutput)
 ts::IPInput::IPInput(TSP* tsp_) :
     InputPlugin(tsp_, u"Receive TS packets from UDP/IP, multicast or unicast", u"[options] [address:]port"),
     _sock(*tsp_),
+    _batch_size(DEF_RECEIVE_BATCH),
     _eval_time(0),
     _display_time(0),
     _next_display(Time::Epoch),
@@ -135,9 +144,12 @@ ts::IPInput::IPInput(TSP* tsp_) :
     _packets_0(0),
     _start_1(Time::Epoch),
     _packets_1(0),
+    _inbuf(),
+    _msgs(),
+    _msg_count(0),
+    _msg_next(0),
     _inbuf_count(0),
-    _inbuf_next(0),
-    _inbuf()
+    _inbuf_next(nullptr)
 {
     // Add UDP receiver common options.
     _sock.defineOptions(*this);
@@ -154,6 +166,14 @@ ts::IPInput::IPInput(TSP* tsp_) :
          u"basis. The value specifies the number of seconds between two evaluations. "
          u"By default, the real-time input bitrate is never evaluated and the input "
          u"bitrate is evaluated from the PCR in the input packets.");
+
+    option(u"receive-batch", 0, INTEGER, 0, 1, 1, UDPSocket::MAX_RECEIVE_BATCH);
+    help(u"receive-batch", u"count",
+         u"Specify the maximum number of UDP messages to receive at a time. "
+         u"On Linux, all available messages, up to this number, are received using "
+         u"one single system call. This reduces the CPU load with high bitrates. "
+         u"On other systems, one message is received at a time. "
+         u"The default is " TS_USTRINGIFY(DEF_RECEIVE_BATCH) u" messages.");
 }
 
 
@@ -179,6 +199,12 @@ ts::IPOutput::IPOutput(TSP* tsp_) :
          u"of the outgoing local interface. It can be also a host name that "
          u"translates to a local address.");
 
+    option(u"no-gso");
+    help(u"no-gso",
+         u"Do not use UDP Generic Segmentation Offload (GSO). By default, on Linux, "
+         u"when the kernel supports it, consecutive UDP messages are passed to the "
+         u"kernel in large buffers and segmented as late as possible.");
+
     option(u"packet-burst", 'p', INTEGER, 0, 1, 1, MAX_PACKET_BURST);
     help(u"packet-burst",
          u"Specifies how many TS packets should be grouped into a UDP packet. "
@@ -208,6 +234,7 @@ bool ts::IPInput::getOptions()
     // Get command line arguments
     _eval_time = MilliSecPerSec * intValue<MilliSecond>(u"evaluation-interval", 0);
     _display_time = MilliSecPerSec * intValue<MilliSecond>(u"display-interval", 0);
+    _batch_size = intValue<size_t>(u"receive-batch", DEF_RECEIVE_BATCH);
     return _sock.load(*this);
 }
 
@@ -224,8 +251,16 @@ bool ts::IPInput::start()
     }
 
     // Socket now ready.
+    // Allocate the input buffer, one slot per message.
+    _inbuf.resize(_batch_size * MAX_IP_SIZE);
+    _msgs.resize(_batch_size);
+    for (size_t i = 0; i < _batch_size; ++i) {
+        _msgs[i] = UDPSocket::ReceivedMessage(&_inbuf[i * MAX_IP_SIZE], MAX_IP_SIZE);
+    }
+
     // Initialize working data.
-    _inbuf_count = _inbuf_next = 0;
+    _msg_count = _msg_next = _inbuf_count = 0;
+    _inbuf_next = nullptr;
     _start = _start_0 = _start_1 = _next_display = Time::Epoch;
     _packets = _packets_0 = _packets_1 = 0;
 
@@ -239,6 +274,10 @@ bool ts::IPInput::start()
 
 bool ts::IPInput::stop()
 {
+    const uint64_t calls = _sock.receiveCallCount();
+    const uint64_t msgs = _sock.receivedMessageCount();
+    tsp->debug(u"received %'d UDP messages in %'d system calls, %d.%02d messages per call",
+               {msgs, calls, calls == 0 ? 0 : msgs / calls, calls == 0 ? 0 : ((100 * msgs) / calls) % 100});
     _sock.close(*tsp);
     return true;
 }
@@ -284,83 +323,106 @@ ts::BitRate ts::IPInput::getBitrate()
 
 
 //----------------------------------------------------------------------------
-// Input method
+// Locate the TS packets inside a UDP message.
 //----------------------------------------------------------------------------
 
-size_t ts::IPInput::receive(TSPacket* buffer, size_t max_packets)
+bool ts::IPInput::locatePackets(const uint8_t* data, size_t size)
 {
-    // Check if we receive new packets or process remain of previous buffer.
-    bool new_packets = false;
-
-    // If there is no remaining packet in the input buffer, wait for a UDP
-    // message. Loop until we get some TS packets.
-    while (_inbuf_count <= 0) {
-
-        // Wait for a UDP message
-        SocketAddress sender;
-        SocketAddress destination;
-        size_t insize;
-        if (!_sock.receive(_inbuf, sizeof(_inbuf), insize, sender, destination, tsp, *tsp)) {
-            return 0;
-        }
+    // Basically, we expect the message to contain only TS packets. However,
+    // we will face the following situations:
+    // - Presence of a header preceeding the first TS packet (typically
+    //   when the TS packets are encapsulated in RTP).
+    // - Presence of a truncated packet at the end of message.
+
+    // To face the first situation, we look backward from the end of
+    // the message, looking for a 0x47 sync byte every 188 bytes, going
+    // backward.
+
+    const uint8_t* p;
+    for (p = data + size; p >= data + PKT_SIZE && p[-int(PKT_SIZE)] == SYNC_BYTE; p -= PKT_SIZE) {}
+
+    if (p < data + size) {
+        // Some packets were found
+        _inbuf_next = p;
+        _inbuf_count = (data + size - p) / PKT_SIZE;
+        return true;
+    }
 
-        // Locate the TS packets inside the UDP message. Basically, we
-        // expect the message to contain only TS packets. However, we
-        // will face the following situations:
-        // - Presence of a header preceeding the first TS packet (typically
-        //   when the TS packets are encapsulated in RTP).
-        // - Presence of a truncated packet at the end of message.
-
-        // To face the first situation, we look backward from the end of
-        // the message, looking for a 0x47 sync byte every 188 bytes, going
-        // backward.
-
-        const uint8_t* p;
-        for (p = _inbuf + insize; p >= _inbuf + PKT_SIZE && p[-int(PKT_SIZE)] == SYNC_BYTE; p -= PKT_SIZE) {}
-
-        if (p < _inbuf + insize) {
-            // Some packets were found
-            _inbuf_next = p - _inbuf;
-            _inbuf_count = (_inbuf + insize - p) / PKT_SIZE;
-            new_packets = true;
-            break; // exit receive loop
+    // If no TS packet is found using the first method, we restart from
+    // the beginning of the message, looking for a 0x47 sync byte every
+    // 188 bytes, going forward. If we find this pattern, followed by
+    // less than 188 bytes, then we have found a sequence of TS packets.
+
+    const uint8_t* max = data + size - PKT_SIZE; // max address for a TS packet
+    _inbuf_count = 0;
+
+    for (p = data; p <= max; p++) {
+        if (*p == SYNC_BYTE) {
+            // Verify that we get a 0x47 sync byte every 188 bytes up
+            // to the end of message (not leaving more than one truncated
+            // TS packet at the end of the message).
+            const uint8_t* end;
+            for (end = p; end <= max && *end == SYNC_BYTE; end += PKT_SIZE) {}
+            if (end > max) {
+                // Less than 188 bytes after last packet. Consider we are OK
+                _inbuf_next = p;
+                _inbuf_count = (end - p) / PKT_SIZE;
+                return true;
+            }
         }
+    }
+
+    // No TS packet found in UDP message.
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Input method
+//----------------------------------------------------------------------------
 
-        // If no TS packet is found using the first method, we restart from
-        // the beginning of the message, looking for a 0x47 sync byte every
-        // 188 bytes, going forward. If we find this pattern, followed by
-        // less than 188 bytes, then we have found a sequence of TS packets.
-
-        const uint8_t* max = _inbuf + insize - PKT_SIZE; // max address for a TS packet
-        _inbuf_count = 0;
-
-        for (p = _inbuf; p <= max; p++) {
-            if (*p == SYNC_BYTE) {
-                // Verify that we get a 0x47 sync byte every 188 bytes up
-                // to the end of message (not leaving more than one truncated
-                // TS packet at the end of the message).
-                const uint8_t* end;
-                for (end = p; end <= max && *end == SYNC_BYTE; end += PKT_SIZE) {}
-                if (end > max) {
-                    // Less than 188 bytes after last packet. Consider we are OK
-                    _inbuf_next = p - _inbuf;
-                    _inbuf_count = (end - p) / PKT_SIZE;
-                    new_packets = true;
-                    break; // exit packet search loop
-                }
+size_t ts::IPInput::receive(TSPacket* buffer, size_t max_packets)
+{
+    size_t pkt_cnt = 0;      // Number of returned packets.
+    size_t new_packets = 0;  // Number of packets in newly processed UDP messages.
+
+    // Loop until the buffer is full or no more data is immediately available.
+    while (pkt_cnt < max_packets) {
+
+        if (_inbuf_count > 0) {
+            // Return packets from the current UDP message.
+            const size_t count = std::min(_inbuf_count, max_packets - pkt_cnt);
+            TSPacket::Copy(buffer + pkt_cnt, _inbuf_next, count);
+            pkt_cnt += count;
+            _inbuf_count -= count;
+            _inbuf_next += count * PKT_SIZE;
+        }
+        else if (_msg_next < _msg_count) {
+            // Locate the TS packets inside the next received UDP message.
+            const UDPSocket::ReceivedMessage& msg(_msgs[_msg_next++]);
+            if (locatePackets(reinterpret_cast<const uint8_t*>(msg.data), msg.size)) {
+                new_packets += _inbuf_count;
+            }
+            else {
+                tsp->debug(u"no TS packet in message from %s, %s bytes", {msg.sender, msg.size});
             }
         }
-
-        if (new_packets) {
-            break; // exit receive loop
+        else if (pkt_cnt > 0) {
+            // All received messages are processed, do not wait for more.
+            break;
+        }
+        else {
+            // Wait for UDP messages. Get all available ones at once.
+            _msg_next = 0;
+            if (!_sock.receiveBatch(_msgs.data(), _msgs.size(), _msg_count, tsp, *tsp)) {
+                _msg_count = 0;
+                return 0;
+            }
         }
-
-        // No TS packet found in UDP message, wait for another one.
-        tsp->debug(u"no TS packet in message from %s, %s bytes", {sender, insize});
     }
 
     // If new packets were received, we may need to re-evaluate the real-time input bitrate.
-    if (new_packets && _eval_time > 0) {
+    if (new_packets > 0 && _eval_time > 0) {
 
         const Time now(Time::CurrentUTC());
 
@@ -373,9 +435,9 @@ size_t ts::IPInput::receive(TSPacket* buffer, size_t max_packets)
         }
 
         // Count packets
-        _packets += _inbuf_count;
-        _packets_0 += _inbuf_count;
-        _packets_1 += _inbuf_count;
+        _packets += new_packets;
+        _packets_0 += new_packets;
+        _packets_1 += new_packets;
 
         // Detect new evaluation period
         if (now >= _start_1 + _eval_time) {
@@ -399,12 +461,6 @@ size_t ts::IPInput::receive(TSPacket* buffer, size_t max_packets)
         }
     }
 
-    // Return packets from the input buffer
-    size_t pkt_cnt = std::min(_inbuf_count, max_packets);
-    TSPacket::Copy(buffer, _inbuf + _inbuf_next, pkt_cnt);
-    _inbuf_count -= pkt_cnt;
-    _inbuf_next += pkt_cnt * PKT_SIZE;
-
     return pkt_cnt;
 }
 
@@ -426,6 +482,7 @@ bool ts::IPOutput::start()
     bool ok = _sock.open(*tsp);
 
     if (ok) {
+        _sock.setGSO(!present(u"no-gso"));
         ok = _sock.setDefaultDestination(dest_name, *tsp) &&
             (loc_name.empty() || _sock.setOutgoingMulticast(loc_name, *tsp)) &&
             (tos < 0 || _sock.setTOS(tos, *tsp)) &&
@@ -445,6 +502,10 @@ bool ts::IPOutput::start()
 
 bool ts::IPOutput::stop()
 {
+    const uint64_t calls = _sock.sendCallCount();
+    const uint64_t msgs = _sock.sentMessageCount();
+    tsp->debug(u"sent %'d UDP messages in %'d system calls, %d.%02d messages per call",
+               {msgs, calls, calls == 0 ? 0 : msgs / calls, calls == 0 ? 0 : ((100 * msgs) / calls) % 100});
     _sock.close(*tsp);
     return true;
 }
@@ -467,15 +528,6 @@ ts::IPOutput::~IPOutput()
 bool ts::IPOutput::send(const TSPacket* pkt, size_t packet_count)
 {
     // Send TS packets in UDP messages, grouped according to burst size.
-
-    while (packet_count > 0) {
-        size_t count = std::min(packet_count, _pkt_burst);
-        if (!_sock.send(pkt, count * PKT_SIZE, *tsp)) {
-            return false;
-        }
-        pkt += count;
-        packet_count -= count;
-    }
-
-    return true;
+    // All messages are sent at once, in as few system calls as possible.
+    return _sock.sendBatch(pkt, packet_count * PKT_SIZE, _pkt_burst * PKT_SIZE, *tsp);
 }
@@ -51,6 +51,7 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, size_t, Status*, bool&, bool&) override;
 
     private:
         // Description of one PID
@@ -282,3 +283,14 @@ ts::ProcessorPlugin::Status ts::PCRVerifyPlugin::processPacket(TSPacket& pkt, bo
 
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+size_t ts::PCRVerifyPlugin::processPacketBatch(TSPacket* pkt, size_t count, Status* status, bool& flush, bool& bitrate_changed)
+{
+    // Never flush, never change bitrate: process all packets.
+    return processPacketBatchDirect<PCRVerifyPlugin>(pkt, count, status, flush, bitrate_changed);
+}
@@ -48,6 +48,7 @@ TSDUCK_SOURCE;
 
 #define DEFAULT_ECM_BITRATE 30000
 #define ASYNC_HANDLER_EXTRA_STACK_SIZE (1024 * 1024)
+#define MAX_SCRAMBLING_THREADS 64
 
 
 //----------------------------------------------------------------------------
@@ -104,6 +105,7 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, size_t, Status*, bool&, bool&) override;
 
     private:
         // Description of a crypto-period.
@@ -173,6 +175,7 @@ namespace ts {
         BitRate           _ecm_bitrate;         // ECM PID's bitrate
         PID               _ecm_pid;             // PID for ECM
         PacketCounter     _partial_scrambling;  // Do not scramble all packets if > 1
+        size_t            _threads;             // Number of threads which scramble packets
         ECMGClientArgs    _ecmg_args;           // Parameters for ECMG client
         tlv::Logger       _logger;              // Message logger for ECMG <=> SCS protocol
         ecmgscs::ChannelStatus _channel_status; // Initial response to ECMG channel_setup
@@ -251,6 +254,7 @@ ts::ScramblerPlugin::ScramblerPlugin(TSP* tsp_) :
     _ecm_bitrate(0),
     _ecm_pid(PID_NULL),
     _partial_scrambling(0),
+    _threads(1),
     _ecmg_args(),
     _logger(Severity::Debug, tsp_),
     _channel_status(),
@@ -349,6 +353,14 @@ ts::ScramblerPlugin::ScramblerPlugin(TSP* tsp_) :
          u"mode, the packet processing continues while generating ECM's. This option "
          u"is always on in offline mode.");
 
+    option(u"threads", 0, INTEGER, 0, 1, 1, MAX_SCRAMBLING_THREADS);
+    help(u"threads", u"count",
+         u"Number of threads which scramble the packets. The packets of each processing "
+         u"window of tsp are split between these threads. The order of the packets is "
+         u"preserved and control word changes still occur on the same packets. The default "
+         u"is 1, meaning that all packets are scrambled in the plugin thread. Use this "
+         u"option to scramble high bitrate services on several CPU cores.");
+
     // ECMG and scrambling options.
     _ecmg_args.defineOptions(*this);
     _scrambling.defineOptions(*this);
@@ -371,6 +383,7 @@ bool ts::ScramblerPlugin::getOptions()
     _scramble_video = !present(u"no-video");
     _scramble_subtitles = present(u"subtitles");
     _partial_scrambling = intValue<PacketCounter>(u"partial-scrambling", 1);
+    _threads = intValue<size_t>(u"threads", 1);
     _ignore_scrambled = present(u"ignore-scrambled");
     _ecm_pid = intValue<PID>(u"pid-ecm", PID_NULL);
     _ecm_bitrate = intValue<BitRate>(u"bitrate-ecm", DEFAULT_ECM_BITRATE);
@@ -434,6 +447,11 @@ bool ts::ScramblerPlugin::start()
     _update_pmt = false;
     _delay_start = 0;
 
+    // Start the scrambling threads, if any.
+    if (!_scrambling.setThreads(_threads)) {
+        return false;
+    }
+
     // Initialize ECMG.
     if (_need_ecm) {
         if (!_ecmg_args.ecmg_address.hasAddress()) {
@@ -497,6 +515,9 @@ bool ts::ScramblerPlugin::stop()
         _ecmg.disconnect();
     }
 
+    // Terminate the scrambling threads.
+    _scrambling.setThreads(1);
+
     tsp->debug(u"scrambled %'d packets in %'d PID's", {_scrambled_count, _scrambled_pids.count()});
     return true;
 }
@@ -840,6 +861,30 @@ ts::ProcessorPlugin::Status ts::ScramblerPlugin::processPacket(TSPacket& pkt, bo
 }
 
 
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+size_t ts::ScramblerPlugin::processPacketBatch(TSPacket* pkt, size_t count, Status* status, bool& flush, bool& bitrate_changed)
+{
+    // The packets of the batch are scrambled together, after all other processing.
+    // Packets are also scrambled before each control word change.
+    _scrambling.startBatch();
+    const size_t done = ProcessorPlugin::processPacketBatch(pkt, count, status, flush, bitrate_changed);
+    if (!_scrambling.endBatch()) {
+        // Do not pass any packet from the first one which was not properly scrambled.
+        const size_t first = _scrambling.batchErrorIndex(pkt, done);
+        if (first < done) {
+            status[first] = TSP_END;
+        }
+        else if (done > 0) {
+            status[done - 1] = TSP_END;
+        }
+    }
+    return done;
+}
+
+
 //----------------------------------------------------------------------------
 // CryptoPeriod default constructor.
 //----------------------------------------------------------------------------
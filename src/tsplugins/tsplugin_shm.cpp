@@ -0,0 +1,329 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Transport stream processor shared library:
+//  Shared memory packet ring input / output
+//
+//----------------------------------------------------------------------------
+
+#include "tsPlugin.h"
+#include "tsPluginRepository.h"
+#include "tsSharedPacketRing.h"
+#include "tsNullReport.h"
+#include "tsTime.h"
+TSDUCK_SOURCE;
+
+#define ABORT_POLL_INTERVAL  100   // Interval in milliseconds to check for abort while waiting.
+
+
+//----------------------------------------------------------------------------
+// Plugin definition
+//----------------------------------------------------------------------------
+
+namespace ts {
+
+    // Input plugin
+    class ShmInput: public InputPlugin
+    {
+    public:
+        // Implementation of plugin API
+        ShmInput(TSP*);
+        virtual bool getOptions() override;
+        virtual bool start() override;
+        virtual bool stop() override;
+        virtual size_t receive(TSPacket*, size_t) override;
+        virtual bool abortInput() override;
+    private:
+        UString          _name;      // Ring name.
+        MilliSecond      _timeout;   // Timeout on packet reception, zero means infinite.
+        SharedPacketRing _ring;      // Shared memory ring.
+        PacketCounter    _lost;      // Already reported lost packets.
+        volatile bool    _aborted;   // Input aborted from another thread.
+
+        // Inaccessible operations
+        ShmInput() = delete;
+        ShmInput(const ShmInput&) = delete;
+        ShmInput& operator=(const ShmInput&) = delete;
+    };
+
+    // Output plugin
+    class ShmOutput: public OutputPlugin
+    {
+    public:
+        // Implementation of plugin API
+        ShmOutput(TSP*);
+        virtual bool getOptions() override;
+        virtual bool start() override;
+        virtual bool stop() override;
+        virtual bool send(const TSPacket*, size_t) override;
+    private:
+        UString                  _name;        // Ring name.
+        size_t                   _capacity;    // Ring size in packets.
+        size_t                   _maxReaders;  // Maximum number of readers.
+        SharedPacketRing::Policy _policy;      // What to do when the ring is full.
+        MilliSecond              _timeout;     // Timeout on back-pressure, zero means infinite.
+        SharedPacketRing         _ring;        // Shared memory ring.
+
+        // Inaccessible operations
+        ShmOutput() = delete;
+        ShmOutput(const ShmOutput&) = delete;
+        ShmOutput& operator=(const ShmOutput&) = delete;
+    };
+}
+
+TSPLUGIN_DECLARE_VERSION
+TSPLUGIN_DECLARE_INPUT(shm, ts::ShmInput)
+TSPLUGIN_DECLARE_OUTPUT(shm, ts::ShmOutput)
+
+
+//----------------------------------------------------------------------------
+// Input plugin constructor
+//----------------------------------------------------------------------------
+
+ts::ShmInput::ShmInput(TSP* tsp_) :
+    InputPlugin(tsp_, u"Receive TS packets from a shared memory ring", u"[options] name"),
+    _name(),
+    _timeout(0),
+    _ring(),
+    _lost(0),
+    _aborted(false)
+{
+    option(u"", 0, STRING, 1, 1);
+    help(u"",
+         u"Name of the shared memory ring. The ring is created by another tsp process "
+         u"using the output plugin 'shm' with the same name. Any number of processes can "
+         u"read the same ring, up to the limit which is set by the writer. Each reader "
+         u"receives all packets which are written after it started.");
+
+    option(u"timeout", 't', POSITIVE);
+    help(u"timeout",
+         u"Specify the timeout in milliseconds to wait for the creation of the ring "
+         u"and then for each packet. By default, wait forever.");
+}
+
+
+//----------------------------------------------------------------------------
+// Input command line options method
+//----------------------------------------------------------------------------
+
+bool ts::ShmInput::getOptions()
+{
+    getValue(_name, u"");
+    _timeout = intValue<MilliSecond>(u"timeout", 0);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Input start method
+//----------------------------------------------------------------------------
+
+bool ts::ShmInput::start()
+{
+    _lost = 0;
+    _aborted = false;
+
+    // The writer may not be started yet, wait for the ring.
+    const Time limit(_timeout > 0 ? Time::CurrentUTC() + _timeout : Time::Apocalypse);
+    bool waiting = false;
+    while (!_ring.open(_name, NULLREP)) {
+        if (_aborted || tsp->aborting()) {
+            return false;
+        }
+        if (Time::CurrentUTC() >= limit) {
+            // Report the actual error.
+            return _ring.open(_name, *tsp);
+        }
+        if (!waiting) {
+            tsp->verbose(u"waiting for shared packet ring %s", {_name});
+            waiting = true;
+        }
+        SleepThread(ABORT_POLL_INTERVAL);
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Input stop method
+//----------------------------------------------------------------------------
+
+bool ts::ShmInput::stop()
+{
+    if (_ring.lostPackets() > 0) {
+        tsp->verbose(u"lost %'d packets in shared packet ring %s", {_ring.lostPackets(), _name});
+    }
+    return _ring.close(*tsp);
+}
+
+
+//----------------------------------------------------------------------------
+// Input abort method
+//----------------------------------------------------------------------------
+
+bool ts::ShmInput::abortInput()
+{
+    _aborted = true;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Input method
+//----------------------------------------------------------------------------
+
+size_t ts::ShmInput::receive(TSPacket* buffer, size_t max_packets)
+{
+    const Time limit(_timeout > 0 ? Time::CurrentUTC() + _timeout : Time::Apocalypse);
+
+    while (!_aborted && !tsp->aborting()) {
+        const size_t count = _ring.read(buffer, max_packets, ABORT_POLL_INTERVAL, *tsp);
+        if (_ring.lostPackets() > _lost) {
+            // The writer overwrote packets before we read them.
+            tsp->warning(u"lost %'d packets, reader too slow", {_ring.lostPackets() - _lost});
+            _lost = _ring.lostPackets();
+        }
+        if (count > 0) {
+            return count;
+        }
+        if (_ring.eof()) {
+            tsp->verbose(u"end of shared packet ring %s", {_name});
+            break;
+        }
+        if (Time::CurrentUTC() >= limit) {
+            tsp->error(u"receive timeout on shared packet ring %s", {_name});
+            break;
+        }
+    }
+    return 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Output plugin constructor
+//----------------------------------------------------------------------------
+
+ts::ShmOutput::ShmOutput(TSP* tsp_) :
+    OutputPlugin(tsp_, u"Send TS packets to a shared memory ring", u"[options] name"),
+    _name(),
+    _capacity(0),
+    _maxReaders(0),
+    _policy(SharedPacketRing::BACK_PRESSURE),
+    _timeout(0),
+    _ring()
+{
+    option(u"", 0, STRING, 1, 1);
+    help(u"",
+         u"Name of the shared memory ring to create. Other tsp processes read the "
+         u"ring using the input plugin 'shm' with the same name. A previous ring with "
+         u"the same name is replaced.");
+
+    option(u"drop-oldest", 'd');
+    help(u"drop-oldest",
+         u"When the ring is full, overwrite the oldest packets. The slow readers lose packets "
+         u"but never slow down this process. By default, wait for the slowest reader "
+         u"(back-pressure).");
+
+    option(u"max-readers", 'm', POSITIVE);
+    help(u"max-readers",
+         u"Maximum number of simultaneous readers. "
+         u"The default is " + UString::Decimal(SharedPacketRing::DEFAULT_MAX_READERS) + u".");
+
+    option(u"packets", 'p', POSITIVE);
+    help(u"packets",
+         u"Size of the ring in TS packets. "
+         u"The default is " + UString::Decimal(SharedPacketRing::DEFAULT_CAPACITY) + u" packets.");
+
+    option(u"timeout", 't', POSITIVE);
+    help(u"timeout",
+         u"With back-pressure, specify the maximum time in milliseconds to wait for the "
+         u"slowest reader. After this timeout, the output is aborted. By default, wait forever.");
+}
+
+
+//----------------------------------------------------------------------------
+// Output command line options method
+//----------------------------------------------------------------------------
+
+bool ts::ShmOutput::getOptions()
+{
+    getValue(_name, u"");
+    _capacity = intValue<size_t>(u"packets", SharedPacketRing::DEFAULT_CAPACITY);
+    _maxReaders = intValue<size_t>(u"max-readers", SharedPacketRing::DEFAULT_MAX_READERS);
+    _policy = present(u"drop-oldest") ? SharedPacketRing::DROP_OLDEST : SharedPacketRing::BACK_PRESSURE;
+    _timeout = intValue<MilliSecond>(u"timeout", 0);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Output start method
+//----------------------------------------------------------------------------
+
+bool ts::ShmOutput::start()
+{
+    return _ring.create(_name, _capacity, _maxReaders, _policy, *tsp);
+}
+
+
+//----------------------------------------------------------------------------
+// Output stop method
+//----------------------------------------------------------------------------
+
+bool ts::ShmOutput::stop()
+{
+    return _ring.close(*tsp);
+}
+
+
+//----------------------------------------------------------------------------
+// Output method
+//----------------------------------------------------------------------------
+
+bool ts::ShmOutput::send(const TSPacket* buffer, size_t packet_count)
+{
+    const Time limit(_timeout > 0 ? Time::CurrentUTC() + _timeout : Time::Apocalypse);
+
+    // The ring is written directly from the buffer. With back-pressure, wait
+    // for the readers by short intervals to check for abort.
+    size_t written = 0;
+    while (written < packet_count) {
+        written += _ring.write(buffer + written, packet_count - written, ABORT_POLL_INTERVAL, *tsp);
+        if (written < packet_count) {
+            if (tsp->aborting()) {
+                return false;
+            }
+            if (Time::CurrentUTC() >= limit) {
+                tsp->error(u"timeout on shared packet ring %s, readers too slow", {_name});
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,3 @@
+[[ ":$PATH:" != *:/root/repo/src/tstools/release-x86_64:* ]] && export PATH="/root/repo/src/tstools/release-x86_64:$PATH"
+export LD_LIBRARY_PATH="/root/repo/src/libtsduck/release-x86_64"
+export TSPLUGINS_PATH=/root/repo/src/tsplugins/release-x86_64:/root/repo/src/libtsduck
@@ -34,9 +34,20 @@
 #include "tsMain.h"
 #include "tsTSAnalyzerReport.h"
 #include "tsTSAnalyzerOptions.h"
-#include "tsInputRedirector.h"
+#include "tsTSFileInput.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+#include "tsGuard.h"
+#include "tsGuardCondition.h"
 TSDUCK_SOURCE;
 
+// Number of packets to read at a time.
+#define READ_PACKETS 1024
+
+// Maximum number of analysis threads.
+#define MAX_THREADS 256
+
 
 //----------------------------------------------------------------------------
 //  Command line options
@@ -47,21 +58,29 @@ struct Options: public ts::Args
     Options(int argc, char *argv[]);
 
     ts::BitRate           bitrate;   // Expected bitrate (188-byte packets)
-    ts::UString           infile;    // Input file name
+    ts::UStringVector     infiles;   // Input file names
+    size_t                threads;   // Number of analysis threads
+    bool                  mmap;      // Use memory-mapped I/O on regular files
     ts::TSAnalyzerOptions analysis;  // Analysis options.
 };
 
 Options::Options(int argc, char *argv[]) :
-    ts::Args(u"Analyze the structure of a transport stream", u"[options] [filename]"),
+    ts::Args(u"Analyze the structure of a transport stream", u"[options] [filename ...]"),
     bitrate(0),
-    infile(),
+    infiles(),
+    threads(1),
+    mmap(false),
     analysis()
 {
     // Define all standard analysis options.
     analysis.defineOptions(*this);
 
-    option(u"", 0, STRING, 0, 1);
-    help(u"", u"Input MPEG capture file (standard input if omitted).");
+    option(u"", 0, STRING, 0, UNLIMITED_COUNT);
+    help(u"",
+         u"Input MPEG capture files (standard input if omitted). "
+         u"When several files are specified, each file is analyzed independently "
+         u"and one report is produced per file, in the order of the command line. "
+         u"Unless --title is specified, the title of each report is the file name.");
 
     option(u"bitrate", 'b', UNSIGNED);
     help(u"bitrate",
@@ -69,16 +88,247 @@ Options::Options(int argc, char *argv[]) :
          u"(based on 188-byte packets). By default, the bitrate is "
          u"evaluated using the PCR in the transport stream.");
 
+    option(u"memory-map");
+    help(u"memory-map",
+         u"Read regular files using memory-mapped I/O instead of read operations. "
+         u"This is faster on large files but the files must not be truncated while "
+         u"they are read. Do not use this option on files which are still being written.");
+
+    option(u"threads", 0, INTEGER, 0, 1, 1, MAX_THREADS);
+    help(u"threads", u"count",
+         u"Number of files to analyze in parallel when several input files are specified. "
+         u"Each file is analyzed by one thread. The reports are still displayed in the "
+         u"order of the command line and are identical to a sequential analysis. "
+         u"The default is 1 (sequential analysis).");
+
     analyze(argc, argv);
 
-    infile = value(u"");
+    getValues(infiles, u"");
     bitrate = intValue<ts::BitRate>(u"bitrate");
+    threads = intValue<size_t>(u"threads", 1);
+    mmap = present(u"memory-map");
     analysis.load(*this);
 
+    if (infiles.empty()) {
+        // Standard input.
+        infiles.push_back(ts::UString());
+    }
+
     exitOnError();
 }
 
 
+//----------------------------------------------------------------------------
+//  Analyze one file, return false on error.
+//----------------------------------------------------------------------------
+
+namespace {
+    bool AnalyzeFile(const ts::UString& name, const Options& opt, std::ostream& out, ts::Report& report)
+    {
+        ts::TSAnalyzerReport analyzer(opt.bitrate);
+        ts::TSAnalyzerOptions analysis(opt.analysis);
+        ts::TSFileInput file;
+        const ts::TSPacket* pkt = nullptr;
+        size_t count = 0;
+        bool sync = true;
+
+        // With several files, each report is identified by the file name.
+        if (opt.infiles.size() > 1 && analysis.title.empty()) {
+            analysis.title = name;
+        }
+        analyzer.setAnalysisOptions(analysis);
+
+        // Packets are analyzed without copy, directly in the file mapping if requested.
+        file.setMemoryMapping(opt.mmap);
+        if (!file.open(name, 1, 0, report)) {
+            return false;
+        }
+
+        while (sync && (count = file.readInPlace(pkt, READ_PACKETS, report)) > 0) {
+            for (size_t i = 0; sync && i < count; ++i) {
+                if ((sync = pkt[i].hasValidSync())) {
+                    analyzer.feedPacket(pkt[i]);
+                }
+                else {
+                    report.error(u"synchronization lost after %'d TS packets, got 0x%X instead of 0x%X at start of TS packet", {file.getPacketCount() - count + i, pkt[i].b[0], ts::SYNC_BYTE});
+                }
+            }
+        }
+        file.close(report);
+
+        analyzer.report(out, analysis);
+        return true;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+//  Parallel analysis of several files.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Result of the analysis of one file.
+    class FileJob : public ts::Report
+    {
+    public:
+        typedef std::pair<int, ts::UString> Message;
+
+        std::string          output;    // Analysis report.
+        std::vector<Message> messages;  // Logged messages, replayed by the main thread.
+        bool                 success;   // Analysis successful.
+        bool                 done;      // Analysis completed.
+
+        FileJob(int max_severity) : Report(max_severity), output(), messages(), success(false), done(false) {}
+
+    protected:
+        // Messages are logged by one worker thread only, no need to synchronize.
+        virtual void writeLog(int severity, const ts::UString& msg) override
+        {
+            messages.push_back(std::make_pair(severity, msg));
+        }
+    };
+
+    // Set of files to analyze in parallel.
+    class ParallelAnalysis
+    {
+    public:
+        ParallelAnalysis(Options& opt);
+        ~ParallelAnalysis();
+
+        // Analyze all files, display reports in order, return false on error.
+        bool run();
+
+    private:
+        // Thread which analyzes files until there is none left.
+        class Worker : public ts::Thread
+        {
+        public:
+            Worker(ParallelAnalysis* parent) : Thread(), _parent(parent) {}
+            virtual ~Worker() override { waitForTermination(); }
+        private:
+            ParallelAnalysis* _parent;
+            virtual void main() override;
+
+            // Inaccessible operations
+            Worker() = delete;
+            Worker(const Worker&) = delete;
+            Worker& operator=(const Worker&) = delete;
+        };
+
+        Options&              _opt;
+        ts::Mutex             _mutex;    // Protect all fields below.
+        ts::Condition         _cond;     // Signaled when a job completes.
+        size_t                _next;     // Index of next file to analyze.
+        bool                  _abort;    // Stop analyzing new files.
+        std::vector<FileJob*> _jobs;     // One job per input file.
+        std::vector<Worker*>  _workers;  // Analysis threads.
+
+        // Inaccessible operations
+        ParallelAnalysis() = delete;
+        ParallelAnalysis(const ParallelAnalysis&) = delete;
+        ParallelAnalysis& operator=(const ParallelAnalysis&) = delete;
+    };
+}
+
+ParallelAnalysis::ParallelAnalysis(Options& opt) :
+    _opt(opt),
+    _mutex(),
+    _cond(),
+    _next(0),
+    _abort(false),
+    _jobs(),
+    _workers()
+{
+    for (size_t i = 0; i < _opt.infiles.size(); ++i) {
+        _jobs.push_back(new FileJob(_opt.maxSeverity()));
+    }
+}
+
+ParallelAnalysis::~ParallelAnalysis()
+{
+    // Make sure the threads do not start new analyses and wait for them.
+    {
+        ts::Guard lock(_mutex);
+        _abort = true;
+    }
+    for (size_t i = 0; i < _workers.size(); ++i) {
+        delete _workers[i];
+    }
+    for (size_t i = 0; i < _jobs.size(); ++i) {
+        delete _jobs[i];
+    }
+}
+
+// Analysis thread.
+void ParallelAnalysis::Worker::main()
+{
+    for (;;) {
+        // Get next file to analyze.
+        size_t index = 0;
+        {
+            ts::Guard lock(_parent->_mutex);
+            if (_parent->_abort || _parent->_next >= _parent->_jobs.size()) {
+                break;
+            }
+            index = _parent->_next++;
+        }
+
+        // Analyze the file without holding the mutex.
+        FileJob* job = _parent->_jobs[index];
+        std::ostringstream out;
+        job->success = AnalyzeFile(_parent->_opt.infiles[index], _parent->_opt, out, *job);
+        job->output = out.str();
+
+        // Notify the main thread.
+        ts::GuardCondition lock(_parent->_mutex, _parent->_cond);
+        job->done = true;
+        lock.signal();
+    }
+}
+
+// Analyze all files.
+bool ParallelAnalysis::run()
+{
+    // Start the analysis threads.
+    const size_t count = std::min(_opt.threads, _jobs.size());
+    for (size_t i = 0; i < count; ++i) {
+        _workers.push_back(new Worker(this));
+        if (!_workers.back()->start()) {
+            _opt.error(u"cannot start analysis thread");
+            delete _workers.back();
+            _workers.pop_back();
+            break;
+        }
+    }
+    if (_workers.empty()) {
+        return false;
+    }
+
+    // Display the reports in the order of the command line, as soon as they are available.
+    bool success = true;
+    for (size_t index = 0; index < _jobs.size(); ++index) {
+        FileJob* job = _jobs[index];
+        {
+            ts::GuardCondition lock(_mutex, _cond);
+            while (!job->done) {
+                lock.waitCondition();
+            }
+        }
+        for (size_t i = 0; i < job->messages.size(); ++i) {
+            _opt.log(job->messages[i].first, job->messages[i].second);
+        }
+        std::cout << job->output << std::flush;
+        success = success && job->success;
+
+        // Free the report memory.
+        job->output.clear();
+        job->messages.clear();
+    }
+    return success;
+}
+
+
 //----------------------------------------------------------------------------
 //  Program entry point
 //----------------------------------------------------------------------------
@@ -86,19 +336,19 @@ Options::Options(int argc, char *argv[]) :
 int MainCode(int argc, char *argv[])
 {
     Options opt(argc, argv);
-    ts::TSAnalyzerReport analyzer(opt.bitrate);
-    ts::InputRedirector input(opt.infile, opt);
-    ts::TSPacket pkt;
+    bool success = true;
 
-    analyzer.setAnalysisOptions(opt.analysis);
-
-    while (pkt.read(std::cin, true, opt)) {
-        analyzer.feedPacket(pkt);
+    if (opt.threads > 1 && opt.infiles.size() > 1) {
+        ParallelAnalysis parallel(opt);
+        success = parallel.run();
+    }
+    else {
+        for (size_t i = 0; i < opt.infiles.size(); ++i) {
+            success = AnalyzeFile(opt.infiles[i], opt, std::cout, opt) && success;
+        }
     }
 
-    analyzer.report(std::cout, opt.analysis);
-
-    return EXIT_SUCCESS;
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 TS_MAIN(MainCode)
@@ -34,8 +34,12 @@
 
 #include "tsMain.h"
 #include "tsTSPacket.h"
+#include "tsTSFileInput.h"
 TSDUCK_SOURCE;
 
+// Number of packets to read at a time.
+#define READ_PACKETS 1024
+
 
 //----------------------------------------------------------------------------
 //  Command line options
@@ -47,6 +51,7 @@ struct Options: public ts::Args
 
     uint32_t          dump_flags;  // Dump options for Hexa and Packet::dump
     bool              raw_file;    // Raw dump of file, not TS packets
+    bool              mmap;        // Use memory-mapped I/O on regular files
     ts::PacketCounter max_packets; // Maximum number of packets to dump per file
     ts::UStringVector infiles;     // Input file names
 };
@@ -55,6 +60,7 @@ Options::Options(int argc, char *argv[]) :
     Args(u"Dump and format MPEG transport stream packets", u"[options] [filename ...]"),
     dump_flags(0),
     raw_file(false),
+    mmap(false),
     max_packets(0),
     infiles()
 {
@@ -76,6 +82,12 @@ Options::Options(int argc, char *argv[]) :
     option(u"max-packets", 'm', UNSIGNED);
     help(u"max-packets", u"Maximum number of packets to dump per file.");
 
+    option(u"memory-map");
+    help(u"memory-map",
+         u"Read regular files using memory-mapped I/O instead of read operations. "
+         u"This is faster on large files but the files must not be truncated while "
+         u"they are read. Do not use this option on files which are still being written.");
+
     option(u"nibble", 'n');
     help(u"nibble", u"Same as --binary but add separator between 4-bit nibbles.");
 
@@ -92,6 +104,7 @@ Options::Options(int argc, char *argv[]) :
 
     getValues(infiles);
     raw_file = present(u"raw-file");
+    mmap = present(u"memory-map");
     max_packets = intValue<ts::PacketCounter>(u"max-packets", std::numeric_limits<ts::PacketCounter>::max());
 
     dump_flags =
@@ -129,37 +142,65 @@ Options::Options(int argc, char *argv[]) :
 
 
 //----------------------------------------------------------------------------
-// Perform the dump on one input file.
+// Perform the raw dump on one input file.
 //----------------------------------------------------------------------------
 
-void DumpFile(Options& opt, std::istream& stream)
+void DumpRawFile(Options& opt, std::istream& stream)
 {
-    if (opt.raw_file) {
-        // Raw dump of file
-        const uint32_t flags = (opt.dump_flags & 0x0000FFFF) | ts::UString::BPL | ts::UString::WIDE_OFFSET;
-        const size_t MAX_RAW_BPL = 16;
-        const size_t raw_bpl = (flags & ts::UString::BINARY) ? 8 : 16;  // Bytes per line in raw mode
-        size_t offset = 0;
-        while (stream) {
-            int c;
-            size_t size;
-            uint8_t buffer[MAX_RAW_BPL];
-            for (size = 0; size < raw_bpl && (c = stream.get()) != EOF; size++) {
-                buffer[size] = uint8_t(c);
-            }
-            std::cout << ts::UString::Dump(buffer, size, flags, 0, raw_bpl, offset);
-            offset += size;
+    // Raw dump of file
+    const uint32_t flags = (opt.dump_flags & 0x0000FFFF) | ts::UString::BPL | ts::UString::WIDE_OFFSET;
+    const size_t MAX_RAW_BPL = 16;
+    const size_t raw_bpl = (flags & ts::UString::BINARY) ? 8 : 16;  // Bytes per line in raw mode
+    size_t offset = 0;
+    while (stream) {
+        int c;
+        size_t size;
+        uint8_t buffer[MAX_RAW_BPL];
+        for (size = 0; size < raw_bpl && (c = stream.get()) != EOF; size++) {
+            buffer[size] = uint8_t(c);
         }
+        std::cout << ts::UString::Dump(buffer, size, flags, 0, raw_bpl, offset);
+        offset += size;
     }
-    else {
-        // Read all packets in the file
-        ts::TSPacket pkt;
-        for (ts::PacketCounter packet_index = 0; packet_index < opt.max_packets && pkt.read(stream, true, opt); packet_index++) {
-            std::cout << std::endl << "* Packet " << ts::UString::Decimal(packet_index) << std::endl;
-            pkt.display (std::cout, opt.dump_flags, 2);
+}
+
+
+//----------------------------------------------------------------------------
+// Perform the packet dump on one input file (standard input if empty name).
+//----------------------------------------------------------------------------
+
+void DumpPacketFile(Options& opt, const ts::UString& filename)
+{
+    ts::TSFileInput file;
+    const ts::TSPacket* pkt = nullptr;
+    size_t count = 0;
+    bool sync = true;
+
+    // Packets are displayed without copy, directly in the file mapping if requested.
+    file.setMemoryMapping(opt.mmap);
+    if (!file.open(filename, 1, 0, opt)) {
+        return;
+    }
+    if (opt.infiles.size() > 1) {
+        std::cout << "* File " << filename << std::endl;
+    }
+
+    // Read all packets in the file
+    ts::PacketCounter packet_index = 0;
+    while (sync && packet_index < opt.max_packets && (count = file.readInPlace(pkt, READ_PACKETS, opt)) > 0) {
+        for (size_t i = 0; sync && packet_index < opt.max_packets && i < count; ++i) {
+            if ((sync = pkt[i].hasValidSync())) {
+                std::cout << std::endl << "* Packet " << ts::UString::Decimal(packet_index) << std::endl;
+                pkt[i].display(std::cout, opt.dump_flags, 2);
+                packet_index++;
+            }
+            else {
+                opt.error(u"synchronization lost after %'d TS packets, got 0x%X instead of 0x%X at start of TS packet", {packet_index, pkt[i].b[0], ts::SYNC_BYTE});
+            }
         }
-        std::cout << std::endl;
     }
+    std::cout << std::endl;
+    file.close(opt);
 }
 
 
@@ -172,11 +213,20 @@ int MainCode(int argc, char *argv[])
     // Decode command line.
     Options opt(argc, argv);
 
-    if (opt.infiles.empty()) {
+    if (!opt.raw_file) {
+        // Dump TS packets from standard input or named files.
+        if (opt.infiles.empty()) {
+            DumpPacketFile(opt, ts::UString());
+        }
+        for (size_t i = 0; i < opt.infiles.size(); ++i) {
+            DumpPacketFile(opt, opt.infiles[i]);
+        }
+    }
+    else if (opt.infiles.empty()) {
         // Try to put standard input in binary mode
         SetBinaryModeStdin(opt);
         // Dump standard input.
-        DumpFile(opt, std::cin);
+        DumpRawFile(opt, std::cin);
     }
     else {
         // Dump named files.
@@ -184,10 +234,7 @@ int MainCode(int argc, char *argv[])
             // Open the file in binary mode.
             std::ifstream file(opt.infiles[i].toUTF8().c_str(), std::ios::binary);
             if (file) {
-                if (opt.infiles.size() > 1 && !opt.raw_file) {
-                    std::cout << "* File " << opt.infiles[i] << std::endl;
-                }
-                DumpFile(opt, file);
+                DumpRawFile(opt, file);
             }
             else {
                 opt.error(u"cannot open file %s", {opt.infiles[i]});
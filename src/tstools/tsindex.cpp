@@ -0,0 +1,183 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Build the index of transport stream files for random access.
+//
+//----------------------------------------------------------------------------
+
+#include "tsMain.h"
+#include "tsTSFileIndex.h"
+#include "tsNames.h"
+#include "tsNullReport.h"
+#include "tsSysUtils.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+//  Command line options
+//----------------------------------------------------------------------------
+
+struct Options: public ts::Args
+{
+    Options(int argc, char *argv[]);
+
+    ts::UStringVector files;     // Transport stream file names.
+    ts::UString       output;    // Index file name (with one input file only).
+    bool              display;   // Display the index content.
+    bool              force;     // Rebuild up-to-date indexes.
+    bool              mmap;      // Use memory-mapped I/O on regular files.
+};
+
+Options::Options(int argc, char *argv[]) :
+    Args(u"Build the index of transport stream files for random access", u"[options] filename ..."),
+    files(),
+    output(),
+    display(false),
+    force(false),
+    mmap(false)
+{
+    option(u"", 0, STRING, 1, UNLIMITED_COUNT);
+    help(u"",
+         u"Transport stream files to index. The index of each file is saved in a file "
+         u"with the same name and the additional suffix \".tsidx\".");
+
+    option(u"display", 'd');
+    help(u"display",
+         u"Display a summary of the index content on standard output. "
+         u"Existing up-to-date indexes are loaded and displayed.");
+
+    option(u"force", 'f');
+    help(u"force", u"Rebuild the index even if an up-to-date index already exists.");
+
+    option(u"memory-map");
+    help(u"memory-map",
+         u"Read regular files using memory-mapped I/O instead of read operations. "
+         u"This is faster on large files but the files must not be truncated while "
+         u"they are read. Do not use this option on files which are still being written.");
+
+    option(u"output", 'o', STRING);
+    help(u"output", u"filename",
+         u"Name of the index file. This option is allowed with one input file only. "
+         u"The index file must then be specified with the option --index of the plugin "
+         u"file to locate the start position.");
+
+    analyze(argc, argv);
+
+    getValues(files);
+    getValue(output, u"output");
+    display = present(u"display");
+    force = present(u"force");
+    mmap = present(u"memory-map");
+
+    if (!output.empty() && files.size() > 1) {
+        error(u"--output cannot be used with more than one input file");
+    }
+
+    exitOnError();
+}
+
+
+//----------------------------------------------------------------------------
+//  Display the content of an index.
+//----------------------------------------------------------------------------
+
+namespace {
+    void Display(const ts::UString& file, const ts::TSFileIndex& index)
+    {
+        std::cout << ts::UString::Format(u"File: %s", {file}) << std::endl
+                  << ts::UString::Format(u"  Packets: %'d", {index.packetCount()}) << std::endl;
+
+        const std::vector<ts::TSFileIndex::PCRPoint>& pcrs(index.pcrPoints());
+        std::cout << ts::UString::Format(u"  PCR: %'d", {pcrs.size()});
+        if (!pcrs.empty()) {
+            std::cout << ts::UString::Format(u", first: %'d at packet %'d, last: %'d at packet %'d", {pcrs.front().pcr, pcrs.front().packet, pcrs.back().pcr, pcrs.back().packet});
+        }
+        std::cout << std::endl;
+
+        const std::vector<ts::TSFileIndex::TimePoint>& times(index.timePoints());
+        std::cout << ts::UString::Format(u"  UTC times: %'d", {times.size()});
+        if (!times.empty()) {
+            std::cout << ts::UString::Format(u", first: %s at packet %'d, last: %s at packet %'d", {times.front().utc.format(ts::Time::DATE | ts::Time::TIME), times.front().packet, times.back().utc.format(ts::Time::DATE | ts::Time::TIME), times.back().packet});
+        }
+        std::cout << std::endl;
+
+        const std::vector<ts::TSFileIndex::TableVersion>& versions(index.tableVersions());
+        std::cout << ts::UString::Format(u"  Table versions: %'d", {versions.size()}) << std::endl;
+        for (std::vector<ts::TSFileIndex::TableVersion>::const_iterator it = versions.begin(); it != versions.end(); ++it) {
+            std::cout << ts::UString::Format(u"    Packet %'d, PID 0x%X (%d), %s, TID ext 0x%X (%d), version %d",
+                                             {it->packet, it->pid, it->pid, ts::names::TID(it->tid), it->tid_ext, it->tid_ext, it->version})
+                      << std::endl;
+        }
+
+        std::vector<ts::PID> pids;
+        index.getPUSIPIDs(pids);
+        std::cout << ts::UString::Format(u"  PID's with PUSI: %d", {pids.size()}) << std::endl;
+        for (std::vector<ts::PID>::const_iterator it = pids.begin(); it != pids.end(); ++it) {
+            std::cout << ts::UString::Format(u"    PID 0x%X (%d): %'d PUSI", {*it, *it, index.pusiPackets(*it).size()}) << std::endl;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+//  Program entry point
+//----------------------------------------------------------------------------
+
+int MainCode(int argc, char *argv[])
+{
+    Options opt(argc, argv);
+    ts::TSFileIndex index;
+    bool success = true;
+
+    for (ts::UStringVector::const_iterator file = opt.files.begin(); file != opt.files.end(); ++file) {
+
+        const ts::UString index_file(opt.output.empty() ? ts::TSFileIndex::IndexFileName(*file) : opt.output);
+
+        // Reuse an existing up-to-date index.
+        if (!opt.force && ts::FileExists(index_file) && index.load(index_file, NULLREP) && index.matchFile(*file)) {
+            opt.verbose(u"%s is up to date", {index_file});
+        }
+        else if (index.build(*file, opt, opt.mmap) && index.save(index_file, opt)) {
+            opt.verbose(u"%s: indexed %'d packets, %'d PCR, %'d UTC times, %'d table versions",
+                        {*file, index.packetCount(), index.pcrPoints().size(), index.timePoints().size(), index.tableVersions().size()});
+        }
+        else {
+            success = false;
+            continue;
+        }
+
+        if (opt.display) {
+            Display(*file, index);
+        }
+    }
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TS_MAIN(MainCode)
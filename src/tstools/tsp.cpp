@@ -153,17 +153,32 @@ int MainCode(int argc, char *argv[])
     // plugin has a hight priority to make room in the buffer, but not as
     // high as the input which must remain the top-most priority?
 
-    ts::tsp::InputExecutor* input = new ts::tsp::InputExecutor(&opt, &opt.inputs.front(), ts::ThreadAttributes().setPriority(ts::ThreadAttributes::GetMaximumPriority()), global_mutex);
-    ts::tsp::OutputExecutor* output = new ts::tsp::OutputExecutor(&opt, &opt.outputs.front(), ts::ThreadAttributes().setPriority(ts::ThreadAttributes::GetHighPriority()), global_mutex);
+    ts::tsp::InputExecutor* input = new ts::tsp::InputExecutor(&opt, &opt.inputs.front(), ts::ThreadAttributes().setPriority(ts::ThreadAttributes::GetMaximumPriority()).setAffinity(opt.input_cpus), global_mutex);
+    ts::tsp::OutputExecutor* output = new ts::tsp::OutputExecutor(&opt, &opt.outputs.front(), ts::ThreadAttributes().setPriority(ts::ThreadAttributes::GetHighPriority()).setAffinity(opt.output_cpus), global_mutex);
     output->ringInsertAfter(input);
 
     // Check if at least one plugin prefers real-time defaults.
     bool realtime = opt.realtime == ts::TRUE || input->isRealTime() || output->isRealTime();
 
-    for (auto it = opt.plugins.begin(); it != opt.plugins.end(); ++it) {
-        ts::tsp::PluginExecutor* p = new ts::tsp::ProcessorExecutor(&opt, &*it, ts::ThreadAttributes(), global_mutex);
+    for (size_t i = 0; i < opt.plugins.size(); ++i) {
+        ts::tsp::PluginExecutor* p = new ts::tsp::ProcessorExecutor(&opt, &opt.plugins[i], ts::ThreadAttributes().setAffinity(opt.plugin_cpus[i]), global_mutex);
         p->ringInsertBefore(output);
         realtime = realtime || p->isRealTime();
+
+        // A grouped processor is executed in the thread of the first processor of the group.
+        // The stack of this thread must be large enough for all plugins of the group.
+        if (p->isGrouped()) {
+            ts::tsp::PluginExecutor* first = p;
+            while (first->isGrouped()) {
+                first = first->ringPrevious<ts::tsp::PluginExecutor>();
+            }
+            ts::ThreadAttributes first_attr, attr;
+            first->getAttributes(first_attr);
+            p->getAttributes(attr);
+            if (attr.getStackSize() > first_attr.getStackSize()) {
+                first->setAttributes(first_attr.setStackSize(attr.getStackSize()));
+            }
+        }
     }
 
     // Check if realtime defaults are explicitly disabled.
@@ -195,8 +210,18 @@ int MainCode(int argc, char *argv[])
         }
     } while ((proc = proc->ringNext<ts::tsp::PluginExecutor>()) != input);
 
-    // Allocate a memory-resident buffer of TS packets
+    // Allocate a memory-resident buffer of TS packets.
+    // When the input thread is bound to some CPU's, the buffer is allocated and locked
+    // (the pages are touched) from the same CPU's. This way, on NUMA systems, the buffer
+    // is physically located on the same node as the input thread ("first touch" policy).
+    ts::ThreadAttributes::CPUSet main_cpus;
+    const bool move_main = !opt.input_cpus.empty() &&
+        ts::ThreadAttributes::GetCurrentThreadAffinity(main_cpus) &&
+        ts::ThreadAttributes::SetCurrentThreadAffinity(opt.input_cpus);
     ts::ResidentBuffer<ts::TSPacket> packet_buffer(opt.bufsize / ts::PKT_SIZE);
+    if (move_main) {
+        ts::ThreadAttributes::SetCurrentThreadAffinity(main_cpus);
+    }
     if (!packet_buffer.isLocked()) {
         report.verbose(u"tsp: buffer failed to lock into physical memory (%d: %s), risk of real-time issue",
                        {packet_buffer.lockErrorCode(), ts::ErrorCodeMessage(packet_buffer.lockErrorCode())});
@@ -235,10 +260,12 @@ int MainCode(int argc, char *argv[])
         monitor.start();
     }
 
-    // Create all plugin executors threads.
+    // Create all plugin executors threads. Grouped processors have no thread.
     proc = input;
     do {
-        proc->start();
+        if (!proc->isGrouped()) {
+            proc->start();
+        }
     } while ((proc = proc->ringNext<ts::tsp::PluginExecutor>()) != input);
 
     // Wait for threads to terminate
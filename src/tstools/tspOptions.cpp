@@ -63,6 +63,7 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
     monitor(false),
     ignore_jt(false),
     sync_log(false),
+    lock_free(false),
     bufsize(0),
     log_msg_count(AsyncReport::MAX_LOG_MESSAGES),
     max_flush_pkt(0),
@@ -73,13 +74,17 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
     instuff_stop(0),
     bitrate(0),
     bitrate_adj(0),
-    realtime(MAYBE)
+    realtime(MAYBE),
+    input_cpus(),
+    output_cpus(),
+    plugin_cpus()
 {
     setDescription(u"MPEG transport stream processor using a chain of plugins");
 
     setSyntax(u"[tsp-options] \\\n"
               u"    [-I input-name [input-options]] \\\n"
               u"    [-P processor-name [processor-options]] ... \\\n"
+              u"    [-G processor-name [processor-options]] ... \\\n"
               u"    [-O output-name [output-options]]");
 
     option(u"add-input-stuffing", 'a', STRING);
@@ -138,6 +143,23 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
     option(u"list-processors", 'l', ListProcessorEnum, 0, 1, true);
     help(u"list-processors", u"List all available processors.");
 
+    option(u"input-cpus", 0, STRING);
+    help(u"input-cpus", u"list",
+         u"Specify the list of CPU's where the input plugin thread is allowed to run. "
+         u"The list is made of comma-separated CPU indexes or ranges of indexes, "
+         u"for instance \"0-3,8\". The packet buffer is allocated from this thread's "
+         u"CPU's so that it is physically located on the same NUMA node as the input. "
+         u"By default, the thread may run on any CPU (see also --numa-node).");
+
+    option(u"lock-free");
+    help(u"lock-free",
+         u"Use lock-free synchronization between the plugins. By default, all plugins "
+         u"share one global lock to pass packets from one plugin to the next one. "
+         u"With this option, two adjacent plugins only share atomic counters and a "
+         u"plugin which waits for packets polls for some time before sleeping. "
+         u"This can improve the scalability of long chains of plugins on systems "
+         u"with many CPU cores, at the expense of some CPU usage while waiting.");
+
     option(u"log-message-count", 0, POSITIVE);
     help(u"log-message-count",
          u"Specify the maximum number of buffered log messages. Log messages are "
@@ -169,6 +191,28 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
          u"This includes CPU load, virtual memory usage. Useful to verify the "
          u"stability of the application.");
 
+    option(u"numa-node", 0, UNSIGNED);
+    help(u"numa-node",
+         u"Run all plugin threads on the CPU's of the specified NUMA node, unless "
+         u"otherwise specified using --input-cpus, --output-cpus or --processor-cpus. "
+         u"This option is currently supported on Linux only.");
+
+    option(u"output-cpus", 0, STRING);
+    help(u"output-cpus", u"list",
+         u"Specify the list of CPU's where the output plugin thread is allowed to run. "
+         u"See option --input-cpus for the format of the list. "
+         u"By default, the thread may run on any CPU (see also --numa-node).");
+
+    option(u"processor-cpus", 0, STRING, 0, UNLIMITED_COUNT);
+    help(u"processor-cpus", u"list",
+         u"Specify the list of CPU's where a packet processor plugin thread is allowed to run. "
+         u"See option --input-cpus for the format of the list. This option can be specified "
+         u"several times. The first occurrence applies to the first packet processor, the "
+         u"second occurrence to the second processor, etc. The last occurrence applies to "
+         u"all remaining processors. The packet processors in a group (see -G) run in the "
+         u"thread of the first processor of the group and use its list of CPU's. "
+         u"By default, the threads may run on any CPU (see also --numa-node).");
+
     option(u"realtime", 'r', TRISTATE, 0, 1, -255, 256, true);
     help(u"realtime",
          u"Specifies if tsp and all plugins should use default values for real-time "
@@ -199,6 +243,7 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
     list_proc_flags = present(u"list-processors") ? intValue<int>(u"list-processors", PluginRepository::LIST_ALL) : 0;
     monitor = present(u"monitor");
     sync_log = present(u"synchronous-log");
+    lock_free = present(u"lock-free");
     bufsize = 1024 * 1024 * intValue<size_t>(u"buffer-size-mb", DEF_BUFSIZE_MB);
     bitrate = intValue<BitRate>(u"bitrate", 0);
     bitrate_adj = MilliSecPerSec * intValue(u"bitrate-adjust-interval", DEF_BITRATE_INTERVAL);
@@ -214,6 +259,23 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
         error(u"invalid value for --add-input-stuffing, use \"nullpkt/inpkt\" format");
     }
 
+    // CPU affinity of plugin threads. The default is the NUMA node, if specified.
+    ThreadAttributes::CPUSet node_cpus;
+    if (present(u"numa-node") && !ThreadAttributes::GetNUMANodeCPUs(intValue<size_t>(u"numa-node"), node_cpus)) {
+        error(u"NUMA node %d not found or unsupported on this system", {intValue<size_t>(u"numa-node")});
+    }
+    getCPUAffinity(input_cpus, u"input-cpus", 0, node_cpus);
+    getCPUAffinity(output_cpus, u"output-cpus", 0, node_cpus);
+    plugin_cpus.resize(plugins.size());
+    for (size_t i = 0; i < plugins.size(); ++i) {
+        getCPUAffinity(plugin_cpus[i], u"processor-cpus", i, node_cpus);
+    }
+
+    // A group of processors starts with a non-grouped one.
+    if (!plugins.empty()) {
+        plugins.front().grouped = false;
+    }
+
     // The default input is the standard input file.
     if (inputs.empty()) {
         inputs.push_back(PluginOptions(INPUT_PLUGIN, u"file"));
@@ -264,11 +326,14 @@ std::ostream& ts::tsp::Options::display(std::ostream& strm, const UString& margi
          << margin << "  --buffer-size-mb: " << UString::Decimal(bufsize) << " bytes" << std::endl
          << margin << "  --debug: " << maxSeverity() << std::endl
          << margin << "  --list-processors: " << list_proc_flags << std::endl
+         << margin << "  --lock-free: " << lock_free << std::endl
          << margin << "  --max-flushed-packets: " << UString::Decimal(max_flush_pkt) << std::endl
          << margin << "  --max-input-packets: " << UString::Decimal(max_input_pkt) << std::endl
          << margin << "  --realtime: " << UString::TristateTrueFalse(realtime) << std::endl
          << margin << "  --monitor: " << monitor << std::endl
          << margin << "  --verbose: " << verbose() << std::endl
+         << margin << "  --input-cpus: " << UString::Decimal(input_cpus.size()) << " CPU's" << std::endl
+         << margin << "  --output-cpus: " << UString::Decimal(output_cpus.size()) << " CPU's" << std::endl
          << margin << "  Number of packet processors: " << plugins.size() << std::endl;
     display(inputs, u"Input plugin", strm, margin + u"  ");
     display(plugins, u"Packet processor plugin", strm, margin + u"  ");
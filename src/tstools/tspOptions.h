@@ -62,6 +62,7 @@ namespace ts {
             bool          monitor;         //!< Run a resource monitoring thread.
             bool          ignore_jt;       //!< Ignore "joint termination" options in plugins.
             bool          sync_log;        //!< Synchronous log.
+            bool          lock_free;       //!< Use lock-free synchronization between plugin executors.
             size_t        bufsize;         //!< Buffer size.
             size_t        log_msg_count;   //!< Maximum buffered log messages.
             size_t        max_flush_pkt;   //!< Max processed packets before flush.
@@ -73,6 +74,9 @@ namespace ts {
             BitRate       bitrate;         //!< Fixed input bitrate.
             MilliSecond   bitrate_adj;     //!< Bitrate adjust interval.
             Tristate      realtime;        //!< Use real-time options.
+            ThreadAttributes::CPUSet input_cpus;   //!< CPU affinity of the input plugin thread (empty: any CPU).
+            ThreadAttributes::CPUSet output_cpus;  //!< CPU affinity of the output plugin thread (empty: any CPU).
+            std::vector<ThreadAttributes::CPUSet> plugin_cpus;  //!< CPU affinity of each packet processor plugin thread.
 
             //!
             //! Apply default values to options which were not specified on the command line.
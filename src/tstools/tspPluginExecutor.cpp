@@ -37,6 +37,10 @@
 #include "tsGuard.h"
 TSDUCK_SOURCE;
 
+// Adaptive polling in lock-free mode, number of polling loops before sleeping.
+#define LOCK_FREE_MIN_SPIN      16
+#define LOCK_FREE_MAX_SPIN   16384
+
 
 //----------------------------------------------------------------------------
 // Constructor
@@ -49,11 +53,19 @@ ts::tsp::PluginExecutor::PluginExecutor(Options* options,
     JointTermination(options, pl_options, attributes, global_mutex),
     RingNode(),
     _buffer(nullptr),
+    _grouped(pl_options->type == PROCESSOR_PLUGIN && pl_options->grouped),
     _to_do(),
     _pkt_first(0),
     _pkt_cnt(0),
     _input_end(false),
-    _bitrate(0)
+    _bitrate(0),
+    _lf_mutex(),
+    _lf_received(0),
+    _lf_processed(0),
+    _lf_input_end(false),
+    _lf_bitrate(0),
+    _lf_sleeping(false),
+    _lf_spin(LOCK_FREE_MIN_SPIN)
 {
 }
 
@@ -77,6 +89,11 @@ void ts::tsp::PluginExecutor::initBuffer(PacketBuffer* buffer,
     _tsp_aborting = aborted;
     _bitrate = bitrate;
     _tsp_bitrate = bitrate;
+    _lf_received = pkt_cnt;
+    _lf_processed = 0;
+    _lf_input_end = input_end;
+    _lf_bitrate = bitrate;
+    _lf_sleeping = false;
 }
 
 
@@ -100,11 +117,15 @@ bool ts::tsp::PluginExecutor::passPackets(size_t count,     // of packets to pas
                                           bool aborted)     // set to current processor
 
 {
+    log(10, u"passPackets (count = %'d, bitrate = %'d, input_end = %'d, aborted = %'d)", {count, bitrate, input_end, aborted});
+
+    if (_options->lock_free) {
+        return passPacketsLockFree(count, bitrate, input_end, aborted);
+    }
+
     assert(count <= _pkt_cnt);
     assert(_pkt_first + count <= _buffer->count());
 
-    log(10, u"passPackets (count = %'d, bitrate = %'d, input_end = %'d, aborted = %'d)", {count, bitrate, input_end, aborted});
-
     // We access data under the protection of the global mutex.
     Guard lock(_global_mutex);
 
@@ -130,7 +151,7 @@ bool ts::tsp::PluginExecutor::passPackets(size_t count,     // of packets to pas
     // Wake the previous processor when we abort
     if (aborted) {
         _tsp_aborting = true; // volatile bool in TSP superclass
-        ringPrevious<PluginExecutor>()->_to_do.signal();
+        abortPrevious()->_to_do.signal();
     }
 
     // Return false when the current processor shall stop.
@@ -144,9 +165,33 @@ bool ts::tsp::PluginExecutor::passPackets(size_t count,     // of packets to pas
 
 void ts::tsp::PluginExecutor::setAbort()
 {
-    Guard lock(_global_mutex);
-    _tsp_aborting = true;
-    ringPrevious<PluginExecutor>()->_to_do.signal();
+    if (_options->lock_free) {
+        _tsp_aborting = true;
+        PluginExecutor* previous = abortPrevious();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        previous->wakeUpLockFree();
+    }
+    else {
+        Guard lock(_global_mutex);
+        _tsp_aborting = true;
+        abortPrevious()->_to_do.signal();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get the previous plugin which has its own thread. All grouped plugins in
+// between are executed in that thread and are set in abort state.
+//----------------------------------------------------------------------------
+
+ts::tsp::PluginExecutor* ts::tsp::PluginExecutor::abortPrevious()
+{
+    PluginExecutor* previous = ringPrevious<PluginExecutor>();
+    while (previous->_grouped) {
+        previous->_tsp_aborting = true;
+        previous = previous->ringPrevious<PluginExecutor>();
+    }
+    return previous;
 }
 
 
@@ -176,6 +221,11 @@ void ts::tsp::PluginExecutor::waitWork(size_t& pkt_first,
 {
     log(10, u"waitWork(...)");
 
+    if (_options->lock_free) {
+        waitWorkLockFree(pkt_first, pkt_cnt, bitrate, input_end, aborted);
+        return;
+    }
+
     // We access data under the protection of the global mutex.
     GuardCondition lock(_global_mutex, _to_do);
 
@@ -197,3 +247,118 @@ void ts::tsp::PluginExecutor::waitWork(size_t& pkt_first,
 
     log(10, u"waitWork (pkt_first = %'d, pkt_cnt = %'d, bitrate = %'d, input_end = %'d, aborted = %'d)", {pkt_first, pkt_cnt, bitrate, input_end, aborted});
 }
+
+
+//----------------------------------------------------------------------------
+// Lock-free mode: wake up this processor if it sleeps.
+// Invoked by the previous or next processor.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::wakeUpLockFree()
+{
+    // The caller has published its modifications with sequential consistency.
+    // If we do not see the processor sleeping here, it will see the modifications
+    // when checking its work, after declaring itself as sleeping.
+    if (_lf_sleeping) {
+        Guard lock(_lf_mutex);
+        _to_do.signal();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Lock-free mode: check if there is something to do.
+//----------------------------------------------------------------------------
+
+bool ts::tsp::PluginExecutor::hasWorkLockFree() const
+{
+    return _lf_input_end || _lf_received != _lf_processed || ringNext<PluginExecutor>()->_tsp_aborting;
+}
+
+
+//----------------------------------------------------------------------------
+// Lock-free mode: pass processed packets to the next packet processor.
+//----------------------------------------------------------------------------
+
+bool ts::tsp::PluginExecutor::passPacketsLockFree(size_t count, BitRate bitrate, bool input_end, bool aborted)
+{
+    assert(count <= _lf_received - _lf_processed);
+    assert(_pkt_first + count <= _buffer->count());
+
+    // Update our buffer. Only this thread accesses these fields.
+    _pkt_first = (_pkt_first + count) % _buffer->count();
+    _lf_processed += count;
+
+    // Update next processor's buffer. The bitrate and the packet count must
+    // be visible before the end of input.
+    PluginExecutor* next = ringNext<PluginExecutor>();
+    next->_lf_bitrate.store(bitrate, std::memory_order_relaxed);
+    next->_lf_received.fetch_add(count);
+    if (input_end) {
+        next->_lf_input_end = true;
+    }
+
+    // Wake the next processor when there is some data
+    if (count > 0 || input_end) {
+        next->wakeUpLockFree();
+    }
+
+    // Force to abort our processor when the next one is aborting.
+    aborted = aborted || next->_tsp_aborting;
+
+    // Wake the previous processor when we abort
+    if (aborted) {
+        _tsp_aborting = true; // volatile bool in TSP superclass
+        PluginExecutor* previous = abortPrevious();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        previous->wakeUpLockFree();
+    }
+
+    // Return false when the current processor shall stop.
+    return !input_end && !aborted;
+}
+
+
+//----------------------------------------------------------------------------
+// Lock-free mode: wait for something to do.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::waitWorkLockFree(size_t& pkt_first, size_t& pkt_cnt, BitRate& bitrate, bool& input_end, bool& aborted)
+{
+    // First, poll for some time, expecting packets to come soon.
+    size_t spin = 0;
+    while (spin < _lf_spin && !hasWorkLockFree()) {
+        spin++;
+        Thread::Yield();
+    }
+
+    if (spin < _lf_spin) {
+        // Got something to do while polling. Poll a bit longer next time.
+        if (spin > 0) {
+            _lf_spin = std::min<size_t>(2 * _lf_spin, LOCK_FREE_MAX_SPIN);
+        }
+    }
+    else {
+        // Polling failed, sleep on the condition. Poll less next time.
+        _lf_spin = std::max<size_t>(_lf_spin / 2, LOCK_FREE_MIN_SPIN);
+        GuardCondition lock(_lf_mutex, _to_do);
+        _lf_sleeping = true;
+        while (!hasWorkLockFree()) {
+            lock.waitCondition();
+        }
+        _lf_sleeping = false;
+    }
+
+    // Read the end of input before the packet count. If the end of input is
+    // set, the packet count is already final.
+    const bool end = _lf_input_end;
+    const size_t available = _lf_received - _lf_processed;
+
+    pkt_first = _pkt_first;
+    pkt_cnt = std::min(available, _buffer->count() - _pkt_first);
+    bitrate = _lf_bitrate.load(std::memory_order_relaxed);
+    input_end = end && pkt_cnt == available;
+    aborted = ringNext<PluginExecutor>()->_tsp_aborting;
+
+    log(10, u"waitWork (pkt_first = %'d, pkt_cnt = %'d, bitrate = %'d, input_end = %'d, aborted = %'d)", {pkt_first, pkt_cnt, bitrate, input_end, aborted});
+}
@@ -42,6 +42,7 @@
 #include "tsCondition.h"
 #include "tsMutex.h"
 #include "tsThread.h"
+#include <atomic>
 
 namespace ts {
     namespace tsp {
@@ -95,6 +96,27 @@ namespace ts {
         //!  window of the next processor), it must notify the _to_do condition variable
         //!  of the next thread.
         //!
+        //!  With the tsp option -\-lock-free, the global mutex is not used to pass
+        //!  packets. The boundary between two adjacent processors is then a pair of
+        //!  counters, each of them being written by one thread only (single producer,
+        //!  single consumer). The total number of packets passed to a processor is
+        //!  an atomic counter which is written by the previous processor only. The
+        //!  number of packets which were processed is known by the processor itself
+        //!  only. When its sliding window is empty, a processor first spins for a
+        //!  while, expecting packets to come soon, before sleeping on its "_to_do"
+        //!  condition variable. The previous processor signals the condition only
+        //!  when the processor is actually sleeping. The spin duration adapts itself
+        //!  to the success of previous spins.
+        //!
+        //!  A packet processor which is specified using -G instead of -P on the
+        //!  command line is "grouped" with the previous one. It does not have its
+        //!  own thread. The thread of the first processor of the group executes
+        //!  all plugins of the group, one after the other, on the same packets.
+        //!  The grouped processors keep their own sliding window, which is always
+        //!  immediately passed to the next processor by the thread of the group.
+        //!  A processor which aborts notifies the first processor of the group
+        //!  which precedes it, all grouped processors in between being aborted.
+        //!
         //!  When a packet processor decides to drop a packet, the synchronization
         //!  byte (first byte of the packet, normally 0x47) is reset to zero. When
         //!  a packet processor or the output processor encounters a packet starting
@@ -176,6 +198,15 @@ namespace ts {
             //!
             bool isRealTime() const;
 
+            //!
+            //! Check if the plugin is grouped with the previous one.
+            //! @return True if the plugin is executed in the thread of the previous plugin.
+            //!
+            bool isGrouped() const
+            {
+                return _grouped;
+            }
+
         protected:
             PacketBuffer* _buffer; //!< Description of shared packet buffer.
 
@@ -217,7 +248,8 @@ namespace ts {
                           bool& aborted);
 
         private:
-            Condition _to_do;    // Notify processor to do something
+            const bool _grouped; // Executed in the thread of the previous plugin
+            Condition  _to_do;   // Notify processor to do something
 
             // The following private data must be accessed exclusively under the
             // protection of the global mutex.
@@ -226,6 +258,29 @@ namespace ts {
             bool    _input_end;  // No more packet after current ones
             BitRate _bitrate;    // Input bitrate (set by previous plugin)
 
+            // The following private data are used in lock-free mode only.
+            // The packet area size is _lf_received - _lf_processed (modulo size_t).
+            Mutex                _lf_mutex;      // Protect _to_do when sleeping
+            std::atomic<size_t>  _lf_received;   // Total packets received from previous plugin (written by previous)
+            size_t               _lf_processed;  // Total packets passed to next plugin (local)
+            std::atomic<bool>    _lf_input_end;  // No more packet after current ones (written by previous)
+            std::atomic<BitRate> _lf_bitrate;    // Input bitrate (written by previous)
+            std::atomic<bool>    _lf_sleeping;   // This processor sleeps on _to_do
+            size_t               _lf_spin;       // Current number of polling loops before sleeping
+
+            // Lock-free versions of passPackets() and waitWork().
+            bool passPacketsLockFree(size_t count, BitRate bitrate, bool input_end, bool aborted);
+            void waitWorkLockFree(size_t& pkt_first, size_t& pkt_cnt, BitRate& bitrate, bool& input_end, bool& aborted);
+
+            // Lock-free mode: check if there is something to do.
+            bool hasWorkLockFree() const;
+
+            // Lock-free mode: wake up a processor if it sleeps.
+            void wakeUpLockFree();
+
+            // Get the previous plugin which has its own thread, abort all grouped plugins in between.
+            PluginExecutor* abortPrevious();
+
             // Inaccessible operations.
             PluginExecutor() = delete;
             PluginExecutor(const PluginExecutor&) = delete;
@@ -45,11 +45,89 @@ ts::tsp::ProcessorExecutor::ProcessorExecutor(Options* options,
                                               Mutex& global_mutex) :
 
     PluginExecutor(options, pl_options, attributes, global_mutex),
-    _processor(dynamic_cast<ProcessorPlugin*>(PluginThread::plugin()))
+    _processor(dynamic_cast<ProcessorPlugin*>(PluginThread::plugin())),
+    _status(),
+    _output_bitrate(0),
+    _bitrate_never_modified(true),
+    _pkt_flush(0),
+    _passed_packets(0),
+    _dropped_packets(0),
+    _nullified_packets(0)
 {
 }
 
 
+//----------------------------------------------------------------------------
+// Process a contiguous slice of packets with the plugin of this executor.
+//----------------------------------------------------------------------------
+
+size_t ts::tsp::ProcessorExecutor::processSlice(TSPacket* pkt, size_t count, bool stop_on_flush, bool& flush, bool& end)
+{
+    if (_status.size() < count) {
+        _status.resize(count);
+    }
+
+    size_t done = 0;
+    while (done < count && !end && !(stop_on_flush && flush)) {
+
+        bool bitrate_changed = false;
+        size_t batch = _processor->processPacketBatch(pkt + done, count - done, _status.data(), flush, bitrate_changed);
+        if (batch == 0 || batch > count - done) {
+            error(u"invalid packet batch processing count %d, expected 1 to %d", {batch, count - done});
+            batch = count - done;
+        }
+
+        // Use the returned status of each packet.
+        for (size_t i = 0; i < batch; ++i) {
+            TSPacket& p(pkt[done + i]);
+            switch (_status[i]) {
+                case ProcessorPlugin::TSP_OK:
+                    // Normal case, pass packet
+                    _passed_packets++;
+                    break;
+                case ProcessorPlugin::TSP_NULL:
+                    // Replace the packet with a complete null packet
+                    p = NullPacket;
+                    _nullified_packets++;
+                    break;
+                case ProcessorPlugin::TSP_DROP:
+                    // Drop this packet, unless already dropped by a previous plugin.
+                    if (p.b[0] != 0) {
+                        p.b[0] = 0;
+                        _dropped_packets++;
+                    }
+                    break;
+                case ProcessorPlugin::TSP_END:
+                    // Signal end of input to successors and abort to predecessors.
+                    // This packet and the next ones are not passed.
+                    end = true;
+                    batch = i;
+                    break;
+                default:
+                    // Invalid status, report error and accept packet.
+                    error(u"invalid packet processing status %d", {_status[i]});
+                    break;
+            }
+        }
+
+        // If the packet processor has signaled a new bitrate, get it.
+        if (bitrate_changed) {
+            BitRate new_bitrate = _processor->getBitrate();
+            if (new_bitrate != 0) {
+                _bitrate_never_modified = false;
+                _output_bitrate = new_bitrate;
+            }
+        }
+
+        done += batch;
+        addTotalPackets(batch);
+    }
+
+    _pkt_flush += done;
+    return done;
+}
+
+
 //----------------------------------------------------------------------------
 // Packet processor plugin thread
 //----------------------------------------------------------------------------
@@ -58,11 +136,17 @@ void ts::tsp::ProcessorExecutor::main()
 {
     debug(u"packet processing thread started");
 
-    PacketCounter passed_packets = 0;
-    PacketCounter dropped_packets = 0;
-    PacketCounter nullified_packets = 0;
-    BitRate output_bitrate = _tsp_bitrate;
-    bool bitrate_never_modified = true;
+    // Build the group of plugins which are executed in this thread.
+    std::vector<ProcessorExecutor*> group(1, this);
+    for (PluginExecutor* next = ringNext<PluginExecutor>(); next->isGrouped(); next = next->ringNext<PluginExecutor>()) {
+        group.push_back(dynamic_cast<ProcessorExecutor*>(next));
+        assert(group.back() != nullptr);
+        group.back()->debug(u"executed in the thread of plugin %s", {pluginName()});
+    }
+    for (size_t i = 0; i < group.size(); ++i) {
+        group[i]->_output_bitrate = group[i]->_tsp_bitrate;
+    }
+
     bool input_end = false;
     bool aborted = false;
 
@@ -72,108 +156,112 @@ void ts::tsp::ProcessorExecutor::main()
         size_t pkt_first, pkt_cnt;
         waitWork(pkt_first, pkt_cnt, _tsp_bitrate, input_end, aborted);
 
-        // If bit rate was never modified by the plugin, always copy the
-        // input bitrate as output bitrate. Otherwise, keep previous
-        // output bitrate, as modified by the plugin.
+        // Propagate the input bitrate in the group. If bit rate was never
+        // modified by a plugin, always copy its input bitrate as output
+        // bitrate. Otherwise, keep previous output bitrate, as modified
+        // by the plugin.
 
-        if (bitrate_never_modified) {
-            output_bitrate = _tsp_bitrate;
+        for (size_t i = 0; i < group.size(); ++i) {
+            ProcessorExecutor* const proc = group[i];
+            if (i > 0) {
+                proc->_tsp_bitrate = group[i-1]->_output_bitrate;
+            }
+            if (proc->_bitrate_never_modified) {
+                proc->_output_bitrate = proc->_tsp_bitrate;
+            }
         }
 
         // If next processor has aborted, abort as well.
-        // We call passPacket to inform our predecessor that we aborted.
+        // Our predecessor is informed after the loop.
 
         if (aborted) {
-            passPackets(0, output_bitrate, true, true);
             break;
         }
 
         // Exit thread if no more packet to process.
-        // We call passPackets to inform our successor of end of input.
+        // We call passPackets to inform our successors of end of input.
 
         if (pkt_cnt == 0 && input_end) {
-            passPackets(0, output_bitrate, true, false);
+            for (size_t i = 0; i < group.size(); ++i) {
+                group[i]->passPackets(0, group[i]->_output_bitrate, true, false);
+            }
             break;
         }
 
-        // Now process the packets.
+        // Now process the packets by batches.
 
         size_t pkt_done = 0;
-        size_t pkt_flush = 0;
 
         while (pkt_done < pkt_cnt && !aborted) {
 
-            bool flush_request = false;
-            TSPacket* pkt = _buffer->base() + pkt_first + pkt_done;
-
-            pkt_done++;
-            pkt_flush++;
-
-            // If the packet has not already been dropped by a previous
-            // packet processor, apply the processing routine to the packet
-
-            if (pkt->b[0] != 0) {
-
-                bool bitrate_changed = false;
-                ProcessorPlugin::Status status = _processor->processPacket(*pkt, flush_request, bitrate_changed);
-
-                // Use the returned status
-                switch (status) {
-                    case ProcessorPlugin::TSP_OK:
-                        // Normal case, pass packet
-                        passed_packets++;
-                        break;
-                    case ProcessorPlugin::TSP_NULL:
-                        // Replace the packet with a complete null packet
-                        *pkt = NullPacket;
-                        nullified_packets++;
-                        break;
-                    case ProcessorPlugin::TSP_DROP:
-                        // Drop this packet.
-                        pkt->b[0] = 0;
-                        dropped_packets++;
-                        break;
-                    case ProcessorPlugin::TSP_END:
-                        // Signal end of input to successors and abort
-                        // to predecessors
-                        input_end = aborted = true;
-                        pkt_done--;
-                        pkt_flush--;
-                        pkt_cnt = pkt_done;
-                        break;
-                    default:
-                        // Invalid status, report error and accept packet.
-                        error(u"invalid packet processing status %d", {status});
-                        break;
+            // Do not process more packets than the next periodic flush.
+            size_t batch = pkt_cnt - pkt_done;
+            if (_options->max_flush_pkt > 0) {
+                batch = std::min(batch, _options->max_flush_pkt - _pkt_flush);
+            }
+
+            // Until a plugin declares its joint termination, its total
+            // number of packets must be accurate after each packet.
+            for (size_t i = 0; i < group.size(); ++i) {
+                if (group[i]->useJointTermination() && !group[i]->thisJointTerminated()) {
+                    batch = 1;
                 }
+            }
 
-                // If the packet processor has signaled a new bitrate, get it.
-                if (bitrate_changed) {
-                    BitRate new_bitrate = _processor->getBitrate();
-                    if (new_bitrate != 0) {
-                        bitrate_never_modified = false;
-                        output_bitrate = new_bitrate;
-                    }
+            // Apply all plugins of the group, one after the other, on the same packets.
+            // The first one may stop on a flush request. Each plugin processes the packets
+            // which were passed by the previous one. On TSP_END, the subsequent plugins
+            // process the packets before the end.
+
+            TSPacket* const pkt = _buffer->base() + pkt_first + pkt_done;
+            bool flush_request = false;
+            size_t end_index = group.size(); // index of first plugin which returned TSP_END
+            size_t count = batch;
+
+            for (size_t i = 0; i < group.size(); ++i) {
+                bool end = false;
+                count = group[i]->processSlice(pkt, count, i == 0, flush_request, end);
+                if (i == 0) {
+                    pkt_done += count;
+                }
+                if (end && end_index == group.size()) {
+                    end_index = i;
                 }
             }
 
-            addTotalPackets(1);
+            if (end_index < group.size()) {
+                aborted = true;
+                pkt_cnt = pkt_done;
+            }
 
             // Do not wait to process pkt_cnt packets before notifying
             // the next processor. Perform periodic flush to avoid waiting
             // too long before two output operations.
 
-            if (flush_request || pkt_done == pkt_cnt || (_options->max_flush_pkt > 0 && pkt_flush % _options->max_flush_pkt == 0)) {
-                aborted = !passPackets(pkt_flush, output_bitrate, pkt_done == pkt_cnt && input_end, aborted);
-                pkt_flush = 0;
+            if (flush_request || pkt_done == pkt_cnt || (_options->max_flush_pkt > 0 && _pkt_flush >= _options->max_flush_pkt)) {
+                for (size_t i = 0; i < group.size(); ++i) {
+                    ProcessorExecutor* const proc = group[i];
+                    proc->passPackets(proc->_pkt_flush, proc->_output_bitrate, (pkt_done == pkt_cnt && input_end) || i >= end_index, i == end_index);
+                    proc->_pkt_flush = 0;
+                    aborted = aborted || proc->_tsp_aborting;
+                }
             }
         }
 
     } while (!input_end && !aborted);
 
-    // Close the packet processor
-    _processor->stop();
-
-    debug(u"packet processing thread %s after %'d packets, %'d passed, %'d dropped, %'d nullified",
-          {aborted ? u"aborted" : u"terminated", totalPackets(), passed_packets, dropped_packets, nullified_packets});
+    // Inform our predecessors that we abort, from the last plugin of the group.
+    if (aborted) {
+        for (size_t i = group.size(); i-- > 0; ) {
+            group[i]->passPackets(0, group[i]->_output_bitrate, true, true);
+        }
+    }
+
+    // Close the packet processors
+    for (size_t i = 0; i < group.size(); ++i) {
+        ProcessorExecutor* const proc = group[i];
+        proc->_processor->stop();
+        proc->debug(u"packet processing thread %s after %'d packets, %'d passed, %'d dropped, %'d nullified",
+                    {aborted ? u"aborted" : u"terminated", proc->totalPackets(), proc->_passed_packets, proc->_dropped_packets, proc->_nullified_packets});
+    }
 }
@@ -39,6 +39,8 @@ namespace ts {
     namespace tsp {
         //!
         //! Execution context of a tsp packet processor plugin.
+        //! The thread of a processor also executes all following processors
+        //! which are grouped with it (see ts::tsp::PluginExecutor::isGrouped()).
         //! @ingroup plugin
         //!
         class ProcessorExecutor: public PluginExecutor
@@ -65,6 +67,20 @@ namespace ts {
 
         private:
             ProcessorPlugin* _processor;
+            std::vector<ProcessorPlugin::Status> _status;  // Status of each packet in a batch
+
+            // Processing state, accessed by the thread of the group only.
+            BitRate       _output_bitrate;          // Output bitrate, as passed to next plugin
+            bool          _bitrate_never_modified;  // The plugin never modified the bitrate
+            size_t        _pkt_flush;               // Processed packets, not yet passed to next plugin
+            PacketCounter _passed_packets;
+            PacketCounter _dropped_packets;
+            PacketCounter _nullified_packets;
+
+            // Process a contiguous slice of packets with the plugin of this executor.
+            // Stop on TSP_END (set end) and optionally on flush request.
+            // Return the number of processed packets, to pass to the next plugin.
+            size_t processSlice(TSPacket* pkt, size_t count, bool stop_on_flush, bool& flush, bool& end);
 
             // Inherited from Thread
             virtual void main() override;
@@ -72,7 +72,8 @@ Options::Options(int argc, char *argv[]) :
     option(u"", 0, STRING);
     help(u"",
          u"Input binary or XML files containing one or more sections or tables. By default, "
-         u"files ending in .xml are XML and files ending in .bin are binary. For other "
+         u"files ending in .xml are XML, files ending in .bin are binary and files ending "
+         u"in .sidx are indexed section files (see tstables --indexed-output). For other "
          u"file names, explicitly specify --binary or --xml. If the file name is "
          u"omitted, the standard input is used (binary by default, specify --xml "
          u"otherwise)."
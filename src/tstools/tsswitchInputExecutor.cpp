@@ -40,7 +40,7 @@ TSDUCK_SOURCE;
 
 ts::tsswitch::InputExecutor::InputExecutor(size_t index, Core& core, Options& opt, Report& log) :
     // Input threads have a high priority to be always ready to load incoming packets in the buffer.
-    PluginThread(&opt, opt.appName(), opt.inputs[index], ThreadAttributes().setPriority(ThreadAttributes::GetHighPriority())),
+    PluginThread(&opt, opt.appName(), opt.inputs[index], ThreadAttributes().setPriority(ThreadAttributes::GetHighPriority()).setAffinity(opt.inputCPUs[index])),
     _core(core),
     _opt(opt),
     _input(dynamic_cast<InputPlugin*>(PluginThread::plugin())),
@@ -160,6 +160,14 @@ void ts::tsswitch::InputExecutor::main()
 {
     debug(u"input thread started");
 
+    // When the thread is bound to some CPU's, reallocate the packet buffer from this thread
+    // so that it is physically located on the same NUMA node ("first touch" policy).
+    // No input session is started yet, the buffer is not used by the output thread.
+    if (!_opt.inputCPUs[_pluginIndex].empty()) {
+        Guard lock(_mutex);
+        TSPacketVector(_buffer.size()).swap(_buffer);
+    }
+
     // Main loop. Each iteration is a complete input session.
     for (;;) {
 
@@ -60,7 +60,9 @@ ts::tsswitch::Options::Options(int argc, char *argv[]) :
     sockBuffer(0),
     remoteServer(),
     allowedRemote(),
-    receiveTimeout(0)
+    receiveTimeout(0),
+    inputCPUs(),
+    outputCPUs()
 {
     setDescription(u"TS input source switch using remote control");
 
@@ -107,6 +109,17 @@ ts::tsswitch::Options::Options(int argc, char *argv[]) :
     option(u"infinite", 'i');
     help(u"infinite", u"Infinitely repeat the cycle through all input plugins in sequence.");
 
+    option(u"input-cpus", 0, STRING, 0, UNLIMITED_COUNT);
+    help(u"input-cpus", u"list",
+         u"Specify the list of CPU's where an input plugin thread is allowed to run. "
+         u"The list is made of comma-separated CPU indexes or ranges of indexes, "
+         u"for instance \"0-3,8\". The buffer of the input plugin is allocated from "
+         u"this thread's CPU's so that it is physically located on the same NUMA node. "
+         u"This option can be specified several times. The first occurrence applies to "
+         u"the first input plugin, the second occurrence to the second input, etc. "
+         u"The last occurrence applies to all remaining input plugins. "
+         u"By default, the threads may run on any CPU (see also --numa-node).");
+
     option(u"log-message-count", 0, POSITIVE);
     help(u"log-message-count",
          u"Specify the maximum number of buffered log messages. Log messages are "
@@ -135,6 +148,18 @@ ts::tsswitch::Options::Options(int argc, char *argv[]) :
          u"This includes CPU load, virtual memory usage. Useful to verify the "
          u"stability of the application.");
 
+    option(u"numa-node", 0, UNSIGNED);
+    help(u"numa-node",
+         u"Run all plugin threads on the CPU's of the specified NUMA node, unless "
+         u"otherwise specified using --input-cpus or --output-cpus. "
+         u"This option is currently supported on Linux only.");
+
+    option(u"output-cpus", 0, STRING);
+    help(u"output-cpus", u"list",
+         u"Specify the list of CPU's where the output plugin thread is allowed to run. "
+         u"See option --input-cpus for the format of the list. "
+         u"By default, the thread may run on any CPU (see also --numa-node).");
+
     option(u"primary-input", 'p', UNSIGNED);
     help(u"primary-input",
          u"Specify the index of the input plugin which is considered as primary "
@@ -221,6 +246,17 @@ ts::tsswitch::Options::Options(int argc, char *argv[]) :
         error(u"options --delayed-switch and --fast-switch are mutually exclusive");
     }
 
+    // CPU affinity of plugin threads. The default is the NUMA node, if specified.
+    ThreadAttributes::CPUSet nodeCPUs;
+    if (present(u"numa-node") && !ThreadAttributes::GetNUMANodeCPUs(intValue<size_t>(u"numa-node"), nodeCPUs)) {
+        error(u"NUMA node %d not found or unsupported on this system", {intValue<size_t>(u"numa-node")});
+    }
+    inputCPUs.resize(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        getCPUAffinity(inputCPUs[i], u"input-cpus", i, nodeCPUs);
+    }
+    getCPUAffinity(outputCPUs, u"output-cpus", 0, nodeCPUs);
+
     // Resolve remote control name.
     if (!remoteName.empty() && remoteServer.resolve(remoteName, *this) && !remoteServer.hasPort()) {
         error(u"missing UDP port number in --remote");
@@ -66,6 +66,8 @@ namespace ts {
             SocketAddress remoteServer;      //!< UDP server addres for remote control.
             IPAddressSet  allowedRemote;     //!< Set of allowed remotes.
             MilliSecond   receiveTimeout;    //!< Receive timeout before switch (0=none).
+            std::vector<ThreadAttributes::CPUSet> inputCPUs;  //!< CPU affinity of each input plugin thread (empty: any CPU).
+            ThreadAttributes::CPUSet outputCPUs;              //!< CPU affinity of the output plugin thread (empty: any CPU).
 
             //!
             //! Constructor.
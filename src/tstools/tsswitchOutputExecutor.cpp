@@ -38,7 +38,7 @@ TSDUCK_SOURCE;
 //----------------------------------------------------------------------------
 
 ts::tsswitch::OutputExecutor::OutputExecutor(Core& core, Options& opt, Report& log) :
-    PluginThread(&opt, opt.appName(), opt.outputs[0], ThreadAttributes()),
+    PluginThread(&opt, opt.appName(), opt.outputs[0], ThreadAttributes().setAffinity(opt.outputCPUs)),
     _core(core),
     _output(dynamic_cast<OutputPlugin*>(plugin())),
     _terminate(false)
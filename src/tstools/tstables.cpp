@@ -32,10 +32,13 @@
 //----------------------------------------------------------------------------
 
 #include "tsMain.h"
-#include "tsInputRedirector.h"
+#include "tsTSFileInput.h"
 #include "tsTablesLogger.h"
 TSDUCK_SOURCE;
 
+// Number of packets to read at a time.
+#define READ_PACKETS 1024
+
 // With static link, enforce a reference to MPEG/DVB structures.
 #if defined(TSDUCK_STATIC_LIBRARY)
 #include "tsStaticReferencesDVB.h"
@@ -52,6 +55,7 @@ struct Options: public ts::Args
     Options(int argc, char *argv[]);
 
     ts::UString           infile;   // Input file name.
+    bool                  mmap;     // Use memory-mapped I/O on regular files.
     ts::TablesLoggerArgs  logger;   // Table logging options.
     ts::TablesDisplayArgs display;  // Table formatting options.
 };
@@ -59,18 +63,26 @@ struct Options: public ts::Args
 Options::Options(int argc, char *argv[]) :
     Args(u"Collect PSI/SI tables from an MPEG transport stream", u"[options] [filename]"),
     infile(),
+    mmap(false),
     logger(),
     display()
 {
     option(u"", 0, STRING, 0, 1);
     help(u"", u"Input MPEG capture file (standard input if omitted).");
 
+    option(u"memory-map");
+    help(u"memory-map",
+         u"Read regular files using memory-mapped I/O instead of read operations. "
+         u"This is faster on large files but the files must not be truncated while "
+         u"they are read. Do not use this option on files which are still being written.");
+
     logger.defineOptions(*this);
     display.defineOptions(*this);
 
     analyze(argc, argv);
 
     infile = value(u"");
+    mmap = present(u"memory-map");
     logger.load(*this);
     display.load(*this);
 
@@ -85,15 +97,31 @@ Options::Options(int argc, char *argv[]) :
 int MainCode(int argc, char *argv[])
 {
     Options opt (argc, argv);
-    ts::InputRedirector input(opt.infile, opt);
     ts::TablesDisplay display(opt.display, opt);
     ts::TablesLogger logger(opt.logger, display, opt);
-    ts::TSPacket pkt;
+    ts::TSFileInput file;
+    const ts::TSPacket* pkt = nullptr;
+    size_t count = 0;
+    bool sync = true;
+
+    // Packets are analyzed without copy, directly in the file mapping if requested.
+    file.setMemoryMapping(opt.mmap);
+    if (!file.open(opt.infile, 1, 0, opt)) {
+        return EXIT_FAILURE;
+    }
 
     // Read all packets in the file and pass them to the logger
-    while (!logger.completed() && pkt.read(std::cin, true, opt)) {
-        logger.feedPacket(pkt);
+    while (sync && !logger.completed() && (count = file.readInPlace(pkt, READ_PACKETS, opt)) > 0) {
+        for (size_t i = 0; sync && !logger.completed() && i < count; ++i) {
+            if ((sync = pkt[i].hasValidSync())) {
+                logger.feedPacket(pkt[i]);
+            }
+            else {
+                opt.error(u"synchronization lost after %'d TS packets, got 0x%X instead of 0x%X at start of TS packet", {file.getPacketCount() - count + i, pkt[i].b[0], ts::SYNC_BYTE});
+            }
+        }
     }
+    file.close(opt);
     logger.close();
 
     // Report errors
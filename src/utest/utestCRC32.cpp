@@ -0,0 +1,176 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for CRC32 class.
+//
+//----------------------------------------------------------------------------
+
+#include "tsCRC32.h"
+#include "tsMonotonic.h"
+#include "tsByteBlock.h"
+#include "utestCppUnitTest.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class CRC32Test: public CppUnit::TestFixture
+{
+public:
+    CRC32Test();
+
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testReference();
+    void testEngines();
+    void testThroughput();
+
+    CPPUNIT_TEST_SUITE(CRC32Test);
+    CPPUNIT_TEST(testReference);
+    CPPUNIT_TEST(testEngines);
+    CPPUNIT_TEST(testThroughput);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    ts::ByteBlock _data;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CRC32Test);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+CRC32Test::CRC32Test() :
+    _data()
+{
+}
+
+// Test suite initialization method.
+void CRC32Test::setUp()
+{
+    // Deterministic pseudo-random data.
+    _data.resize(8192);
+    uint32_t x = 0x12345678;
+    for (size_t i = 0; i < _data.size(); ++i) {
+        x = x * 1103515245 + 12345;
+        _data[i] = uint8_t(x >> 16);
+    }
+}
+
+// Test suite cleanup method.
+void CRC32Test::tearDown()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Test cases
+//----------------------------------------------------------------------------
+
+void CRC32Test::testReference()
+{
+    // Standard check value of CRC-32/MPEG-2.
+    static const char check[] = "123456789";
+
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0x0376E6E7), ts::CRC32(check, 9).value());
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0xFFFFFFFF), ts::CRC32(check, 0).value());
+
+    ts::CRC32 crc;
+    crc.add(check, 4);
+    crc.add(check + 4, 5);
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0x0376E6E7), crc.value());
+
+    CPPUNIT_ASSERT(ts::CRC32::IsSupported(ts::CRC32::BYTE_TABLE));
+    CPPUNIT_ASSERT(ts::CRC32::IsSupported(ts::CRC32::SLICING_BY_8));
+    utest::Out() << "CRC32Test: carry-less multiplication supported: " << ts::UString::YesNo(ts::CRC32::IsSupported(ts::CRC32::CLMUL)) << std::endl;
+}
+
+void CRC32Test::testEngines()
+{
+    // All implementations must give the same result on all sizes and alignments.
+    for (size_t size = 0; size < 1100; ++size) {
+        for (size_t offset = 0; offset < 4; ++offset) {
+            ts::CRC32 ref, slice, clmul, def;
+            ref.add(&_data[offset], size, ts::CRC32::BYTE_TABLE);
+            slice.add(&_data[offset], size, ts::CRC32::SLICING_BY_8);
+            clmul.add(&_data[offset], size, ts::CRC32::CLMUL);
+            def.add(&_data[offset], size);
+            CPPUNIT_ASSERT_EQUAL(ref.value(), slice.value());
+            CPPUNIT_ASSERT_EQUAL(ref.value(), clmul.value());
+            CPPUNIT_ASSERT_EQUAL(ref.value(), def.value());
+        }
+    }
+
+    // Computation in several chunks.
+    ts::CRC32 ref(_data.data(), _data.size());
+    ts::CRC32 crc;
+    for (size_t start = 0, chunk = 1; start < _data.size(); start += chunk, chunk = 2 * chunk + 1) {
+        crc.add(&_data[start], std::min(chunk, _data.size() - start));
+    }
+    CPPUNIT_ASSERT_EQUAL(ref.value(), crc.value());
+}
+
+void CRC32Test::testThroughput()
+{
+    // Micro-benchmark, typical section sizes.
+    static const size_t sizes[] = {16, 188, 1024, 4096};
+    static const ts::CRC32::Engine engines[] = {ts::CRC32::BYTE_TABLE, ts::CRC32::SLICING_BY_8, ts::CRC32::CLMUL};
+    static const ts::UChar* const names[] = {u"byte table", u"slicing-by-8", u"clmul"};
+    static const size_t total = 16 * 1024 * 1024;  // bytes per measurement
+
+    for (size_t is = 0; is < sizeof(sizes) / sizeof(sizes[0]); ++is) {
+        const size_t size = sizes[is];
+        for (size_t ie = 0; ie < sizeof(engines) / sizeof(engines[0]); ++ie) {
+            if (!ts::CRC32::IsSupported(engines[ie])) {
+                continue;
+            }
+            uint32_t result = 0;
+            ts::Monotonic start;
+            start.getSystemTime();
+            for (size_t done = 0; done < total; done += size) {
+                ts::CRC32 crc;
+                crc.add(_data.data(), size, engines[ie]);
+                result ^= crc.value();
+            }
+            ts::Monotonic end;
+            end.getSystemTime();
+            const ts::NanoSecond duration = std::max<ts::NanoSecond>(1, end - start);
+            utest::Out() << "CRC32Test: " << ts::UString(names[ie]).toJustifiedLeft(12)
+                         << " size: " << ts::UString::Decimal(size, 4)
+                         << " bytes, " << ts::UString::Decimal((ts::NanoSecond(total) * ts::NanoSecPerSec) / (1024 * 1024 * duration), 6)
+                         << " MB/s, result: " << ts::UString::Hexa(result) << std::endl;
+        }
+    }
+}
@@ -83,6 +83,7 @@ public:
     void testAES_CTS3();
     void testAES_CTS4();
     void testAES_DVS042();
+    void testAESAcceleration();
     void testDES();
     void testTDES();
     void testTDES_CBC();
@@ -104,6 +105,7 @@ public:
     CPPUNIT_TEST(testAES_CTS3);
     CPPUNIT_TEST(testAES_CTS4);
     CPPUNIT_TEST(testAES_DVS042);
+    CPPUNIT_TEST(testAESAcceleration);
     CPPUNIT_TEST(testDES);
     CPPUNIT_TEST(testTDES);
     CPPUNIT_TEST(testTDES_CBC);
@@ -399,6 +401,57 @@ void CryptoTest::testAES_DVS042()
     testChainingSizes(dvs042_aes, 16, 17, 23, 31, 32, 33, 45, 64, 67, 184, 12345, 0);
 }
 
+void CryptoTest::testAESAcceleration()
+{
+    utest::Out() << "CryptoTest: AES hardware acceleration: " << ts::UString::YesNo(ts::AES::IsAccelerated()) << std::endl;
+
+    // Compare hardware and portable implementations, with all key sizes and
+    // block counts which exercise the parallel and sequential code paths.
+    ts::SystemRandomGenerator prng;
+    ts::AES hw;
+    ts::AES sw;
+    sw.setAcceleration(false);
+
+    for (size_t key_size = ts::AES::MIN_KEY_SIZE; key_size <= ts::AES::MAX_KEY_SIZE; key_size += 8) {
+        for (size_t count = 0; count <= 19; ++count) {
+
+            const ts::UString name(ts::UString::Format(u"AES-%d on %d blocks", {8 * key_size, count}));
+            const size_t size = count * ts::AES::BLOCK_SIZE;
+            ts::ByteBlock key(key_size);
+            ts::ByteBlock plain(size + 1);
+            ts::ByteBlock cipher1(size + 1);
+            ts::ByteBlock cipher2(size + 1);
+            ts::ByteBlock decipher(size + 1);
+
+            CPPUNIT_ASSERT(prng.read(key.data(), key.size()));
+            CPPUNIT_ASSERT(prng.read(plain.data(), plain.size()));
+            CPPUNIT_ASSERT(hw.setKey(key.data(), key.size()));
+            CPPUNIT_ASSERT(sw.setKey(key.data(), key.size()));
+
+            CPPUNIT_ASSERT(hw.encryptBlocks(plain.data(), cipher1.data(), count));
+            CPPUNIT_ASSERT(sw.encryptBlocks(plain.data(), cipher2.data(), count));
+            if (::memcmp(cipher1.data(), cipher2.data(), size) != 0) {
+                utest::Out()
+                    << "CryptoTest: " << name << ": encryption mismatch" << std::endl
+                    << "  Portable: " << ts::UString::Dump(cipher2.data(), size, ts::UString::SINGLE_LINE) << std::endl
+                    << "  Hardware: " << ts::UString::Dump(cipher1.data(), size, ts::UString::SINGLE_LINE) << std::endl;
+                CPPUNIT_FAIL("CryptoTest: " + name.toUTF8() + ": encryption mismatch");
+            }
+
+            CPPUNIT_ASSERT(hw.decryptBlocks(cipher1.data(), decipher.data(), count));
+            CPPUNIT_ASSERT(::memcmp(plain.data(), decipher.data(), size) == 0);
+            CPPUNIT_ASSERT(sw.decryptBlocks(cipher1.data(), decipher.data(), count));
+            CPPUNIT_ASSERT(::memcmp(plain.data(), decipher.data(), size) == 0);
+
+            // In place.
+            CPPUNIT_ASSERT(hw.encryptBlocks(decipher.data(), decipher.data(), count));
+            CPPUNIT_ASSERT(::memcmp(cipher1.data(), decipher.data(), size) == 0);
+            CPPUNIT_ASSERT(hw.decryptBlocks(decipher.data(), decipher.data(), count));
+            CPPUNIT_ASSERT(::memcmp(plain.data(), decipher.data(), size) == 0);
+        }
+    }
+}
+
 void CryptoTest::testDES()
 {
     ts::DES des;
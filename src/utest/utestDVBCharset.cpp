@@ -32,6 +32,10 @@
 //----------------------------------------------------------------------------
 
 #include "tsDVBCharset.h"
+#include "tsDVBCharsetSingleByte.h"
+#include "tsDVBCharsetUTF8.h"
+#include "tsByteBlock.h"
+#include "tsMonotonic.h"
 #include "utestCppUnitTest.h"
 TSDUCK_SOURCE;
 
@@ -46,9 +50,15 @@ public:
     virtual void tearDown() override;
 
     void testRepository();
+    void testSingleByte();
+    void testUTF8();
+    void testThroughput();
 
     CPPUNIT_TEST_SUITE(DVBCharsetTest);
     CPPUNIT_TEST(testRepository);
+    CPPUNIT_TEST(testSingleByte);
+    CPPUNIT_TEST(testUTF8);
+    CPPUNIT_TEST(testThroughput);
     CPPUNIT_TEST_SUITE_END();
 };
 
@@ -79,3 +89,90 @@ void DVBCharsetTest::testRepository()
     utest::Out() << "DVBCharsetTest::testRepository: charsets: " << ts::UString::Join(ts::DVBCharset::GetAllNames()) << std::endl;
     CPPUNIT_ASSERT_EQUAL(size_t(17), ts::DVBCharset::GetAllNames().size());
 }
+
+void DVBCharsetTest::testSingleByte()
+{
+    // Long runs of ASCII characters, control codes and upper half of ISO-8859-1.
+    ts::ByteBlock dvb;
+    ts::UString ref;
+    for (size_t len = 0; len <= 40; ++len) {
+        for (size_t i = 0; i < len; ++i) {
+            const uint8_t c = uint8_t(0x20 + (len + i) % 0x5F);
+            dvb.push_back(c);
+            ref.push_back(ts::UChar(c));
+        }
+        dvb.push_back(0xE9);
+        ref.push_back(ts::LATIN_SMALL_LETTER_E_WITH_ACUTE);
+        dvb.push_back(0x8A);
+        ref.push_back(ts::LINE_FEED);
+    }
+
+    ts::UString str;
+    CPPUNIT_ASSERT(ts::DVBCharsetSingleByte::ISO_8859_1.decode(str, dvb.data(), dvb.size()));
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(ref, str);
+
+    // Untranslatable characters are skipped.
+    static const uint8_t invalid[] = {'a', 'b', 0x7F, 'c', 0x05, 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 0x90};
+    CPPUNIT_ASSERT(!ts::DVBCharsetSingleByte::ISO_8859_1.decode(str, invalid, sizeof(invalid)));
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"abcdefghijklmnopqr", str);
+
+    CPPUNIT_ASSERT(ts::DVBCharsetSingleByte::ISO_8859_1.decode(str, nullptr, 0));
+    CPPUNIT_ASSERT(str.empty());
+}
+
+void DVBCharsetTest::testUTF8()
+{
+    const ts::UString ref(u"Ce soir : l'\u00E9quipe enqu\u00EAte sur une s\u00E9rie d'\u00E9v\u00E9nements inexpliqu\u00E9s, \u20AC 12.");
+    const std::string utf8(ref.toUTF8());
+    ts::UString str;
+    CPPUNIT_ASSERT(ts::DVBCharsetUTF8::UTF_8.decode(str, reinterpret_cast<const uint8_t*>(utf8.data()), utf8.size()));
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(ref, str);
+}
+
+void DVBCharsetTest::testThroughput()
+{
+    // Micro-benchmark, typical EIT event descriptions.
+    static const ts::UChar* const texts[] = {
+        u"Tonight: the team investigates a series of unexplained events in a small coastal town, "
+        u"while the detective faces new questions about the past. Drama series, season 3, episode 12.",
+        u"Ce soir : l'\u00E9quipe enqu\u00EAte sur une s\u00E9rie d'\u00E9v\u00E9nements inexpliqu\u00E9s dans une petite "
+        u"ville c\u00F4ti\u00E8re, tandis que l'inspecteur doit r\u00E9pondre \u00E0 de nouvelles questions.",
+        u"\u0421\u0435\u0433\u043E\u0434\u043D\u044F \u0432\u0435\u0447\u0435\u0440\u043E\u043C: "
+        u"\u043A\u043E\u043C\u0430\u043D\u0434\u0430 \u0440\u0430\u0441\u0441\u043B\u0435\u0434\u0443\u0435\u0442 "
+        u"\u0441\u0435\u0440\u0438\u044E \u0441\u043E\u0431\u044B\u0442\u0438\u0439. \u0414\u0440\u0430\u043C\u0430, 3, 12.",
+    };
+    static const ts::UChar* const names[] = {u"english", u"french", u"russian"};
+    static const size_t total = 16 * 1024 * 1024;  // bytes per measurement
+
+    for (size_t it = 0; it < sizeof(texts) / sizeof(texts[0]); ++it) {
+        const ts::UString text(texts[it]);
+        const ts::DVBCharset* const charsets[] = {&ts::DVBCharsetSingleByte::ISO_8859_1, &ts::DVBCharsetSingleByte::ISO_8859_5, &ts::DVBCharsetUTF8::UTF_8};
+        for (size_t ic = 0; ic < sizeof(charsets) / sizeof(charsets[0]); ++ic) {
+            const ts::DVBCharset* const charset = charsets[ic];
+            if (!charset->canEncode(text)) {
+                continue;
+            }
+            ts::ByteBlock dvb(2 * 3 * text.size());
+            uint8_t* buffer = dvb.data();
+            size_t size = dvb.size();
+            charset->encode(buffer, size, text);
+            dvb.resize(dvb.size() - size);
+
+            size_t result = 0;
+            ts::Monotonic start;
+            start.getSystemTime();
+            for (size_t done = 0; done < total; done += dvb.size()) {
+                ts::UString str;
+                charset->decode(str, dvb.data(), dvb.size());
+                result += str.size();
+            }
+            ts::Monotonic end;
+            end.getSystemTime();
+            const ts::NanoSecond duration = std::max<ts::NanoSecond>(1, end - start);
+            utest::Out() << "DVBCharsetTest: " << ts::UString(names[it]).toJustifiedLeft(8)
+                         << charset->name().toJustifiedLeft(11)
+                         << " decode: " << ts::UString::Decimal((ts::NanoSecond(total) * ts::NanoSecPerSec) / (1024 * 1024 * duration), 5)
+                         << " MB/s, characters: " << result << std::endl;
+        }
+    }
+}
@@ -91,6 +91,7 @@ public:
     void testTDT();
     void testTOT();
     void testHEVC();
+    void testRepeatedSections();
 
     CPPUNIT_TEST_SUITE(DemuxTest);
     CPPUNIT_TEST(testPAT);
@@ -104,6 +105,7 @@ public:
     CPPUNIT_TEST(testTDT);
     CPPUNIT_TEST(testTOT);
     CPPUNIT_TEST(testHEVC);
+    CPPUNIT_TEST(testRepeatedSections);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -486,3 +488,65 @@ void DemuxTest::testHEVC()
 {
     TEST_TABLE("PMT with HEVC descriptor", pmt_hevc);
 }
+
+namespace {
+    // Collect all sections and tables from a demux.
+    class SectionCollector: public ts::TableHandlerInterface, public ts::SectionHandlerInterface
+    {
+    public:
+        std::vector<ts::ByteBlock> sections;
+        size_t tables;
+        SectionCollector() : sections(), tables(0) {}
+        virtual void handleTable(ts::SectionDemux&, const ts::BinaryTable&) override
+        {
+            tables++;
+        }
+        virtual void handleSection(ts::SectionDemux&, const ts::Section& section) override
+        {
+            sections.push_back(ts::ByteBlock(section.content(), section.size()));
+        }
+    };
+}
+
+void DemuxTest::testRepeatedSections()
+{
+    // Repeat tables with sections in one or several packets.
+    const ts::TSPacket* pat = reinterpret_cast<const ts::TSPacket*>(psi_pat_r4_packets);
+    const ts::TSPacket* nit = reinterpret_cast<const ts::TSPacket*>(psi_nit_tntv23_packets);
+    const size_t pat_count = sizeof(psi_pat_r4_packets) / ts::PKT_SIZE;
+    const size_t nit_count = sizeof(psi_nit_tntv23_packets) / ts::PKT_SIZE;
+    const size_t repeat = 5;
+
+    SectionCollector collector;
+    ts::SectionDemux demux(&collector, &collector, ts::AllPIDs);
+
+    ts::TSPacket pkt;
+    uint8_t pat_cc = 0;
+    uint8_t nit_cc = 0;
+    for (size_t r = 0; r < repeat; ++r) {
+        for (size_t i = 0; i < pat_count; ++i) {
+            pkt = pat[i];
+            pkt.setCC(pat_cc++ % ts::CC_MAX);
+            demux.feedPacket(pkt);
+        }
+        for (size_t i = 0; i < nit_count; ++i) {
+            pkt = nit[i];
+            pkt.setCC(nit_cc++ % ts::CC_MAX);
+            demux.feedPacket(pkt);
+        }
+    }
+
+    // Each table is notified once, each section is notified at each repetition.
+    CPPUNIT_ASSERT(!demux.hasErrors());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), collector.tables);
+    CPPUNIT_ASSERT(collector.sections.size() % repeat == 0);
+    const size_t per_repeat = collector.sections.size() / repeat;
+    CPPUNIT_ASSERT(per_repeat >= 2);
+    for (size_t i = per_repeat; i < collector.sections.size(); ++i) {
+        CPPUNIT_ASSERT(collector.sections[i] == collector.sections[i % per_repeat]);
+    }
+
+    // Repeated sections are built in recycled objects.
+    utest::Out() << "DemuxTest: repeated sections: " << collector.sections.size() << ", avoided allocations: " << demux.allocationsAvoided() << std::endl;
+    CPPUNIT_ASSERT(demux.allocationsAvoided() > 0);
+}
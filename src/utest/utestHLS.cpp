@@ -32,7 +32,9 @@
 //----------------------------------------------------------------------------
 
 #include "tshlsPlayList.h"
-#include "utestCppUnitTest.h"
+#include "tshlsPrefetchBuffer.h"
+#include "tsSysUtils.h"
+#include "utestCppUnitThread.h"
 TSDUCK_SOURCE;
 
 
@@ -50,10 +52,16 @@ public:
 
     void testMasterPlaylist();
     void testMediaPlaylist();
+    void testBuildMediaPlaylist();
+    void testPrefetchBuffer();
+    void testPrefetchThreads();
 
     CPPUNIT_TEST_SUITE(HLSTest);
     CPPUNIT_TEST(testMasterPlaylist);
     CPPUNIT_TEST(testMediaPlaylist);
+    CPPUNIT_TEST(testBuildMediaPlaylist);
+    CPPUNIT_TEST(testPrefetchBuffer);
+    CPPUNIT_TEST(testPrefetchThreads);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -193,3 +201,270 @@ void HLSTest::testMediaPlaylist()
     CPPUNIT_ASSERT_EQUAL(ts::MilliSecond(6000), seg.duration);
     CPPUNIT_ASSERT(!seg.gap);
 }
+
+void HLSTest::testBuildMediaPlaylist()
+{
+    ts::hls::PlayList pl;
+    pl.reset(ts::hls::MEDIA_PLAYLIST, u"/tmp/live.m3u8", 6);
+    pl.setTargetDuration(4);
+    pl.setMediaSequence(12);
+    pl.setPartTargetDuration(500);
+
+    ts::hls::MediaSegment seg;
+    seg.uri = u"live-000012.ts";
+    seg.duration = 4004;
+    CPPUNIT_ASSERT(pl.addSegment(seg));
+    seg.uri = u"live-000013.ts";
+    seg.duration = 3960;
+    seg.bitrate = 2048000;
+    CPPUNIT_ASSERT(pl.addSegment(seg));
+
+    ts::hls::MediaSegment part;
+    part.uri = u"live-000014.ts";
+    part.duration = 520;
+    part.byteSize = 94000;
+    part.independent = true;
+    CPPUNIT_ASSERT(pl.addPart(part));
+    part.duration = 480;
+    part.byteOffset = 94000;
+    part.byteSize = 37600;
+    part.independent = false;
+    CPPUNIT_ASSERT(pl.addPart(part));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), pl.partCount());
+
+    const ts::UString text(pl.textContent());
+    utest::Out() << "HLSTest::testBuildMediaPlaylist: " << std::endl << text;
+
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(
+        u"#EXTM3U\n"
+        u"#EXT-X-VERSION:6\n"
+        u"#EXT-X-TARGETDURATION:4\n"
+        u"#EXT-X-MEDIA-SEQUENCE:12\n"
+        u"#EXT-X-SERVER-CONTROL:PART-HOLD-BACK=1.500\n"
+        u"#EXT-X-PART-INF:PART-TARGET=0.500\n"
+        u"#EXTINF:4.004,\n"
+        u"live-000012.ts\n"
+        u"#EXT-X-BITRATE:2000\n"
+        u"#EXTINF:3.960,\n"
+        u"live-000013.ts\n"
+        u"#EXT-X-PART:DURATION=0.520,URI=\"live-000014.ts\",BYTERANGE=\"94000@0\",INDEPENDENT=YES\n"
+        u"#EXT-X-PART:DURATION=0.480,URI=\"live-000014.ts\",BYTERANGE=\"37600@94000\"\n",
+        text);
+
+    // Sliding window: the media sequence follows the first segment.
+    CPPUNIT_ASSERT(pl.popFirstSegment(seg));
+    CPPUNIT_ASSERT_EQUAL(size_t(13), pl.mediaSequence());
+    seg.uri = u"live-000014.ts";
+    seg.duration = 4000;
+    seg.bitrate = 0;
+    CPPUNIT_ASSERT(pl.addSegment(seg));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), pl.partCount());
+    pl.setEndList(true);
+
+    // Read back the generated text.
+    ts::hls::PlayList pl2;
+    CPPUNIT_ASSERT(pl2.loadText(pl.textContent(), true));
+    CPPUNIT_ASSERT(pl2.isValid());
+    CPPUNIT_ASSERT_EQUAL(ts::hls::MEDIA_PLAYLIST, pl2.type());
+    CPPUNIT_ASSERT_EQUAL(6, pl2.version());
+    CPPUNIT_ASSERT_EQUAL(ts::Second(4), pl2.targetDuration());
+    CPPUNIT_ASSERT_EQUAL(size_t(13), pl2.mediaSequence());
+    CPPUNIT_ASSERT(pl2.endList());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), pl2.segmentCount());
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"live-000013.ts", pl2.segment(0).uri);
+    CPPUNIT_ASSERT_EQUAL(ts::MilliSecond(3960), pl2.segment(0).duration);
+    CPPUNIT_ASSERT_EQUAL(ts::BitRate(2048000), pl2.segment(0).bitrate);
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"live-000014.ts", pl2.segment(1).uri);
+    CPPUNIT_ASSERT_EQUAL(ts::MilliSecond(4000), pl2.segment(1).duration);
+
+    // Byte ranges are read back.
+    ts::hls::PlayList pl3;
+    CPPUNIT_ASSERT(pl3.loadText(u"#EXTM3U\n#EXT-X-TARGETDURATION:5\n"
+                                u"#EXTINF:5,\n#EXT-X-BYTERANGE:1000@200\nall.ts\n"
+                                u"#EXTINF:5,\n#EXT-X-BYTERANGE:3000\nall.ts\n", true));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), pl3.segmentCount());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(200), pl3.segment(0).byteOffset);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1000), pl3.segment(0).byteSize);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1200), pl3.segment(1).byteOffset);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3000), pl3.segment(1).byteSize);
+}
+
+void HLSTest::testPrefetchBuffer()
+{
+    typedef ts::hls::PrefetchBuffer PB;
+    PB buf(3);
+    bool end = true;
+
+    CPPUNIT_ASSERT_EQUAL(size_t(3), buf.capacity());
+    CPPUNIT_ASSERT_EQUAL(size_t(3), buf.waitRoom());
+    buf.push(u"a");
+    buf.push(u"b");
+    buf.push(u"c");
+    CPPUNIT_ASSERT_EQUAL(size_t(3), buf.size());
+    CPPUNIT_ASSERT(buf.pop(0, end).isNull());
+    CPPUNIT_ASSERT(!end);
+
+    // Pending segments are downloaded in playlist order.
+    PB::SegmentPtr pa(buf.nextPending());
+    PB::SegmentPtr pb(buf.nextPending());
+    PB::SegmentPtr pc(buf.nextPending());
+    CPPUNIT_ASSERT(!pa.isNull());
+    CPPUNIT_ASSERT(!pb.isNull());
+    CPPUNIT_ASSERT(!pc.isNull());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), pa->index);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), pb->index);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), pc->index);
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"b", pb->url);
+    CPPUNIT_ASSERT_EQUAL(PB::SEG_LOADING, pb->status);
+
+    // The segments are used in playlist order, whatever the download order.
+    buf.completed(pb, true);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), buf.loadedCount());
+    CPPUNIT_ASSERT(buf.pop(0, end).isNull());
+    CPPUNIT_ASSERT(!end);
+
+    buf.completed(pa, false);
+    PB::SegmentPtr seg(buf.pop(0, end));
+    CPPUNIT_ASSERT(seg == pa);
+    CPPUNIT_ASSERT_EQUAL(PB::SEG_FAILED, seg->status);
+    seg = buf.pop(0, end);
+    CPPUNIT_ASSERT(seg == pb);
+    CPPUNIT_ASSERT_EQUAL(PB::SEG_LOADED, seg->status);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), buf.loadedCount());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), buf.waitRoom());
+
+    // End of segments after the last one is used.
+    buf.setEnd();
+    CPPUNIT_ASSERT(buf.pop(10, end).isNull());
+    CPPUNIT_ASSERT(!end);
+    buf.completed(pc, true);
+    seg = buf.pop(0, end);
+    CPPUNIT_ASSERT(seg == pc);
+    CPPUNIT_ASSERT(!end);
+    CPPUNIT_ASSERT(buf.pop(0, end).isNull());
+    CPPUNIT_ASSERT(end);
+
+    // Termination releases all threads and interrupts the downloads through the abort interface.
+    const ts::AbortInterface& abort(buf);
+    CPPUNIT_ASSERT(!buf.terminated());
+    CPPUNIT_ASSERT(!abort.aborting());
+    buf.terminate();
+    CPPUNIT_ASSERT(buf.terminated());
+    CPPUNIT_ASSERT(abort.aborting());
+    CPPUNIT_ASSERT(buf.nextPending().isNull());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), buf.waitRoom());
+    CPPUNIT_ASSERT(buf.waitTerminate(ts::Infinite));
+
+    // New session.
+    buf.reset(2);
+    CPPUNIT_ASSERT(!buf.terminated());
+    CPPUNIT_ASSERT(!abort.aborting());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), buf.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), buf.waitRoom());
+    buf.push(u"d");
+    seg = buf.nextPending();
+    CPPUNIT_ASSERT(!seg.isNull());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), seg->index);
+    CPPUNIT_ASSERT(!buf.waitTerminate(10));
+}
+
+namespace {
+    // Number of segments in the multi-threaded test.
+    const size_t PREFETCH_SEGMENTS = 200;
+
+    // A thread which adds segments in a prefetch buffer, as the playlist thread.
+    class PrefetchProducer: public utest::CppUnitThread
+    {
+    public:
+        PrefetchProducer(ts::hls::PrefetchBuffer& buffer) :
+            utest::CppUnitThread(),
+            _buffer(buffer)
+        {
+        }
+
+        virtual void test() override
+        {
+            size_t count = 0;
+            while (count < PREFETCH_SEGMENTS) {
+                size_t room = _buffer.waitRoom();
+                CPPUNIT_ASSERT(room > 0);
+                for (; room > 0 && count < PREFETCH_SEGMENTS; --room) {
+                    _buffer.push(ts::UString::Decimal(count++));
+                    CPPUNIT_ASSERT(_buffer.size() <= _buffer.capacity());
+                }
+            }
+            _buffer.setEnd();
+        }
+
+    private:
+        ts::hls::PrefetchBuffer& _buffer;
+    };
+
+    // A thread which downloads segments from a prefetch buffer, with various durations.
+    // One segment out of 10 fails. The content of a segment is its index.
+    class PrefetchDownloader: public utest::CppUnitThread
+    {
+    public:
+        PrefetchDownloader(ts::hls::PrefetchBuffer& buffer) :
+            utest::CppUnitThread(),
+            _buffer(buffer)
+        {
+        }
+
+        virtual void test() override
+        {
+            ts::hls::PrefetchBuffer::SegmentPtr seg;
+            while (!(seg = _buffer.nextPending()).isNull()) {
+                CPPUNIT_ASSERT_EQUAL(ts::hls::PrefetchBuffer::SEG_LOADING, seg->status);
+                CPPUNIT_ASSERT_USTRINGS_EQUAL(ts::UString::Decimal(seg->index), seg->url);
+                ts::SleepThread((seg->index * 7) % 5);
+                seg->data.appendUInt32(uint32_t(seg->index));
+                _buffer.completed(seg, seg->index % 10 != 3);
+            }
+        }
+
+    private:
+        ts::hls::PrefetchBuffer& _buffer;
+    };
+}
+
+void HLSTest::testPrefetchThreads()
+{
+    ts::hls::PrefetchBuffer buf(4);
+    PrefetchProducer producer(buf);
+    PrefetchDownloader downloader1(buf);
+    PrefetchDownloader downloader2(buf);
+    PrefetchDownloader downloader3(buf);
+
+    CPPUNIT_ASSERT(producer.start());
+    CPPUNIT_ASSERT(downloader1.start());
+    CPPUNIT_ASSERT(downloader2.start());
+    CPPUNIT_ASSERT(downloader3.start());
+
+    // The segments are used in playlist order.
+    size_t count = 0;
+    bool end = false;
+    while (!end) {
+        const ts::hls::PrefetchBuffer::SegmentPtr seg(buf.pop(1000, end));
+        if (!seg.isNull()) {
+            CPPUNIT_ASSERT_EQUAL(count, seg->index);
+            if (count % 10 == 3) {
+                CPPUNIT_ASSERT_EQUAL(ts::hls::PrefetchBuffer::SEG_FAILED, seg->status);
+            }
+            else {
+                CPPUNIT_ASSERT_EQUAL(ts::hls::PrefetchBuffer::SEG_LOADED, seg->status);
+                CPPUNIT_ASSERT_EQUAL(size_t(4), seg->data.size());
+                CPPUNIT_ASSERT_EQUAL(uint32_t(count), ts::GetUInt32(seg->data.data()));
+            }
+            count++;
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(PREFETCH_SEGMENTS, count);
+
+    // The download threads wait for more segments until termination.
+    buf.terminate();
+    producer.waitForTermination();
+    downloader1.waitForTermination();
+    downloader2.waitForTermination();
+    downloader3.waitForTermination();
+}
@@ -42,7 +42,9 @@
 #include "tsThread.h"
 #include "tsSysUtils.h"
 #include "tsIPUtils.h"
+#include "tsByteBlock.h"
 #include "tsCerrReport.h"
+#include "tsNullReport.h"
 #include "utestCppUnitThread.h"
 TSDUCK_SOURCE;
 
@@ -68,6 +70,8 @@ public:
     void testSocketAddress();
     void testTCPSocket();
     void testUDPSocket();
+    void testUDPReceiveBatch();
+    void testUDPSendBatch();
     void testIPHeader();
 
     CPPUNIT_TEST_SUITE(NetworkingTest);
@@ -80,6 +84,8 @@ public:
     CPPUNIT_TEST(testSocketAddress);
     CPPUNIT_TEST(testTCPSocket);
     CPPUNIT_TEST(testUDPSocket);
+    CPPUNIT_TEST(testUDPReceiveBatch);
+    CPPUNIT_TEST(testUDPSendBatch);
     CPPUNIT_TEST(testIPHeader);
     CPPUNIT_TEST_SUITE_END();
 
@@ -677,6 +683,204 @@ void NetworkingTest::testUDPSocket()
     CERR.debug(u"UDPSocketTest: main thread: reply sent");
 }
 
+// Content of test UDP messages: message index, then byte pattern.
+namespace {
+    ts::ByteBlock UDPMessage(size_t index, size_t size)
+    {
+        ts::ByteBlock msg(size);
+        for (size_t i = 0; i < size; ++i) {
+            msg[i] = uint8_t(index * 13 + i);
+        }
+        return msg;
+    }
+
+    // Compare address and port.
+    bool SameSocketAddress(const ts::SocketAddress& a1, const ts::SocketAddress& a2)
+    {
+        return ts::IPAddress(a1) == ts::IPAddress(a2) && a1.port() == a2.port();
+    }
+
+    // Receive the messages of a batch and check them against the sent data.
+    void ReceiveUDPBatch(ts::UDPSocket& sock, const ts::ByteBlock& data, size_t msg_size, const ts::SocketAddress& sender)
+    {
+        std::vector<ts::ByteBlock> buffers(32, ts::ByteBlock(msg_size + 100));
+        std::vector<ts::UDPSocket::ReceivedMessage> msgs(buffers.size());
+        size_t offset = 0;
+        while (offset < data.size()) {
+            for (size_t i = 0; i < msgs.size(); ++i) {
+                msgs[i] = ts::UDPSocket::ReceivedMessage(buffers[i].data(), buffers[i].size());
+            }
+            size_t ret_count = 0;
+            CPPUNIT_ASSERT(sock.receiveBatch(msgs.data(), msgs.size(), ret_count, nullptr, CERR));
+            for (size_t i = 0; i < ret_count; ++i) {
+                const size_t size = std::min(msg_size, data.size() - offset);
+                CPPUNIT_ASSERT_EQUAL(size, msgs[i].size);
+                CPPUNIT_ASSERT(::memcmp(data.data() + offset, msgs[i].data, size) == 0);
+                CPPUNIT_ASSERT(SameSocketAddress(msgs[i].sender, sender));
+                offset += size;
+            }
+        }
+        CPPUNIT_ASSERT_EQUAL(data.size(), offset);
+    }
+}
+
+// Test batch reception on the local loopback.
+void NetworkingTest::testUDPReceiveBatch()
+{
+    CPPUNIT_ASSERT(ts::IPInitialize());
+
+    const uint16_t portNumber = 12346;
+    const ts::SocketAddress address(ts::IPAddress::LocalHost, portNumber);
+
+    ts::UDPSocket sock(true);
+    CPPUNIT_ASSERT(sock.isOpen());
+    CPPUNIT_ASSERT(sock.reusePort(true, CERR));
+    CPPUNIT_ASSERT(sock.bind(address, CERR));
+
+    // Two senders, the messages are interleaved. Message i has 20 + 7 * i bytes.
+    ts::UDPSocket sender1(true);
+    ts::UDPSocket sender2(true);
+    ts::SocketAddress address1;
+    ts::SocketAddress address2;
+    CPPUNIT_ASSERT(sender1.bind(ts::SocketAddress(ts::IPAddress::LocalHost, ts::SocketAddress::AnyPort), CERR));
+    CPPUNIT_ASSERT(sender2.bind(ts::SocketAddress(ts::IPAddress::LocalHost, ts::SocketAddress::AnyPort), CERR));
+    CPPUNIT_ASSERT(sender1.getLocalAddress(address1, CERR));
+    CPPUNIT_ASSERT(sender2.getLocalAddress(address2, CERR));
+    CPPUNIT_ASSERT(address1.port() != address2.port());
+
+    static const size_t count = 9;
+    for (size_t i = 0; i < count; ++i) {
+        const ts::ByteBlock msg(UDPMessage(i, 20 + 7 * i));
+        CPPUNIT_ASSERT((i % 3 == 2 ? sender2 : sender1).send(msg.data(), msg.size(), address, CERR));
+    }
+    // The last message is larger than the reception buffer.
+    const ts::ByteBlock large(UDPMessage(count, 500));
+    CPPUNIT_ASSERT(sender1.send(large.data(), large.size(), address, CERR));
+
+    // Leave time to the loopback interface to deliver all messages.
+    ts::SleepThread(100);
+
+    std::vector<ts::ByteBlock> buffers(16, ts::ByteBlock(200));
+    std::vector<ts::UDPSocket::ReceivedMessage> msgs(buffers.size());
+    size_t received = 0;
+    while (received <= count) {
+        // The first batch is limited by the number of buffers, the next ones by the available messages.
+        for (size_t i = 0; i < msgs.size(); ++i) {
+            msgs[i] = ts::UDPSocket::ReceivedMessage(buffers[i].data(), buffers[i].size());
+        }
+        const size_t max_count = received == 0 ? 4 : msgs.size();
+        size_t ret_count = 0;
+        CPPUNIT_ASSERT(sock.receiveBatch(msgs.data(), max_count, ret_count, nullptr, CERR));
+        CERR.debug(u"UDPSocketTest: received batch of %d messages, max: %d", {ret_count, max_count});
+        CPPUNIT_ASSERT(ret_count >= 1);
+        CPPUNIT_ASSERT(ret_count <= max_count);
+        CPPUNIT_ASSERT(received + ret_count <= count + 1);
+#if defined(TS_LINUX)
+        CPPUNIT_ASSERT_EQUAL(std::min(max_count, count + 1 - received), ret_count);
+#endif
+        for (size_t i = 0; i < ret_count; ++i, ++received) {
+            const ts::UDPSocket::ReceivedMessage& m(msgs[i]);
+            CPPUNIT_ASSERT(SameSocketAddress(m.sender, received % 3 == 2 ? address2 : address1));
+            CPPUNIT_ASSERT(SameSocketAddress(m.destination, address));
+            if (received < count) {
+                const ts::ByteBlock ref(UDPMessage(received, 20 + 7 * received));
+                CPPUNIT_ASSERT_EQUAL(ref.size(), m.size);
+                CPPUNIT_ASSERT(::memcmp(ref.data(), m.data, m.size) == 0);
+            }
+            else {
+                // Truncated message.
+                CPPUNIT_ASSERT_EQUAL(m.max_size, m.size);
+                CPPUNIT_ASSERT(::memcmp(large.data(), m.data, m.size) == 0);
+            }
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(count + 1, received);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(count + 1), sock.receivedMessageCount());
+#if defined(TS_LINUX)
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), sock.receiveCallCount());
+#endif
+}
+
+// Test batch transmission on the local loopback.
+void NetworkingTest::testUDPSendBatch()
+{
+    CPPUNIT_ASSERT(ts::IPInitialize());
+
+    const uint16_t portNumber = 12347;
+    const ts::SocketAddress address(ts::IPAddress::LocalHost, portNumber);
+
+    ts::UDPSocket sock(true);
+    CPPUNIT_ASSERT(sock.isOpen());
+    CPPUNIT_ASSERT(sock.reusePort(true, CERR));
+    CPPUNIT_ASSERT(sock.bind(address, CERR));
+
+    ts::UDPSocket sender(true);
+    ts::SocketAddress sender_address;
+    CPPUNIT_ASSERT(sender.bind(ts::SocketAddress(ts::IPAddress::LocalHost, ts::SocketAddress::AnyPort), CERR));
+    CPPUNIT_ASSERT(sender.getLocalAddress(sender_address, CERR));
+    CPPUNIT_ASSERT(sender.setDefaultDestination(address, CERR));
+
+    // 100 messages of 188 bytes and a shorter last one.
+    const size_t msg_size = 188;
+    ts::ByteBlock data(100 * msg_size + 50);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = uint8_t(i + i / msg_size);
+    }
+
+    // Same messages with and without GSO.
+    for (int gso = 1; gso >= 0; --gso) {
+        const uint64_t calls = sender.sendCallCount();
+        const uint64_t messages = sender.sentMessageCount();
+        sender.setGSO(gso != 0);
+        CPPUNIT_ASSERT(sender.sendBatch(data.data(), data.size(), msg_size, CERR));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(101), sender.sentMessageCount() - messages);
+#if defined(TS_LINUX)
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), sender.sendCallCount() - calls);
+#else
+        CPPUNIT_ASSERT_EQUAL(uint64_t(101), sender.sendCallCount() - calls);
+#endif
+        ReceiveUDPBatch(sock, data, msg_size, sender_address);
+    }
+
+    // One single message, shorter than the message size.
+    CPPUNIT_ASSERT(sender.sendBatch(data.data(), 100, msg_size, CERR));
+    ReceiveUDPBatch(sock, ts::ByteBlock(data.data(), 100), msg_size, sender_address);
+    CPPUNIT_ASSERT(!sender.sendBatch(data.data(), 100, 0, NULLREP));
+
+#if defined(TS_LINUX) && defined(SO_NO_CHECK)
+    // The kernel rejects GSO on sockets without UDP checksum: the messages are sent again without GSO.
+    {
+        ts::UDPSocket sender2(true);
+        ts::SocketAddress sender2_address;
+        CPPUNIT_ASSERT(sender2.bind(ts::SocketAddress(ts::IPAddress::LocalHost, ts::SocketAddress::AnyPort), CERR));
+        CPPUNIT_ASSERT(sender2.getLocalAddress(sender2_address, CERR));
+        int on = 1;
+        CPPUNIT_ASSERT(::setsockopt(sender2.getSocket(), SOL_SOCKET, SO_NO_CHECK, &on, sizeof(on)) == 0);
+        sender2.setGSO(true);
+        for (int i = 0; i < 2; ++i) {
+            CPPUNIT_ASSERT(sender2.sendBatch(data.data(), data.size(), msg_size, address, CERR));
+            ReceiveUDPBatch(sock, data, msg_size, sender2_address);
+        }
+        CPPUNIT_ASSERT_EQUAL(uint64_t(202), sender2.sentMessageCount());
+    }
+#endif
+
+#if defined(TS_LINUX)
+    // More messages than one sendmmsg() call can send, the rest is sent in a second call.
+    // Only the counters are checked, the receiver may drop messages when its buffer is full.
+    // Keep this test last, the received messages are not read.
+    {
+        sender.setGSO(false);
+        const uint64_t calls = sender.sendCallCount();
+        const uint64_t messages = sender.sentMessageCount();
+        const ts::ByteBlock small(1100 * 16);
+        CPPUNIT_ASSERT(sender.sendBatch(small.data(), small.size(), 16, CERR));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1100), sender.sentMessageCount() - messages);
+        CPPUNIT_ASSERT_EQUAL(uint64_t(2), sender.sendCallCount() - calls);
+    }
+#endif
+}
+
 // Test IP header
 void NetworkingTest::testIPHeader()
 {
@@ -0,0 +1,239 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for PIDMap class.
+//
+//----------------------------------------------------------------------------
+
+#include "tsPIDMap.h"
+#include "tsMonotonic.h"
+#include "tsUString.h"
+#include "utestCppUnitTest.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class PIDMapTest: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testBasic();
+    void testIterators();
+    void testCompareMap();
+    void testThroughput();
+
+    CPPUNIT_TEST_SUITE(PIDMapTest);
+    CPPUNIT_TEST(testBasic);
+    CPPUNIT_TEST(testIterators);
+    CPPUNIT_TEST(testCompareMap);
+    CPPUNIT_TEST(testThroughput);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PIDMapTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void PIDMapTest::setUp()
+{
+}
+
+// Test suite cleanup method.
+void PIDMapTest::tearDown()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Test cases
+//----------------------------------------------------------------------------
+
+void PIDMapTest::testBasic()
+{
+    ts::PIDMap<int> map;
+    CPPUNIT_ASSERT(map.empty());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), map.size());
+    CPPUNIT_ASSERT(map.begin() == map.end());
+    CPPUNIT_ASSERT(map.find(100) == map.end());
+
+    map[100] = 1;
+    map[0] = 2;
+    map[ts::PID_NULL] = 3;
+    CPPUNIT_ASSERT(!map.empty());
+    CPPUNIT_ASSERT_EQUAL(size_t(3), map.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), map.count(100));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), map.count(101));
+    CPPUNIT_ASSERT_EQUAL(1, map[100]);
+    CPPUNIT_ASSERT(map.find(ts::PID_NULL) != map.end());
+    CPPUNIT_ASSERT_EQUAL(ts::PID_NULL, map.find(ts::PID_NULL)->first);
+    CPPUNIT_ASSERT_EQUAL(3, map.find(ts::PID_NULL)->second);
+
+    // Default-constructed element.
+    CPPUNIT_ASSERT_EQUAL(0, map[200]);
+    CPPUNIT_ASSERT_EQUAL(size_t(4), map.size());
+
+    CPPUNIT_ASSERT_EQUAL(size_t(1), map.erase(100));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), map.erase(100));
+    CPPUNIT_ASSERT_EQUAL(size_t(3), map.size());
+    CPPUNIT_ASSERT(map.find(100) == map.end());
+
+    // Copy is a deep copy.
+    ts::PIDMap<int> copy(map);
+    copy[0] = 10;
+    CPPUNIT_ASSERT_EQUAL(2, map[0]);
+    CPPUNIT_ASSERT_EQUAL(10, copy[0]);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), copy.size());
+
+    map.clear();
+    CPPUNIT_ASSERT(map.empty());
+    CPPUNIT_ASSERT(map.begin() == map.end());
+    CPPUNIT_ASSERT_EQUAL(size_t(3), copy.size());
+}
+
+void PIDMapTest::testIterators()
+{
+    ts::PIDMap<ts::PID> map;
+    static const ts::PID pids[] = {8000, 3, 500, 17, 0, 8191, 256};
+    for (size_t i = 0; i < sizeof(pids) / sizeof(pids[0]); ++i) {
+        map[pids[i]] = pids[i];
+    }
+
+    // Iteration in increasing order of PID.
+    const ts::PIDMap<ts::PID>& cmap(map);
+    ts::PID previous = 0;
+    size_t count = 0;
+    for (ts::PIDMap<ts::PID>::const_iterator it = cmap.begin(); it != cmap.end(); ++it) {
+        CPPUNIT_ASSERT(count == 0 || it->first > previous);
+        CPPUNIT_ASSERT_EQUAL(it->first, it->second);
+        previous = it->first;
+        count++;
+    }
+    CPPUNIT_ASSERT_EQUAL(map.size(), count);
+
+    // Inserting or erasing other elements does not invalidate iterators.
+    count = 0;
+    for (ts::PIDMap<ts::PID>::iterator it = map.begin(); it != map.end(); ++it) {
+        if (it->first == 17) {
+            map.erase(3);
+            map.erase(500);
+            map[1000] = 1000;
+        }
+        count++;
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(7), count);  // 0, 3, 17, 256, 1000, 8000, 8191
+    CPPUNIT_ASSERT_EQUAL(size_t(6), map.size());
+}
+
+void PIDMapTest::testCompareMap()
+{
+    // Random operations on a PIDMap and a std::map must give the same result.
+    ts::PIDMap<uint32_t> map;
+    std::map<ts::PID, uint32_t> ref;
+    uint32_t x = 0x12345678;
+
+    for (size_t i = 0; i < 100000; ++i) {
+        x = x * 1103515245 + 12345;
+        const ts::PID pid = ts::PID(x >> 8) % 300;
+        switch ((x >> 4) & 0x03) {
+            case 0:
+                CPPUNIT_ASSERT_EQUAL(ref.erase(pid), map.erase(pid));
+                break;
+            case 1:
+                CPPUNIT_ASSERT_EQUAL(ref.count(pid), map.count(pid));
+                break;
+            default:
+                map[pid] += x;
+                ref[pid] += x;
+                break;
+        }
+    }
+
+    CPPUNIT_ASSERT_EQUAL(ref.size(), map.size());
+    std::map<ts::PID, uint32_t>::const_iterator it1 = ref.begin();
+    ts::PIDMap<uint32_t>::const_iterator it2 = map.begin();
+    while (it1 != ref.end() && it2 != map.end()) {
+        CPPUNIT_ASSERT_EQUAL(it1->first, it2->first);
+        CPPUNIT_ASSERT_EQUAL(it1->second, it2->second);
+        ++it1;
+        ++it2;
+    }
+    CPPUNIT_ASSERT(it1 == ref.end());
+    CPPUNIT_ASSERT(it2 == map.end());
+}
+
+void PIDMapTest::testThroughput()
+{
+    // Micro-benchmark, one lookup per packet on a typical set of PID's.
+    static const size_t pid_count = 40;
+    static const size_t lookups = 16 * 1024 * 1024;
+
+    ts::PIDMap<uint32_t> map;
+    std::map<ts::PID, uint32_t> ref;
+    std::vector<ts::PID> pids;
+    for (size_t i = 0; i < pid_count; ++i) {
+        pids.push_back(ts::PID((i * 211) % ts::PID_MAX));
+        map[pids.back()] = 0;
+        ref[pids.back()] = 0;
+    }
+
+    for (int pass = 0; pass < 2; ++pass) {
+        uint32_t x = 0;
+        ts::Monotonic start;
+        start.getSystemTime();
+        for (size_t i = 0; i < lookups; ++i) {
+            x = x * 1103515245 + 12345;
+            const ts::PID pid = pids[(x >> 16) % pid_count];
+            if (pass == 0) {
+                ref[pid]++;
+            }
+            else {
+                map[pid]++;
+            }
+        }
+        ts::Monotonic end;
+        end.getSystemTime();
+        const ts::NanoSecond duration = std::max<ts::NanoSecond>(1, end - start);
+        utest::Out() << "PIDMapTest: " << (pass == 0 ? "std::map" : "PIDMap  ")
+                     << " lookups: " << ts::UString::Decimal((ts::NanoSecond(lookups) * 1000) / duration, 6)
+                     << " per microsecond" << std::endl;
+    }
+
+    for (size_t i = 0; i < pid_count; ++i) {
+        CPPUNIT_ASSERT_EQUAL(ref[pids[i]], map[pids[i]]);
+    }
+}
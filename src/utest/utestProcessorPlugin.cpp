@@ -0,0 +1,261 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for the packet batch processing of ts::ProcessorPlugin
+//
+//----------------------------------------------------------------------------
+
+#include "tsPlugin.h"
+#include "tsMonotonic.h"
+#include "tsCerrReport.h"
+#include "utestCppUnitTest.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class ProcessorPluginTest: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testDefaultBatch();
+    void testDirectBatch();
+    void testThroughput();
+
+    CPPUNIT_TEST_SUITE(ProcessorPluginTest);
+    CPPUNIT_TEST(testDefaultBatch);
+    CPPUNIT_TEST(testDirectBatch);
+    CPPUNIT_TEST(testThroughput);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ProcessorPluginTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void ProcessorPluginTest::setUp()
+{
+}
+
+// Test suite cleanup method.
+void ProcessorPluginTest::tearDown()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// A minimal tsp environment and test plugins.
+//----------------------------------------------------------------------------
+
+namespace {
+    class TestTSP: public ts::TSP
+    {
+    public:
+        TestTSP() : ts::TSP(ts::Severity::Info) {}
+        virtual void useJointTermination(bool) override {}
+        virtual void jointTerminate() override {}
+        virtual bool useJointTermination() const override { return false; }
+        virtual bool thisJointTerminated() const override { return false; }
+    protected:
+        virtual void writeLog(int severity, const ts::UString& msg) override
+        {
+            if (utest::DebugMode()) {
+                CERR.log(severity, msg);
+            }
+        }
+    };
+
+    // Byte 4 of each packet is the action to perform.
+    enum : uint8_t {ACT_OK, ACT_NULL, ACT_DROP, ACT_END, ACT_FLUSH, ACT_BITRATE};
+
+    // Uses the default packet batch processing.
+    class TestPlugin: public ts::ProcessorPlugin
+    {
+    public:
+        size_t calls;  // Number of processed packets.
+
+        TestPlugin(ts::TSP* tsp_) : ts::ProcessorPlugin(tsp_), calls(0) {}
+
+        virtual Status processPacket(ts::TSPacket& pkt, bool& flush, bool& bitrate_changed) override
+        {
+            calls++;
+            switch (pkt.b[4]) {
+                case ACT_NULL: return TSP_NULL;
+                case ACT_DROP: return TSP_DROP;
+                case ACT_END: return TSP_END;
+                case ACT_FLUSH: flush = true; return TSP_OK;
+                case ACT_BITRATE: bitrate_changed = true; return TSP_OK;
+                default: return TSP_OK;
+            }
+        }
+    };
+
+    // Uses the direct packet batch processing.
+    class DirectTestPlugin: public TestPlugin
+    {
+    public:
+        DirectTestPlugin(ts::TSP* tsp_) : TestPlugin(tsp_) {}
+
+        virtual size_t processPacketBatch(ts::TSPacket* pkt, size_t count, Status* status, bool& flush, bool& bitrate_changed) override
+        {
+            return processPacketBatchDirect<DirectTestPlugin>(pkt, count, status, flush, bitrate_changed);
+        }
+    };
+
+    // Packets with the actions: OK, (dropped), NULL, FLUSH, DROP, BITRATE, OK, END, OK.
+    ts::TSPacketVector TestPackets()
+    {
+        static const uint8_t actions[] = {ACT_OK, ACT_OK, ACT_NULL, ACT_FLUSH, ACT_DROP, ACT_BITRATE, ACT_OK, ACT_END, ACT_OK};
+        ts::TSPacketVector pkts(sizeof(actions));
+        for (size_t i = 0; i < pkts.size(); ++i) {
+            pkts[i] = ts::NullPacket;
+            pkts[i].b[4] = actions[i];
+        }
+        // Packet already dropped by a previous plugin.
+        pkts[1].b[0] = 0;
+        return pkts;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test cases
+//----------------------------------------------------------------------------
+
+void ProcessorPluginTest::testDefaultBatch()
+{
+    TestTSP tsp;
+    TestPlugin plugin(&tsp);
+    ts::TSPacketVector pkts(TestPackets());
+    ts::ProcessorPlugin::Status status[9];
+    bool flush = false;
+    bool bitrate_changed = false;
+
+    // Stop after a flush request.
+    CPPUNIT_ASSERT_EQUAL(size_t(4), plugin.processPacketBatch(pkts.data(), pkts.size(), status, flush, bitrate_changed));
+    CPPUNIT_ASSERT(flush);
+    CPPUNIT_ASSERT(!bitrate_changed);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), plugin.calls);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_OK, status[0]);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_DROP, status[1]);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_NULL, status[2]);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_OK, status[3]);
+
+    // Stop after a bitrate change.
+    flush = false;
+    CPPUNIT_ASSERT_EQUAL(size_t(2), plugin.processPacketBatch(pkts.data() + 4, pkts.size() - 4, status, flush, bitrate_changed));
+    CPPUNIT_ASSERT(!flush);
+    CPPUNIT_ASSERT(bitrate_changed);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_DROP, status[0]);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_OK, status[1]);
+
+    // Stop at the end, inside the batch.
+    bitrate_changed = false;
+    CPPUNIT_ASSERT_EQUAL(size_t(2), plugin.processPacketBatch(pkts.data() + 6, pkts.size() - 6, status, flush, bitrate_changed));
+    CPPUNIT_ASSERT(!flush);
+    CPPUNIT_ASSERT(!bitrate_changed);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_OK, status[0]);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_END, status[1]);
+    CPPUNIT_ASSERT_EQUAL(size_t(7), plugin.calls);
+
+    // One packet at a time.
+    CPPUNIT_ASSERT_EQUAL(size_t(1), plugin.processPacketBatch(pkts.data() + 8, 1, status, flush, bitrate_changed));
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_OK, status[0]);
+    CPPUNIT_ASSERT_EQUAL(size_t(8), plugin.calls);
+}
+
+void ProcessorPluginTest::testDirectBatch()
+{
+    TestTSP tsp;
+    DirectTestPlugin plugin(&tsp);
+    ts::TSPacketVector pkts(TestPackets());
+    ts::ProcessorPlugin::Status status[9];
+    bool flush = false;
+    bool bitrate_changed = false;
+
+    // Flush and bitrate change are not notified immediately, stop at the end only.
+    CPPUNIT_ASSERT_EQUAL(size_t(8), plugin.processPacketBatch(pkts.data(), pkts.size(), status, flush, bitrate_changed));
+    CPPUNIT_ASSERT(flush);
+    CPPUNIT_ASSERT(bitrate_changed);
+    CPPUNIT_ASSERT_EQUAL(size_t(7), plugin.calls);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_OK, status[0]);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_DROP, status[1]);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_NULL, status[2]);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_OK, status[3]);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_DROP, status[4]);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_OK, status[5]);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_OK, status[6]);
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_END, status[7]);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(1), plugin.processPacketBatch(pkts.data() + 8, 1, status, flush, bitrate_changed));
+    CPPUNIT_ASSERT_EQUAL(ts::ProcessorPlugin::TSP_OK, status[0]);
+    CPPUNIT_ASSERT_EQUAL(size_t(8), plugin.calls);
+}
+
+void ProcessorPluginTest::testThroughput()
+{
+    // Micro-benchmark, per-packet overhead of the batch processing.
+    static const size_t count = 1000;   // packets per batch
+    static const size_t rounds = 2000;  // batches per measurement
+
+    TestTSP tsp;
+    TestPlugin plugin1(&tsp);
+    DirectTestPlugin plugin2(&tsp);
+    ts::ProcessorPlugin* const plugins[] = {&plugin1, &plugin2};
+    static const char* const names[] = {"default", "direct"};
+
+    ts::TSPacketVector pkts(count, ts::NullPacket);
+    std::vector<ts::ProcessorPlugin::Status> status(count);
+
+    for (size_t ip = 0; ip < 2; ++ip) {
+        bool flush = false;
+        bool bitrate_changed = false;
+        ts::Monotonic start;
+        start.getSystemTime();
+        for (size_t r = 0; r < rounds; ++r) {
+            CPPUNIT_ASSERT_EQUAL(count, plugins[ip]->processPacketBatch(pkts.data(), count, status.data(), flush, bitrate_changed));
+        }
+        ts::Monotonic end;
+        end.getSystemTime();
+        const ts::NanoSecond duration = std::max<ts::NanoSecond>(1, end - start);
+        utest::Out() << "ProcessorPluginTest: " << names[ip] << " batch: "
+                     << ts::UString::Decimal((duration * 100) / ts::NanoSecond(count * rounds)).toJustifiedRight(5)
+                     << " ns/100 packets" << std::endl;
+    }
+    CPPUNIT_ASSERT_EQUAL(count * rounds, plugin1.calls);
+    CPPUNIT_ASSERT_EQUAL(count * rounds, plugin2.calls);
+}
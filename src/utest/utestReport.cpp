@@ -33,8 +33,9 @@
 
 #include "tsReportBuffer.h"
 #include "tsReportFile.h"
+#include "tsAsyncReport.h"
 #include "tsSysUtils.h"
-#include "utestCppUnitTest.h"
+#include "utestCppUnitThread.h"
 TSDUCK_SOURCE;
 
 
@@ -55,6 +56,10 @@ public:
     void testPrintf();
     void testByName();
     void testByStream();
+    void testAsync();
+    void testAsyncOverflow();
+    void testAsyncSynchronous();
+    void testAsyncTerminate();
 
     CPPUNIT_TEST_SUITE(ReportTest);
     CPPUNIT_TEST(testSeverity);
@@ -62,6 +67,10 @@ public:
     CPPUNIT_TEST(testPrintf);
     CPPUNIT_TEST(testByName);
     CPPUNIT_TEST(testByStream);
+    CPPUNIT_TEST(testAsync);
+    CPPUNIT_TEST(testAsyncOverflow);
+    CPPUNIT_TEST(testAsyncSynchronous);
+    CPPUNIT_TEST(testAsyncTerminate);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -325,3 +334,175 @@ void ReportTest::testByStream()
     ts::UString::Load(value, _fileName);
     CPPUNIT_ASSERT(value == ref);
 }
+
+// Report handler for asynchronous reports.
+namespace {
+    class AsyncHandler : public ts::ReportHandler
+    {
+    public:
+        ts::UStringVector  messages;
+        std::atomic<bool>  blocked;
+
+        AsyncHandler() : messages(), blocked(false) {}
+
+        virtual void handleMessage(int severity, const ts::UString& msg) override
+        {
+            messages.push_back(ts::Severity::Header(severity) + msg);
+            while (blocked) {
+                ts::SleepThread(1);
+            }
+        }
+    };
+}
+
+// Test case: asynchronous report, messages formatted in the logging thread.
+void ReportTest::testAsync()
+{
+    AsyncHandler handler;
+    ts::AsyncReport log(ts::Severity::Info, false, 4, true);
+    log.setMessageHandler(&handler);
+
+    const ts::UString ustr(u"def");
+    const std::string str("ghi");
+    const ts::UString large(300, u'x');
+
+    ts::UStringVector ref;
+    log.info(u"i8=%d, u16=0x%X, i64=%'d, b=%s", {int8_t(-3), uint16_t(0x12), int64_t(-1234567), true});
+    ref.push_back(ts::UString::Format(u"i8=%d, u16=0x%X, i64=%'d, b=%s", {int8_t(-3), uint16_t(0x12), int64_t(-1234567), true}));
+    log.error(u"strings: %s, %s, %s, %s", {u"abc", ustr, str, "jkl"});
+    ref.push_back(u"Error: strings: abc, def, ghi, jkl");
+    log.verbose(u"not logged %d", {1});
+    log.warning(u"large: %s", {large});
+    ref.push_back(u"Warning: large: " + large);
+    log.info(u"many: %d %d %d %d %d %d %d %d %d %d", {1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+    ref.push_back(u"many: 1 2 3 4 5 6 7 8 9 10");
+    log.logWithPrefix(ts::Severity::Info, u"foo: ", u"value %d", {12});
+    ref.push_back(u"foo: value 12");
+    log.info(u"preformatted");
+    ref.push_back(u"preformatted");
+    for (int i = 0; i < 20; ++i) {
+        log.info(u"message %d", {i});
+        ref.push_back(ts::UString::Format(u"message %d", {i}));
+    }
+
+    log.terminate();
+    CPPUNIT_ASSERT_EQUAL(size_t(0), log.droppedMessages());
+    CPPUNIT_ASSERT_EQUAL(ref.size(), handler.messages.size());
+    for (size_t i = 0; i < ref.size(); ++i) {
+        CPPUNIT_ASSERT_USTRINGS_EQUAL(ref[i], handler.messages[i]);
+    }
+}
+
+// Test case: asynchronous report, dropped messages on overflow.
+void ReportTest::testAsyncOverflow()
+{
+    AsyncHandler handler;
+    handler.blocked = true;
+    ts::AsyncReport log(ts::Severity::Info, false, 4, false);
+    log.setMessageHandler(&handler);
+
+    // The logging thread is blocked after the first message, most messages are dropped.
+    const size_t count = 100;
+    for (size_t i = 0; i < count; ++i) {
+        log.info(u"message %d", {i});
+    }
+    handler.blocked = false;
+    log.terminate();
+
+    const size_t dropped = log.droppedMessages();
+    utest::Out() << "ReportTest::testAsyncOverflow: " << dropped << " dropped messages" << std::endl;
+    CPPUNIT_ASSERT(dropped > 0);
+    CPPUNIT_ASSERT_EQUAL(count - dropped + 1, handler.messages.size());
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(ts::UString::Format(u"Warning: %'d log messages dropped", {dropped}), handler.messages.back());
+}
+
+namespace {
+    // A thread which logs messages.
+    class AsyncProducer: public utest::CppUnitThread
+    {
+    public:
+        AsyncProducer(ts::Report& report, size_t count) :
+            utest::CppUnitThread(),
+            _report(report),
+            _count(count)
+        {
+        }
+
+        virtual void test() override
+        {
+            for (size_t i = 0; i < _count; ++i) {
+                _report.info(u"message %d", {i});
+            }
+        }
+
+    private:
+        ts::Report& _report;
+        size_t      _count;
+    };
+
+    // A thread which unblocks a handler after some time.
+    class AsyncUnblocker: public utest::CppUnitThread
+    {
+    public:
+        AsyncUnblocker(AsyncHandler& handler) :
+            utest::CppUnitThread(),
+            _handler(handler)
+        {
+        }
+
+        virtual void test() override
+        {
+            ts::SleepThread(100);
+            _handler.blocked = false;
+        }
+
+    private:
+        AsyncHandler& _handler;
+    };
+}
+
+// Test case: synchronous report, several application threads wait for free slots.
+void ReportTest::testAsyncSynchronous()
+{
+    AsyncHandler handler;
+    ts::AsyncReport log(ts::Severity::Info, false, 4, true);
+    log.setMessageHandler(&handler);
+
+    const size_t count = 500;
+    AsyncProducer p1(log, count);
+    AsyncProducer p2(log, count);
+    AsyncProducer p3(log, count);
+    CPPUNIT_ASSERT(p1.start());
+    CPPUNIT_ASSERT(p2.start());
+    CPPUNIT_ASSERT(p3.start());
+    p1.waitForTermination();
+    p2.waitForTermination();
+    p3.waitForTermination();
+    log.terminate();
+
+    CPPUNIT_ASSERT_EQUAL(size_t(0), log.droppedMessages());
+    CPPUNIT_ASSERT_EQUAL(3 * count, handler.messages.size());
+}
+
+// Test case: synchronous report, an application thread waits for a free slot during termination.
+void ReportTest::testAsyncTerminate()
+{
+    AsyncHandler handler;
+    handler.blocked = true;
+    ts::AsyncReport log(ts::Severity::Info, false, 4, true);
+    log.setMessageHandler(&handler);
+
+    // The producer is blocked on a full queue while the report is terminated.
+    const size_t count = 1000;
+    AsyncProducer producer(log, count);
+    AsyncUnblocker unblocker(handler);
+    CPPUNIT_ASSERT(producer.start());
+    ts::SleepThread(50);
+    CPPUNIT_ASSERT(unblocker.start());
+    log.terminate();
+
+    // The producer must not wait forever after termination.
+    producer.waitForTermination();
+    unblocker.waitForTermination();
+    CPPUNIT_ASSERT(handler.messages.size() <= count + 1);
+}
@@ -32,7 +32,9 @@
 //----------------------------------------------------------------------------
 
 #include "tsDVBCSA2.h"
+#include "tsTSScrambling.h"
 #include "tsTSPacket.h"
+#include "tsMonotonic.h"
 #include "tsNames.h"
 #include "utestCppUnitTest.h"
 TSDUCK_SOURCE;
@@ -49,9 +51,19 @@ public:
     virtual void tearDown() override;
 
     void testScrambling();
+    void testBatch();
+    void testTSScramblingBatch();
+    void testTSScramblingThreads();
+    void testTSScramblingErrors();
+    void testBatchThroughput();
 
     CPPUNIT_TEST_SUITE(ScramblingTest);
     CPPUNIT_TEST(testScrambling);
+    CPPUNIT_TEST(testBatch);
+    CPPUNIT_TEST(testTSScramblingBatch);
+    CPPUNIT_TEST(testTSScramblingThreads);
+    CPPUNIT_TEST(testTSScramblingErrors);
+    CPPUNIT_TEST(testBatchThroughput);
     CPPUNIT_TEST_SUITE_END();
 };
 
@@ -211,3 +223,240 @@ void ScramblingTest::testScrambling()
         CPPUNIT_ASSERT(::memcmp(pkt.b + header_size, vec->cipher.b + header_size, payload_size) == 0);
     }
 }
+
+void ScramblingTest::testBatch()
+{
+    const ScramblingTestVector* vec = scrambling_test_vectors;
+    const size_t vec_count = sizeof(scrambling_test_vectors) / sizeof(ScramblingTestVector);
+    ts::DVBCSA2 scrambler;
+
+    utest::Out() << "ScramblingTest: batch size: " << ts::DVBCSA2::BatchSize() << std::endl;
+
+    // Test vectors, more packets than the batch size, all with the same key.
+    for (size_t ti = 0; ti < vec_count; ++ti, ++vec) {
+
+        const size_t header_size = vec->plain.getHeaderSize();
+        const size_t payload_size = vec->plain.getPayloadSize();
+        const uint8_t scv = vec->cipher.getScrambling();
+        const size_t count = ts::DVBCSA2::BatchSize() + 30;
+
+        CPPUNIT_ASSERT(scrambler.setKey(scv == ts::SC_EVEN_KEY ? vec->cw_even : vec->cw_odd, sizeof(vec->cw_even)));
+
+        ts::TSPacketVector pkts(count, vec->cipher);
+        std::vector<uint8_t*> data(count);
+        std::vector<size_t> sizes(count, payload_size);
+        for (size_t i = 0; i < count; ++i) {
+            data[i] = pkts[i].b + header_size;
+        }
+
+        CPPUNIT_ASSERT(scrambler.decryptBatchInPlace(data.data(), sizes.data(), count));
+        for (size_t i = 0; i < count; ++i) {
+            CPPUNIT_ASSERT(::memcmp(pkts[i].b + header_size, vec->plain.b + header_size, payload_size) == 0);
+        }
+
+        CPPUNIT_ASSERT(scrambler.encryptBatchInPlace(data.data(), sizes.data(), count));
+        for (size_t i = 0; i < count; ++i) {
+            CPPUNIT_ASSERT(::memcmp(pkts[i].b + header_size, vec->cipher.b + header_size, payload_size) == 0);
+        }
+    }
+
+    // All payload sizes, compared with the packet-by-packet implementation.
+    static const uint8_t cw[ts::DVBCSA2::KEY_SIZE] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+    CPPUNIT_ASSERT(scrambler.setKey(cw, sizeof(cw)));
+
+    const size_t count = 2 * (ts::PKT_SIZE - 4 + 1);
+    ts::ByteBlock ref(count * ts::PKT_SIZE);
+    for (size_t i = 0; i < ref.size(); ++i) {
+        ref[i] = uint8_t(i * 7 + i / 251);
+    }
+    ts::ByteBlock buf(ref);
+    std::vector<uint8_t*> data(count);
+    std::vector<size_t> sizes(count);
+    for (size_t i = 0; i < count; ++i) {
+        data[i] = buf.data() + i * ts::PKT_SIZE;
+        sizes[i] = i % (ts::PKT_SIZE - 4 + 1);
+    }
+
+    CPPUNIT_ASSERT(scrambler.encryptBatchInPlace(data.data(), sizes.data(), count));
+    for (size_t i = 0; i < count; ++i) {
+        CPPUNIT_ASSERT(scrambler.encryptInPlace(ref.data() + i * ts::PKT_SIZE, sizes[i]));
+    }
+    CPPUNIT_ASSERT(buf == ref);
+
+    CPPUNIT_ASSERT(scrambler.decryptBatchInPlace(data.data(), sizes.data(), count));
+    for (size_t i = 0; i < count; ++i) {
+        CPPUNIT_ASSERT(scrambler.decryptInPlace(ref.data() + i * ts::PKT_SIZE, sizes[i]));
+    }
+    CPPUNIT_ASSERT(buf == ref);
+
+    // Payloads larger than a TS packet are rejected.
+    sizes[0] = 200;
+    CPPUNIT_ASSERT(!scrambler.encryptBatchInPlace(data.data(), sizes.data(), count));
+}
+
+void ScramblingTest::testTSScramblingBatch()
+{
+    const ScramblingTestVector* vec = scrambling_test_vectors;
+    const size_t vec_count = sizeof(scrambling_test_vectors) / sizeof(ScramblingTestVector);
+
+    // Same packets with key changes, processed with and without deferred mode.
+    ts::TSScrambling direct;
+    ts::TSScrambling deferred;
+    ts::TSPacketVector pkts1;
+    ts::TSPacketVector pkts2;
+
+    deferred.startBatch();
+    for (size_t ti = 0; ti < vec_count; ++ti, ++vec) {
+        const uint8_t scv = vec->cipher.getScrambling();
+        const ts::ByteBlock cw(scv == ts::SC_EVEN_KEY ? vec->cw_even : vec->cw_odd, ts::DVBCSA2::KEY_SIZE);
+        CPPUNIT_ASSERT(direct.setCW(cw, scv));
+        CPPUNIT_ASSERT(deferred.setCW(cw, scv));
+        CPPUNIT_ASSERT(direct.setEncryptParity(scv));
+        CPPUNIT_ASSERT(deferred.setEncryptParity(scv));
+        pkts1.resize(pkts1.size() + 40, vec->plain);
+        pkts2.resize(pkts2.size() + 40, vec->plain);
+        for (size_t i = pkts1.size() - 40; i < pkts1.size(); ++i) {
+            CPPUNIT_ASSERT(direct.encrypt(pkts1[i]));
+            CPPUNIT_ASSERT(pkts1[i] == vec->cipher);
+            CPPUNIT_ASSERT(deferred.encrypt(pkts2[i]));
+        }
+    }
+    CPPUNIT_ASSERT(deferred.endBatch());
+    CPPUNIT_ASSERT(pkts1 == pkts2);
+
+    deferred.startBatch();
+    for (size_t i = 0; i < pkts2.size(); ++i) {
+        CPPUNIT_ASSERT(deferred.decrypt(pkts2[i]));
+    }
+    CPPUNIT_ASSERT(deferred.endBatch());
+    for (size_t i = 0; i < pkts2.size(); ++i) {
+        CPPUNIT_ASSERT(direct.decrypt(pkts1[i]));
+    }
+    CPPUNIT_ASSERT(pkts1 == pkts2);
+    CPPUNIT_ASSERT(pkts1.back() == scrambling_test_vectors[vec_count - 1].plain);
+}
+
+void ScramblingTest::testTSScramblingThreads()
+{
+    const ScramblingTestVector* vec = scrambling_test_vectors;
+    const size_t vec_count = sizeof(scrambling_test_vectors) / sizeof(ScramblingTestVector);
+    const size_t pkt_per_cw = 500;
+
+    // Same packets with key changes in the middle of batches, processed by several threads.
+    ts::TSScrambling scrambling;
+    CPPUNIT_ASSERT(scrambling.setThreads(4));
+    CPPUNIT_ASSERT_EQUAL(size_t(4), scrambling.threads());
+    ts::TSPacketVector pkts;
+
+    scrambling.startBatch();
+    for (size_t ti = 0; ti < vec_count; ++ti, ++vec) {
+        const uint8_t scv = vec->cipher.getScrambling();
+        const ts::ByteBlock cw(scv == ts::SC_EVEN_KEY ? vec->cw_even : vec->cw_odd, ts::DVBCSA2::KEY_SIZE);
+        CPPUNIT_ASSERT(scrambling.setCW(cw, scv));
+        CPPUNIT_ASSERT(scrambling.setEncryptParity(scv));
+        pkts.resize(pkts.size() + pkt_per_cw, vec->plain);
+        for (size_t i = pkts.size() - pkt_per_cw; i < pkts.size(); ++i) {
+            CPPUNIT_ASSERT(scrambling.encrypt(pkts[i]));
+        }
+    }
+    CPPUNIT_ASSERT(scrambling.endBatch());
+
+    for (size_t i = 0; i < pkts.size(); ++i) {
+        CPPUNIT_ASSERT(pkts[i] == scrambling_test_vectors[i / pkt_per_cw].cipher);
+    }
+
+    scrambling.startBatch();
+    vec = scrambling_test_vectors;
+    for (size_t ti = 0; ti < vec_count; ++ti, ++vec) {
+        const uint8_t scv = vec->cipher.getScrambling();
+        const ts::ByteBlock cw(scv == ts::SC_EVEN_KEY ? vec->cw_even : vec->cw_odd, ts::DVBCSA2::KEY_SIZE);
+        CPPUNIT_ASSERT(scrambling.setCW(cw, scv));
+        for (size_t i = ti * pkt_per_cw; i < (ti + 1) * pkt_per_cw; ++i) {
+            CPPUNIT_ASSERT(scrambling.decrypt(pkts[i]));
+        }
+    }
+    CPPUNIT_ASSERT(scrambling.endBatch());
+
+    for (size_t i = 0; i < pkts.size(); ++i) {
+        CPPUNIT_ASSERT(pkts[i] == scrambling_test_vectors[i / pkt_per_cw].plain);
+    }
+
+    CPPUNIT_ASSERT(scrambling.setThreads(1));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), scrambling.threads());
+}
+
+void ScramblingTest::testTSScramblingErrors()
+{
+    const ScramblingTestVector& vec(scrambling_test_vectors[0]);
+    const uint8_t scv = vec.cipher.getScrambling();
+    const ts::ByteBlock cw(scv == ts::SC_EVEN_KEY ? vec.cw_even : vec.cw_odd, ts::DVBCSA2::KEY_SIZE);
+
+    ts::TSScrambling scrambling;
+    ts::TSPacketVector pkts(20, vec.plain);
+    CPPUNIT_ASSERT(scrambling.setCW(cw, scv));
+    CPPUNIT_ASSERT(scrambling.setEncryptParity(scv));
+
+    // Deferred packets are processed with the algorithm at the time they were registered.
+    scrambling.startBatch();
+    for (size_t i = 0; i < 10; ++i) {
+        CPPUNIT_ASSERT(scrambling.encrypt(pkts[i]));
+    }
+    CPPUNIT_ASSERT(scrambling.setScramblingType(ts::SCRAMBLING_ATIS_IIF_IDSA));
+    for (size_t i = 0; i < 10; ++i) {
+        CPPUNIT_ASSERT(pkts[i] == vec.cipher);
+    }
+    CPPUNIT_ASSERT(scrambling.setScramblingType(ts::SCRAMBLING_DVB_CSA2));
+
+    // There is no DVB-CSA2 key for the other parity, the next deferred packets cannot be processed.
+    CPPUNIT_ASSERT(scrambling.setEncryptParity(scv ^ 1));
+    for (size_t i = 10; i < pkts.size(); ++i) {
+        CPPUNIT_ASSERT(scrambling.encrypt(pkts[i]));
+    }
+    CPPUNIT_ASSERT(!scrambling.endBatch());
+    CPPUNIT_ASSERT_EQUAL(size_t(10), scrambling.batchErrorIndex(pkts.data(), pkts.size()));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), scrambling.batchErrorIndex(pkts.data() + 15, 5));
+    CPPUNIT_ASSERT_EQUAL(size_t(5), scrambling.batchErrorIndex(pkts.data(), 5));
+
+    // A new batch starts without error.
+    scrambling.startBatch();
+    CPPUNIT_ASSERT(scrambling.endBatch());
+    CPPUNIT_ASSERT_EQUAL(pkts.size(), scrambling.batchErrorIndex(pkts.data(), pkts.size()));
+}
+
+void ScramblingTest::testBatchThroughput()
+{
+    static const uint8_t cw[ts::DVBCSA2::KEY_SIZE] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+    static const size_t count = 1024;
+    static const size_t payload_size = ts::PKT_SIZE - 4;
+
+    ts::DVBCSA2 scrambler;
+    CPPUNIT_ASSERT(scrambler.setKey(cw, sizeof(cw)));
+
+    ts::ByteBlock buf(count * payload_size, 0x5A);
+    std::vector<uint8_t*> data(count);
+    std::vector<size_t> sizes(count, payload_size);
+    for (size_t i = 0; i < count; ++i) {
+        data[i] = buf.data() + i * payload_size;
+    }
+
+    ts::Monotonic start;
+    ts::Monotonic end;
+
+    // Packet by packet.
+    start.getSystemTime();
+    for (size_t i = 0; i < count; ++i) {
+        CPPUNIT_ASSERT(scrambler.decryptInPlace(data[i], sizes[i]));
+    }
+    end.getSystemTime();
+    const ts::NanoSecond single = std::max<ts::NanoSecond>(1, end - start);
+
+    // By batches.
+    start.getSystemTime();
+    CPPUNIT_ASSERT(scrambler.decryptBatchInPlace(data.data(), sizes.data(), count));
+    end.getSystemTime();
+    const ts::NanoSecond batch = std::max<ts::NanoSecond>(1, end - start);
+
+    utest::Out() << "ScramblingTest: DVB-CSA2 descrambling, packet by packet: "
+                 << ts::UString::Decimal((ts::NanoSecond(count) * ts::NanoSecPerSec) / single) << " packets/s, by batch: "
+                 << ts::UString::Decimal((ts::NanoSecond(count) * ts::NanoSecPerSec) / batch) << " packets/s" << std::endl;
+}
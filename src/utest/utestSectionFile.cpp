@@ -32,6 +32,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsSectionFile.h"
+#include "tsIndexedSectionFile.h"
 #include "tsPAT.h"
 #include "tsTDT.h"
 #include "tsSysUtils.h"
@@ -68,6 +69,7 @@ public:
     void testSCTE35();
     void testAllTables();
     void testBuildSections();
+    void testIndexedFile();
 
     CPPUNIT_TEST_SUITE(SectionFileTest);
     CPPUNIT_TEST(testConfigurationFile);
@@ -78,6 +80,7 @@ public:
     CPPUNIT_TEST(testSCTE35);
     CPPUNIT_TEST(testAllTables);
     CPPUNIT_TEST(testBuildSections);
+    CPPUNIT_TEST(testIndexedFile);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -86,6 +89,7 @@ private:
     ts::Report& report();
     ts::UString _tempFileNameBin;
     ts::UString _tempFileNameXML;
+    ts::UString _tempFileNameIdx;
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(SectionFileTest);
@@ -98,7 +102,8 @@ CPPUNIT_TEST_SUITE_REGISTRATION(SectionFileTest);
 // Constructor.
 SectionFileTest::SectionFileTest() :
     _tempFileNameBin(ts::TempFile(u".tmp.bin")),
-    _tempFileNameXML(ts::TempFile(u".tmp.xml"))
+    _tempFileNameXML(ts::TempFile(u".tmp.xml")),
+    _tempFileNameIdx(ts::TempFile(u".tmp.sidx"))
 {
 }
 
@@ -107,6 +112,7 @@ void SectionFileTest::setUp()
 {
     ts::DeleteFile(_tempFileNameBin);
     ts::DeleteFile(_tempFileNameXML);
+    ts::DeleteFile(_tempFileNameIdx);
 }
 
 // Test suite cleanup method.
@@ -114,6 +120,7 @@ void SectionFileTest::tearDown()
 {
     ts::DeleteFile(_tempFileNameBin);
     ts::DeleteFile(_tempFileNameXML);
+    ts::DeleteFile(_tempFileNameIdx);
 }
 
 ts::Report& SectionFileTest::report()
@@ -460,3 +467,93 @@ void SectionFileTest::testBuildSections()
     ts::TDT xmlTDT(*xmlFile.tables()[2]);
     CPPUNIT_ASSERT(tdtTime == xmlTDT.utc_time);
 }
+
+void SectionFileTest::testIndexedFile()
+{
+    // Build a PAT with 2 sections and a TDT (short section) on their own PID's.
+    ts::PAT pat(3, true, 0x5678);
+    for (uint16_t srv = 3; srv < ts::MAX_PSI_LONG_SECTION_PAYLOAD_SIZE / 4 + 16; ++srv) {
+        pat.pmts[srv] = ts::PID(srv + 2);
+    }
+    ts::BinaryTablePtr patBin(new(ts::BinaryTable));
+    pat.serialize(*patBin);
+    patBin->setSourcePID(ts::PID_PAT);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), patBin->sectionCount());
+
+    ts::TDT tdt(ts::Time::Fields(2018, 6, 21, 10, 20, 30));
+    ts::BinaryTablePtr tdtBin(new(ts::BinaryTable));
+    tdt.serialize(*tdtBin);
+    tdtBin->setSourcePID(ts::PID_TDT);
+
+    // The TDT is stored first, the index must not depend on the file order.
+    ts::SectionFile file;
+    file.add(tdtBin);
+    file.add(patBin);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), file.sections().size());
+
+    utest::Out() << "SectionFileTest::testIndexedFile: saving " << _tempFileNameIdx << std::endl;
+    CPPUNIT_ASSERT(!ts::FileExists(_tempFileNameIdx));
+    CPPUNIT_ASSERT(file.saveIndexed(_tempFileNameIdx, report()));
+    CPPUNIT_ASSERT(ts::FileExists(_tempFileNameIdx));
+    CPPUNIT_ASSERT(ts::IndexedSectionFile::IsIndexedFile(_tempFileNameIdx));
+    CPPUNIT_ASSERT_EQUAL(ts::SectionFile::INDEXED, ts::SectionFile::GetFileType(_tempFileNameIdx));
+
+    // Access the sections without loading them.
+    ts::IndexedSectionFile idx;
+    CPPUNIT_ASSERT(idx.open(_tempFileNameIdx, report()));
+    CPPUNIT_ASSERT(idx.isOpen());
+    CPPUNIT_ASSERT_EQUAL(size_t(3), idx.count());
+
+    ts::IndexedSectionFile::Entry entry;
+    CPPUNIT_ASSERT(idx.getEntry(0, entry));
+    CPPUNIT_ASSERT_EQUAL(ts::PID(ts::PID_TDT), entry.pid);
+    CPPUNIT_ASSERT_EQUAL(ts::TID(ts::TID_TDT), entry.tid);
+    CPPUNIT_ASSERT(!entry.is_long);
+
+    CPPUNIT_ASSERT(idx.getEntry(2, entry));
+    CPPUNIT_ASSERT_EQUAL(ts::PID(ts::PID_PAT), entry.pid);
+    CPPUNIT_ASSERT_EQUAL(ts::TID(ts::TID_PAT), entry.tid);
+    CPPUNIT_ASSERT_EQUAL(uint16_t(0x5678), entry.tid_ext);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(3), entry.version);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(1), entry.section_number);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(1), entry.last_section_number);
+    CPPUNIT_ASSERT(entry.is_long);
+    CPPUNIT_ASSERT(entry.is_current);
+    CPPUNIT_ASSERT_EQUAL(patBin->sectionAt(1)->size(), entry.size);
+    CPPUNIT_ASSERT(!idx.getEntry(3, entry));
+
+    std::vector<size_t> indexes;
+    idx.findSections(indexes, ts::PID_PAT);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), indexes.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), indexes[0]);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), indexes[1]);
+
+    idx.findSections(indexes, ts::PID_TDT, ts::TID_TDT);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), indexes.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), indexes[0]);
+
+    idx.findSections(indexes, ts::PID_PAT, ts::TID_PAT, 0x5678);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), indexes.size());
+    idx.findSections(indexes, ts::PID_PAT, ts::TID_PAT, 0x1234);
+    CPPUNIT_ASSERT(indexes.empty());
+    idx.findSections(indexes, ts::PID_NIT);
+    CPPUNIT_ASSERT(indexes.empty());
+
+    for (size_t i = 0; i < file.sections().size(); ++i) {
+        const ts::SectionPtr sect(idx.getSection(i, ts::CRC32::CHECK));
+        CPPUNIT_ASSERT(!sect.isNull());
+        CPPUNIT_ASSERT(*sect == *file.sections()[i]);
+        CPPUNIT_ASSERT_EQUAL(file.sections()[i]->sourcePID(), sect->sourcePID());
+    }
+    CPPUNIT_ASSERT(idx.close(report()));
+    CPPUNIT_ASSERT(!idx.isOpen());
+
+    // Reload the complete file.
+    ts::SectionFile idxFile;
+    CPPUNIT_ASSERT(idxFile.load(_tempFileNameIdx, report()));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), idxFile.tables().size());
+    CPPUNIT_ASSERT_EQUAL(size_t(3), idxFile.sections().size());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), idxFile.orphanSections().size());
+    CPPUNIT_ASSERT(*idxFile.tables()[0] == *tdtBin);
+    CPPUNIT_ASSERT(*idxFile.tables()[1] == *patBin);
+}
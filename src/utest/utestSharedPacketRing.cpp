@@ -0,0 +1,269 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for SharedPacketRing class.
+//
+//----------------------------------------------------------------------------
+
+#include "tsSharedPacketRing.h"
+#include "tsMemoryUtils.h"
+#include "tsCerrReport.h"
+#include "tsNullReport.h"
+#include "utestCppUnitThread.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class SharedPacketRingTest: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testReadWrite();
+    void testDropOldest();
+    void testBackPressure();
+    void testEndOfStream();
+    void testConcurrent();
+
+    CPPUNIT_TEST_SUITE(SharedPacketRingTest);
+    CPPUNIT_TEST(testReadWrite);
+    CPPUNIT_TEST(testDropOldest);
+    CPPUNIT_TEST(testBackPressure);
+    CPPUNIT_TEST(testEndOfStream);
+    CPPUNIT_TEST(testConcurrent);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    ts::UString _name;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SharedPacketRingTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void SharedPacketRingTest::setUp()
+{
+    // Use a ring name which is unique to this process.
+    _name = ts::UString::Format(u"utest-%d", {ts::CurrentProcessId()});
+}
+
+// Test suite cleanup method.
+void SharedPacketRingTest::tearDown()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Build packets with a sequence number in the payload.
+    void BuildPackets(ts::TSPacket* packets, size_t count, uint32_t first)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            packets[i] = ts::NullPacket;
+            ts::PutUInt32(packets[i].b + 4, first + uint32_t(i));
+        }
+    }
+
+    // Get the sequence number of a packet.
+    uint32_t SequenceOf(const ts::TSPacket& pkt)
+    {
+        return ts::GetUInt32(pkt.b + 4);
+    }
+}
+
+void SharedPacketRingTest::testReadWrite()
+{
+    ts::SharedPacketRing writer;
+    ts::SharedPacketRing reader;
+    CPPUNIT_ASSERT(!reader.open(_name, NULLREP));
+    CPPUNIT_ASSERT(writer.create(_name, 100, 4, ts::SharedPacketRing::BACK_PRESSURE, CERR));
+    CPPUNIT_ASSERT(writer.isOpen());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), writer.readerCount());
+
+    // Packets which are written before the reader opens the ring are not received.
+    ts::TSPacket out[50];
+    BuildPackets(out, 10, 0);
+    CPPUNIT_ASSERT_EQUAL(size_t(10), writer.write(out, 10, 0, CERR));
+
+    CPPUNIT_ASSERT(reader.open(_name, CERR));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), writer.readerCount());
+
+    ts::TSPacket in[50];
+    CPPUNIT_ASSERT_EQUAL(size_t(0), reader.read(in, 50, 0, CERR));
+    CPPUNIT_ASSERT(!reader.eof());
+
+    BuildPackets(out, 30, 10);
+    CPPUNIT_ASSERT_EQUAL(size_t(30), writer.write(out, 30, 0, CERR));
+    CPPUNIT_ASSERT_EQUAL(size_t(20), reader.read(in, 20, 0, CERR));
+    CPPUNIT_ASSERT_EQUAL(size_t(10), reader.read(in + 20, 50, 0, CERR));
+    for (size_t i = 0; i < 30; ++i) {
+        CPPUNIT_ASSERT_EQUAL(uint32_t(10 + i), SequenceOf(in[i]));
+    }
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(0), reader.lostPackets());
+
+    CPPUNIT_ASSERT(reader.close(CERR));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), writer.readerCount());
+    CPPUNIT_ASSERT(writer.close(CERR));
+}
+
+void SharedPacketRingTest::testDropOldest()
+{
+    ts::SharedPacketRing writer;
+    ts::SharedPacketRing reader;
+    CPPUNIT_ASSERT(writer.create(_name, 16, 4, ts::SharedPacketRing::DROP_OLDEST, CERR));
+    CPPUNIT_ASSERT(reader.open(_name, CERR));
+
+    // The writer never waits, the reader loses the oldest packets.
+    ts::TSPacket out[40];
+    BuildPackets(out, 40, 0);
+    CPPUNIT_ASSERT_EQUAL(size_t(40), writer.write(out, 40, 0, CERR));
+
+    ts::TSPacket in[40];
+    CPPUNIT_ASSERT_EQUAL(size_t(16), reader.read(in, 40, 0, CERR));
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(24), reader.lostPackets());
+    for (size_t i = 0; i < 16; ++i) {
+        CPPUNIT_ASSERT_EQUAL(uint32_t(24 + i), SequenceOf(in[i]));
+    }
+}
+
+void SharedPacketRingTest::testBackPressure()
+{
+    ts::SharedPacketRing writer;
+    ts::SharedPacketRing reader;
+    CPPUNIT_ASSERT(writer.create(_name, 16, 4, ts::SharedPacketRing::BACK_PRESSURE, CERR));
+    CPPUNIT_ASSERT(reader.open(_name, CERR));
+
+    // The writer is blocked by the reader.
+    ts::TSPacket out[40];
+    BuildPackets(out, 40, 0);
+    CPPUNIT_ASSERT_EQUAL(size_t(16), writer.write(out, 40, 10, CERR));
+
+    ts::TSPacket in[40];
+    CPPUNIT_ASSERT_EQUAL(size_t(10), reader.read(in, 10, 0, CERR));
+    CPPUNIT_ASSERT_EQUAL(size_t(10), writer.write(out + 16, 24, 10, CERR));
+    CPPUNIT_ASSERT_EQUAL(size_t(16), reader.read(in + 10, 30, 0, CERR));
+    for (size_t i = 0; i < 26; ++i) {
+        CPPUNIT_ASSERT_EQUAL(uint32_t(i), SequenceOf(in[i]));
+    }
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(0), reader.lostPackets());
+
+    // Without reader, the writer is no longer blocked.
+    CPPUNIT_ASSERT(reader.close(CERR));
+    CPPUNIT_ASSERT_EQUAL(size_t(14), writer.write(out + 26, 14, 0, CERR));
+}
+
+void SharedPacketRingTest::testEndOfStream()
+{
+    ts::SharedPacketRing writer;
+    ts::SharedPacketRing reader;
+    CPPUNIT_ASSERT(writer.create(_name, 16, 4, ts::SharedPacketRing::BACK_PRESSURE, CERR));
+    CPPUNIT_ASSERT(reader.open(_name, CERR));
+
+    ts::TSPacket pkt[8];
+    BuildPackets(pkt, 8, 0);
+    CPPUNIT_ASSERT_EQUAL(size_t(8), writer.write(pkt, 8, 0, CERR));
+    CPPUNIT_ASSERT(writer.close(CERR));
+
+    // The ring no longer exists for new readers but current readers get the remaining packets.
+    ts::SharedPacketRing late;
+    CPPUNIT_ASSERT(!late.open(_name, NULLREP));
+    CPPUNIT_ASSERT_EQUAL(size_t(8), reader.read(pkt, 8, 0, CERR));
+    CPPUNIT_ASSERT(!reader.eof());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), reader.read(pkt, 8, 1000, CERR));
+    CPPUNIT_ASSERT(reader.eof());
+}
+
+namespace {
+    class RingReader: public utest::CppUnitThread
+    {
+    public:
+        RingReader(const ts::UString& name, uint32_t count) :
+            utest::CppUnitThread(),
+            _name(name),
+            _count(count)
+        {
+        }
+
+        virtual void test() override
+        {
+            ts::SharedPacketRing ring;
+            CPPUNIT_ASSERT(ring.open(_name, CERR));
+            ts::TSPacket pkt[100];
+            uint32_t next = 0;
+            while (!ring.eof()) {
+                const size_t count = ring.read(pkt, 100, 1000, CERR);
+                for (size_t i = 0; i < count; ++i) {
+                    CPPUNIT_ASSERT_EQUAL(next++, SequenceOf(pkt[i]));
+                }
+            }
+            CPPUNIT_ASSERT_EQUAL(_count, next);
+            CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(0), ring.lostPackets());
+        }
+
+    private:
+        const ts::UString _name;
+        const uint32_t    _count;
+    };
+}
+
+void SharedPacketRingTest::testConcurrent()
+{
+    const uint32_t total = 200000;
+    ts::SharedPacketRing writer;
+    CPPUNIT_ASSERT(writer.create(_name, 64, 4, ts::SharedPacketRing::BACK_PRESSURE, CERR));
+
+    // Two readers with a small ring, the writer is often blocked.
+    RingReader reader1(_name, total);
+    RingReader reader2(_name, total);
+    CPPUNIT_ASSERT(reader1.start());
+    CPPUNIT_ASSERT(reader2.start());
+    while (writer.readerCount() < 2) {
+        ts::SleepThread(1);
+    }
+
+    ts::TSPacket pkt[50];
+    for (uint32_t seq = 0; seq < total; seq += 50) {
+        BuildPackets(pkt, 50, seq);
+        CPPUNIT_ASSERT_EQUAL(size_t(50), writer.write(pkt, 50, 10000, CERR));
+    }
+    CPPUNIT_ASSERT(writer.close(CERR));
+    reader1.waitForTermination();
+    reader2.waitForTermination();
+}
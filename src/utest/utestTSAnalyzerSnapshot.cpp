@@ -0,0 +1,219 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for TSAnalyzerSnapshot class.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSAnalyzerSnapshot.h"
+#include "tsTSAnalyzer.h"
+#include "tsTSPacket.h"
+#include "utestCppUnitThread.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSAnalyzerSnapshotTest: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testEmpty();
+    void testAnalyzer();
+    void testConcurrent();
+
+    CPPUNIT_TEST_SUITE(TSAnalyzerSnapshotTest);
+    CPPUNIT_TEST(testEmpty);
+    CPPUNIT_TEST(testAnalyzer);
+    CPPUNIT_TEST(testConcurrent);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TSAnalyzerSnapshotTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void TSAnalyzerSnapshotTest::setUp()
+{
+}
+
+// Test suite cleanup method.
+void TSAnalyzerSnapshotTest::tearDown()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Test cases
+//----------------------------------------------------------------------------
+
+void TSAnalyzerSnapshotTest::testEmpty()
+{
+    ts::TSAnalyzerSnapshot snapshot;
+    ts::TSAnalyzerSnapshot::Counters counters;
+    counters.ts_packets = 12;
+    counters.pids.resize(3);
+
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), snapshot.sequence());
+    snapshot.get(counters);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), counters.sequence);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), counters.ts_packets);
+    CPPUNIT_ASSERT(counters.pids.empty());
+}
+
+void TSAnalyzerSnapshotTest::testAnalyzer()
+{
+    ts::TSAnalyzerSnapshot snapshot;
+    ts::TSAnalyzerSnapshot::Counters counters;
+    ts::TSAnalyzer analyzer;
+    analyzer.setSnapshot(&snapshot, 10);
+
+    // 30 packets on PID 100, 5 on PID 200, with one discontinuity on PID 200.
+    ts::TSPacket pkt(ts::NullPacket);
+    uint8_t cc100 = 0;
+    uint8_t cc200 = 0;
+    for (size_t i = 0; i < 35; ++i) {
+        if (i % 7 == 3) {
+            if (i == 31) {
+                cc200 += 2;
+            }
+            pkt.setPID(200);
+            pkt.setCC(cc200++ % ts::CC_MAX);
+        }
+        else {
+            pkt.setPID(100);
+            pkt.setCC(cc100++ % ts::CC_MAX);
+        }
+        analyzer.feedPacket(pkt);
+    }
+
+    // Published before packets 10, 20, 30.
+    snapshot.get(counters);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3), counters.sequence);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(30), counters.ts_packets);
+
+    analyzer.publishSnapshot();
+    snapshot.get(counters);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(4), counters.sequence);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(35), counters.ts_packets);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), counters.pids.size());
+    CPPUNIT_ASSERT_EQUAL(ts::PID(100), counters.pids[0].pid);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(30), counters.pids[0].packets);
+    CPPUNIT_ASSERT_EQUAL(ts::PID(200), counters.pids[1].pid);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(5), counters.pids[1].packets);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), counters.pids[1].discontinuities);
+    CPPUNIT_ASSERT_EQUAL(counters.pids[0].discontinuities + counters.pids[1].discontinuities, counters.discontinuities);
+
+    const ts::json::ValuePtr json(counters.toJSON());
+    CPPUNIT_ASSERT(json->isObject());
+    CPPUNIT_ASSERT_EQUAL(int64_t(35), json->value(u"ts").value(u"packets").toInteger());
+    CPPUNIT_ASSERT_EQUAL(int64_t(200), json->value(u"pids").at(1).value(u"pid").toInteger());
+    CPPUNIT_ASSERT_EQUAL(int64_t(5), json->value(u"pids").at(1).value(u"packets").toInteger());
+
+    // No more publication after detach.
+    analyzer.setSnapshot(nullptr, 0);
+    analyzer.publishSnapshot();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(4), snapshot.sequence());
+}
+
+// A reader thread checks that all snapshots are consistent while the writer publishes.
+namespace {
+    class SnapshotReader: public utest::CppUnitThread
+    {
+    public:
+        SnapshotReader(const ts::TSAnalyzerSnapshot& snapshot, const volatile bool& stop) :
+            utest::CppUnitThread(),
+            _snapshot(snapshot),
+            _stop(stop),
+            reads(0)
+        {
+        }
+
+        virtual void test() override
+        {
+            ts::TSAnalyzerSnapshot::Counters counters;
+            uint64_t last = 0;
+            while (!_stop) {
+                _snapshot.get(counters);
+                CPPUNIT_ASSERT(counters.sequence >= last);
+                last = counters.sequence;
+                uint64_t total = 0;
+                for (size_t i = 0; i < counters.pids.size(); ++i) {
+                    total += counters.pids[i].packets;
+                }
+                // The writer always publishes a global count which is the sum of the PID counts.
+                CPPUNIT_ASSERT_EQUAL(counters.ts_packets, total);
+                CPPUNIT_ASSERT_EQUAL(counters.sequence, counters.invalid_sync);
+                reads++;
+            }
+        }
+
+    private:
+        const ts::TSAnalyzerSnapshot& _snapshot;
+        const volatile bool& _stop;
+
+    public:
+        size_t reads;
+    };
+}
+
+void TSAnalyzerSnapshotTest::testConcurrent()
+{
+    ts::TSAnalyzerSnapshot snapshot;
+    volatile bool stop = false;
+    SnapshotReader reader(snapshot, stop);
+    CPPUNIT_ASSERT(reader.start());
+
+    ts::TSAnalyzerSnapshot::Counters counters;
+    for (uint64_t seq = 1; seq <= 20000; ++seq) {
+        counters.pids.resize(1 + seq % 50);
+        counters.ts_packets = 0;
+        for (size_t i = 0; i < counters.pids.size(); ++i) {
+            counters.pids[i].pid = ts::PID(i);
+            counters.pids[i].packets = seq + i;
+            counters.ts_packets += seq + i;
+        }
+        // Also store the sequence number in a counter to check the consistency of the copy.
+        counters.invalid_sync = seq;
+        snapshot.publish(counters);
+    }
+
+    stop = true;
+    reader.waitForTermination();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(20000), snapshot.sequence());
+    utest::Out() << "TSAnalyzerSnapshotTest: " << reader.reads << " consistent reads during 20000 publications" << std::endl;
+}
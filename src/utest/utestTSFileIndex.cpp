@@ -0,0 +1,262 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for class ts::TSFileIndex
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSFileIndex.h"
+#include "tsTSFileOutput.h"
+#include "tsByteBlock.h"
+#include "tsSysUtils.h"
+#include "tsCerrReport.h"
+#include "tsNullReport.h"
+#include "utestCppUnitTest.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSFileIndexTest: public CppUnit::TestFixture
+{
+public:
+    TSFileIndexTest();
+
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testSaveLoad();
+    void testTruncated();
+    void testInvalidPID();
+    void testInvalidCount();
+    void testBuildFile();
+
+    CPPUNIT_TEST_SUITE(TSFileIndexTest);
+    CPPUNIT_TEST(testSaveLoad);
+    CPPUNIT_TEST(testTruncated);
+    CPPUNIT_TEST(testInvalidPID);
+    CPPUNIT_TEST(testInvalidCount);
+    CPPUNIT_TEST(testBuildFile);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    ts::UString _tempFileName;
+    ts::UString _tsFileName;
+    ts::Report& report();
+    static ts::TSPacket makePacket(uint64_t index);
+    void buildIndex(ts::TSFileIndex& index);
+    ts::ByteBlock emptyIndexHeader();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TSFileIndexTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+TSFileIndexTest::TSFileIndexTest() :
+    _tempFileName(ts::TempFile(u".tmp.tsidx")),
+    _tsFileName(ts::TempFile(u".tmp.ts"))
+{
+}
+
+// Test suite initialization method.
+void TSFileIndexTest::setUp()
+{
+    ts::DeleteFile(_tempFileName);
+    ts::DeleteFile(_tsFileName);
+}
+
+// Test suite cleanup method.
+void TSFileIndexTest::tearDown()
+{
+    ts::DeleteFile(_tempFileName);
+    ts::DeleteFile(_tsFileName);
+}
+
+ts::Report& TSFileIndexTest::report()
+{
+    if (utest::DebugMode()) {
+        return CERR;
+    }
+    else {
+        return NULLREP;
+    }
+}
+
+// Synthetic packets: PUSI every 10 packets in PID 100 and every 7 packets
+// in PID 200, PCR every 20 packets in PID 100.
+ts::TSPacket TSFileIndexTest::makePacket(uint64_t index)
+{
+    ts::TSPacket pkt(ts::NullPacket);
+    pkt.setPID(index % 2 == 0 ? 100 : 200);
+    if ((index % 2 == 0 && index % 10 == 0) || (index % 2 == 1 && index % 7 == 0)) {
+        pkt.setPUSI();
+    }
+    if (index % 20 == 0) {
+        // Adaptation field with PCR only.
+        pkt.b[3] = 0x30;
+        pkt.b[4] = 7;
+        pkt.b[5] = 0x10;
+        pkt.setPCR(index * 1000);
+    }
+    return pkt;
+}
+
+// Build an index from 1000 synthetic packets.
+void TSFileIndexTest::buildIndex(ts::TSFileIndex& index)
+{
+    for (uint64_t i = 0; i < 1000; ++i) {
+        index.feedPacket(makePacket(i));
+    }
+}
+
+// Binary content of a valid index file with no data, before the PID count.
+ts::ByteBlock TSFileIndexTest::emptyIndexHeader()
+{
+    ts::TSFileIndex index;
+    CPPUNIT_ASSERT(index.save(_tempFileName, report()));
+    ts::ByteBlock data;
+    CPPUNIT_ASSERT(data.loadFromFile(_tempFileName, 1024, &report()));
+    // Remove the trailing PID count (2 bytes).
+    CPPUNIT_ASSERT(data.size() > 2);
+    data.resize(data.size() - 2);
+    return data;
+}
+
+
+//----------------------------------------------------------------------------
+// Test cases
+//----------------------------------------------------------------------------
+
+void TSFileIndexTest::testSaveLoad()
+{
+    ts::TSFileIndex index1;
+    buildIndex(index1);
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(1000), index1.packetCount());
+    CPPUNIT_ASSERT_EQUAL(size_t(50), index1.pcrPoints().size());
+    CPPUNIT_ASSERT_EQUAL(size_t(100), index1.pusiPackets(100).size());
+    CPPUNIT_ASSERT_EQUAL(size_t(71), index1.pusiPackets(200).size());
+    CPPUNIT_ASSERT(index1.save(_tempFileName, report()));
+
+    ts::TSFileIndex index2;
+    CPPUNIT_ASSERT(index2.load(_tempFileName, report()));
+    CPPUNIT_ASSERT_EQUAL(index1.packetCount(), index2.packetCount());
+    CPPUNIT_ASSERT_EQUAL(index1.pcrPoints().size(), index2.pcrPoints().size());
+    for (size_t i = 0; i < index1.pcrPoints().size(); ++i) {
+        CPPUNIT_ASSERT_EQUAL(index1.pcrPoints()[i].packet, index2.pcrPoints()[i].packet);
+        CPPUNIT_ASSERT_EQUAL(index1.pcrPoints()[i].pid, index2.pcrPoints()[i].pid);
+        CPPUNIT_ASSERT_EQUAL(index1.pcrPoints()[i].pcr, index2.pcrPoints()[i].pcr);
+    }
+    CPPUNIT_ASSERT(index1.pusiPackets(100) == index2.pusiPackets(100));
+    CPPUNIT_ASSERT(index1.pusiPackets(200) == index2.pusiPackets(200));
+    CPPUNIT_ASSERT(index2.pusiPackets(300).empty());
+
+    ts::PacketCounter packet = 0;
+    CPPUNIT_ASSERT(index2.findPUSI(200, 100, packet));
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(105), packet);
+    CPPUNIT_ASSERT(index2.findPCR(500000, packet));
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(500), packet);
+}
+
+void TSFileIndexTest::testTruncated()
+{
+    ts::TSFileIndex index;
+    buildIndex(index);
+    CPPUNIT_ASSERT(index.save(_tempFileName, report()));
+
+    ts::ByteBlock data;
+    CPPUNIT_ASSERT(data.loadFromFile(_tempFileName, 1000000, &report()));
+
+    // Any truncation must be detected, at least in the last PUSI list.
+    for (size_t size = 0; size < data.size(); size += 97) {
+        CPPUNIT_ASSERT(ts::ByteBlock(data.data(), size).saveToFile(_tempFileName, &report()));
+        CPPUNIT_ASSERT(!index.load(_tempFileName, report()));
+        CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(0), index.packetCount());
+        CPPUNIT_ASSERT(index.pcrPoints().empty());
+        CPPUNIT_ASSERT(index.pusiPackets(100).empty());
+    }
+    CPPUNIT_ASSERT(ts::ByteBlock(data.data(), data.size() - 1).saveToFile(_tempFileName, &report()));
+    CPPUNIT_ASSERT(!index.load(_tempFileName, report()));
+}
+
+void TSFileIndexTest::testInvalidPID()
+{
+    ts::ByteBlock data(emptyIndexHeader());
+    data.appendUInt16(1);           // PID count
+    data.appendUInt16(0xFFFF);      // invalid PID
+    data.appendUInt32(1);           // PUSI count
+    data.appendUInt32(10);          // distance
+    CPPUNIT_ASSERT(data.saveToFile(_tempFileName, &report()));
+
+    ts::TSFileIndex index;
+    CPPUNIT_ASSERT(!index.load(_tempFileName, report()));
+}
+
+void TSFileIndexTest::testInvalidCount()
+{
+    ts::ByteBlock data(emptyIndexHeader());
+    data.appendUInt16(1);           // PID count
+    data.appendUInt16(100);         // PID
+    data.appendUInt32(0xFFFFFFFF);  // PUSI count, much larger than the file
+    data.appendUInt32(10);          // distance
+    CPPUNIT_ASSERT(data.saveToFile(_tempFileName, &report()));
+
+    ts::TSFileIndex index;
+    CPPUNIT_ASSERT(!index.load(_tempFileName, report()));
+    CPPUNIT_ASSERT(index.pusiPackets(100).empty());
+}
+
+void TSFileIndexTest::testBuildFile()
+{
+    ts::TSFileIndex ref;
+    buildIndex(ref);
+
+    ts::TSFileOutput file;
+    CPPUNIT_ASSERT(file.open(_tsFileName, false, false, report()));
+    for (uint64_t i = 0; i < 1000; ++i) {
+        const ts::TSPacket pkt(makePacket(i));
+        CPPUNIT_ASSERT(file.write(&pkt, 1, report()));
+    }
+    CPPUNIT_ASSERT(file.close(report()));
+
+    // Same index with read operations and memory-mapped I/O.
+    for (int mmap = 0; mmap < 2; ++mmap) {
+        ts::TSFileIndex index;
+        CPPUNIT_ASSERT(index.build(_tsFileName, report(), mmap != 0));
+        CPPUNIT_ASSERT_EQUAL(ref.packetCount(), index.packetCount());
+        CPPUNIT_ASSERT_EQUAL(ref.pcrPoints().size(), index.pcrPoints().size());
+        CPPUNIT_ASSERT(ref.pusiPackets(100) == index.pusiPackets(100));
+        CPPUNIT_ASSERT(ref.pusiPackets(200) == index.pusiPackets(200));
+    }
+}
@@ -0,0 +1,234 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for class ts::TSFileInput
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSFileInput.h"
+#include "tsByteBlock.h"
+#include "tsSysUtils.h"
+#include "tsCerrReport.h"
+#include "tsNullReport.h"
+#include "utestCppUnitTest.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSFileInputTest: public CppUnit::TestFixture
+{
+public:
+    TSFileInputTest();
+
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testRead();
+    void testMemoryMapped();
+    void testMappingWindows();
+    void testStartOffset();
+    void testRepeat();
+    void testTruncatedPacket();
+
+    CPPUNIT_TEST_SUITE(TSFileInputTest);
+    CPPUNIT_TEST(testRead);
+    CPPUNIT_TEST(testMemoryMapped);
+    CPPUNIT_TEST(testMappingWindows);
+    CPPUNIT_TEST(testStartOffset);
+    CPPUNIT_TEST(testRepeat);
+    CPPUNIT_TEST(testTruncatedPacket);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    static const size_t PACKET_COUNT = 1000;
+    ts::UString _tempFileName;
+    ts::Report& report();
+
+    // Create the test file with sequence numbers in the packets.
+    void createFile(size_t extra_bytes = 0);
+
+    // Read the file and check the sequence of packets.
+    // Each repetition contains the packets first to PACKET_COUNT - 1.
+    void checkFile(bool mmap, size_t window, size_t max_packets, bool in_place, size_t repeat, size_t first);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TSFileInputTest);
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t TSFileInputTest::PACKET_COUNT;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+TSFileInputTest::TSFileInputTest() :
+    _tempFileName(ts::TempFile(u".tmp.ts"))
+{
+}
+
+// Test suite initialization method.
+void TSFileInputTest::setUp()
+{
+    ts::DeleteFile(_tempFileName);
+}
+
+// Test suite cleanup method.
+void TSFileInputTest::tearDown()
+{
+    ts::DeleteFile(_tempFileName);
+}
+
+ts::Report& TSFileInputTest::report()
+{
+    if (utest::DebugMode()) {
+        return CERR;
+    }
+    else {
+        return NULLREP;
+    }
+}
+
+void TSFileInputTest::createFile(size_t extra_bytes)
+{
+    ts::ByteBlock data(PACKET_COUNT * ts::PKT_SIZE + extra_bytes, 0xFF);
+    for (size_t i = 0; i < PACKET_COUNT; ++i) {
+        uint8_t* pkt = data.data() + i * ts::PKT_SIZE;
+        ::memcpy(pkt, ts::NullPacket.b, ts::PKT_SIZE);
+        ts::PutUInt32(pkt + 4, uint32_t(i));
+    }
+    CPPUNIT_ASSERT(data.saveToFile(_tempFileName, &report()));
+}
+
+void TSFileInputTest::checkFile(bool mmap, size_t window, size_t max_packets, bool in_place, size_t repeat, size_t first)
+{
+    ts::TSFileInput file;
+    file.setMemoryMapping(mmap, window);
+    CPPUNIT_ASSERT(file.open(_tempFileName, repeat, first * ts::PKT_SIZE, report()));
+    CPPUNIT_ASSERT(file.isOpen());
+#if !defined(TS_WINDOWS)
+    CPPUNIT_ASSERT_EQUAL(mmap, file.isMemoryMapped());
+#endif
+
+    ts::TSPacketVector buffer(max_packets);
+    const ts::TSPacket* pkt = nullptr;
+    size_t count = 0;
+    size_t index = 0;
+
+    while ((count = in_place ? file.readInPlace(pkt, max_packets, report()) : file.read(buffer.data(), max_packets, report()) ) > 0) {
+        CPPUNIT_ASSERT(count <= max_packets);
+        if (!in_place) {
+            pkt = buffer.data();
+        }
+        for (size_t i = 0; i < count; ++i, ++index) {
+            CPPUNIT_ASSERT(pkt[i].hasValidSync());
+            CPPUNIT_ASSERT_EQUAL(uint32_t(first + index % (PACKET_COUNT - first)), ts::GetUInt32(pkt[i].b + 4));
+        }
+    }
+
+    CPPUNIT_ASSERT_EQUAL(repeat * (PACKET_COUNT - first), index);
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(index), file.getPacketCount());
+    CPPUNIT_ASSERT(file.close(report()));
+}
+
+
+//----------------------------------------------------------------------------
+// Test cases
+//----------------------------------------------------------------------------
+
+void TSFileInputTest::testRead()
+{
+    createFile();
+    checkFile(false, ts::TSFileInput::DEFAULT_MMAP_WINDOW, 100, false, 1, 0);
+    checkFile(false, ts::TSFileInput::DEFAULT_MMAP_WINDOW, 77, true, 1, 0);
+}
+
+void TSFileInputTest::testMemoryMapped()
+{
+#if !defined(TS_WINDOWS)
+    createFile();
+    checkFile(true, ts::TSFileInput::DEFAULT_MMAP_WINDOW, 100, false, 1, 0);
+    checkFile(true, ts::TSFileInput::DEFAULT_MMAP_WINDOW, 77, true, 1, 0);
+    checkFile(true, ts::TSFileInput::DEFAULT_MMAP_WINDOW, 5000, true, 1, 0);
+#endif
+}
+
+void TSFileInputTest::testMappingWindows()
+{
+#if !defined(TS_WINDOWS)
+    // Small windows are rounded up to two pages. With packets of 188 bytes,
+    // windows boundaries are never aligned on packets, the next window shall
+    // start before the end of the previous one.
+    createFile();
+    checkFile(true, 1, 1000, true, 1, 0);
+    checkFile(true, 3 * 4096 + 100, 1000, true, 1, 0);
+    checkFile(true, 3 * 4096 + 100, 31, true, 1, 0);
+    checkFile(true, 3 * 4096 + 100, 31, false, 1, 0);
+    checkFile(true, 3 * 4096 + 100, 31, true, 3, 17);
+#endif
+}
+
+void TSFileInputTest::testStartOffset()
+{
+    createFile();
+    checkFile(false, ts::TSFileInput::DEFAULT_MMAP_WINDOW, 100, false, 1, 123);
+    checkFile(false, ts::TSFileInput::DEFAULT_MMAP_WINDOW, 100, true, 1, 999);
+#if !defined(TS_WINDOWS)
+    checkFile(true, ts::TSFileInput::DEFAULT_MMAP_WINDOW, 100, true, 1, 123);
+    checkFile(true, ts::TSFileInput::DEFAULT_MMAP_WINDOW, 100, false, 1, 999);
+#endif
+}
+
+void TSFileInputTest::testRepeat()
+{
+    createFile();
+    checkFile(false, ts::TSFileInput::DEFAULT_MMAP_WINDOW, 100, false, 3, 0);
+    checkFile(false, ts::TSFileInput::DEFAULT_MMAP_WINDOW, 64, true, 4, 500);
+#if !defined(TS_WINDOWS)
+    checkFile(true, ts::TSFileInput::DEFAULT_MMAP_WINDOW, 100, true, 3, 0);
+    checkFile(true, ts::TSFileInput::DEFAULT_MMAP_WINDOW, 64, false, 4, 500);
+#endif
+}
+
+void TSFileInputTest::testTruncatedPacket()
+{
+    // A truncated packet at end of file is ignored, also when repeating.
+    createFile(100);
+    checkFile(false, ts::TSFileInput::DEFAULT_MMAP_WINDOW, 100, false, 1, 0);
+    checkFile(false, ts::TSFileInput::DEFAULT_MMAP_WINDOW, 100, true, 2, 10);
+#if !defined(TS_WINDOWS)
+    checkFile(true, ts::TSFileInput::DEFAULT_MMAP_WINDOW, 100, true, 1, 0);
+    checkFile(true, 3 * 4096 + 100, 100, true, 2, 10);
+#endif
+}
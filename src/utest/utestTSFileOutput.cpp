@@ -0,0 +1,213 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for class ts::TSFileOutput
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSFileOutput.h"
+#include "tsTSFileInput.h"
+#include "tsSysUtils.h"
+#include "tsCerrReport.h"
+#include "tsNullReport.h"
+#include "utestCppUnitTest.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSFileOutputTest: public CppUnit::TestFixture
+{
+public:
+    TSFileOutputTest();
+
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testSynchronous();
+    void testAsynchronous();
+    void testDirectIO();
+    void testAppend();
+
+    CPPUNIT_TEST_SUITE(TSFileOutputTest);
+    CPPUNIT_TEST(testSynchronous);
+    CPPUNIT_TEST(testAsynchronous);
+    CPPUNIT_TEST(testDirectIO);
+    CPPUNIT_TEST(testAppend);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    ts::UString _tempFileName;
+    ts::Report& report();
+
+    // Write packets first to first + count - 1 in the file, max_packets at a time.
+    void writeFile(bool append, size_t depth, bool direct, size_t first, size_t count, size_t max_packets);
+
+    // Read the file and check that it contains the packets 0 to count - 1.
+    void checkFile(size_t count);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TSFileOutputTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+TSFileOutputTest::TSFileOutputTest() :
+    _tempFileName(ts::TempFile(u".tmp.ts"))
+{
+}
+
+// Test suite initialization method.
+void TSFileOutputTest::setUp()
+{
+    ts::DeleteFile(_tempFileName);
+}
+
+// Test suite cleanup method.
+void TSFileOutputTest::tearDown()
+{
+    ts::DeleteFile(_tempFileName);
+}
+
+ts::Report& TSFileOutputTest::report()
+{
+    if (utest::DebugMode()) {
+        return CERR;
+    }
+    else {
+        return NULLREP;
+    }
+}
+
+void TSFileOutputTest::writeFile(bool append, size_t depth, bool direct, size_t first, size_t count, size_t max_packets)
+{
+    // Small buffers: packets overlap buffer boundaries.
+    ts::TSFileOutput file;
+    file.setAsynchronous(depth, 4096);
+    file.setDirectIO(direct);
+    CPPUNIT_ASSERT(file.open(_tempFileName, append, false, report()));
+    CPPUNIT_ASSERT(file.isOpen());
+
+    ts::TSPacketVector buffer(max_packets);
+    size_t index = 0;
+    while (index < count) {
+        const size_t size = std::min(max_packets, count - index);
+        for (size_t i = 0; i < size; ++i) {
+            buffer[i] = ts::NullPacket;
+            ts::PutUInt32(buffer[i].b + 4, uint32_t(first + index + i));
+        }
+        CPPUNIT_ASSERT(file.write(buffer.data(), size, report()));
+        index += size;
+    }
+
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(count), file.getPacketCount());
+    CPPUNIT_ASSERT(file.close(report()));
+    CPPUNIT_ASSERT(!file.isOpen());
+
+    // The statistics remain available after close.
+    ts::TSFileOutput::WriteStatistics stats;
+    file.getWriteStatistics(stats);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(count * ts::PKT_SIZE), stats.bytes);
+    CPPUNIT_ASSERT(stats.writes > 0);
+    CPPUNIT_ASSERT(stats.max_time <= stats.total_time);
+    CPPUNIT_ASSERT(stats.max_pending <= depth);
+}
+
+void TSFileOutputTest::checkFile(size_t count)
+{
+    CPPUNIT_ASSERT_EQUAL(int64_t(count * ts::PKT_SIZE), ts::GetFileSize(_tempFileName));
+
+    ts::TSFileInput file;
+    CPPUNIT_ASSERT(file.open(_tempFileName, 1, 0, report()));
+
+    ts::TSPacketVector buffer(100);
+    size_t size = 0;
+    size_t index = 0;
+    while ((size = file.read(buffer.data(), buffer.size(), report())) > 0) {
+        for (size_t i = 0; i < size; ++i, ++index) {
+            CPPUNIT_ASSERT(buffer[i].hasValidSync());
+            CPPUNIT_ASSERT_EQUAL(uint32_t(index), ts::GetUInt32(buffer[i].b + 4));
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(count, index);
+    CPPUNIT_ASSERT(file.close(report()));
+}
+
+
+//----------------------------------------------------------------------------
+// Test cases
+//----------------------------------------------------------------------------
+
+void TSFileOutputTest::testSynchronous()
+{
+    writeFile(false, 0, false, 0, 1000, 37);
+    checkFile(1000);
+}
+
+void TSFileOutputTest::testAsynchronous()
+{
+    writeFile(false, 3, false, 0, 1000, 37);
+    checkFile(1000);
+    writeFile(false, 2, false, 0, 1000, 1);
+    checkFile(1000);
+    writeFile(false, 4, false, 0, 1000, 500);
+    checkFile(1000);
+}
+
+void TSFileOutputTest::testDirectIO()
+{
+    // Direct I/O is silently ignored when not supported (by the system or the file system).
+    // The last buffer is not aligned, the writer thread shall fall back to normal I/O.
+    writeFile(false, 3, true, 0, 1000, 37);
+    checkFile(1000);
+    // 1024 packets = 47 aligned blocks of 4096 bytes.
+    writeFile(false, 2, true, 0, 1024, 100);
+    checkFile(1024);
+    // Direct I/O is ignored in synchronous mode.
+    writeFile(false, 0, true, 0, 500, 37);
+    checkFile(500);
+}
+
+void TSFileOutputTest::testAppend()
+{
+    writeFile(false, 0, false, 0, 300, 37);
+    writeFile(true, 2, false, 300, 300, 37);
+    checkFile(600);
+    // Unaligned end of file, direct I/O is not possible.
+    writeFile(true, 2, true, 600, 424, 37);
+    checkFile(1024);
+    // Aligned end of file, direct I/O can be used with the first buffers.
+    writeFile(true, 3, true, 1024, 1000, 37);
+    checkFile(2024);
+}
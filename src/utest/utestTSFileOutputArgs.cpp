@@ -0,0 +1,350 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2018, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for class ts::TSFileOutputArgs
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSFileOutputArgs.h"
+#include "tsByteBlock.h"
+#include "tsSysUtils.h"
+#include "tsCerrReport.h"
+#include "tsNullReport.h"
+#include "utestCppUnitTest.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSFileOutputArgsTest: public CppUnit::TestFixture
+{
+public:
+    TSFileOutputArgsTest();
+
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testOptions();
+    void testSingleFile();
+    void testSizeRotation();
+    void testDurationRotation();
+    void testMaxFiles();
+    void testTrimming();
+
+    CPPUNIT_TEST_SUITE(TSFileOutputArgsTest);
+    CPPUNIT_TEST(testOptions);
+    CPPUNIT_TEST(testSingleFile);
+    CPPUNIT_TEST(testSizeRotation);
+    CPPUNIT_TEST(testDurationRotation);
+    CPPUNIT_TEST(testMaxFiles);
+    CPPUNIT_TEST(testTrimming);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    ts::UString _tempPrefix;  // Segment files are named _tempPrefix-YYYYMMDD-hhmmss-mmm.ts
+    ts::UString _tempFileName;
+    ts::Report& report();
+
+    // Load the command line options in a TSFileOutputArgs.
+    bool loadArgs(ts::TSFileOutputArgs& file, const ts::UStringVector& options);
+
+    // Write packets first to first + count - 1, max_packets at a time.
+    void writePackets(ts::TSFileOutputArgs& file, size_t first, size_t count, size_t max_packets);
+
+    // Get the list of segment files, in alphabetical order.
+    ts::UStringVector getSegments();
+
+    // Check that a file contains the packets first to first + count - 1.
+    void checkFile(const ts::UString& name, size_t first, size_t count);
+
+    // Delete all segment files.
+    void cleanup();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TSFileOutputArgsTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+TSFileOutputArgsTest::TSFileOutputArgsTest() :
+    _tempPrefix(ts::TempFile(u"")),
+    _tempFileName(_tempPrefix + u".ts")
+{
+}
+
+// Test suite initialization method.
+void TSFileOutputArgsTest::setUp()
+{
+    cleanup();
+}
+
+// Test suite cleanup method.
+void TSFileOutputArgsTest::tearDown()
+{
+    cleanup();
+}
+
+ts::Report& TSFileOutputArgsTest::report()
+{
+    if (utest::DebugMode()) {
+        return CERR;
+    }
+    else {
+        return NULLREP;
+    }
+}
+
+void TSFileOutputArgsTest::cleanup()
+{
+    const ts::UStringVector segments(getSegments());
+    for (auto it = segments.begin(); it != segments.end(); ++it) {
+        ts::DeleteFile(*it);
+    }
+    ts::DeleteFile(_tempFileName);
+    ts::DeleteFile(_tempFileName + u".next");
+}
+
+bool TSFileOutputArgsTest::loadArgs(ts::TSFileOutputArgs& file, const ts::UStringVector& options)
+{
+    ts::Args args(u"test", u"[options] filename", ts::Args::NO_EXIT_ON_ERROR);
+    args.redirectReport(&report());
+    args.option(u"", 0, ts::Args::STRING, 0, 1);
+    file.defineOptions(args);
+    ts::UStringVector params(options);
+    params.push_back(_tempFileName);
+    return args.analyze(u"test", params) && file.loadArgs(args) && args.valid();
+}
+
+void TSFileOutputArgsTest::writePackets(ts::TSFileOutputArgs& file, size_t first, size_t count, size_t max_packets)
+{
+    ts::TSPacketVector buffer(max_packets);
+    size_t index = 0;
+    while (index < count) {
+        const size_t size = std::min(max_packets, count - index);
+        for (size_t i = 0; i < size; ++i) {
+            buffer[i] = ts::NullPacket;
+            ts::PutUInt32(buffer[i].b + 4, uint32_t(first + index + i));
+        }
+        CPPUNIT_ASSERT(file.write(buffer.data(), size, report()));
+        index += size;
+    }
+}
+
+ts::UStringVector TSFileOutputArgsTest::getSegments()
+{
+    ts::UStringVector segments;
+    CPPUNIT_ASSERT(ts::ExpandWildcard(segments, _tempPrefix + u"-*.ts"));
+    std::sort(segments.begin(), segments.end());
+
+    // Check the name template.
+    for (auto it = segments.begin(); it != segments.end(); ++it) {
+        CPPUNIT_ASSERT_EQUAL(_tempPrefix.size() + 23, it->size());
+        CPPUNIT_ASSERT(it->startWith(_tempPrefix + u"-"));
+        CPPUNIT_ASSERT(it->endWith(u".ts"));
+    }
+    return segments;
+}
+
+void TSFileOutputArgsTest::checkFile(const ts::UString& name, size_t first, size_t count)
+{
+    ts::ByteBlock data;
+    CPPUNIT_ASSERT(data.loadFromFile(name, 100000000, &report()));
+    CPPUNIT_ASSERT_EQUAL(count * ts::PKT_SIZE, data.size());
+    for (size_t i = 0; i < count; ++i) {
+        CPPUNIT_ASSERT_EQUAL(ts::SYNC_BYTE, data[i * ts::PKT_SIZE]);
+        CPPUNIT_ASSERT_EQUAL(uint32_t(first + i), ts::GetUInt32(&data[i * ts::PKT_SIZE + 4]));
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test cases
+//----------------------------------------------------------------------------
+
+void TSFileOutputArgsTest::testOptions()
+{
+    ts::TSFileOutputArgs file;
+    CPPUNIT_ASSERT(loadArgs(file, {}));
+    CPPUNIT_ASSERT(!file.isSegmented());
+    CPPUNIT_ASSERT(loadArgs(file, {u"--max-size", u"1000"}));
+    CPPUNIT_ASSERT(file.isSegmented());
+    CPPUNIT_ASSERT(loadArgs(file, {u"--max-duration", u"10", u"--wall-clock", u"--max-files", u"3"}));
+    CPPUNIT_ASSERT(file.isSegmented());
+
+    // Segment files are always new files.
+    CPPUNIT_ASSERT(!loadArgs(file, {u"--max-size", u"1000", u"--append"}));
+    CPPUNIT_ASSERT(!loadArgs(file, {u"--max-duration", u"10", u"--keep"}));
+    CPPUNIT_ASSERT(!loadArgs(file, {u"--max-files", u"3"}));
+    CPPUNIT_ASSERT(!loadArgs(file, {u"--wall-clock"}));
+}
+
+void TSFileOutputArgsTest::testSingleFile()
+{
+    ts::TSFileOutputArgs file;
+    CPPUNIT_ASSERT(loadArgs(file, {u"--async-depth", u"2"}));
+    CPPUNIT_ASSERT(file.open(report()));
+    writePackets(file, 0, 500, 37);
+    CPPUNIT_ASSERT(file.close(report()));
+    checkFile(_tempFileName, 0, 500);
+    CPPUNIT_ASSERT(getSegments().empty());
+
+    CPPUNIT_ASSERT(loadArgs(file, {u"--append"}));
+    CPPUNIT_ASSERT(file.open(report()));
+    writePackets(file, 500, 100, 37);
+    CPPUNIT_ASSERT(file.close(report()));
+    checkFile(_tempFileName, 0, 600);
+
+    CPPUNIT_ASSERT(loadArgs(file, {u"--keep"}));
+    CPPUNIT_ASSERT(!file.open(report()));
+    checkFile(_tempFileName, 0, 600);
+}
+
+void TSFileOutputArgsTest::testSizeRotation()
+{
+    // The segment size is rounded down to 10 packets. The packets are written 7 at a time:
+    // the segment boundaries are in the middle of the write operations.
+    ts::TSFileOutputArgs file;
+    CPPUNIT_ASSERT(loadArgs(file, {u"--max-size", u"1900"}));
+    CPPUNIT_ASSERT(file.open(report()));
+    writePackets(file, 0, 95, 7);
+    CPPUNIT_ASSERT(file.close(report()));
+
+    ts::TSFileOutput::WriteStatistics stats;
+    file.getWriteStatistics(stats);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(95 * ts::PKT_SIZE), stats.bytes);
+
+    // Several segments are created in the same millisecond, the names remain unique
+    // and the alphabetical order is the creation order.
+    const ts::UStringVector segments(getSegments());
+    CPPUNIT_ASSERT_EQUAL(size_t(10), segments.size());
+    for (size_t i = 0; i < segments.size(); ++i) {
+        checkFile(segments[i], 10 * i, i < 9 ? 10 : 5);
+    }
+    CPPUNIT_ASSERT(!ts::FileExists(_tempFileName));
+    CPPUNIT_ASSERT(!ts::FileExists(_tempFileName + u".next"));
+
+    // A second execution creates new segments after the previous ones. The names of the
+    // segments which were created in the same millisecond use the next milliseconds.
+    ts::SleepThread(100);
+    CPPUNIT_ASSERT(loadArgs(file, {u"--max-size", u"1880", u"--async-depth", u"2"}));
+    CPPUNIT_ASSERT(file.open(report()));
+    writePackets(file, 95, 20, 1);
+    CPPUNIT_ASSERT(file.close(report()));
+
+    const ts::UStringVector all(getSegments());
+    CPPUNIT_ASSERT_EQUAL(size_t(12), all.size());
+    CPPUNIT_ASSERT(std::equal(segments.begin(), segments.end(), all.begin()));
+    checkFile(all[10], 95, 10);
+    checkFile(all[11], 105, 10);
+}
+
+void TSFileOutputArgsTest::testDurationRotation()
+{
+    // The segment switch is checked once per write operation.
+    ts::TSFileOutputArgs file;
+    CPPUNIT_ASSERT(loadArgs(file, {u"--max-duration", u"1"}));
+    CPPUNIT_ASSERT(file.open(report()));
+    writePackets(file, 0, 20, 7);
+    ts::SleepThread(1100);
+    writePackets(file, 20, 30, 30);
+    writePackets(file, 50, 10, 3);
+    ts::SleepThread(1100);
+    writePackets(file, 60, 5, 5);
+    CPPUNIT_ASSERT(file.close(report()));
+
+    const ts::UStringVector segments(getSegments());
+    CPPUNIT_ASSERT_EQUAL(size_t(3), segments.size());
+    checkFile(segments[0], 0, 20);
+    checkFile(segments[1], 20, 40);
+    checkFile(segments[2], 60, 5);
+}
+
+void TSFileOutputArgsTest::testMaxFiles()
+{
+    ts::TSFileOutputArgs file;
+    CPPUNIT_ASSERT(loadArgs(file, {u"--max-size", u"940", u"--max-files", u"3"}));
+    CPPUNIT_ASSERT(file.open(report()));
+    writePackets(file, 0, 52, 4);
+    CPPUNIT_ASSERT(file.close(report()));
+
+    // 11 segments were created, the 3 last ones are retained.
+    const ts::UStringVector segments(getSegments());
+    CPPUNIT_ASSERT_EQUAL(size_t(3), segments.size());
+    checkFile(segments[0], 40, 5);
+    checkFile(segments[1], 45, 5);
+    checkFile(segments[2], 50, 2);
+
+    // The segments of a previous execution are not deleted.
+    ts::SleepThread(100);
+    CPPUNIT_ASSERT(loadArgs(file, {u"--max-size", u"940", u"--max-files", u"2"}));
+    CPPUNIT_ASSERT(file.open(report()));
+    writePackets(file, 52, 15, 15);
+    CPPUNIT_ASSERT(file.close(report()));
+
+    const ts::UStringVector all(getSegments());
+    CPPUNIT_ASSERT_EQUAL(size_t(5), all.size());
+    CPPUNIT_ASSERT(std::equal(segments.begin(), segments.end(), all.begin()));
+    checkFile(all[3], 57, 5);
+    checkFile(all[4], 62, 5);
+}
+
+void TSFileOutputArgsTest::testTrimming()
+{
+    // The next segments are preallocated with the size of the largest segment.
+    // Leave time to the helper thread to prepare them.
+    ts::TSFileOutputArgs file;
+    CPPUNIT_ASSERT(loadArgs(file, {u"--max-size", u"188000"}));
+    CPPUNIT_ASSERT(file.open(report()));
+    writePackets(file, 0, 1000, 100);
+    ts::SleepThread(200);
+    writePackets(file, 1000, 1000, 100);
+    ts::SleepThread(200);
+    writePackets(file, 2000, 10, 10);
+    CPPUNIT_ASSERT(file.close(report()));
+
+    // The size of the last segment is the written size.
+    const ts::UStringVector segments(getSegments());
+    CPPUNIT_ASSERT_EQUAL(size_t(3), segments.size());
+    checkFile(segments[0], 0, 1000);
+    checkFile(segments[1], 1000, 1000);
+    checkFile(segments[2], 2000, 10);
+
+#if defined(TS_LINUX)
+    // The unused preallocated space of the last segment is released.
+    struct ::stat st;
+    CPPUNIT_ASSERT(::stat(segments[2].toUTF8().c_str(), &st) == 0);
+    utest::Out() << "TSFileOutputArgsTest: last segment: " << st.st_size << " bytes, " << (st.st_blocks * 512) << " allocated" << std::endl;
+    CPPUNIT_ASSERT(st.st_blocks * 512 < 100000);
+#endif
+}
@@ -44,6 +44,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsThreadAttributes.h"
+#include "tsUString.h"
 #include "utestCppUnitTest.h"
 TSDUCK_SOURCE;
 
@@ -61,11 +62,15 @@ public:
     void testStackSize();
     void testDeleteWhenTerminated();
     void testPriority();
+    void testAffinity();
+    void testCPUList();
 
     CPPUNIT_TEST_SUITE (ThreadAttributesTest);
     CPPUNIT_TEST (testStackSize);
     CPPUNIT_TEST (testDeleteWhenTerminated);
     CPPUNIT_TEST (testPriority);
+    CPPUNIT_TEST (testAffinity);
+    CPPUNIT_TEST (testCPUList);
     CPPUNIT_TEST_SUITE_END ();
 };
 
@@ -134,3 +139,44 @@ void ThreadAttributesTest::testPriority()
     attr.setPriority (ts::ThreadAttributes::GetNormalPriority());
     CPPUNIT_ASSERT(attr.getPriority() == ts::ThreadAttributes::GetNormalPriority());
 }
+
+void ThreadAttributesTest::testAffinity()
+{
+    ts::ThreadAttributes attr;
+    CPPUNIT_ASSERT(attr.getAffinity().empty()); // default value
+
+    ts::ThreadAttributes::CPUSet cpus;
+    cpus.insert(1);
+    cpus.insert(3);
+    CPPUNIT_ASSERT(attr.setAffinity(cpus).getAffinity() == cpus);
+    CPPUNIT_ASSERT(attr.setAffinity(ts::ThreadAttributes::CPUSet()).getAffinity().empty());
+
+    // Setting the current affinity to itself shall not fail when supported.
+    if (ts::ThreadAttributes::GetCurrentThreadAffinity(cpus)) {
+        utest::Out() << "ThreadAttributesTest: current thread affinity: " << cpus.size() << " CPU's" << std::endl;
+        CPPUNIT_ASSERT(!cpus.empty());
+        CPPUNIT_ASSERT(ts::ThreadAttributes::SetCurrentThreadAffinity(cpus));
+    }
+}
+
+void ThreadAttributesTest::testCPUList()
+{
+    ts::ThreadAttributes::CPUSet cpus;
+
+    CPPUNIT_ASSERT(ts::ThreadAttributes::DecodeCPUList(u"0-3,8, 10-11", cpus));
+    CPPUNIT_ASSERT_EQUAL(size_t(7), cpus.size());
+    CPPUNIT_ASSERT(cpus.count(0) == 1);
+    CPPUNIT_ASSERT(cpus.count(3) == 1);
+    CPPUNIT_ASSERT(cpus.count(4) == 0);
+    CPPUNIT_ASSERT(cpus.count(8) == 1);
+    CPPUNIT_ASSERT(cpus.count(11) == 1);
+
+    CPPUNIT_ASSERT(ts::ThreadAttributes::DecodeCPUList(u"5", cpus));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), cpus.size());
+    CPPUNIT_ASSERT(cpus.count(5) == 1);
+
+    CPPUNIT_ASSERT(!ts::ThreadAttributes::DecodeCPUList(u"", cpus));
+    CPPUNIT_ASSERT(!ts::ThreadAttributes::DecodeCPUList(u"3-1", cpus));
+    CPPUNIT_ASSERT(!ts::ThreadAttributes::DecodeCPUList(u"1,x", cpus));
+    CPPUNIT_ASSERT(!ts::ThreadAttributes::DecodeCPUList(u"0-99999999", cpus));
+}
@@ -52,6 +52,7 @@ public:
 
     void testIsSpace();
     void testUTF();
+    void testUTFRuns();
     void testDiacritical();
     void testSurrogate();
     void testWidth();
@@ -99,6 +100,7 @@ public:
     CPPUNIT_TEST_SUITE(UStringTest);
     CPPUNIT_TEST(testIsSpace);
     CPPUNIT_TEST(testUTF);
+    CPPUNIT_TEST(testUTFRuns);
     CPPUNIT_TEST(testDiacritical);
     CPPUNIT_TEST(testSurrogate);
     CPPUNIT_TEST(testWidth);
@@ -313,6 +315,60 @@ void UStringTest::testDiacritical()
     CPPUNIT_ASSERT(ts::IsCombiningDiacritical(ts::RIGHT_TO_LEFT_MARK));
 }
 
+void UStringTest::testUTFRuns()
+{
+    // Runs of ASCII characters of all lengths around the size of vectorized blocks,
+    // separated by non-ASCII characters of all UTF-8 sizes.
+    static const uint32_t separators[] = {0x00E9, 0x20AC, 0x1D538};
+    static const char* const utf8_separators[] = {"\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9D\x94\xB8"};
+
+    for (size_t is = 0; is < 3; ++is) {
+        for (size_t len = 0; len <= 40; ++len) {
+            ts::UString ref;
+            std::string utf8;
+            for (size_t rep = 0; rep < 3; ++rep) {
+                for (size_t i = 0; i < len; ++i) {
+                    const char c = char('!' + (i + rep) % 90);
+                    ref.push_back(ts::UChar(c));
+                    utf8.push_back(c);
+                }
+                ref.append(separators[is]);
+                utf8.append(utf8_separators[is]);
+            }
+            CPPUNIT_ASSERT_USTRINGS_EQUAL(ref, ts::UString::FromUTF8(utf8));
+            CPPUNIT_ASSERT_STRINGS_EQUAL(utf8, ref.toUTF8());
+        }
+    }
+
+    // The conversion stops exactly at the end of the output buffer.
+    const std::string text("The quick brown fox jumps over the lazy dog, twice.");
+    ts::UChar out16[40];
+    const char* in8 = text.data();
+    ts::UChar* pout16 = out16;
+    ts::UString::ConvertUTF8ToUTF16(in8, text.data() + text.size(), pout16, out16 + 37);
+    CPPUNIT_ASSERT(in8 == text.data() + 37);
+    CPPUNIT_ASSERT(pout16 == out16 + 37);
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(ts::UString::FromUTF8(text.substr(0, 37)), ts::UString(out16, 37));
+
+    const ts::UString utext(ts::UString::FromUTF8(text));
+    char out8[40];
+    const ts::UChar* in16 = utext.data();
+    char* pout8 = out8;
+    ts::UString::ConvertUTF16ToUTF8(in16, utext.data() + utext.size(), pout8, out8 + 33);
+    CPPUNIT_ASSERT(in16 == utext.data() + 33);
+    CPPUNIT_ASSERT(pout8 == out8 + 33);
+    CPPUNIT_ASSERT_STRINGS_EQUAL(text.substr(0, 33), std::string(out8, 33));
+
+    // Conversion of a restricted range of ASCII characters.
+    const std::string ctrl("abcdefghijklmnopqrstuvwxyz0123456789\nABCD");
+    in8 = ctrl.data();
+    pout16 = out16;
+    ts::UString::ConvertASCIIToUTF16(in8, ctrl.data() + ctrl.size(), pout16, out16 + 40, 0x20, 0x7E);
+    CPPUNIT_ASSERT(in8 == ctrl.data() + 36);
+    CPPUNIT_ASSERT(pout16 == out16 + 36);
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"abcdefghijklmnopqrstuvwxyz0123456789", ts::UString(out16, 36));
+}
+
 void UStringTest::testSurrogate()
 {
     const ts::UString ab({MATH_A1, MATH_A2, MATH_B1, MATH_B2});
@@ -33,6 +33,7 @@
 
 #include "tsxmlDocument.h"
 #include "tsxmlElement.h"
+#include "tsxmlPullParser.h"
 #include "tsTextFormatter.h"
 #include "tsCerrReport.h"
 #include "tsReportBuffer.h"
@@ -61,6 +62,8 @@ public:
     void testKeepOpen();
     void testEscape();
     void testTweaks();
+    void testPullParser();
+    void testPullParserInvalid();
 
     CPPUNIT_TEST_SUITE(XMLTest);
     CPPUNIT_TEST(testDocument);
@@ -71,6 +74,8 @@ public:
     CPPUNIT_TEST(testKeepOpen);
     CPPUNIT_TEST(testEscape);
     CPPUNIT_TEST(testTweaks);
+    CPPUNIT_TEST(testPullParser);
+    CPPUNIT_TEST(testPullParserInvalid);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -473,3 +478,103 @@ void XMLTest::testTweaks()
         u"<root a1=\"foo\" a2=\"ab&amp;<>'&quot;cd\" a3='ef\"gh' a4=\"ij'kl\">text&lt;&amp;'\"&gt;text</root>\n",
         doc.toString());
 }
+
+void XMLTest::testPullParser()
+{
+    std::istringstream strm(
+        "<?xml version='1.0' encoding='UTF-8'?>\n"
+        "<!-- leading comment -->\n"
+        "<root attr1=\"val1\"\n"
+        "      attr2=\"val2\">\n"
+        "  <!-- comment in root -->\n"
+        "  <node1 a1=\"v>1\" a2='/'>Text in node1</node1><node2/>\n"
+        "  <node3>\n"
+        "    <node3><sub/></node3>\n"
+        "    <![CDATA[</node3> <foo>]]>\n"
+        "    <!-- </node3> -->\n"
+        "  </node3>\n"
+        "</root>\n"
+        "<!-- trailing comment -->\n");
+
+    ts::xml::PullParser parser(report());
+    CPPUNIT_ASSERT(parser.open(strm));
+    CPPUNIT_ASSERT(parser.isOpen());
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"root", parser.rootName());
+
+    ts::xml::Document doc(report());
+    CPPUNIT_ASSERT(parser.readElement(doc));
+    ts::xml::Element* root = doc.rootElement();
+    CPPUNIT_ASSERT(root != nullptr);
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"root", root->name());
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"val1", root->attribute(u"attr1").value());
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"val2", root->attribute(u"attr2").value());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), root->childrenCount());
+    ts::xml::Element* elem = root->firstChildElement();
+    CPPUNIT_ASSERT(elem != nullptr);
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"node1", elem->name());
+    CPPUNIT_ASSERT_EQUAL(size_t(6), elem->lineNumber());
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"v>1", elem->attribute(u"a1").value());
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"/", elem->attribute(u"a2").value());
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"Text in node1", elem->text());
+
+    CPPUNIT_ASSERT(parser.readElement(doc));
+    root = doc.rootElement();
+    CPPUNIT_ASSERT(root != nullptr);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), root->childrenCount());
+    elem = root->firstChildElement();
+    CPPUNIT_ASSERT(elem != nullptr);
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"node2", elem->name());
+    CPPUNIT_ASSERT(!elem->hasChildren());
+
+    CPPUNIT_ASSERT(parser.readElement(doc));
+    root = doc.rootElement();
+    CPPUNIT_ASSERT(root != nullptr);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), root->childrenCount());
+    elem = root->firstChildElement();
+    CPPUNIT_ASSERT(elem != nullptr);
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"node3", elem->name());
+    CPPUNIT_ASSERT_EQUAL(size_t(7), elem->lineNumber());
+    ts::xml::Element* sub = elem->firstChildElement();
+    CPPUNIT_ASSERT(sub != nullptr);
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"node3", sub->name());
+    CPPUNIT_ASSERT_EQUAL(size_t(8), sub->lineNumber());
+    CPPUNIT_ASSERT(sub->nextSiblingElement() == nullptr);
+
+    CPPUNIT_ASSERT(!parser.readElement(doc));
+    CPPUNIT_ASSERT(!parser.hasError());
+    CPPUNIT_ASSERT(!parser.isOpen());
+    CPPUNIT_ASSERT(!doc.hasChildren());
+}
+
+void XMLTest::testPullParserInvalid()
+{
+    std::istringstream strm(
+        "<?xml version='1.0' encoding='UTF-8'?>\n"
+        "<foo>\n"
+        "  <bar/>\n"
+        "  <bar>\n"
+        "</foo>\n");
+
+    ts::ReportBuffer<> rep;
+    ts::xml::PullParser parser(rep);
+    CPPUNIT_ASSERT(parser.open(strm));
+
+    ts::xml::Document doc(rep);
+    CPPUNIT_ASSERT(parser.readElement(doc));
+    CPPUNIT_ASSERT(!parser.readElement(doc));
+    CPPUNIT_ASSERT(parser.hasError());
+    CPPUNIT_ASSERT(!parser.isOpen());
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"Error: line 5: parsing error, expected </bar> to match <bar> at line 4", rep.getMessages());
+
+    // Truncated document.
+    std::istringstream strm2(
+        "<foo>\n"
+        "  <bar>\n"
+        "    <x/>\n");
+
+    rep.resetMessages();
+    CPPUNIT_ASSERT(parser.open(strm2));
+    CPPUNIT_ASSERT(!parser.readElement(doc));
+    CPPUNIT_ASSERT(parser.hasError());
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"Error: line 3: unexpected end of document, element starting at line 2 is not terminated", rep.getMessages());
+}